@@ -0,0 +1,131 @@
+/**
+ * Ping-pong latency benchmark: kora_channel versus sys_pipe
+ *
+ * A forked child echoes every message back to the parent. The parent
+ * times each round trip and prints percentiles as JSON.
+ *
+ * Usage: bench_channel [iterations] [message_size]
+ */
+
+#include "bench_harness.h"
+
+#include <kora/syscalls.h>
+#include <kora/channel.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WARMUP 1000
+
+static void report(const char *name, uint64_t *samples, size_t n, int last) {
+    bench_stats_t stats = bench_summarize(samples, n);
+    printf("    {\"name\": \"%s\", ", name);
+    bench_print_stats(&stats);
+    printf("}%s\n", last ? "" : ",");
+}
+
+static void bench_channel(uint64_t *samples, size_t iters, size_t msg_size) {
+    size_t one = kora_channel_footprint(64, (uint32_t)msg_size);
+    int fd = sys_shm_create(NULL, 2 * one, KORA_SHM_CLOEXEC);
+    unsigned char *mem = sys_mmap(NULL, 2 * one, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    sys_close(fd);
+    if (mem == (void *)-1) {
+        perror("mmap");
+        exit(1);
+    }
+
+    kora_channel_t *req = kora_channel_init(mem, one, 64, (uint32_t)msg_size, KORA_CHANNEL_SPSC);
+    kora_channel_t *rsp = kora_channel_init(mem + one, one, 64, (uint32_t)msg_size, KORA_CHANNEL_SPSC);
+    char *buf = calloc(1, msg_size);
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        int n;
+        while ((n = kora_channel_recv(req, buf, msg_size, -1)) >= 0) {
+            kora_channel_send(rsp, buf, (size_t)n, -1);
+        }
+        sys_exit(0);
+    }
+
+    for (size_t i = 0; i < WARMUP + iters; i++) {
+        uint64_t start = bench_now_ns();
+        kora_channel_send(req, buf, msg_size, -1);
+        kora_channel_recv(rsp, buf, msg_size, -1);
+        if (i >= WARMUP) {
+            samples[i - WARMUP] = bench_now_ns() - start;
+        }
+    }
+
+    kora_channel_close(req);
+    sys_wait(pid, NULL, 0);
+    sys_munmap(mem, 2 * one);
+    free(buf);
+}
+
+static void bench_pipe(uint64_t *samples, size_t iters, size_t msg_size) {
+    int to_child[2], to_parent[2];
+    if (sys_pipe2(to_child, 0) != 0 || sys_pipe2(to_parent, 0) != 0) {
+        perror("pipe");
+        exit(1);
+    }
+    char *buf = calloc(1, msg_size);
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        sys_close(to_child[1]);
+        sys_close(to_parent[0]);
+        int n;
+        while ((n = sys_read(to_child[0], buf, msg_size)) > 0) {
+            sys_write(to_parent[1], buf, (size_t)n);
+        }
+        sys_exit(0);
+    }
+    sys_close(to_child[0]);
+    sys_close(to_parent[1]);
+
+    for (size_t i = 0; i < WARMUP + iters; i++) {
+        uint64_t start = bench_now_ns();
+        sys_write(to_child[1], buf, msg_size);
+        size_t got = 0;
+        while (got < msg_size) {
+            int n = sys_read(to_parent[0], buf + got, msg_size - got);
+            if (n <= 0) {
+                exit(1);
+            }
+            got += (size_t)n;
+        }
+        if (i >= WARMUP) {
+            samples[i - WARMUP] = bench_now_ns() - start;
+        }
+    }
+
+    sys_close(to_child[1]);
+    sys_wait(pid, NULL, 0);
+    sys_close(to_parent[0]);
+    free(buf);
+}
+
+int main(int argc, char **argv) {
+    size_t iters = argc > 1 ? strtoul(argv[1], NULL, 10) : 100000;
+    size_t msg_size = argc > 2 ? strtoul(argv[2], NULL, 10) : 64;
+    if (iters == 0 || msg_size == 0) {
+        fprintf(stderr, "usage: %s [iterations] [message_size]\n", argv[0]);
+        return 1;
+    }
+
+    uint64_t *samples = malloc(iters * sizeof(*samples));
+
+    printf("{\n  \"benchmark\": \"pingpong\",\n  \"iterations\": %zu,\n"
+           "  \"message_size\": %zu,\n  \"results\": [\n", iters, msg_size);
+    bench_channel(samples, iters, msg_size);
+    report("kora_channel_spsc", samples, iters, 0);
+    bench_pipe(samples, iters, msg_size);
+    report("sys_pipe", samples, iters, 1);
+    printf("  ]\n}\n");
+
+    free(samples);
+    return 0;
+}
@@ -0,0 +1,131 @@
+/**
+ * Dispatch overhead benchmark
+ *
+ * Built twice from the same source: bench_dispatch calls the out-of-line
+ * sys_* wrappers, bench_dispatch_inline is compiled with
+ * KORA_INLINE_DISPATCH and calls the platform functions directly. Running
+ * both shows what the extra call costs for the cheapest entry points,
+ * where it is largest relative to the work done. The getpid_layer case
+ * pushes a backend layer that forwards getpid, which is what tracing or
+ * test layers built on kora/backend.h add to a call. fd_slot_get reads
+ * a per-descriptor slot from kora/fd.h, the lookup a feature keeping
+ * state per descriptor adds to each call.
+ *
+ * Usage: bench_dispatch [iterations]
+ */
+
+#include "bench_harness.h"
+
+#include <kora/backend.h>
+#include <kora/fd.h>
+#include <kora/syscalls.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BATCH 256
+
+#ifdef KORA_INLINE_DISPATCH
+#define MODE "inline"
+#else
+#define MODE "outline"
+#endif
+
+static sem_t sem;
+static volatile long sink;
+
+static void op_clock_gettime(void) {
+    struct timespec ts;
+    sys_clock_gettime(CLOCK_MONOTONIC, &ts);
+    sink += ts.tv_nsec;
+}
+
+static void op_sem_post_wait(void) {
+    sys_sem_post(&sem);
+    sys_sem_wait(&sem);
+}
+
+static void op_getpid(void) {
+    sink += sys_getpid();
+}
+
+static void op_gettid(void) {
+    sink += sys_gettid();
+}
+
+static const kora_backend_ops_t *layer_next;
+
+static pid_t layer_getpid(void) {
+    return layer_next->getpid();
+}
+
+static const kora_backend_ops_t layer = { .getpid = layer_getpid };
+
+static void push_layer(void) {
+    kora_backend_push(&layer, &layer_next);
+}
+
+static int slot_fd;
+static int slot;
+static int slot_value;
+
+static void op_fd_slot_get(void) {
+    sink += kora_fd_get(slot_fd, slot) != NULL;
+}
+
+static void set_slot(void) {
+    slot = kora_fd_slot_register(NULL);
+    slot_fd = sys_open("/dev/null", KORA_O_RDONLY);
+    kora_fd_set(slot_fd, slot, &slot_value);
+}
+
+static const struct {
+    const char *name;
+    void (*op)(void);
+    void (*setup)(void);
+} cases[] = {
+    { "clock_gettime", op_clock_gettime, NULL },
+    { "sem_post_wait", op_sem_post_wait, NULL },
+    { "getpid",        op_getpid,        NULL },
+    { "gettid",        op_gettid,        NULL },
+    { "fd_slot_get",   op_fd_slot_get,   set_slot },
+    { "getpid_layer",  op_getpid,        push_layer },  /* Last: stays pushed */
+};
+
+int main(int argc, char **argv) {
+    size_t iters = argc > 1 ? strtoul(argv[1], NULL, 10) : 20000;
+    if (iters == 0) {
+        fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    uint64_t *samples = malloc(iters * sizeof(*samples));
+    sem_init(&sem, 0, 0);
+
+    printf("{\n  \"benchmark\": \"dispatch\",\n  \"mode\": \"%s\",\n"
+           "  \"iterations\": %zu,\n  \"ops_per_sample\": %d,\n  \"results\": [\n",
+           MODE, iters, BATCH);
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        if (cases[c].setup != NULL) {
+            cases[c].setup();
+        }
+        for (size_t i = 0; i < iters / 10; i++) {
+            cases[c].op();
+        }
+        for (size_t i = 0; i < iters; i++) {
+            uint64_t start = bench_now_ns();
+            for (int j = 0; j < BATCH; j++) {
+                cases[c].op();
+            }
+            samples[i] = (bench_now_ns() - start) / BATCH;
+        }
+        bench_stats_t stats = bench_summarize(samples, iters);
+        printf("    {\"name\": \"%s\", ", cases[c].name);
+        bench_print_stats(&stats);
+        printf("}%s\n", c + 1 < sizeof(cases) / sizeof(cases[0]) ? "," : "");
+    }
+    printf("  ]\n}\n");
+
+    sem_destroy(&sem);
+    free(samples);
+    return 0;
+}
@@ -0,0 +1,45 @@
+#include "bench_harness.h"
+
+#include <kora/syscalls.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    sys_clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+bench_stats_t bench_summarize(uint64_t *samples, size_t n) {
+    bench_stats_t stats = {0, 0, 0, 0, 0};
+    uint64_t total = 0;
+
+    if (n == 0) {
+        return stats;
+    }
+    for (size_t i = 0; i < n; i++) {
+        total += samples[i];
+    }
+    qsort(samples, n, sizeof(*samples), cmp_u64);
+    stats.mean_ns = total / n;
+    stats.p50_ns = samples[n / 2];
+    stats.p90_ns = samples[n * 90 / 100];
+    stats.p99_ns = samples[n * 99 / 100];
+    stats.max_ns = samples[n - 1];
+    return stats;
+}
+
+void bench_print_stats(const bench_stats_t *stats) {
+    printf("\"mean_ns\": %llu, \"p50_ns\": %llu, \"p90_ns\": %llu, "
+           "\"p99_ns\": %llu, \"max_ns\": %llu",
+           (unsigned long long)stats->mean_ns,
+           (unsigned long long)stats->p50_ns,
+           (unsigned long long)stats->p90_ns,
+           (unsigned long long)stats->p99_ns,
+           (unsigned long long)stats->max_ns);
+}
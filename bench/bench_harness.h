@@ -0,0 +1,28 @@
+/**
+ * Shared helpers for the benchmark programs
+ *
+ * Samples are nanosecond durations. Percentiles are taken by sorting the
+ * samples in place, so report after all samples for a series are taken.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    uint64_t mean_ns;
+    uint64_t p50_ns;
+    uint64_t p90_ns;
+    uint64_t p99_ns;
+    uint64_t max_ns;
+} bench_stats_t;
+
+/** Monotonic time in nanoseconds, read through sys_clock_gettime */
+uint64_t bench_now_ns(void);
+
+/** Sort samples and compute their summary */
+bench_stats_t bench_summarize(uint64_t *samples, size_t n);
+
+/** Print stats as a JSON object body, without braces */
+void bench_print_stats(const bench_stats_t *stats);
@@ -0,0 +1,148 @@
+/**
+ * Raw Linux backend benchmark
+ *
+ * Compares the glibc backend with the raw system calls of
+ * kora/linux_raw.h. The startup cases spawn and wait for the two builds
+ * of bench_raw_start.c. The per-call cases run each call directly
+ * (_raw), through sys_* with the default backend (_glibc), and through
+ * sys_* with the raw backend pushed (_layer).
+ *
+ * Usage: bench_raw [iterations]
+ */
+
+#include "bench_harness.h"
+
+#include <kora/backend.h>
+#include <kora/linux_raw.h>
+#include <kora/syscalls.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BATCH 64
+
+static volatile long sink;
+static int null_fd;
+static kora_stat_t st;
+
+static void start(const char *path) {
+    char *argv[] = { (char *)path, NULL };
+    int status = 0;
+
+    pid_t pid = sys_spawn(path, argv, NULL);
+    if (pid < 0 || sys_wait(pid, &status, 0) != pid || status != 0) {
+        fprintf(stderr, "%s did not run\n", path);
+        exit(1);
+    }
+}
+
+static void op_start_raw(void) {
+    start(RAW_START_PATH);
+}
+
+static void op_start_glibc(void) {
+    start(GLIBC_START_PATH);
+}
+
+static void op_getpid(void) {
+    sink += sys_getpid();
+}
+
+static void op_getpid_raw(void) {
+    sink += kora_raw_getpid();
+}
+
+static void op_write(void) {
+    sink += sys_write(null_fd, "x", 1);
+}
+
+static void op_write_raw(void) {
+    sink += kora_raw_write(null_fd, "x", 1);
+}
+
+static void op_stat(void) {
+    sink += sys_stat("/", &st);
+}
+
+static void op_stat_raw(void) {
+    sink += kora_raw_stat("/", &st);
+}
+
+static void op_clock_gettime(void) {
+    struct timespec ts;
+    sys_clock_gettime(CLOCK_MONOTONIC, &ts);
+    sink += ts.tv_nsec;
+}
+
+static void op_clock_gettime_raw(void) {
+    struct timespec ts;
+    kora_raw_clock_gettime(CLOCK_MONOTONIC, &ts);
+    sink += ts.tv_nsec;
+}
+
+static const kora_backend_ops_t *next;
+
+static void push_raw(void) {
+    kora_backend_push(kora_backend_linux_raw(), &next);
+}
+
+static const struct {
+    const char *name;
+    void (*op)(void);
+    void (*setup)(void);
+    int batch;
+} cases[] = {
+    { "start_raw",           op_start_raw,         NULL,     1 },
+    { "start_glibc",         op_start_glibc,       NULL,     1 },
+    { "getpid_raw",          op_getpid_raw,        NULL,     BATCH },
+    { "getpid_glibc",        op_getpid,            NULL,     BATCH },
+    { "write_raw",           op_write_raw,         NULL,     BATCH },
+    { "write_glibc",         op_write,             NULL,     BATCH },
+    { "stat_raw",            op_stat_raw,          NULL,     BATCH },
+    { "stat_glibc",          op_stat,              NULL,     BATCH },
+    { "clock_gettime_raw",   op_clock_gettime_raw, NULL,     BATCH },
+    { "clock_gettime_glibc", op_clock_gettime,     NULL,     BATCH },
+    /* Last: the layer stays pushed */
+    { "getpid_layer",        op_getpid,            push_raw, BATCH },
+    { "write_layer",         op_write,             NULL,     BATCH },
+    { "stat_layer",          op_stat,              NULL,     BATCH },
+};
+
+int main(int argc, char **argv) {
+    size_t iters = argc > 1 ? strtoul(argv[1], NULL, 10) : 20000;
+    if (iters == 0) {
+        fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    uint64_t *samples = malloc(iters * sizeof(*samples));
+    null_fd = sys_open("/dev/null", KORA_O_WRONLY);
+
+    printf("{\n  \"benchmark\": \"raw\",\n  \"iterations\": %zu,\n  \"results\": [\n", iters);
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        /* Process startup is slow enough that a hundredth of the samples will do */
+        size_t n = cases[c].batch == 1 ? (iters + 99) / 100 : iters;
+
+        if (cases[c].setup != NULL) {
+            cases[c].setup();
+        }
+        for (size_t i = 0; i < n / 10; i++) {
+            cases[c].op();
+        }
+        for (size_t i = 0; i < n; i++) {
+            uint64_t t0 = bench_now_ns();
+            for (int j = 0; j < cases[c].batch; j++) {
+                cases[c].op();
+            }
+            samples[i] = (bench_now_ns() - t0) / (uint64_t)cases[c].batch;
+        }
+        bench_stats_t stats = bench_summarize(samples, n);
+        printf("    {\"name\": \"%s\", ", cases[c].name);
+        bench_print_stats(&stats);
+        printf("}%s\n", c + 1 < sizeof(cases) / sizeof(cases[0]) ? "," : "");
+    }
+    printf("  ]\n}\n");
+
+    sys_close(null_fd);
+    free(samples);
+    return 0;
+}
@@ -0,0 +1,47 @@
+/**
+ * Smallest program for bench_raw's startup comparison
+ *
+ * Built twice from the same source. bench_raw_start is linked with
+ * -nostdlib -static against koralayer_raw and begins at its own _start,
+ * with no dynamic loader and no libc initialisation. bench_glibc_start
+ * is an ordinary program making the same call through glibc. Each
+ * exits with status 0 once it has run.
+ */
+
+#if defined(KORA_RAW_START)
+
+#include <kora/linux_raw.h>
+
+/* Only the assembly below refers to it, which link-time optimisation cannot see */
+__attribute__((used)) _Noreturn void raw_main(void);
+
+_Noreturn void raw_main(void) {
+    kora_raw_exit(kora_raw_getpid() > 0 ? 0 : 1);
+}
+
+/* Clear the frame pointer for debuggers and call with the ABI's stack alignment */
+#if defined(__x86_64__)
+__asm__(".text\n"
+        ".global _start\n"
+        "_start:\n"
+        "    xor %ebp, %ebp\n"
+        "    and $-16, %rsp\n"
+        "    call raw_main\n");
+#elif defined(__aarch64__)
+__asm__(".text\n"
+        ".global _start\n"
+        "_start:\n"
+        "    mov x29, #0\n"
+        "    mov x30, #0\n"
+        "    bl raw_main\n");
+#endif
+
+#else
+
+#include <unistd.h>
+
+int main(void) {
+    return getpid() > 0 ? 0 : 1;
+}
+
+#endif
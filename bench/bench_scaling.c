@@ -0,0 +1,433 @@
+/**
+ * Thread scaling benchmark and stress run for each sys_* family
+ *
+ * Each case runs at 1, 2, 4, ... threads up to the maximum. The threads
+ * are released together from a barrier and each does the same number
+ * of operations, so throughput is the total over the wall time from the
+ * first start to the last finish. Speedup is relative to one thread: a
+ * family serialised on shared state in the layer shows a flat curve
+ * where the host call keeps climbing. Every operation checks its result
+ * (the bytes read back, the entries listed, its own errno) and the
+ * program exits with status 1 if any check failed, naming the first
+ * failure of each run on stderr. Files live in a fresh directory from
+ * mkdtemp, so concurrent runs do not collide.
+ *
+ * Usage: bench_scaling [max-threads] [ops-per-thread] [name-filter]
+ */
+
+#include "bench_harness.h"
+
+#include <kora/error.h>
+#include <kora/fd.h>
+#include <kora/syscalls.h>
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define IO_SIZE     256
+#define DIR_ENTRIES 16
+#define STAT_SIZE   1000
+
+typedef struct {
+    int id;
+    char path[128];      /* This thread's file */
+    char buf[IO_SIZE];
+    int fd;
+    int fds[2];
+    uint64_t last_ns;
+    unsigned long failures;
+    const char *failure; /* The first one */
+    uint64_t start_ns;
+    uint64_t end_ns;
+    pthread_t thread;
+} worker_t;
+
+typedef struct {
+    const char *name;
+    unsigned divisor;                /* Run ops / divisor for slow cases */
+    const char *(*init)(worker_t *w);
+    const char *(*op)(worker_t *w);  /* NULL, or what went wrong */
+    void (*fini)(worker_t *w);
+    int memfs;                       /* Runs with a memory filesystem mounted */
+} scaling_case_t;
+
+static char dir[64];
+static char list_dir[96];
+static char stat_file[96];
+static char mount_dir[96];
+static sem_t sem;
+static pid_t pid;
+static int slot = -1;
+
+static size_t ops;
+static pthread_barrier_t barrier;
+static const scaling_case_t *current;
+
+static void fail(const char *what) {
+    perror(what);
+    exit(1);
+}
+
+/* File I/O: write a pattern naming the thread, read it back */
+
+static const char *host_file_init(worker_t *w) {
+    snprintf(w->path, sizeof(w->path), "%s/f%d", dir, w->id);
+    return NULL;
+}
+
+static const char *memfs_file_init(worker_t *w) {
+    snprintf(w->path, sizeof(w->path), "%s/f%d", mount_dir, w->id);
+    return NULL;
+}
+
+static const char *file_op(worker_t *w) {
+    char back[IO_SIZE];
+
+    memset(w->buf, 'a' + w->id % 26, sizeof(w->buf));
+    int fd = sys_open(w->path, KORA_O_RDWR | KORA_O_CREAT | KORA_O_TRUNC);
+    if (fd < 0) {
+        return "open";
+    }
+    const char *err = NULL;
+    if (sys_write(fd, w->buf, sizeof(w->buf)) != sizeof(w->buf)) {
+        err = "write";
+    } else if (sys_seek(fd, 0, KORA_SEEK_SET) != 0) {
+        err = "seek";
+    } else if (sys_read(fd, back, sizeof(back)) != sizeof(back) ||
+               memcmp(back, w->buf, sizeof(back)) != 0) {
+        err = "read back another thread's data";
+    }
+    if (sys_close(fd) != KORA_SUCCESS && err == NULL) {
+        err = "close";
+    }
+    return err;
+}
+
+static const char *stat_op(worker_t *w) {
+    kora_stat_t st;
+    (void)w;
+    if (sys_stat(stat_file, &st) != 0) {
+        return "stat";
+    }
+    return st.size == STAT_SIZE ? NULL : "stat size";
+}
+
+static const char *dir_op(worker_t *w) {
+    kora_dirent_t entry;
+    int n = 0, r;
+    (void)w;
+
+    int d = sys_opendir(list_dir);
+    if (d < 0) {
+        return "opendir";
+    }
+    while ((r = sys_readdir(d, &entry)) == 1) {
+        n += entry.name[0] == 'e';
+    }
+    if (sys_closedir(d) != KORA_SUCCESS) {
+        return "closedir";
+    }
+    if (r != 0) {
+        return "readdir";
+    }
+    return n == DIR_ENTRIES ? NULL : "readdir entry count";
+}
+
+static const char *mmap_op(worker_t *w) {
+    int *p = sys_mmap(NULL, 4096, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == (void *)-1) {
+        return "mmap";
+    }
+    p[1023] = w->id;
+    const char *err = p[1023] == w->id ? NULL : "mapping contents";
+    if (sys_munmap(p, 4096) != 0) {
+        err = "munmap";
+    }
+    return err;
+}
+
+static const char *pipe_init(worker_t *w) {
+    return sys_pipe(w->fds) == KORA_SUCCESS ? NULL : "pipe";
+}
+
+static const char *pipe_op(worker_t *w) {
+    char c = (char)w->id, back = 0;
+    if (sys_write(w->fds[1], &c, 1) != 1) {
+        return "pipe write";
+    }
+    if (sys_read(w->fds[0], &back, 1) != 1 || back != c) {
+        return "pipe read";
+    }
+    return NULL;
+}
+
+static void pipe_fini(worker_t *w) {
+    sys_close(w->fds[0]);
+    sys_close(w->fds[1]);
+}
+
+/* Every thread posts and waits on the same semaphore */
+static const char *sem_op(worker_t *w) {
+    (void)w;
+    if (sys_sem_post(&sem) != KORA_SUCCESS) {
+        return "sem_post";
+    }
+    return sys_sem_wait(&sem) == KORA_SUCCESS ? NULL : "sem_wait";
+}
+
+static const char *clock_op(worker_t *w) {
+    struct timespec ts;
+    if (sys_clock_gettime(CLOCK_MONOTONIC, &ts) != KORA_SUCCESS) {
+        return "clock_gettime";
+    }
+    uint64_t now = (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+    if (now < w->last_ns) {
+        return "monotonic clock went backwards";
+    }
+    w->last_ns = now;
+    return NULL;
+}
+
+static const char *getpid_op(worker_t *w) {
+    (void)w;
+    return sys_getpid() == pid ? NULL : "getpid";
+}
+
+/* Failures on alternate threads must not see each other's error state */
+static const char *error_op(worker_t *w) {
+    int expect = w->id % 2 ? EBADF : ENOENT;
+
+    int r = w->id % 2 ? sys_close(-1) : sys_open(w->path, KORA_O_RDONLY);
+    if (r != KORA_ERROR || errno != expect) {
+        return "errno";
+    }
+    kora_error_t e = kora_last_error();
+    if (e.host_errno != expect || e.syscall != (w->id % 2 ? SYS_CLOSE : SYS_OPEN)) {
+        return "kora_last_error from another thread";
+    }
+    return NULL;
+}
+
+static const char *error_init(worker_t *w) {
+    snprintf(w->path, sizeof(w->path), "%s/missing%d", dir, w->id);
+    return NULL;
+}
+
+static const char *slot_init(worker_t *w) {
+    w->fd = sys_open("/dev/null", KORA_O_RDONLY);
+    return w->fd >= 0 ? NULL : "open /dev/null";
+}
+
+static const char *slot_op(worker_t *w) {
+    if (kora_fd_set(w->fd, slot, w) != KORA_SUCCESS) {
+        return "kora_fd_set";
+    }
+    return kora_fd_get(w->fd, slot) == w ? NULL : "kora_fd_get";
+}
+
+static void slot_fini(worker_t *w) {
+    sys_close(w->fd);
+}
+
+static const char *spawn_op(worker_t *w) {
+    char *argv[] = {"/bin/true", NULL};
+    int status = -1;
+    (void)w;
+
+    pid_t child = sys_spawn("/bin/true", argv, NULL);
+    if (child < 0) {
+        return "spawn";
+    }
+    if (sys_wait(child, &status, 0) != child || status != 0) {
+        return "wait";
+    }
+    return NULL;
+}
+
+static const scaling_case_t cases[] = {
+    { "file_io",       1,   host_file_init,  file_op,   NULL,      0 },
+    { "memfs_io",      1,   memfs_file_init, file_op,   NULL,      1 },
+    { "stat",          1,   NULL,            stat_op,   NULL,      0 },
+    { "opendir",       1,   NULL,            dir_op,    NULL,      0 },
+    { "mmap_munmap",   1,   NULL,            mmap_op,   NULL,      0 },
+    { "pipe",          1,   pipe_init,       pipe_op,   pipe_fini, 0 },
+    { "sem_shared",    1,   NULL,            sem_op,    NULL,      0 },
+    { "clock_gettime", 1,   NULL,            clock_op,  NULL,      0 },
+    { "getpid",        1,   NULL,            getpid_op, NULL,      0 },
+    { "error_state",   1,   error_init,      error_op,  NULL,      0 },
+    { "fd_slots",      1,   slot_init,       slot_op,   slot_fini, 0 },
+    { "spawn_wait",    100, NULL,            spawn_op,  NULL,      0 },
+};
+
+static void note_failure(worker_t *w, const char *what) {
+    if (w->failures++ == 0) {
+        w->failure = what;
+    }
+}
+
+static void *run_worker(void *arg) {
+    worker_t *w = arg;
+    size_t n = ops / current->divisor ? ops / current->divisor : 1;
+    const char *init_err = current->init ? current->init(w) : NULL;
+
+    pthread_barrier_wait(&barrier);
+    w->start_ns = bench_now_ns();
+    if (init_err != NULL) {
+        note_failure(w, init_err);
+    } else {
+        for (size_t i = 0; i < n; i++) {
+            const char *err = current->op(w);
+            if (err != NULL) {
+                note_failure(w, err);
+            }
+        }
+    }
+    w->end_ns = bench_now_ns();
+    if (current->fini && init_err == NULL) {
+        current->fini(w);
+    }
+    return NULL;
+}
+
+/* Operations per second at this many threads; failures are added to *failures */
+static double run_threads(const scaling_case_t *c, int threads, unsigned long *failures) {
+    worker_t *workers = calloc((size_t)threads, sizeof(*workers));
+    size_t n = ops / c->divisor ? ops / c->divisor : 1;
+
+    if (workers == NULL) {
+        fail("calloc");
+    }
+    current = c;
+    pthread_barrier_init(&barrier, NULL, (unsigned)threads);
+    for (int i = 0; i < threads; i++) {
+        workers[i].id = i;
+        if (pthread_create(&workers[i].thread, NULL, run_worker, &workers[i]) != 0) {
+            fail("pthread_create");
+        }
+    }
+
+    uint64_t start = UINT64_MAX, end = 0;
+    for (int i = 0; i < threads; i++) {
+        worker_t *w = &workers[i];
+        pthread_join(w->thread, NULL);
+        start = w->start_ns < start ? w->start_ns : start;
+        end = w->end_ns > end ? w->end_ns : end;
+        if (w->failures) {
+            fprintf(stderr, "%s, %d threads: thread %d failed %lu of %zu: %s\n",
+                    c->name, threads, i, w->failures, n, w->failure);
+            *failures += w->failures;
+        }
+    }
+    pthread_barrier_destroy(&barrier);
+    free(workers);
+
+    return end > start ? (double)n * threads * 1e9 / (double)(end - start) : 0.0;
+}
+
+static void setup(void) {
+    char path[128];
+
+    strcpy(dir, "/tmp/kora-scaling-XXXXXX");
+    if (mkdtemp(dir) == NULL) {
+        fail("mkdtemp");
+    }
+    snprintf(stat_file, sizeof(stat_file), "%s/stat", dir);
+    snprintf(list_dir, sizeof(list_dir), "%s/list", dir);
+    snprintf(mount_dir, sizeof(mount_dir), "%s/mnt", dir);
+
+    int fd = sys_open(stat_file, KORA_O_WRONLY | KORA_O_CREAT);
+    char block[STAT_SIZE] = {0};
+    if (fd < 0 || sys_write(fd, block, sizeof(block)) != sizeof(block)) {
+        fail("stat file");
+    }
+    sys_close(fd);
+
+    if (sys_mkdir(list_dir) != KORA_SUCCESS) {
+        fail("mkdir");
+    }
+    for (int i = 0; i < DIR_ENTRIES; i++) {
+        snprintf(path, sizeof(path), "%s/e%d", list_dir, i);
+        if ((fd = sys_open(path, KORA_O_WRONLY | KORA_O_CREAT)) < 0) {
+            fail("list entry");
+        }
+        sys_close(fd);
+    }
+
+    if (sem_init(&sem, 0, 0) != 0) {
+        fail("sem_init");
+    }
+    if ((slot = kora_fd_slot_register(NULL)) < 0) {
+        fail("kora_fd_slot_register");
+    }
+    pid = getpid();
+}
+
+static void teardown(void) {
+    char cmd[96];
+
+    sem_destroy(&sem);
+    snprintf(cmd, sizeof(cmd), "rm -rf %s", dir);
+    if (system(cmd) != 0) {
+        fprintf(stderr, "could not remove %s\n", dir);
+    }
+}
+
+int main(int argc, char **argv) {
+    int max_threads = argc > 1 ? atoi(argv[1]) : 64;
+    ops = argc > 2 ? strtoul(argv[2], NULL, 10) : 2000;
+    const char *filter = argc > 3 ? argv[3] : NULL;
+    if (max_threads <= 0 || ops == 0) {
+        fprintf(stderr, "usage: %s [max-threads] [ops-per-thread] [name-filter]\n", argv[0]);
+        return 1;
+    }
+
+    setup();
+    unsigned long failures = 0;
+    int first = 1;
+
+    printf("{\n  \"benchmark\": \"scaling\",\n  \"max_threads\": %d,\n"
+           "  \"ops_per_thread\": %zu,\n  \"results\": [\n", max_threads, ops);
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        if (filter && strstr(cases[c].name, filter) == NULL) {
+            continue;
+        }
+        /* Mounted only meanwhile, so the other cases run without the VFS hooks */
+        if (cases[c].memfs && sys_mount(NULL, mount_dir, "memfs", 0, NULL) != KORA_SUCCESS) {
+            fail("mount memfs");
+        }
+        double base = 0.0;
+        for (int t = 1; ; t = t * 2 < max_threads ? t * 2 : max_threads) {
+            unsigned long failed = 0;
+            double rate = run_threads(&cases[c], t, &failed);
+            if (t == 1) {
+                base = rate;
+            }
+            printf("%s    {\"name\": \"%s\", \"threads\": %d, \"ops_per_sec\": %.0f, "
+                   "\"speedup\": %.2f, \"failures\": %lu}",
+                   first ? "" : ",\n", cases[c].name, t, rate,
+                   base > 0.0 ? rate / base : 0.0, failed);
+            fflush(stdout);
+            first = 0;
+            failures += failed;
+            if (t == max_threads) {
+                break;
+            }
+        }
+        if (cases[c].memfs) {
+            sys_umount(mount_dir);
+        }
+    }
+    printf("\n  ]\n}\n");
+
+    teardown();
+    if (failures) {
+        fprintf(stderr, "%lu operations failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,450 @@
+/**
+ * Shim overhead benchmark: every sys_* family versus the direct host call
+ *
+ * Each case has a layer variant going through sys_* and a host variant
+ * making the equivalent libc call. Samples alternate between the two so
+ * drift (frequency scaling, noisy neighbours) affects both equally. Cheap
+ * operations are timed in batches and divided down so the cost of reading
+ * the clock does not swamp them. When hardware counters are available the
+ * instructions retired per operation are reported as well.
+ *
+ * Usage: koralayer_bench [iterations] [name-filter]
+ */
+
+#include "bench_harness.h"
+
+#include <kora/syscalls.h>
+#include <kora/perf.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <semaphore.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+
+typedef struct {
+    char dir[64];
+    char file[96];
+    size_t size;
+    char *buf;
+    int fd;
+    int null_fd;
+    int zero_fd;
+    int saved_stdout;
+    int to_child[2];
+    int to_parent[2];
+    pid_t child;
+    sem_t sem;
+} bench_ctx_t;
+
+typedef struct {
+    const char *name;
+    size_t size;       /* Transfer size for I/O cases, 0 otherwise */
+    unsigned batch;    /* Operations per timed sample */
+    unsigned divisor;  /* Run iterations / divisor samples for slow cases */
+    void (*setup)(bench_ctx_t *ctx);
+    void (*layer)(bench_ctx_t *ctx);
+    void (*host)(bench_ctx_t *ctx);
+    void (*teardown)(bench_ctx_t *ctx);
+} bench_case_t;
+
+static void fail(const char *what) {
+    perror(what);
+    exit(1);
+}
+
+/* putc: stdout is pointed at /dev/null for the duration */
+
+static void putc_setup(bench_ctx_t *ctx) {
+    fflush(stdout);
+    ctx->saved_stdout = dup(STDOUT_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY);
+    if (ctx->saved_stdout < 0 || null_fd < 0) {
+        fail("putc setup");
+    }
+    dup2(null_fd, STDOUT_FILENO);
+    close(null_fd);
+}
+
+static void putc_layer(bench_ctx_t *ctx) { (void)ctx; sys_putc('x'); }
+static void putc_host(bench_ctx_t *ctx) { (void)ctx; putchar('x'); }
+
+static void putc_teardown(bench_ctx_t *ctx) {
+    fflush(stdout);
+    dup2(ctx->saved_stdout, STDOUT_FILENO);
+    close(ctx->saved_stdout);
+}
+
+/* open/close and stat on a scratch file */
+
+static void file_setup(bench_ctx_t *ctx) {
+    int fd = open(ctx->file, O_CREAT | O_WRONLY | O_TRUNC, 0644);
+    if (fd < 0) {
+        fail("file setup");
+    }
+    close(fd);
+}
+
+static void file_teardown(bench_ctx_t *ctx) {
+    unlink(ctx->file);
+}
+
+static void open_close_layer(bench_ctx_t *ctx) {
+    sys_close(sys_open(ctx->file, KORA_O_RDONLY));
+}
+
+static void open_close_host(bench_ctx_t *ctx) {
+    close(open(ctx->file, O_RDONLY));
+}
+
+static void stat_layer(bench_ctx_t *ctx) {
+    kora_stat_t st;
+    sys_stat(ctx->file, &st);
+}
+
+static void stat_host(bench_ctx_t *ctx) {
+    struct stat st;
+    stat(ctx->file, &st);
+}
+
+/* read from /dev/zero and write to /dev/null, so only the call path is measured */
+
+static void io_setup(bench_ctx_t *ctx) {
+    ctx->buf = calloc(1, ctx->size);
+    ctx->zero_fd = open("/dev/zero", O_RDONLY);
+    ctx->null_fd = open("/dev/null", O_WRONLY);
+    if (!ctx->buf || ctx->zero_fd < 0 || ctx->null_fd < 0) {
+        fail("io setup");
+    }
+}
+
+static void io_teardown(bench_ctx_t *ctx) {
+    close(ctx->zero_fd);
+    close(ctx->null_fd);
+    free(ctx->buf);
+}
+
+static void read_layer(bench_ctx_t *ctx) { sys_read(ctx->zero_fd, ctx->buf, ctx->size); }
+static void read_host(bench_ctx_t *ctx) { (void)!read(ctx->zero_fd, ctx->buf, ctx->size); }
+static void write_layer(bench_ctx_t *ctx) { sys_write(ctx->null_fd, ctx->buf, ctx->size); }
+static void write_host(bench_ctx_t *ctx) { (void)!write(ctx->null_fd, ctx->buf, ctx->size); }
+
+/* readdir: a full pass over a directory of 32 entries */
+
+static void dir_setup(bench_ctx_t *ctx) {
+    char path[160];
+    for (int i = 0; i < 32; i++) {
+        snprintf(path, sizeof(path), "%s/entry%02d", ctx->dir, i);
+        int fd = open(path, O_CREAT | O_WRONLY, 0644);
+        if (fd < 0) {
+            fail("dir setup");
+        }
+        close(fd);
+    }
+}
+
+static void dir_teardown(bench_ctx_t *ctx) {
+    char path[160];
+    for (int i = 0; i < 32; i++) {
+        snprintf(path, sizeof(path), "%s/entry%02d", ctx->dir, i);
+        unlink(path);
+    }
+}
+
+static void readdir_layer(bench_ctx_t *ctx) {
+    kora_dirent_t entry;
+    int dir = sys_opendir(ctx->dir);
+    while (sys_readdir(dir, &entry) == 1) {  /* 0 at the end, -1 on error */
+    }
+    sys_closedir(dir);
+}
+
+static void readdir_host(bench_ctx_t *ctx) {
+    DIR *dir = opendir(ctx->dir);
+    while (readdir(dir) != NULL) {
+    }
+    closedir(dir);
+}
+
+/* mmap/munmap of one anonymous page */
+
+static void mmap_layer(bench_ctx_t *ctx) {
+    (void)ctx;
+    void *p = sys_mmap(NULL, 4096, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    sys_munmap(p, 4096);
+}
+
+static void mmap_host(bench_ctx_t *ctx) {
+    (void)ctx;
+    void *p = mmap(NULL, 4096, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    munmap(p, 4096);
+}
+
+/* pipe ping-pong: one byte to a forked echo child and back */
+
+static void pipe_setup(bench_ctx_t *ctx) {
+    if (pipe(ctx->to_child) != 0 || pipe(ctx->to_parent) != 0) {
+        fail("pipe setup");
+    }
+    ctx->child = fork();
+    if (ctx->child < 0) {
+        fail("fork");
+    }
+    if (ctx->child == 0) {
+        char c;
+        close(ctx->to_child[1]);
+        close(ctx->to_parent[0]);
+        while (read(ctx->to_child[0], &c, 1) == 1) {
+            (void)!write(ctx->to_parent[1], &c, 1);
+        }
+        _exit(0);
+    }
+    close(ctx->to_child[0]);
+    close(ctx->to_parent[1]);
+}
+
+static void pipe_teardown(bench_ctx_t *ctx) {
+    close(ctx->to_child[1]);
+    waitpid(ctx->child, NULL, 0);
+    close(ctx->to_parent[0]);
+}
+
+static void pipe_layer(bench_ctx_t *ctx) {
+    char c = 'x';
+    sys_write(ctx->to_child[1], &c, 1);
+    sys_read(ctx->to_parent[0], &c, 1);
+}
+
+static void pipe_host(bench_ctx_t *ctx) {
+    char c = 'x';
+    (void)!write(ctx->to_child[1], &c, 1);
+    (void)!read(ctx->to_parent[0], &c, 1);
+}
+
+/* spawn/wait of /bin/true */
+
+static void spawn_layer(bench_ctx_t *ctx) {
+    (void)ctx;
+    char *argv[] = {"/bin/true", NULL};
+    pid_t pid = sys_spawn("/bin/true", argv, NULL);
+    sys_wait(pid, NULL, 0);
+}
+
+static void spawn_host(bench_ctx_t *ctx) {
+    (void)ctx;
+    char *argv[] = {"/bin/true", NULL};
+    pid_t pid;
+    if (posix_spawn(&pid, "/bin/true", NULL, NULL, argv, environ) == 0) {
+        waitpid(pid, NULL, 0);
+    }
+}
+
+/* semaphore post followed by an uncontended wait */
+
+static void sem_setup(bench_ctx_t *ctx) {
+    if (sem_init(&ctx->sem, 0, 0) != 0) {
+        fail("sem_init");
+    }
+}
+
+static void sem_teardown(bench_ctx_t *ctx) {
+    sem_destroy(&ctx->sem);
+}
+
+static void sem_layer(bench_ctx_t *ctx) {
+    sys_sem_post(&ctx->sem);
+    sys_sem_wait(&ctx->sem);
+}
+
+static void sem_host(bench_ctx_t *ctx) {
+    sem_post(&ctx->sem);
+    sem_wait(&ctx->sem);
+}
+
+/* clock_gettime, normally served from the vDSO */
+
+static void clock_layer(bench_ctx_t *ctx) {
+    (void)ctx;
+    struct timespec ts;
+    sys_clock_gettime(CLOCK_MONOTONIC, &ts);
+}
+
+static void clock_host(bench_ctx_t *ctx) {
+    (void)ctx;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+}
+
+/*
+ * stat of the scratch file with memory filesystems mounted beside it, so
+ * every path is routed through the mount table before reaching the host.
+ */
+
+#define ROUTED_MOUNTS 64
+
+static void routed_setup(bench_ctx_t *ctx) {
+    char prefix[96];
+    file_setup(ctx);
+    for (int i = 0; i < ROUTED_MOUNTS; i++) {
+        snprintf(prefix, sizeof(prefix), "%s/mnt%d", ctx->dir, i);
+        if (sys_mount(NULL, prefix, "memfs", 0, NULL) != KORA_SUCCESS) {
+            fail("routed setup");
+        }
+    }
+}
+
+static void routed_teardown(bench_ctx_t *ctx) {
+    char prefix[96];
+    for (int i = 0; i < ROUTED_MOUNTS; i++) {
+        snprintf(prefix, sizeof(prefix), "%s/mnt%d", ctx->dir, i);
+        sys_umount(prefix);
+    }
+    file_teardown(ctx);
+}
+
+static const bench_case_t cases[] = {
+    { "putc",          0,     64, 1,   putc_setup, putc_layer,       putc_host,       putc_teardown },
+    { "open_close",    0,     16, 1,   file_setup, open_close_layer, open_close_host, file_teardown },
+    { "read_64",       64,    32, 1,   io_setup,   read_layer,       read_host,       io_teardown },
+    { "read_4096",     4096,  16, 1,   io_setup,   read_layer,       read_host,       io_teardown },
+    { "read_65536",    65536, 4,  1,   io_setup,   read_layer,       read_host,       io_teardown },
+    { "write_64",      64,    32, 1,   io_setup,   write_layer,      write_host,      io_teardown },
+    { "write_4096",    4096,  32, 1,   io_setup,   write_layer,      write_host,      io_teardown },
+    { "write_65536",   65536, 32, 1,   io_setup,   write_layer,      write_host,      io_teardown },
+    { "stat",          0,     16, 1,   file_setup, stat_layer,       stat_host,       file_teardown },
+    { "readdir_32",    0,     1,  1,   dir_setup,  readdir_layer,    readdir_host,    dir_teardown },
+    { "mmap_munmap",   0,     8,  1,   NULL,       mmap_layer,       mmap_host,       NULL },
+    { "pipe_pingpong", 0,     1,  1,   pipe_setup, pipe_layer,       pipe_host,       pipe_teardown },
+    { "spawn_wait",    0,     1,  100, NULL,       spawn_layer,      spawn_host,      NULL },
+    { "sem_post_wait", 0,     64, 1,   sem_setup,  sem_layer,        sem_host,        sem_teardown },
+    { "clock_gettime", 0,     64, 1,   NULL,       clock_layer,      clock_host,      NULL },
+    { "stat_routed",   0,     16, 1,   routed_setup, stat_layer,     stat_host,       routed_teardown },
+};
+
+static uint64_t time_batch(void (*op)(bench_ctx_t *), bench_ctx_t *ctx, unsigned batch) {
+    uint64_t start = bench_now_ns();
+    for (unsigned i = 0; i < batch; i++) {
+        op(ctx);
+    }
+    return (bench_now_ns() - start) / batch;
+}
+
+/* Instructions retired per operation, or -1 without counters */
+static double instructions_per_op(kora_perf_counter_t *perf, void (*op)(bench_ctx_t *),
+                                  bench_ctx_t *ctx, unsigned ops) {
+    kora_perf_values_t values;
+
+    if (!perf) {
+        return -1.0;
+    }
+    kora_perf_counter_reset(perf);
+    kora_perf_counter_enable(perf);
+    for (unsigned i = 0; i < ops; i++) {
+        op(ctx);
+    }
+    kora_perf_counter_disable(perf);
+    if (kora_perf_counter_read(perf, &values) != KORA_SUCCESS) {
+        return -1.0;
+    }
+    return (double)values.scaled[0] / ops;
+}
+
+static void print_series(const char *label, const bench_stats_t *stats, double insns) {
+    printf("\"%s\": {", label);
+    bench_print_stats(stats);
+    if (insns >= 0) {
+        printf(", \"instructions\": %.1f", insns);
+    }
+    printf("}");
+}
+
+static void run_case(const bench_case_t *c, bench_ctx_t *ctx, size_t iters,
+                     kora_perf_counter_t *perf, int first) {
+    size_t n = iters / c->divisor;
+    size_t warmup = n / 10 + 1;
+    if (n == 0) {
+        n = 1;
+    }
+
+    uint64_t *layer = malloc(n * sizeof(*layer));
+    uint64_t *host = malloc(n * sizeof(*host));
+    if (!layer || !host) {
+        fail("malloc");
+    }
+
+    ctx->size = c->size;
+    if (c->setup) {
+        c->setup(ctx);
+    }
+    for (size_t i = 0; i < warmup; i++) {
+        c->layer(ctx);
+        c->host(ctx);
+    }
+    for (size_t i = 0; i < n; i++) {
+        layer[i] = time_batch(c->layer, ctx, c->batch);
+        host[i] = time_batch(c->host, ctx, c->batch);
+    }
+    unsigned perf_ops = c->divisor > 1 ? 10 : 1000;
+    double layer_insns = instructions_per_op(perf, c->layer, ctx, perf_ops);
+    double host_insns = instructions_per_op(perf, c->host, ctx, perf_ops);
+    if (c->teardown) {
+        c->teardown(ctx);
+    }
+
+    bench_stats_t ls = bench_summarize(layer, n);
+    bench_stats_t hs = bench_summarize(host, n);
+    long long overhead = (long long)ls.p50_ns - (long long)hs.p50_ns;
+
+    printf("%s    {\"name\": \"%s\", \"samples\": %zu, \"ops_per_sample\": %u,\n      ",
+           first ? "" : ",\n", c->name, n, c->batch);
+    print_series("layer", &ls, layer_insns);
+    printf(",\n      ");
+    print_series("host", &hs, host_insns);
+    printf(",\n      \"overhead_p50_ns\": %lld}", overhead);
+
+    free(layer);
+    free(host);
+}
+
+int main(int argc, char **argv) {
+    size_t iters = argc > 1 ? strtoul(argv[1], NULL, 10) : 20000;
+    const char *filter = argc > 2 ? argv[2] : NULL;
+    if (iters == 0) {
+        fprintf(stderr, "usage: %s [iterations] [name-filter]\n", argv[0]);
+        return 1;
+    }
+
+    bench_ctx_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    snprintf(ctx.dir, sizeof(ctx.dir), "/tmp/koralayer_bench.%d", (int)getpid());
+    snprintf(ctx.file, sizeof(ctx.file), "%s/file", ctx.dir);
+    if (mkdir(ctx.dir, 0755) != 0) {
+        fail("mkdir");
+    }
+
+    int events[] = { KORA_PERF_INSTRUCTIONS };
+    kora_perf_counter_t *perf = kora_perf_counter_open(events, 1, 0);
+
+    printf("{\n  \"benchmark\": \"syscall_overhead\",\n  \"iterations\": %zu,\n"
+           "  \"counters\": %s,\n  \"results\": [\n", iters, perf ? "true" : "false");
+    int first = 1;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        if (filter && strstr(cases[i].name, filter) == NULL) {
+            continue;
+        }
+        run_case(&cases[i], &ctx, iters, perf, first);
+        first = 0;
+    }
+    printf("\n  ]\n}\n");
+
+    kora_perf_counter_close(perf);
+    rmdir(ctx.dir);
+    return 0;
+}
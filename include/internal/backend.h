@@ -0,0 +1,72 @@
+/**
+ * KoraLayer Backend Hook
+ *
+ * Used by the sys_* bodies in internal/dispatch.h, and by host mounts in
+ * src/vfs.c, for the call that reaches the host. KORA_BACKEND(name,
+ * (args)) is an expression calling the top pushed layer when there is
+ * one, and otherwise the platform function directly, so that with
+ * nothing pushed the call can still be inlined.
+ */
+
+#pragma once
+
+#include <internal/syscall_impl.h>
+#include <kora/backend.h>
+#include <stdatomic.h>
+#include <stddef.h>
+
+/* Complete table of the top layer, NULL when nothing is pushed */
+extern _Atomic(const kora_backend_ops_t *) kora_backend_top;
+
+#if defined(KORA_PLATFORM_LINUX)
+#define KORA_BACKEND_HOST(name) linux_sys_##name
+#elif defined(KORA_PLATFORM_MACOS)
+#define KORA_BACKEND_HOST(name) macos_sys_##name
+#elif defined(KORA_PLATFORM_WINDOWS)
+#define KORA_BACKEND_HOST(name) windows_sys_##name
+#endif
+
+/* Nonzero on a thread started with its own TLS, which only the host may serve */
+#if defined(KORA_PLATFORM_LINUX)
+#define KORA_RAW_THREAD() linux_sys_thread_raw()
+#else
+#define KORA_RAW_THREAD() 0
+#endif
+
+#if defined(KORA_NO_BACKEND)
+
+#define KORA_BACKEND(name, args) KORA_BACKEND_HOST(name) args
+
+#else
+
+/*
+ * The top is loaded once into a local: a layer popped between two loads
+ * could leave the second one NULL. The member is parenthesised so a
+ * libc macro of the same name is not expanded.
+ */
+#if defined(__GNUC__)
+
+#define KORA_BACKEND(name, args)                                                      \
+    __extension__({                                                                   \
+        const kora_backend_ops_t *kora_top_ =                                         \
+            atomic_load_explicit(&kora_backend_top, memory_order_acquire);            \
+        kora_top_ == NULL ? KORA_BACKEND_HOST(name) args : (kora_top_->name) args;    \
+    })
+
+#else
+
+/* Without statement expressions, one helper per call picks the function */
+#define KORA_BACKEND_FN_(ret, name, params)                                           \
+    static __inline ret (*kora_backend_fn_##name(void)) params {                     \
+        const kora_backend_ops_t *top =                                               \
+            atomic_load_explicit(&kora_backend_top, memory_order_acquire);            \
+        return top == NULL ? KORA_BACKEND_HOST(name) : (top->name);                   \
+    }
+KORA_BACKEND_CALLS(KORA_BACKEND_FN_)
+#undef KORA_BACKEND_FN_
+
+#define KORA_BACKEND(name, args) (kora_backend_fn_##name()) args
+
+#endif
+
+#endif
@@ -0,0 +1,59 @@
+/**
+ * KoraLayer Block Devices
+ *
+ * An image-backed filesystem opens its image file as a block device and
+ * does all image I/O through it by byte range; the ranges are served
+ * from the shared block cache described in kora/bcache.h. Calls on one
+ * device may come from several threads at once.
+ */
+
+#pragma once
+
+#include <kora/bcache.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct kora_bdev kora_bdev_t;
+
+/**
+ * Open a block device on a host file
+ *
+ * @param fd Open descriptor of the image; closed by kora_bdev_close
+ * @param size Bytes of the image to serve
+ * @param rdonly Non-zero to refuse writes with -EROFS
+ * @param dev Set to the device
+ * @return 0, or -ENOMEM (or the error starting the writeback thread)
+ */
+int kora_bdev_open(int fd, uint64_t size, int rdonly, kora_bdev_t **dev);
+
+/**
+ * Write back, drop the device's blocks from the cache and close its file
+ *
+ * @return 0, or the first write error met since the last sync
+ */
+int kora_bdev_close(kora_bdev_t *dev);
+
+/**
+ * Copy len bytes at off into buf
+ *
+ * When this read continues an earlier one, blocks past it are read ahead
+ * in the same host read, but never at or beyond ahead: a filesystem
+ * passes the end of the file's data that follows on disk, or 0 to read
+ * only what is asked.
+ *
+ * @return 0, -EINVAL past the end of the device, or the host read error
+ */
+int kora_bdev_read(kora_bdev_t *dev, uint64_t off, void *buf, size_t len, uint64_t ahead);
+
+/** Copy len bytes from buf to off; 0, -EINVAL, -EROFS, -EIO or -ENOMEM */
+int kora_bdev_write(kora_bdev_t *dev, uint64_t off, const void *buf, size_t len);
+
+/** Zero len bytes at off; as kora_bdev_write */
+int kora_bdev_zero(kora_bdev_t *dev, uint64_t off, size_t len);
+
+/**
+ * Write back every dirty block of the device and flush its file
+ *
+ * @return 0, or the first write error met since the last sync
+ */
+int kora_bdev_sync(kora_bdev_t *dev);
@@ -0,0 +1,823 @@
+/**
+ * KoraOS System Call Dispatch
+ *
+ * Internal header holding the sys_* entry points, each of which forwards
+ * to the platform implementation. src/syscalls.c includes it with an
+ * empty KORA_DISPATCH to emit the out-of-line definitions every program
+ * links against. With KORA_INLINE_DISPATCH, kora/syscalls.h includes it
+ * again with KORA_DISPATCH set to GNU extern inline, so callers reach the
+ * linux_sys_* (or macos_sys_*, windows_sys_*) function directly while the
+ * library symbols remain available for address-taking.
+ *
+ * Every body is bracketed by the trace hooks from internal/trace.h. The
+ * file, process and splice calls also pass through the injection hooks
+ * from internal/inject.h, which may delay them, shorten their transfer
+ * or fail them without reaching the platform. After that, the file and
+ * directory calls are offered to the mounted filesystems of
+ * internal/vfs.h, and only reach the platform for host paths and
+ * descriptors. The platform is reached through KORA_BACKEND from
+ * internal/backend.h, which calls any layers pushed with kora/backend.h
+ * instead. Closing a host descriptor releases its extension slots in the
+ * descriptor table of internal/fdtable.h.
+ */
+
+#pragma once
+
+#include <internal/syscall_impl.h>
+#include <internal/backend.h>
+#include <internal/fdtable.h>
+#include <internal/inject.h>
+#include <internal/trace.h>
+#include <internal/vfs.h>
+
+#ifndef KORA_DISPATCH
+#error "Define KORA_DISPATCH before including internal/dispatch.h"
+#endif
+
+KORA_DISPATCH int sys_putc(char c) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(putc, (c));
+    KORA_TRACE_END1(SYS_PUTC, ret, c);
+    return ret;
+}
+
+KORA_DISPATCH int sys_getc(void) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(getc, ());
+    KORA_TRACE_END0(SYS_GETC, ret);
+    return ret;
+}
+
+KORA_DISPATCH int sys_open(const char *path, int flags) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    if (!KORA_INJECT_ERRNO(SYS_OPEN, NULL, ret) &&
+        !KORA_VFS(kora_vfs_open(path, flags, &ret))) {
+        ret = KORA_BACKEND(open, (path, flags));
+    }
+    KORA_TRACE_END2(SYS_OPEN, ret, path, flags);
+    return ret;
+}
+
+KORA_DISPATCH int sys_close(int fd) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    if (!KORA_INJECT_ERRNO(SYS_CLOSE, NULL, ret) &&
+        !KORA_VFS(kora_vfs_close(fd, &ret))) {
+        ret = KORA_BACKEND(close, (fd));
+        KORA_FD_CLOSED(fd);
+    }
+    KORA_TRACE_END1(SYS_CLOSE, ret, fd);
+    return ret;
+}
+
+KORA_DISPATCH int sys_read(int fd, void *buf, size_t count) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    if (!KORA_INJECT_ERRNO(SYS_READ, &count, ret) &&
+        !KORA_VFS(kora_vfs_read(fd, buf, count, &ret))) {
+        ret = KORA_BACKEND(read, (fd, buf, count));
+    }
+    KORA_TRACE_END3(SYS_READ, ret, fd, buf, count);
+    return ret;
+}
+
+KORA_DISPATCH int sys_write(int fd, const void *buf, size_t count) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    if (!KORA_INJECT_ERRNO(SYS_WRITE, &count, ret) &&
+        !KORA_VFS(kora_vfs_write(fd, buf, count, &ret))) {
+        ret = KORA_BACKEND(write, (fd, buf, count));
+    }
+    KORA_TRACE_END3(SYS_WRITE, ret, fd, buf, count);
+    return ret;
+}
+
+KORA_DISPATCH long sys_seek(int fd, long offset, int whence) {
+    long ret;
+    KORA_TRACE_BEGIN();
+    if (!KORA_INJECT_ERRNO(SYS_SEEK, NULL, ret) &&
+        !KORA_VFS(kora_vfs_seek(fd, offset, whence, &ret))) {
+        ret = KORA_BACKEND(seek, (fd, offset, whence));
+    }
+    KORA_TRACE_END3(SYS_SEEK, ret, fd, offset, whence);
+    return ret;
+}
+
+KORA_DISPATCH int sys_fadvise(int fd, uint64_t offset, uint64_t len, int advice) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    if (!KORA_VFS(kora_vfs_fadvise(fd, &ret))) {
+        ret = KORA_BACKEND(fadvise, (fd, offset, len, advice));
+    }
+    KORA_TRACE_END4(SYS_FADVISE, ret, fd, offset, len, advice);
+    return ret;
+}
+
+KORA_DISPATCH int sys_readahead(int fd, uint64_t offset, size_t count) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    if (!KORA_INJECT_NEG(SYS_READAHEAD, NULL, ret) &&
+        !KORA_VFS(kora_vfs_readahead(fd, &ret))) {
+        ret = KORA_BACKEND(readahead, (fd, offset, count));
+    }
+    KORA_TRACE_END3(SYS_READAHEAD, ret, fd, offset, count);
+    return ret;
+}
+
+KORA_DISPATCH int sys_ioctl(int fd, unsigned long request, void *arg) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    if (!KORA_VFS(kora_vfs_ioctl(fd, &ret))) {
+        ret = KORA_BACKEND(ioctl, (fd, request, arg));
+    }
+    KORA_TRACE_END3(SYS_IOCTL, ret, fd, request, arg);
+    return ret;
+}
+
+KORA_DISPATCH int sys_mkdir(const char *path) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    if (!KORA_INJECT_ERRNO(SYS_MKDIR, NULL, ret) &&
+        !KORA_VFS(kora_vfs_mkdir(path, &ret))) {
+        ret = KORA_BACKEND(mkdir, (path));
+    }
+    KORA_TRACE_END1(SYS_MKDIR, ret, path);
+    return ret;
+}
+
+KORA_DISPATCH int sys_rmdir(const char *path) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    if (!KORA_INJECT_ERRNO(SYS_RMDIR, NULL, ret) &&
+        !KORA_VFS(kora_vfs_rmdir(path, &ret))) {
+        ret = KORA_BACKEND(rmdir, (path));
+    }
+    KORA_TRACE_END1(SYS_RMDIR, ret, path);
+    return ret;
+}
+
+KORA_DISPATCH int sys_opendir(const char *path) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    if (!KORA_INJECT_ERRNO(SYS_OPENDIR, NULL, ret) &&
+        !KORA_VFS(kora_vfs_opendir(path, &ret))) {
+        ret = KORA_BACKEND(opendir, (path));
+    }
+    KORA_TRACE_END1(SYS_OPENDIR, ret, path);
+    return ret;
+}
+
+KORA_DISPATCH int sys_readdir(int dir, kora_dirent_t *entry) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    if (!KORA_INJECT_ERRNO(SYS_READDIR, NULL, ret) &&
+        !KORA_VFS(kora_vfs_readdir(dir, entry, &ret))) {
+        ret = KORA_BACKEND(readdir, (dir, entry));
+    }
+    KORA_TRACE_END2(SYS_READDIR, ret, dir, entry);
+    return ret;
+}
+
+KORA_DISPATCH int sys_closedir(int dir) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    if (!KORA_VFS(kora_vfs_closedir(dir, &ret))) {
+        ret = KORA_BACKEND(closedir, (dir));
+        KORA_FD_CLOSED(dir);
+    }
+    KORA_TRACE_END1(SYS_CLOSEDIR, ret, dir);
+    return ret;
+}
+
+KORA_DISPATCH int sys_symlink(const char *target, const char *linkpath) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    if (!KORA_INJECT_ERRNO(SYS_SYMLINK, NULL, ret) &&
+        !KORA_VFS(kora_vfs_symlink(target, linkpath, &ret))) {
+        ret = KORA_BACKEND(symlink, (target, linkpath));
+    }
+    KORA_TRACE_END2(SYS_SYMLINK, ret, target, linkpath);
+    return ret;
+}
+
+KORA_DISPATCH int sys_readlink(const char *path, char *buf, size_t size) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    if (!KORA_INJECT_ERRNO(SYS_READLINK, NULL, ret) &&
+        !KORA_VFS(kora_vfs_readlink(path, buf, size, &ret))) {
+        ret = KORA_BACKEND(readlink, (path, buf, size));
+    }
+    KORA_TRACE_END3(SYS_READLINK, ret, path, buf, size);
+    return ret;
+}
+
+KORA_DISPATCH int sys_get_file_info(const char *path, kora_file_info_t *info) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    if (!KORA_INJECT_NEG(SYS_GET_FILE_INFO, NULL, ret) &&
+        !KORA_VFS(kora_vfs_get_file_info(path, info, &ret))) {
+        ret = KORA_BACKEND(get_file_info, (path, info));
+    }
+    KORA_TRACE_END2(SYS_GET_FILE_INFO, ret, path, info);
+    return ret;
+}
+
+KORA_DISPATCH int sys_get_fd_info(int fd, kora_file_info_t *info) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    if (!KORA_INJECT_NEG(SYS_GET_FD_INFO, NULL, ret) &&
+        !KORA_VFS(kora_vfs_get_fd_info(fd, info, &ret))) {
+        ret = KORA_BACKEND(get_fd_info, (fd, info));
+    }
+    KORA_TRACE_END2(SYS_GET_FD_INFO, ret, fd, info);
+    return ret;
+}
+
+KORA_DISPATCH int sys_stat(const char *path, kora_stat_t *st) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    if (!KORA_INJECT_NEG(SYS_STAT, NULL, ret) &&
+        !KORA_VFS(kora_vfs_stat(path, st, &ret))) {
+        ret = KORA_BACKEND(stat, (path, st));
+    }
+    KORA_TRACE_END2(SYS_STAT, ret, path, st);
+    return ret;
+}
+
+KORA_DISPATCH int sys_fstat(int fd, kora_stat_t *st) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    if (!KORA_INJECT_NEG(SYS_FSTAT, NULL, ret) &&
+        !KORA_VFS(kora_vfs_fstat(fd, st, &ret))) {
+        ret = KORA_BACKEND(fstat, (fd, st));
+    }
+    KORA_TRACE_END2(SYS_FSTAT, ret, fd, st);
+    return ret;
+}
+
+KORA_DISPATCH int sys_lstat(const char *path, kora_stat_t *st) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    if (!KORA_INJECT_NEG(SYS_LSTAT, NULL, ret) &&
+        !KORA_VFS(kora_vfs_lstat(path, st, &ret))) {
+        ret = KORA_BACKEND(lstat, (path, st));
+    }
+    KORA_TRACE_END2(SYS_LSTAT, ret, path, st);
+    return ret;
+}
+
+KORA_DISPATCH int sys_link(const char *existing, const char *newpath) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    if (!KORA_INJECT_NEG(SYS_LINK, NULL, ret) &&
+        !KORA_VFS(kora_vfs_link(existing, newpath, &ret))) {
+        ret = KORA_BACKEND(link, (existing, newpath));
+    }
+    KORA_TRACE_END2(SYS_LINK, ret, existing, newpath);
+    return ret;
+}
+
+KORA_DISPATCH int sys_chdir(const char *path) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(chdir, (path));
+    KORA_TRACE_END1(SYS_CHDIR, ret, path);
+    return ret;
+}
+
+KORA_DISPATCH int sys_getcwd(char *buf, size_t size) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(getcwd, (buf, size));
+    KORA_TRACE_END2(SYS_GETCWD, ret, buf, size);
+    return ret;
+}
+
+KORA_DISPATCH int sys_utime(const char *path, uint64_t mtime) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    if (!KORA_INJECT_NEG(SYS_UTIME, NULL, ret) &&
+        !KORA_VFS(kora_vfs_utime(path, mtime, &ret))) {
+        ret = KORA_BACKEND(utime, (path, mtime));
+    }
+    KORA_TRACE_END2(SYS_UTIME, ret, path, mtime);
+    return ret;
+}
+
+KORA_DISPATCH int sys_exists(const char *path, uint8_t *type) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    if (!KORA_VFS(kora_vfs_exists(path, type, &ret))) {
+        ret = KORA_BACKEND(exists, (path, type));
+    }
+    KORA_TRACE_END2(SYS_EXISTS, ret, path, type);
+    return ret;
+}
+
+
+KORA_DISPATCH int sys_unlink(const char *path) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    if (!KORA_INJECT_NEG(SYS_UNLINK, NULL, ret) &&
+        !KORA_VFS(kora_vfs_unlink(path, &ret))) {
+        ret = KORA_BACKEND(unlink, (path));
+    }
+    KORA_TRACE_END1(SYS_UNLINK, ret, path);
+    return ret;
+}
+
+KORA_DISPATCH int sys_rename(const char *oldpath, const char *newpath) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    if (!KORA_INJECT_NEG(SYS_RENAME, NULL, ret) &&
+        !KORA_VFS(kora_vfs_rename(oldpath, newpath, &ret))) {
+        ret = KORA_BACKEND(rename, (oldpath, newpath));
+    }
+    KORA_TRACE_END2(SYS_RENAME, ret, oldpath, newpath);
+    return ret;
+}
+
+KORA_DISPATCH void *sys_brk(void *new_end) {
+    void *ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(brk, (new_end));
+    KORA_TRACE_END1(SYS_BRK, ret, new_end);
+    return ret;
+}
+
+KORA_DISPATCH void *sys_sbrk(ptrdiff_t delta) {
+    void *ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(sbrk, (delta));
+    KORA_TRACE_END1(SYS_SBRK, ret, delta);
+    return ret;
+}
+
+KORA_DISPATCH void *sys_mmap(void *addr, size_t len, int prot, int flags, int fd, off_t off) {
+    void *ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(mmap, (addr, len, prot, flags, fd, off));
+    KORA_TRACE_END6(SYS_MMAP, ret, addr, len, prot, flags, fd, off);
+    return ret;
+}
+
+KORA_DISPATCH int sys_munmap(void *addr, size_t len) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(munmap, (addr, len));
+    KORA_TRACE_END2(SYS_MUNMAP, ret, addr, len);
+    return ret;
+}
+
+KORA_DISPATCH int sys_mprotect(void *addr, size_t len, int prot) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(mprotect, (addr, len, prot));
+    KORA_TRACE_END3(SYS_MPROTECT, ret, addr, len, prot);
+    return ret;
+}
+
+KORA_DISPATCH int sys_shm_create(const char *name, uint64_t size, int flags) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(shm_create, (name, size, flags));
+    KORA_TRACE_END3(SYS_SHM_CREATE, ret, name, size, flags);
+    return ret;
+}
+
+KORA_DISPATCH int sys_shm_open(const char *name, int flags) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(shm_open, (name, flags));
+    KORA_TRACE_END2(SYS_SHM_OPEN, ret, name, flags);
+    return ret;
+}
+
+KORA_DISPATCH int sys_shm_unlink(const char *name) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(shm_unlink, (name));
+    KORA_TRACE_END1(SYS_SHM_UNLINK, ret, name);
+    return ret;
+}
+
+KORA_DISPATCH int sys_shm_seal(int fd, unsigned seals) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(shm_seal, (fd, seals));
+    KORA_TRACE_END2(SYS_SHM_SEAL, ret, fd, seals);
+    return ret;
+}
+
+KORA_DISPATCH pid_t sys_spawn(const char *path, char *const argv[], char *const envp[]) {
+    pid_t ret;
+    KORA_TRACE_BEGIN();
+    if (!KORA_INJECT_ERRNO(SYS_SPAWN, NULL, ret)) {
+        ret = KORA_BACKEND(spawn, (path, argv, envp));
+    }
+    KORA_TRACE_END3(SYS_SPAWN, ret, path, argv, envp);
+    return ret;
+}
+
+KORA_DISPATCH void sys_exit(int status) {
+    KORA_TRACE_BEGIN();
+    kora_vfs_sys_exit();
+    KORA_TRACE_END1(SYS_EXIT, 0, status);
+    KORA_BACKEND(exit, (status));
+    while (1) { } /* Should not return */
+}
+
+KORA_DISPATCH pid_t sys_wait(pid_t pid, int *status, int options) {
+    pid_t ret;
+    KORA_TRACE_BEGIN();
+    if (!KORA_INJECT_ERRNO(SYS_WAIT, NULL, ret)) {
+        ret = KORA_BACKEND(wait, (pid, status, options));
+    }
+    KORA_TRACE_END3(SYS_WAIT, ret, pid, status, options);
+    return ret;
+}
+
+KORA_DISPATCH pid_t sys_wait4(pid_t pid, int *status, int options, kora_rusage_t *usage) {
+    pid_t ret;
+    KORA_TRACE_BEGIN();
+    if (!KORA_INJECT_ERRNO(SYS_WAIT4, NULL, ret)) {
+        ret = KORA_BACKEND(wait4, (pid, status, options, usage));
+    }
+    KORA_TRACE_END4(SYS_WAIT4, ret, pid, status, options, usage);
+    return ret;
+}
+
+KORA_DISPATCH int sys_getrusage(int who, kora_rusage_t *usage) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(getrusage, (who, usage));
+    KORA_TRACE_END2(SYS_GETRUSAGE, ret, who, usage);
+    return ret;
+}
+
+KORA_DISPATCH int sys_thread_create(kora_thread_t *thread, const kora_thread_attr_t *attr,
+                                    void *(*entry)(void *), void *arg) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(thread_create, (thread, attr, entry, arg));
+    KORA_TRACE_END4(SYS_THREAD_CREATE, ret, thread, attr, entry, arg);
+    return ret;
+}
+
+KORA_DISPATCH int sys_thread_join(kora_thread_t thread, void **retval) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(thread_join, (thread, retval));
+    KORA_TRACE_END2(SYS_THREAD_JOIN, ret, thread, retval);
+    return ret;
+}
+
+/* A raw thread has no host TLS for the trace hooks, nor for a pushed layer */
+KORA_DISPATCH void sys_thread_exit(void *retval) {
+    if (KORA_RAW_THREAD()) {
+        KORA_BACKEND_HOST(thread_exit)(retval);
+    }
+    KORA_TRACE_BEGIN();
+    KORA_TRACE_END1(SYS_THREAD_EXIT, 0, retval);
+    KORA_BACKEND(thread_exit, (retval));
+    while (1) { } /* Should not return */
+}
+
+KORA_DISPATCH kora_thread_t sys_thread_self(void) {
+    kora_thread_t ret;
+    if (KORA_RAW_THREAD()) {
+        return KORA_BACKEND_HOST(thread_self)();
+    }
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(thread_self, ());
+    KORA_TRACE_END0(SYS_THREAD_SELF, ret);
+    return ret;
+}
+
+KORA_DISPATCH int sys_yield(void) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(yield, ());
+    KORA_TRACE_END0(SYS_YIELD, ret);
+    return ret;
+}
+
+KORA_DISPATCH pid_t sys_getpid(void) {
+    pid_t ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(getpid, ());
+    KORA_TRACE_END0(SYS_GETPID, ret);
+    return ret;
+}
+
+KORA_DISPATCH pid_t sys_getppid(void) {
+    pid_t ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(getppid, ());
+    KORA_TRACE_END0(SYS_GETPPID, ret);
+    return ret;
+}
+
+KORA_DISPATCH int sys_setpriority(pid_t pid, int prio) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(setpriority, (pid, prio));
+    KORA_TRACE_END2(SYS_SETPRIORITY, ret, pid, prio);
+    return ret;
+}
+
+KORA_DISPATCH pid_t sys_gettid(void) {
+    pid_t ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(gettid, ());
+    KORA_TRACE_END0(SYS_GETTID, ret);
+    return ret;
+}
+
+KORA_DISPATCH int sys_sched_setpolicy(pid_t tid, int policy, int priority) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(sched_setpolicy, (tid, policy, priority));
+    KORA_TRACE_END3(SYS_SCHED_SETPOLICY, ret, tid, policy, priority);
+    return ret;
+}
+
+KORA_DISPATCH int sys_sched_getpolicy(pid_t tid, int *priority) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(sched_getpolicy, (tid, priority));
+    KORA_TRACE_END2(SYS_SCHED_GETPOLICY, ret, tid, priority);
+    return ret;
+}
+
+KORA_DISPATCH int sys_ioprio_set(pid_t tid, int ioclass, int level) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(ioprio_set, (tid, ioclass, level));
+    KORA_TRACE_END3(SYS_IOPRIO_SET, ret, tid, ioclass, level);
+    return ret;
+}
+
+KORA_DISPATCH int sys_ioprio_get(pid_t tid, int *level) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(ioprio_get, (tid, level));
+    KORA_TRACE_END2(SYS_IOPRIO_GET, ret, tid, level);
+    return ret;
+}
+
+KORA_DISPATCH int sys_sched_setaffinity(pid_t pid, const kora_cpuset_t *set) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(sched_setaffinity, (pid, set));
+    KORA_TRACE_END2(SYS_SCHED_SETAFFINITY, ret, pid, set);
+    return ret;
+}
+
+KORA_DISPATCH int sys_sched_getaffinity(pid_t pid, kora_cpuset_t *set) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(sched_getaffinity, (pid, set));
+    KORA_TRACE_END2(SYS_SCHED_GETAFFINITY, ret, pid, set);
+    return ret;
+}
+
+KORA_DISPATCH int sys_getcpu(unsigned *cpu, unsigned *node) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(getcpu, (cpu, node));
+    KORA_TRACE_END2(SYS_GETCPU, ret, cpu, node);
+    return ret;
+}
+
+KORA_DISPATCH int sys_cpu_topology(kora_cpu_topology_t *topo, kora_cpu_info_t *cpus, size_t max) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(cpu_topology, (topo, cpus, max));
+    KORA_TRACE_END3(SYS_CPU_TOPOLOGY, ret, topo, cpus, max);
+    return ret;
+}
+
+KORA_DISPATCH int sys_pipe(int fds[2]) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(pipe, (fds));
+    KORA_TRACE_END1(SYS_PIPE, ret, fds);
+    return ret;
+}
+
+KORA_DISPATCH int sys_pipe2(int fds[2], int flags) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(pipe2, (fds, flags));
+    KORA_TRACE_END2(SYS_PIPE2, ret, fds, flags);
+    return ret;
+}
+
+KORA_DISPATCH int sys_pipe_size(int fd, int size) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(pipe_size, (fd, size));
+    KORA_TRACE_END2(SYS_PIPE_SIZE, ret, fd, size);
+    return ret;
+}
+
+KORA_DISPATCH long sys_splice(int fd_in, int64_t *off_in, int fd_out, int64_t *off_out,
+                              size_t len, unsigned flags) {
+    long ret;
+    KORA_TRACE_BEGIN();
+    if (!KORA_INJECT_ERRNO(SYS_SPLICE, &len, ret)) {
+        ret = KORA_BACKEND(splice, (fd_in, off_in, fd_out, off_out, len, flags));
+    }
+    KORA_TRACE_END6(SYS_SPLICE, ret, fd_in, off_in, fd_out, off_out, len, flags);
+    return ret;
+}
+
+KORA_DISPATCH long sys_tee(int fd_in, int fd_out, size_t len, unsigned flags) {
+    long ret;
+    KORA_TRACE_BEGIN();
+    if (!KORA_INJECT_ERRNO(SYS_TEE, &len, ret)) {
+        ret = KORA_BACKEND(tee, (fd_in, fd_out, len, flags));
+    }
+    KORA_TRACE_END4(SYS_TEE, ret, fd_in, fd_out, len, flags);
+    return ret;
+}
+
+KORA_DISPATCH int sys_dup(int oldfd) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(dup, (oldfd));
+    KORA_TRACE_END1(SYS_DUP, ret, oldfd);
+    return ret;
+}
+
+KORA_DISPATCH int sys_dup2(int oldfd, int newfd) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(dup2, (oldfd, newfd));
+    if (ret >= 0 && oldfd != newfd) {
+        KORA_FD_CLOSED(newfd);
+    }
+    KORA_TRACE_END2(SYS_DUP2, ret, oldfd, newfd);
+    return ret;
+}
+
+KORA_DISPATCH int sys_select(int nfds, fd_set *r, fd_set *w, fd_set *e, struct timeval *tmo) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(select, (nfds, r, w, e, tmo));
+    KORA_TRACE_END5(SYS_SELECT, ret, nfds, r, w, e, tmo);
+    return ret;
+}
+
+KORA_DISPATCH int sys_sem_wait(sem_t *sem) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(sem_wait, (sem));
+    KORA_TRACE_END1(SYS_SEM_WAIT, ret, sem);
+    return ret;
+}
+
+KORA_DISPATCH int sys_sem_post(sem_t *sem) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(sem_post, (sem));
+    KORA_TRACE_END1(SYS_SEM_POST, ret, sem);
+    return ret;
+}
+
+KORA_DISPATCH int sys_clock_gettime(clockid_t id, struct timespec *tp) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(clock_gettime, (id, tp));
+    KORA_TRACE_END2(SYS_CLOCK_GETTIME, ret, id, tp);
+    return ret;
+}
+
+KORA_DISPATCH int sys_gettimeofday(struct timeval *tv, void *tz) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(gettimeofday, (tv, tz));
+    KORA_TRACE_END2(SYS_GETTIMEOFDAY, ret, tv, tz);
+    return ret;
+}
+
+KORA_DISPATCH int sys_nanosleep(const struct timespec *req, struct timespec *rem) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(nanosleep, (req, rem));
+    KORA_TRACE_END2(SYS_NANOSLEEP, ret, req, rem);
+    return ret;
+}
+
+KORA_DISPATCH unsigned sys_sleep(unsigned seconds) {
+    unsigned ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(sleep, (seconds));
+    KORA_TRACE_END1(SYS_SLEEP, ret, seconds);
+    return ret;
+}
+
+KORA_DISPATCH int sys_setitimer(int which, const struct itimerval *new, struct itimerval *old) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(setitimer, (which, new, old));
+    KORA_TRACE_END3(SYS_SETITIMER, ret, which, new, old);
+    return ret;
+}
+
+KORA_DISPATCH sighandler_t sys_signal(int signum, sighandler_t handler) {
+    sighandler_t ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(signal, (signum, handler));
+    KORA_TRACE_END2(SYS_SIGNAL, ret, signum, handler);
+    return ret;
+}
+
+KORA_DISPATCH int sys_sigaction(int signum, const struct sigaction *act, struct sigaction *oldact) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(sigaction, (signum, act, oldact));
+    KORA_TRACE_END3(SYS_SIGACTION, ret, signum, act, oldact);
+    return ret;
+}
+
+KORA_DISPATCH int sys_sigprocmask(int how, const sigset_t *set, sigset_t *oldset) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(sigprocmask, (how, set, oldset));
+    KORA_TRACE_END3(SYS_SIGPROCMASK, ret, how, set, oldset);
+    return ret;
+}
+
+KORA_DISPATCH int sys_signalfd(const sigset_t *mask, int flags) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(signalfd, (mask, flags));
+    KORA_TRACE_END2(SYS_SIGNALFD, ret, mask, flags);
+    return ret;
+}
+
+KORA_DISPATCH int sys_signalfd_read(int fd, kora_siginfo_t *info, size_t max) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(signalfd_read, (fd, info, max));
+    KORA_TRACE_END3(SYS_SIGNALFD_READ, ret, fd, info, max);
+    return ret;
+}
+
+KORA_DISPATCH int sys_kill(pid_t pid, int signum) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(kill, (pid, signum));
+    KORA_TRACE_END2(SYS_KILL, ret, pid, signum);
+    return ret;
+}
+
+KORA_DISPATCH int sys_sigreturn(void) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(sigreturn, ());
+    KORA_TRACE_END0(SYS_SIGRETURN, ret);
+    return ret;
+}
+
+KORA_DISPATCH int sys_sync(void) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(sync, ());
+    KORA_TRACE_END0(SYS_SYNC, ret);
+    return ret;
+}
+
+KORA_DISPATCH int sys_reboot(int cmd) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    ret = KORA_BACKEND(reboot, (cmd));
+    KORA_TRACE_END1(SYS_REBOOT, ret, cmd);
+    return ret;
+}
+
+KORA_DISPATCH int sys_mount(const char *src, const char *tgt, const char *type,
+                            unsigned flags, const void *data) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    if (!kora_vfs_sys_mount(src, tgt, type, flags, data, &ret)) {
+        ret = KORA_BACKEND(mount, (src, tgt, type, flags, data));
+    }
+    KORA_TRACE_END5(SYS_MOUNT, ret, src, tgt, type, flags, data);
+    return ret;
+}
+
+KORA_DISPATCH int sys_umount(const char *tgt) {
+    int ret;
+    KORA_TRACE_BEGIN();
+    if (!kora_vfs_sys_umount(tgt, &ret)) {
+        ret = KORA_BACKEND(umount, (tgt));
+    }
+    KORA_TRACE_END1(SYS_UMOUNT, ret, tgt);
+    return ret;
+}
@@ -0,0 +1,38 @@
+/**
+ * KoraLayer Error Recording
+ *
+ * Internal fast path used by the platform backends on failure
+ */
+
+#pragma once
+
+#include <kora/error.h>
+#include <stdatomic.h>
+
+#if defined(_MSC_VER)
+    #define KORA_THREAD_LOCAL __declspec(thread)
+#else
+    #define KORA_THREAD_LOCAL _Thread_local
+#endif
+
+extern KORA_THREAD_LOCAL kora_error_t kora_tls_error;
+extern _Atomic(kora_diag_sink_t) kora_diag_sink;
+
+/**
+ * Hand a failure to the installed diagnostic sink (slow path)
+ */
+void kora_diag_emit(int syscall, int host_errno);
+
+/**
+ * Record a failed call for kora_last_error()
+ *
+ * Costs two thread-local stores when no sink is installed.
+ */
+static inline void kora_record_error(int syscall, int host_errno) {
+    kora_tls_error.syscall = syscall;
+    kora_tls_error.host_errno = host_errno;
+
+    if (atomic_load_explicit(&kora_diag_sink, memory_order_relaxed) != NULL) {
+        kora_diag_emit(syscall, host_errno);
+    }
+}
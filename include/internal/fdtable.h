@@ -0,0 +1,103 @@
+/**
+ * KoraLayer Descriptor Table Internals
+ *
+ * Entries live in two ranges of fixed chunk directories, one for host
+ * descriptors and one for layer descriptors from KORA_FD_LAYER_BASE.
+ * Chunks are allocated on first use and never freed, so kora_fd_entry
+ * is two acquire loads. Host entries exist only once a slot was set on
+ * the descriptor or a platform attached a handle to it, as it does for
+ * the DIR behind a host directory descriptor; layer entries are
+ * allocated and freed with their descriptors by kora_fd_alloc and
+ * kora_fd_free.
+ */
+
+#pragma once
+
+#include <kora/fd.h>
+#include <stdatomic.h>
+#include <stddef.h>
+
+#define KORA_FD_LAYER_BASE (1 << 24)
+#define KORA_FD_CHUNK      1024
+#define KORA_FD_CHUNKS     1024   /* Up to a million descriptors per range */
+
+#define KORA_FD_DIR 0x1   /* A directory handle rather than a descriptor */
+
+typedef struct {
+    _Atomic(void *) owner;   /* Layer descriptors: serving backend, NULL when free */
+    const char *backend;     /* Its name */
+    _Atomic(void *) handle;  /* The backend's handle */
+    unsigned flags;          /* KORA_FD_* */
+    _Atomic(void *) slots[KORA_FD_SLOTS];
+} kora_fd_entry_t;
+
+extern _Atomic(kora_fd_entry_t *) kora_fd_chunks[2][KORA_FD_CHUNKS];
+
+/* Registered slots; while 0, closing a host descriptor skips the table */
+extern atomic_int kora_fd_slots_used;
+
+/**
+ * Entry for a descriptor, or NULL if its chunk was never allocated
+ */
+static inline kora_fd_entry_t *kora_fd_entry(int fd) {
+    if (fd < 0) {
+        return NULL;
+    }
+    int layer = fd >= KORA_FD_LAYER_BASE;
+    size_t index = (size_t)fd - (layer ? KORA_FD_LAYER_BASE : 0);
+    if (index >= (size_t)KORA_FD_CHUNK * KORA_FD_CHUNKS) {
+        return NULL;
+    }
+    kora_fd_entry_t *chunk =
+        atomic_load_explicit(&kora_fd_chunks[layer][index / KORA_FD_CHUNK], memory_order_acquire);
+    return chunk != NULL ? &chunk[index % KORA_FD_CHUNK] : NULL;
+}
+
+/**
+ * Number a new layer descriptor
+ *
+ * @param owner Backend serving it, not NULL
+ * @param backend Its name, for kora_fd_backend
+ * @return The descriptor, or -EMFILE or -ENOMEM
+ */
+int kora_fd_alloc(void *owner, const char *backend, void *handle, unsigned flags);
+
+/**
+ * Release a layer descriptor's slots and its number
+ */
+void kora_fd_free(int fd);
+
+/**
+ * Release a host descriptor's slots after it was closed
+ */
+void kora_fd_closed(int fd);
+
+/**
+ * Attach a platform handle to a host descriptor
+ *
+ * @return 0, or -EBADF (negative, or past the KORA_FD_CHUNK * KORA_FD_CHUNKS
+ *         host entries) or -ENOMEM
+ */
+int kora_fd_attach(int fd, void *handle);
+
+/**
+ * Detach a host descriptor's handle; only one of several racing callers gets it
+ *
+ * @return The handle, or NULL if none was attached
+ */
+void *kora_fd_detach(int fd);
+
+/**
+ * @return The handle attached to a host descriptor, or NULL
+ */
+static inline void *kora_fd_attached(int fd) {
+    kora_fd_entry_t *e = fd < KORA_FD_LAYER_BASE ? kora_fd_entry(fd) : NULL;
+    return e != NULL ? atomic_load_explicit(&e->handle, memory_order_acquire) : NULL;
+}
+
+/* A layer entry's handle, published before its owner */
+#define KORA_FD_HANDLE(e) atomic_load_explicit(&(e)->handle, memory_order_relaxed)
+
+#define KORA_FD_CLOSED(fd)                                                    \
+    ((void)(atomic_load_explicit(&kora_fd_slots_used, memory_order_relaxed) && \
+            (kora_fd_closed(fd), 1)))
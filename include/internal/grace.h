@@ -0,0 +1,45 @@
+/**
+ * KoraLayer Grace Periods
+ *
+ * Lets lock-free readers use a structure that a writer replaces, and the
+ * writer free the replaced one once no reader can still be using it. A
+ * reader brackets its use with kora_grace_enter and kora_grace_exit,
+ * which only touch a counter of the calling thread's own. The writer
+ * publishes the replacement with a seq_cst store and then calls
+ * kora_grace_wait, which returns once every section that began before
+ * the store has ended. Readers must load the published pointer seq_cst.
+ *
+ * Sections nest, so a call made from a signal handler that interrupted
+ * one is counted too. A section must not block for long, since writers
+ * wait for it: kora_grace_leave ends it early, before a call into the
+ * host that may block.
+ */
+
+#pragma once
+
+/**
+ * Start a section
+ *
+ * @return Whether the thread was already inside one, for kora_grace_exit
+ */
+int kora_grace_enter(void);
+
+/**
+ * End the current section early; does nothing if it already ended
+ */
+void kora_grace_leave(void);
+
+/**
+ * End the current section and return to the one it was nested in
+ *
+ * @param outer What kora_grace_enter returned
+ */
+void kora_grace_exit(int outer);
+
+/**
+ * Wait for every section that began before the call to end
+ *
+ * @return 0, or -ENOTSUP where the platform has no grace periods, in
+ *         which case nothing replaced may be freed
+ */
+int kora_grace_wait(void);
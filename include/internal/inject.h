@@ -0,0 +1,50 @@
+/**
+ * KoraLayer Injection Hooks
+ *
+ * Used by the sys_* bodies in internal/dispatch.h, after the trace
+ * hooks so that injected delays and failures are traced. Each macro is
+ * an expression that is non-zero when the call must not be made, in
+ * which case it has already stored the failure in ret: -1 with errno
+ * for KORA_INJECT_ERRNO, a negative errno for KORA_INJECT_NEG. count
+ * points at the call's transfer size, or is NULL, and may be lowered.
+ */
+
+#pragma once
+
+#include <kora/inject.h>
+#include <stdatomic.h>
+#include <stddef.h>
+
+extern atomic_int kora_inject_active;
+
+/**
+ * Apply the rule for a call (slow path)
+ *
+ * Sleeps for any delay and may lower *count. Preserves errno.
+ *
+ * @return 0 to make the call, or the errno to fail it with
+ */
+int kora_inject_enter(int syscall, size_t *count);
+
+/**
+ * kora_inject_enter that also sets errno when failing the call
+ */
+int kora_inject_enter_errno(int syscall, size_t *count);
+
+#if defined(KORA_NO_INJECT)
+
+#define KORA_INJECT_ERRNO(sys, count, ret) 0
+#define KORA_INJECT_NEG(sys, count, ret) 0
+
+#else
+
+#define KORA_INJECT_ERRNO(sys, count, ret)                                   \
+    (atomic_load_explicit(&kora_inject_active, memory_order_relaxed) &&      \
+     kora_inject_enter_errno((sys), (count)) != 0 &&                         \
+     ((ret) = -1, 1))
+
+#define KORA_INJECT_NEG(sys, count, ret)                                     \
+    (atomic_load_explicit(&kora_inject_active, memory_order_relaxed) &&      \
+     ((ret) = -kora_inject_enter((sys), (count))) != 0)
+
+#endif
@@ -0,0 +1,151 @@
+/**
+ * KoraLayer Raw System Call Instructions
+ *
+ * kora_raw_syscallN(nr, args...) enters the Linux kernel directly, with
+ * syscall on x86-64 and svc #0 on aarch64, and returns what the kernel
+ * left in the result register: the result, or -errno in [-4095, -1].
+ * Used by src/linux/raw_linux.c; nothing here touches libc or errno.
+ */
+
+#pragma once
+
+#include <kora/linux_raw.h>
+
+#if defined(KORA_HAVE_LINUX_RAW)
+
+#include <asm/unistd.h>
+
+#if defined(__x86_64__)
+
+/* rcx and r11 are clobbered by the instruction itself */
+static inline long kora_raw_syscall0(long n) {
+    long ret;
+    __asm__ __volatile__("syscall" : "=a"(ret) : "a"(n) : "rcx", "r11", "memory");
+    return ret;
+}
+
+static inline long kora_raw_syscall1(long n, long a1) {
+    long ret;
+    __asm__ __volatile__("syscall" : "=a"(ret) : "a"(n), "D"(a1) : "rcx", "r11", "memory");
+    return ret;
+}
+
+static inline long kora_raw_syscall2(long n, long a1, long a2) {
+    long ret;
+    __asm__ __volatile__("syscall" : "=a"(ret) : "a"(n), "D"(a1), "S"(a2)
+                         : "rcx", "r11", "memory");
+    return ret;
+}
+
+static inline long kora_raw_syscall3(long n, long a1, long a2, long a3) {
+    long ret;
+    __asm__ __volatile__("syscall" : "=a"(ret) : "a"(n), "D"(a1), "S"(a2), "d"(a3)
+                         : "rcx", "r11", "memory");
+    return ret;
+}
+
+static inline long kora_raw_syscall4(long n, long a1, long a2, long a3, long a4) {
+    register long r10 __asm__("r10") = a4;
+    long ret;
+    __asm__ __volatile__("syscall" : "=a"(ret) : "a"(n), "D"(a1), "S"(a2), "d"(a3), "r"(r10)
+                         : "rcx", "r11", "memory");
+    return ret;
+}
+
+static inline long kora_raw_syscall5(long n, long a1, long a2, long a3, long a4, long a5) {
+    register long r10 __asm__("r10") = a4;
+    register long r8 __asm__("r8") = a5;
+    long ret;
+    __asm__ __volatile__("syscall" : "=a"(ret)
+                         : "a"(n), "D"(a1), "S"(a2), "d"(a3), "r"(r10), "r"(r8)
+                         : "rcx", "r11", "memory");
+    return ret;
+}
+
+static inline long kora_raw_syscall6(long n, long a1, long a2, long a3, long a4, long a5,
+                                     long a6) {
+    register long r10 __asm__("r10") = a4;
+    register long r8 __asm__("r8") = a5;
+    register long r9 __asm__("r9") = a6;
+    long ret;
+    __asm__ __volatile__("syscall" : "=a"(ret)
+                         : "a"(n), "D"(a1), "S"(a2), "d"(a3), "r"(r10), "r"(r8), "r"(r9)
+                         : "rcx", "r11", "memory");
+    return ret;
+}
+
+#elif defined(__aarch64__)
+
+/* Number in x8, arguments in x0-x5, result in x0 */
+static inline long kora_raw_syscall0(long n) {
+    register long x8 __asm__("x8") = n;
+    register long x0 __asm__("x0");
+    __asm__ __volatile__("svc #0" : "=r"(x0) : "r"(x8) : "memory", "cc");
+    return x0;
+}
+
+static inline long kora_raw_syscall1(long n, long a1) {
+    register long x8 __asm__("x8") = n;
+    register long x0 __asm__("x0") = a1;
+    __asm__ __volatile__("svc #0" : "+r"(x0) : "r"(x8) : "memory", "cc");
+    return x0;
+}
+
+static inline long kora_raw_syscall2(long n, long a1, long a2) {
+    register long x8 __asm__("x8") = n;
+    register long x0 __asm__("x0") = a1;
+    register long x1 __asm__("x1") = a2;
+    __asm__ __volatile__("svc #0" : "+r"(x0) : "r"(x8), "r"(x1) : "memory", "cc");
+    return x0;
+}
+
+static inline long kora_raw_syscall3(long n, long a1, long a2, long a3) {
+    register long x8 __asm__("x8") = n;
+    register long x0 __asm__("x0") = a1;
+    register long x1 __asm__("x1") = a2;
+    register long x2 __asm__("x2") = a3;
+    __asm__ __volatile__("svc #0" : "+r"(x0) : "r"(x8), "r"(x1), "r"(x2) : "memory", "cc");
+    return x0;
+}
+
+static inline long kora_raw_syscall4(long n, long a1, long a2, long a3, long a4) {
+    register long x8 __asm__("x8") = n;
+    register long x0 __asm__("x0") = a1;
+    register long x1 __asm__("x1") = a2;
+    register long x2 __asm__("x2") = a3;
+    register long x3 __asm__("x3") = a4;
+    __asm__ __volatile__("svc #0" : "+r"(x0) : "r"(x8), "r"(x1), "r"(x2), "r"(x3)
+                         : "memory", "cc");
+    return x0;
+}
+
+static inline long kora_raw_syscall5(long n, long a1, long a2, long a3, long a4, long a5) {
+    register long x8 __asm__("x8") = n;
+    register long x0 __asm__("x0") = a1;
+    register long x1 __asm__("x1") = a2;
+    register long x2 __asm__("x2") = a3;
+    register long x3 __asm__("x3") = a4;
+    register long x4 __asm__("x4") = a5;
+    __asm__ __volatile__("svc #0" : "+r"(x0) : "r"(x8), "r"(x1), "r"(x2), "r"(x3), "r"(x4)
+                         : "memory", "cc");
+    return x0;
+}
+
+static inline long kora_raw_syscall6(long n, long a1, long a2, long a3, long a4, long a5,
+                                     long a6) {
+    register long x8 __asm__("x8") = n;
+    register long x0 __asm__("x0") = a1;
+    register long x1 __asm__("x1") = a2;
+    register long x2 __asm__("x2") = a3;
+    register long x3 __asm__("x3") = a4;
+    register long x4 __asm__("x4") = a5;
+    register long x5 __asm__("x5") = a6;
+    __asm__ __volatile__("svc #0" : "+r"(x0)
+                         : "r"(x8), "r"(x1), "r"(x2), "r"(x3), "r"(x4), "r"(x5)
+                         : "memory", "cc");
+    return x0;
+}
+
+#endif
+
+#endif /* KORA_HAVE_LINUX_RAW */
@@ -34,6 +34,8 @@
     int linux_sys_read(int fd, void *buf, size_t count);
     int linux_sys_write(int fd, const void *buf, size_t count);
     long linux_sys_seek(int fd, long offset, int whence);
+    int linux_sys_fadvise(int fd, uint64_t offset, uint64_t len, int advice);
+    int linux_sys_readahead(int fd, uint64_t offset, size_t count);
     int linux_sys_ioctl(int fd, unsigned long request, void *arg);
     int linux_sys_mkdir(const char *path);
     int linux_sys_rmdir(const char *path);
@@ -49,11 +51,29 @@
     void *linux_sys_mmap(void *addr, size_t len, int prot, int flags, int fd, off_t off);
     int linux_sys_munmap(void *addr, size_t len);
     int linux_sys_mprotect(void *addr, size_t len, int prot);
+    int linux_sys_shm_create(const char *name, uint64_t size, int flags);
+    int linux_sys_shm_open(const char *name, int flags);
+    int linux_sys_shm_unlink(const char *name);
+    int linux_sys_shm_seal(int fd, unsigned seals);
     int linux_sys_yield(void);
     pid_t linux_sys_getpid(void);
     pid_t linux_sys_getppid(void);
     int linux_sys_setpriority(pid_t pid, int prio);
+    pid_t linux_sys_gettid(void);
+    int linux_sys_sched_setpolicy(pid_t tid, int policy, int priority);
+    int linux_sys_sched_getpolicy(pid_t tid, int *priority);
+    int linux_sys_ioprio_set(pid_t tid, int ioclass, int level);
+    int linux_sys_ioprio_get(pid_t tid, int *level);
+    int linux_sys_sched_setaffinity(pid_t pid, const kora_cpuset_t *set);
+    int linux_sys_sched_getaffinity(pid_t pid, kora_cpuset_t *set);
+    int linux_sys_getcpu(unsigned *cpu, unsigned *node);
+    int linux_sys_cpu_topology(kora_cpu_topology_t *topo, kora_cpu_info_t *cpus, size_t max);
     int linux_sys_pipe(int fds[2]);
+    int linux_sys_pipe2(int fds[2], int flags);
+    int linux_sys_pipe_size(int fd, int size);
+    long linux_sys_splice(int fd_in, int64_t *off_in, int fd_out, int64_t *off_out,
+                          size_t len, unsigned flags);
+    long linux_sys_tee(int fd_in, int fd_out, size_t len, unsigned flags);
     int linux_sys_dup(int oldfd);
     int linux_sys_dup2(int oldfd, int newfd);
     int linux_sys_select(int nfds, fd_set *r, fd_set *w, fd_set *e, struct timeval *tmo);
@@ -65,12 +85,17 @@
     unsigned linux_sys_sleep(unsigned seconds);
     int linux_sys_setitimer(int which, const struct itimerval *new, struct itimerval *old);
     sighandler_t linux_sys_signal(int signum, sighandler_t handler);
+    int linux_sys_sigaction(int signum, const struct sigaction *act, struct sigaction *oldact);
+    int linux_sys_sigprocmask(int how, const sigset_t *set, sigset_t *oldset);
+    int linux_sys_signalfd(const sigset_t *mask, int flags);
+    int linux_sys_signalfd_read(int fd, kora_siginfo_t *info, size_t max);
     int linux_sys_kill(pid_t pid, int signum);
     int linux_sys_sigreturn(void);
     int linux_sys_sync(void);
     int linux_sys_reboot(int cmd);
     int linux_sys_mount(const char *src, const char *tgt, const char *type,
                         unsigned flags, const void *data);
+    int linux_sys_umount(const char *tgt);
     int linux_sys_get_file_info(const char *path, kora_file_info_t *info);
     int linux_sys_get_fd_info(int fd, kora_file_info_t *info);
     int linux_sys_stat(const char *path, kora_stat_t *st);
@@ -84,6 +109,14 @@
     pid_t linux_sys_spawn(const char *path, char *const argv[], char *const envp[]);
     void linux_sys_exit(int status) __attribute__((noreturn));
     pid_t linux_sys_wait(pid_t pid, int *status, int options);
+    pid_t linux_sys_wait4(pid_t pid, int *status, int options, kora_rusage_t *usage);
+    int linux_sys_getrusage(int who, kora_rusage_t *usage);
+    int linux_sys_thread_create(kora_thread_t *thread, const kora_thread_attr_t *attr,
+                              void *(*entry)(void *), void *arg);
+    int linux_sys_thread_join(kora_thread_t thread, void **retval);
+    void linux_sys_thread_exit(void *retval) __attribute__((noreturn));
+    kora_thread_t linux_sys_thread_self(void);
+    int linux_sys_thread_raw(void);
 #elif defined(KORA_PLATFORM_MACOS)
     int macos_sys_putc(char c);
     int macos_sys_getc(void);
@@ -92,6 +125,8 @@
     int macos_sys_read(int fd, void *buf, size_t count);
     int macos_sys_write(int fd, const void *buf, size_t count);
     long macos_sys_seek(int fd, long offset, int whence);
+    int macos_sys_fadvise(int fd, uint64_t offset, uint64_t len, int advice);
+    int macos_sys_readahead(int fd, uint64_t offset, size_t count);
     int macos_sys_ioctl(int fd, unsigned long request, void *arg);
     int macos_sys_mkdir(const char *path);
     int macos_sys_rmdir(const char *path);
@@ -107,11 +142,29 @@
     void *macos_sys_mmap(void *addr, size_t len, int prot, int flags, int fd, off_t off);
     int macos_sys_munmap(void *addr, size_t len);
     int macos_sys_mprotect(void *addr, size_t len, int prot);
+    int macos_sys_shm_create(const char *name, uint64_t size, int flags);
+    int macos_sys_shm_open(const char *name, int flags);
+    int macos_sys_shm_unlink(const char *name);
+    int macos_sys_shm_seal(int fd, unsigned seals);
     int macos_sys_yield(void);
     pid_t macos_sys_getpid(void);
     pid_t macos_sys_getppid(void);
     int macos_sys_setpriority(pid_t pid, int prio);
+    pid_t macos_sys_gettid(void);
+    int macos_sys_sched_setpolicy(pid_t tid, int policy, int priority);
+    int macos_sys_sched_getpolicy(pid_t tid, int *priority);
+    int macos_sys_ioprio_set(pid_t tid, int ioclass, int level);
+    int macos_sys_ioprio_get(pid_t tid, int *level);
+    int macos_sys_sched_setaffinity(pid_t pid, const kora_cpuset_t *set);
+    int macos_sys_sched_getaffinity(pid_t pid, kora_cpuset_t *set);
+    int macos_sys_getcpu(unsigned *cpu, unsigned *node);
+    int macos_sys_cpu_topology(kora_cpu_topology_t *topo, kora_cpu_info_t *cpus, size_t max);
     int macos_sys_pipe(int fds[2]);
+    int macos_sys_pipe2(int fds[2], int flags);
+    int macos_sys_pipe_size(int fd, int size);
+    long macos_sys_splice(int fd_in, int64_t *off_in, int fd_out, int64_t *off_out,
+                          size_t len, unsigned flags);
+    long macos_sys_tee(int fd_in, int fd_out, size_t len, unsigned flags);
     int macos_sys_dup(int oldfd);
     int macos_sys_dup2(int oldfd, int newfd);
     int macos_sys_select(int nfds, fd_set *r, fd_set *w, fd_set *e, struct timeval *tmo);
@@ -123,12 +176,17 @@
     unsigned macos_sys_sleep(unsigned seconds);
     int macos_sys_setitimer(int which, const struct itimerval *new, struct itimerval *old);
     sighandler_t macos_sys_signal(int signum, sighandler_t handler);
+    int macos_sys_sigaction(int signum, const struct sigaction *act, struct sigaction *oldact);
+    int macos_sys_sigprocmask(int how, const sigset_t *set, sigset_t *oldset);
+    int macos_sys_signalfd(const sigset_t *mask, int flags);
+    int macos_sys_signalfd_read(int fd, kora_siginfo_t *info, size_t max);
     int macos_sys_kill(pid_t pid, int signum);
     int macos_sys_sigreturn(void);
     int macos_sys_sync(void);
     int macos_sys_reboot(int cmd);
     int macos_sys_mount(const char *src, const char *tgt, const char *type,
                         unsigned flags, const void *data);
+    int macos_sys_umount(const char *tgt);
     int macos_sys_get_file_info(const char *path, kora_file_info_t *info);
     int macos_sys_get_fd_info(int fd, kora_file_info_t *info);
     int macos_sys_stat(const char *path, kora_stat_t *st);
@@ -142,6 +200,13 @@
     pid_t macos_sys_spawn(const char *path, char *const argv[], char *const envp[]);
     void macos_sys_exit(int status) __attribute__((noreturn));
     pid_t macos_sys_wait(pid_t pid, int *status, int options);
+    pid_t macos_sys_wait4(pid_t pid, int *status, int options, kora_rusage_t *usage);
+    int macos_sys_getrusage(int who, kora_rusage_t *usage);
+    int macos_sys_thread_create(kora_thread_t *thread, const kora_thread_attr_t *attr,
+                              void *(*entry)(void *), void *arg);
+    int macos_sys_thread_join(kora_thread_t thread, void **retval);
+    void macos_sys_thread_exit(void *retval) __attribute__((noreturn));
+    kora_thread_t macos_sys_thread_self(void);
 #elif defined(KORA_PLATFORM_WINDOWS)
     int windows_sys_putc(char c);
     int windows_sys_getc(void);
@@ -150,6 +215,8 @@
     int windows_sys_read(int fd, void *buf, size_t count);
     int windows_sys_write(int fd, const void *buf, size_t count);
     long windows_sys_seek(int fd, long offset, int whence);
+    int windows_sys_fadvise(int fd, uint64_t offset, uint64_t len, int advice);
+    int windows_sys_readahead(int fd, uint64_t offset, size_t count);
     int windows_sys_ioctl(int fd, unsigned long request, void *arg);
     int windows_sys_mkdir(const char *path);
     int windows_sys_rmdir(const char *path);
@@ -165,11 +232,29 @@
     void *windows_sys_mmap(void *addr, size_t len, int prot, int flags, int fd, off_t off);
     int windows_sys_munmap(void *addr, size_t len);
     int windows_sys_mprotect(void *addr, size_t len, int prot);
+    int windows_sys_shm_create(const char *name, uint64_t size, int flags);
+    int windows_sys_shm_open(const char *name, int flags);
+    int windows_sys_shm_unlink(const char *name);
+    int windows_sys_shm_seal(int fd, unsigned seals);
     int windows_sys_yield(void);
     pid_t windows_sys_getpid(void);
     pid_t windows_sys_getppid(void);
     int windows_sys_setpriority(pid_t pid, int prio);
+    pid_t windows_sys_gettid(void);
+    int windows_sys_sched_setpolicy(pid_t tid, int policy, int priority);
+    int windows_sys_sched_getpolicy(pid_t tid, int *priority);
+    int windows_sys_ioprio_set(pid_t tid, int ioclass, int level);
+    int windows_sys_ioprio_get(pid_t tid, int *level);
+    int windows_sys_sched_setaffinity(pid_t pid, const kora_cpuset_t *set);
+    int windows_sys_sched_getaffinity(pid_t pid, kora_cpuset_t *set);
+    int windows_sys_getcpu(unsigned *cpu, unsigned *node);
+    int windows_sys_cpu_topology(kora_cpu_topology_t *topo, kora_cpu_info_t *cpus, size_t max);
     int windows_sys_pipe(int fds[2]);
+    int windows_sys_pipe2(int fds[2], int flags);
+    int windows_sys_pipe_size(int fd, int size);
+    long windows_sys_splice(int fd_in, int64_t *off_in, int fd_out, int64_t *off_out,
+                            size_t len, unsigned flags);
+    long windows_sys_tee(int fd_in, int fd_out, size_t len, unsigned flags);
     int windows_sys_dup(int oldfd);
     int windows_sys_dup2(int oldfd, int newfd);
     int windows_sys_select(int nfds, fd_set *r, fd_set *w, fd_set *e, struct timeval *tmo);
@@ -181,12 +266,17 @@
     unsigned windows_sys_sleep(unsigned seconds);
     int windows_sys_setitimer(int which, const struct itimerval *new, struct itimerval *old);
     sighandler_t windows_sys_signal(int signum, sighandler_t handler);
+    int windows_sys_sigaction(int signum, const struct sigaction *act, struct sigaction *oldact);
+    int windows_sys_sigprocmask(int how, const sigset_t *set, sigset_t *oldset);
+    int windows_sys_signalfd(const sigset_t *mask, int flags);
+    int windows_sys_signalfd_read(int fd, kora_siginfo_t *info, size_t max);
     int windows_sys_kill(pid_t pid, int signum);
     int windows_sys_sigreturn(void);
     int windows_sys_sync(void);
     int windows_sys_reboot(int cmd);
     int windows_sys_mount(const char *src, const char *tgt, const char *type,
                           unsigned flags, const void *data);
+    int windows_sys_umount(const char *tgt);
     int windows_sys_get_file_info(const char *path, kora_file_info_t *info);
     int windows_sys_get_fd_info(int fd, kora_file_info_t *info);
     int windows_sys_stat(const char *path, kora_stat_t *st);
@@ -200,4 +290,17 @@
     pid_t windows_sys_spawn(const char *path, char *const argv[], char *const envp[]);
     void windows_sys_exit(int status);
     pid_t windows_sys_wait(pid_t pid, int *status, int options);
+    pid_t windows_sys_wait4(pid_t pid, int *status, int options, kora_rusage_t *usage);
+    int windows_sys_getrusage(int who, kora_rusage_t *usage);
+    int windows_sys_thread_create(kora_thread_t *thread, const kora_thread_attr_t *attr,
+                              void *(*entry)(void *), void *arg);
+    int windows_sys_thread_join(kora_thread_t thread, void **retval);
+    void windows_sys_thread_exit(void *retval);
+    kora_thread_t windows_sys_thread_self(void);
+#endif
+
+/* Inline dispatch for callers; see kora/syscalls.h */
+#if defined(KORA_INLINE_DISPATCH) && !defined(KORA_DISPATCH) && defined(__GNUC__)
+#define KORA_DISPATCH extern __inline__ __attribute__((__gnu_inline__))
+#include <internal/dispatch.h>
 #endif
@@ -0,0 +1,99 @@
+/**
+ * KoraLayer Trace Hooks
+ *
+ * Used by the sys_* bodies in internal/dispatch.h. KORA_TRACE_BEGIN
+ * samples the wall and thread CPU clocks only when tracing is on;
+ * KORA_TRACE_ENDn hands the call to the recorder with n arguments.
+ */
+
+#pragma once
+
+#include <kora/trace.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+extern atomic_int kora_trace_active;
+
+/**
+ * Clock readings taken at entry to a traced call
+ */
+typedef struct {
+    uint64_t start_ns;  /* Monotonic clock; 0 when not tracing */
+    uint64_t cpu_ns;    /* Calling thread's CPU clock */
+} kora_trace_span_t;
+
+/**
+ * Monotonic clock in nanoseconds
+ */
+uint64_t kora_trace_clock(void);
+
+/**
+ * Fill in the entry readings of a span (slow path)
+ */
+void kora_trace_begin(kora_trace_span_t *span);
+
+/**
+ * Append one call to the calling thread's ring (slow path)
+ *
+ * Preserves errno.
+ */
+void kora_trace_record(int syscall, const kora_trace_span_t *span, int64_t result,
+                       int nargs, const uint64_t *args);
+
+#if defined(KORA_NO_TRACE)
+
+#define KORA_TRACE_BEGIN() ((void)0)
+#define KORA_TRACE_END0(sys, ret) ((void)0)
+#define KORA_TRACE_END1(sys, ret, a) ((void)0)
+#define KORA_TRACE_END2(sys, ret, a, b) ((void)0)
+#define KORA_TRACE_END3(sys, ret, a, b, c) ((void)0)
+#define KORA_TRACE_END4(sys, ret, a, b, c, d) ((void)0)
+#define KORA_TRACE_END5(sys, ret, a, b, c, d, e) ((void)0)
+#define KORA_TRACE_END6(sys, ret, a, b, c, d, e, f) ((void)0)
+
+#else
+
+#define KORA_TRACE_ARG(x)    ((uint64_t)(uintptr_t)(x))
+#define KORA_TRACE_RESULT(x) ((int64_t)(intptr_t)(x))
+
+#define KORA_TRACE_BEGIN()                                                   \
+    kora_trace_span_t kora_trace_span_ = { 0, 0 };                           \
+    if (atomic_load_explicit(&kora_trace_active, memory_order_relaxed)) {    \
+        kora_trace_begin(&kora_trace_span_);                                 \
+    }                                                                        \
+    (void)0
+
+#define KORA_TRACE_EMIT_(sys, ret, n, ...)                                   \
+    do {                                                                     \
+        if (kora_trace_span_.start_ns != 0) {                                \
+            const uint64_t kora_trace_args_[] = { __VA_ARGS__ };             \
+            kora_trace_record((sys), &kora_trace_span_,                      \
+                              KORA_TRACE_RESULT(ret), (n), kora_trace_args_); \
+        }                                                                    \
+    } while (0)
+
+#define KORA_TRACE_END0(sys, ret)                                            \
+    do {                                                                     \
+        if (kora_trace_span_.start_ns != 0) {                                \
+            kora_trace_record((sys), &kora_trace_span_,                      \
+                              KORA_TRACE_RESULT(ret), 0, NULL);              \
+        }                                                                    \
+    } while (0)
+#define KORA_TRACE_END1(sys, ret, a) \
+    KORA_TRACE_EMIT_(sys, ret, 1, KORA_TRACE_ARG(a))
+#define KORA_TRACE_END2(sys, ret, a, b) \
+    KORA_TRACE_EMIT_(sys, ret, 2, KORA_TRACE_ARG(a), KORA_TRACE_ARG(b))
+#define KORA_TRACE_END3(sys, ret, a, b, c) \
+    KORA_TRACE_EMIT_(sys, ret, 3, KORA_TRACE_ARG(a), KORA_TRACE_ARG(b), KORA_TRACE_ARG(c))
+#define KORA_TRACE_END4(sys, ret, a, b, c, d) \
+    KORA_TRACE_EMIT_(sys, ret, 4, KORA_TRACE_ARG(a), KORA_TRACE_ARG(b), KORA_TRACE_ARG(c), \
+                     KORA_TRACE_ARG(d))
+#define KORA_TRACE_END5(sys, ret, a, b, c, d, e) \
+    KORA_TRACE_EMIT_(sys, ret, 5, KORA_TRACE_ARG(a), KORA_TRACE_ARG(b), KORA_TRACE_ARG(c), \
+                     KORA_TRACE_ARG(d), KORA_TRACE_ARG(e))
+#define KORA_TRACE_END6(sys, ret, a, b, c, d, e, f) \
+    KORA_TRACE_EMIT_(sys, ret, 6, KORA_TRACE_ARG(a), KORA_TRACE_ARG(b), KORA_TRACE_ARG(c), \
+                     KORA_TRACE_ARG(d), KORA_TRACE_ARG(e), KORA_TRACE_ARG(f))
+
+#endif
@@ -0,0 +1,155 @@
+/**
+ * KoraLayer Virtual Filesystem Routing
+ *
+ * Filesystems implemented inside the layer (such as the in-memory one in
+ * kora/memfs.h) are mounted on an absolute path prefix. The sys_* bodies
+ * in internal/dispatch.h offer every file and directory call to the
+ * kora_vfs_* hook for it first; a hook returns non-zero when the path or
+ * descriptor belongs to a mounted filesystem, after storing the result
+ * in *ret using the call's own convention, and zero to let the platform
+ * backend handle the call. Relative paths always go to the platform.
+ *
+ * A host mount stands for a host directory instead: the hooks rewrite
+ * paths under it and pass them to the platform backend themselves.
+ *
+ * Descriptors and directory handles of mounted filesystems are entries
+ * in the layer's descriptor table (internal/fdtable.h), numbered from
+ * KORA_VFS_FD_BASE, far above anything the host hands out.
+ */
+
+#pragma once
+
+#include <internal/fdtable.h>
+#include <kora/syscalls.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define KORA_VFS_FD_BASE KORA_FD_LAYER_BASE
+
+typedef struct kora_vfs kora_vfs_t;
+
+/**
+ * Operations of a mounted filesystem
+ *
+ * Paths are relative to the mount point and start with '/'. File and
+ * directory handles are opaque to the layer. Every operation returns 0
+ * (or a byte count) on success and a negative errno on failure.
+ */
+typedef struct {
+    const char *name;
+
+    int (*open)(kora_vfs_t *fs, const char *path, int flags, void **file);
+    int (*close)(kora_vfs_t *fs, void *file);
+    long (*read)(kora_vfs_t *fs, void *file, void *buf, size_t count);
+    long (*write)(kora_vfs_t *fs, void *file, const void *buf, size_t count);
+    long (*seek)(kora_vfs_t *fs, void *file, long offset, int whence);
+    int (*fstat)(kora_vfs_t *fs, void *file, kora_stat_t *st);
+    int (*fget_info)(kora_vfs_t *fs, void *file, kora_file_info_t *info);
+
+    int (*opendir)(kora_vfs_t *fs, const char *path, void **dir);
+    int (*readdir)(kora_vfs_t *fs, void *dir, kora_dirent_t *entry);  /* 1, or 0 at the end */
+    int (*closedir)(kora_vfs_t *fs, void *dir);
+
+    int (*mkdir)(kora_vfs_t *fs, const char *path);
+    int (*rmdir)(kora_vfs_t *fs, const char *path);
+    int (*unlink)(kora_vfs_t *fs, const char *path);
+    int (*rename)(kora_vfs_t *fs, const char *from, const char *to);
+    int (*link)(kora_vfs_t *fs, const char *existing, const char *path);
+    int (*symlink)(kora_vfs_t *fs, const char *target, const char *path);
+    int (*readlink)(kora_vfs_t *fs, const char *path, char *buf, size_t size);  /* No NUL */
+    int (*stat)(kora_vfs_t *fs, const char *path, kora_stat_t *st);
+    int (*lstat)(kora_vfs_t *fs, const char *path, kora_stat_t *st);
+    int (*get_info)(kora_vfs_t *fs, const char *path, kora_file_info_t *info);
+    int (*utime)(kora_vfs_t *fs, const char *path, uint64_t mtime);
+
+    /* Free the filesystem; called on unmount with no handles open */
+    void (*destroy)(kora_vfs_t *fs);
+} kora_vfs_ops_t;
+
+/**
+ * Header embedded at the start of every filesystem instance
+ */
+struct kora_vfs {
+    const kora_vfs_ops_t *ops;
+    const char *prefix;   /* Mount point, set by kora_vfs_mount */
+    atomic_int handles;   /* Open descriptors and directory handles */
+};
+
+/* Set while anything is mounted; KORA_VFS skips the hooks otherwise */
+extern atomic_int kora_vfs_active;
+
+/**
+ * Route a path prefix to a filesystem
+ *
+ * @return 0, or -EINVAL (prefix not absolute) or -EBUSY (already mounted)
+ */
+int kora_vfs_mount(const char *prefix, kora_vfs_t *fs);
+
+/**
+ * Remove a mount and destroy its filesystem
+ *
+ * @param ops Only unmount a filesystem of this type, or NULL for any
+ * @return 0, or -EINVAL (not mounted) or -EBUSY (handles still open)
+ */
+int kora_vfs_unmount(const char *prefix, const kora_vfs_ops_t *ops);
+
+/**
+ * Route a path prefix to a host directory
+ *
+ * @param dir Host directory, resolved now; NULL for the prefix itself
+ * @param flags KORA_MOUNT_RDONLY fails changes under the prefix with -EROFS
+ * @return 0, or -EINVAL, -EBUSY, -ENOTDIR, -ENOMEM or the error resolving dir
+ */
+int kora_vfs_host_mount(const char *dir, const char *prefix, unsigned flags);
+
+/**
+ * sys_mount of a filesystem type implemented in the layer
+ *
+ * Not behind KORA_VFS, since nothing may be mounted yet.
+ *
+ * @return Non-zero when type is one of ours, with the result in *ret
+ */
+int kora_vfs_sys_mount(const char *src, const char *tgt, const char *type, unsigned flags,
+                       const void *data, int *ret);
+
+/**
+ * sys_umount of any mount made in the layer
+ *
+ * @return Non-zero when the call was handled, with the result in *ret
+ */
+int kora_vfs_sys_umount(const char *tgt, int *ret);
+
+/**
+ * Write back mounted images before sys_exit, which runs no atexit handlers
+ */
+void kora_vfs_sys_exit(void);
+
+#define KORA_VFS(call) \
+    (atomic_load_explicit(&kora_vfs_active, memory_order_relaxed) && (call))
+
+int kora_vfs_open(const char *path, int flags, int *ret);
+int kora_vfs_close(int fd, int *ret);
+int kora_vfs_read(int fd, void *buf, size_t count, int *ret);
+int kora_vfs_write(int fd, const void *buf, size_t count, int *ret);
+int kora_vfs_seek(int fd, long offset, int whence, long *ret);
+int kora_vfs_fadvise(int fd, int *ret);
+int kora_vfs_readahead(int fd, int *ret);
+int kora_vfs_ioctl(int fd, int *ret);
+int kora_vfs_mkdir(const char *path, int *ret);
+int kora_vfs_rmdir(const char *path, int *ret);
+int kora_vfs_opendir(const char *path, int *ret);
+int kora_vfs_readdir(int dir, kora_dirent_t *entry, int *ret);
+int kora_vfs_closedir(int dir, int *ret);
+int kora_vfs_symlink(const char *target, const char *linkpath, int *ret);
+int kora_vfs_readlink(const char *path, char *buf, size_t size, int *ret);
+int kora_vfs_get_file_info(const char *path, kora_file_info_t *info, int *ret);
+int kora_vfs_get_fd_info(int fd, kora_file_info_t *info, int *ret);
+int kora_vfs_stat(const char *path, kora_stat_t *st, int *ret);
+int kora_vfs_fstat(int fd, kora_stat_t *st, int *ret);
+int kora_vfs_lstat(const char *path, kora_stat_t *st, int *ret);
+int kora_vfs_exists(const char *path, uint8_t *type, int *ret);
+int kora_vfs_unlink(const char *path, int *ret);
+int kora_vfs_rename(const char *oldpath, const char *newpath, int *ret);
+int kora_vfs_link(const char *existing, const char *newpath, int *ret);
+int kora_vfs_utime(const char *path, uint64_t mtime, int *ret);
@@ -0,0 +1,176 @@
+/**
+ * KoraLayer Backends
+ *
+ * A sys_* call that the layer does not serve itself (from a mounted
+ * filesystem, or by failing it on purpose) ends in the backend: by
+ * default the host implementation for the platform the library was
+ * built for. A program can push layers on top of it at run time, each a
+ * table with one entry per sys_* call:
+ *
+ * - An interposer fills in the calls it wants to see and forwards them
+ *   through the table kora_backend_push hands back, for example to log,
+ *   count or slow them down.
+ * - A replacement answers the calls it fills in itself, for example a
+ *   test double for sys_getpid or sys_spawn.
+ *
+ * Entries left NULL go to the layer below. Layers see calls after the
+ * trace and injection hooks and after mount routing, so a call to a
+ * host mount reaches them with the host path. With nothing pushed, a
+ * call pays one atomic load over calling the host directly;
+ * -DKORA_BACKEND_HOOKS=OFF compiles even that out.
+ */
+
+/*
+ * Guarded below the include rather than with #pragma once: with
+ * KORA_INLINE_DISPATCH, kora/syscalls.h pulls in the dispatch bodies,
+ * which need the table, and they re-enter this header from there.
+ */
+#include <kora/syscalls.h>
+
+#ifndef KORA_BACKEND_H
+#define KORA_BACKEND_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Every backend call as X(return type, name, parameter list), the name
+ * being that of the sys_* function without its prefix
+ */
+#define KORA_BACKEND_CALLS(X)                                                              \
+    X(int, putc, (char c))                                                                 \
+    X(int, getc, (void))                                                                   \
+    X(int, open, (const char *path, int flags))                                            \
+    X(int, close, (int fd))                                                                \
+    X(int, read, (int fd, void *buf, size_t count))                                        \
+    X(int, write, (int fd, const void *buf, size_t count))                                 \
+    X(long, seek, (int fd, long offset, int whence))                                       \
+    X(int, fadvise, (int fd, uint64_t offset, uint64_t len, int advice))                   \
+    X(int, readahead, (int fd, uint64_t offset, size_t count))                             \
+    X(int, ioctl, (int fd, unsigned long request, void *arg))                              \
+    X(int, mkdir, (const char *path))                                                      \
+    X(int, rmdir, (const char *path))                                                      \
+    X(int, opendir, (const char *path))                                                    \
+    X(int, readdir, (int dir, kora_dirent_t *entry))                                       \
+    X(int, closedir, (int dir))                                                            \
+    X(int, symlink, (const char *target, const char *linkpath))                            \
+    X(int, readlink, (const char *path, char *buf, size_t size))                           \
+    X(int, get_file_info, (const char *path, kora_file_info_t *info))                      \
+    X(int, get_fd_info, (int fd, kora_file_info_t *info))                                  \
+    X(int, stat, (const char *path, kora_stat_t *st))                                      \
+    X(int, fstat, (int fd, kora_stat_t *st))                                               \
+    X(int, lstat, (const char *path, kora_stat_t *st))                                     \
+    X(int, link, (const char *existing, const char *newpath))                              \
+    X(int, chdir, (const char *path))                                                      \
+    X(int, getcwd, (char *buf, size_t size))                                               \
+    X(int, utime, (const char *path, uint64_t mtime))                                      \
+    X(int, exists, (const char *path, uint8_t *type))                                      \
+    X(int, unlink, (const char *path))                                                     \
+    X(int, rename, (const char *oldpath, const char *newpath))                             \
+    X(void *, brk, (void *new_end))                                                        \
+    X(void *, sbrk, (ptrdiff_t delta))                                                     \
+    X(void *, mmap, (void *addr, size_t len, int prot, int flags, int fd, off_t off))      \
+    X(int, munmap, (void *addr, size_t len))                                               \
+    X(int, mprotect, (void *addr, size_t len, int prot))                                   \
+    X(int, shm_create, (const char *name, uint64_t size, int flags))                       \
+    X(int, shm_open, (const char *name, int flags))                                        \
+    X(int, shm_unlink, (const char *name))                                                 \
+    X(int, shm_seal, (int fd, unsigned seals))                                             \
+    X(pid_t, spawn, (const char *path, char *const argv[], char *const envp[]))            \
+    X(void, exit, (int status))                                                            \
+    X(pid_t, wait, (pid_t pid, int *status, int options))                                  \
+    X(pid_t, wait4, (pid_t pid, int *status, int options, kora_rusage_t *usage))           \
+    X(int, getrusage, (int who, kora_rusage_t *usage))                                     \
+    X(int, thread_create, (kora_thread_t *thread, const kora_thread_attr_t *attr,          \
+                           void *(*entry)(void *), void *arg))                             \
+    X(int, thread_join, (kora_thread_t thread, void **retval))                             \
+    X(void, thread_exit, (void *retval))                                                   \
+    X(kora_thread_t, thread_self, (void))                                                  \
+    X(int, yield, (void))                                                                  \
+    X(pid_t, getpid, (void))                                                               \
+    X(pid_t, getppid, (void))                                                              \
+    X(int, setpriority, (pid_t pid, int prio))                                             \
+    X(pid_t, gettid, (void))                                                               \
+    X(int, sched_setpolicy, (pid_t tid, int policy, int priority))                         \
+    X(int, sched_getpolicy, (pid_t tid, int *priority))                                    \
+    X(int, ioprio_set, (pid_t tid, int ioclass, int level))                                \
+    X(int, ioprio_get, (pid_t tid, int *level))                                            \
+    X(int, sched_setaffinity, (pid_t pid, const kora_cpuset_t *set))                       \
+    X(int, sched_getaffinity, (pid_t pid, kora_cpuset_t *set))                             \
+    X(int, getcpu, (unsigned *cpu, unsigned *node))                                        \
+    X(int, cpu_topology, (kora_cpu_topology_t *topo, kora_cpu_info_t *cpus, size_t max))   \
+    X(int, pipe, (int fds[2]))                                                             \
+    X(int, pipe2, (int fds[2], int flags))                                                 \
+    X(int, pipe_size, (int fd, int size))                                                  \
+    X(long, splice, (int fd_in, int64_t *off_in, int fd_out, int64_t *off_out, size_t len, \
+                     unsigned flags))                                                      \
+    X(long, tee, (int fd_in, int fd_out, size_t len, unsigned flags))                      \
+    X(int, dup, (int oldfd))                                                               \
+    X(int, dup2, (int oldfd, int newfd))                                                   \
+    X(int, select, (int nfds, fd_set *r, fd_set *w, fd_set *e, struct timeval *tmo))       \
+    X(int, sem_wait, (sem_t *sem))                                                         \
+    X(int, sem_post, (sem_t *sem))                                                         \
+    X(int, clock_gettime, (clockid_t id, struct timespec *tp))                             \
+    X(int, gettimeofday, (struct timeval *tv, void *tz))                                   \
+    X(int, nanosleep, (const struct timespec *req, struct timespec *rem))                  \
+    X(unsigned, sleep, (unsigned seconds))                                                 \
+    X(int, setitimer, (int which, const struct itimerval *new, struct itimerval *old))     \
+    X(sighandler_t, signal, (int signum, sighandler_t handler))                            \
+    X(int, sigaction, (int signum, const struct sigaction *act, struct sigaction *oldact)) \
+    X(int, sigprocmask, (int how, const sigset_t *set, sigset_t *oldset))                  \
+    X(int, signalfd, (const sigset_t *mask, int flags))                                    \
+    X(int, signalfd_read, (int fd, kora_siginfo_t *info, size_t max))                      \
+    X(int, kill, (pid_t pid, int signum))                                                  \
+    X(int, sigreturn, (void))                                                              \
+    X(int, sync, (void))                                                                   \
+    X(int, reboot, (int cmd))                                                              \
+    X(int, mount, (const char *src, const char *tgt, const char *type, unsigned flags,     \
+                   const void *data))                                                      \
+    X(int, umount, (const char *tgt))
+
+/**
+ * One entry per sys_* call, with the same signature
+ */
+typedef struct kora_backend_ops {
+#define KORA_BACKEND_ENTRY_(ret, name, params) ret (*name) params;
+    KORA_BACKEND_CALLS(KORA_BACKEND_ENTRY_)
+#undef KORA_BACKEND_ENTRY_
+} kora_backend_ops_t;
+
+/**
+ * Push a layer on top of the backend
+ *
+ * The table must stay valid until the layer is popped, and the layer's
+ * functions may be called from any thread as soon as this returns.
+ *
+ * @param ops Entries for the calls to take over; NULL entries go below
+ * @param next Set, before the layer takes effect, to the complete table
+ *        of the layers below, for forwarding calls
+ * @return KORA_SUCCESS, or KORA_ERROR with errno set to EINVAL (ops
+ *         already pushed), ENOMEM or ENOTSUP (hooks compiled out)
+ */
+int kora_backend_push(const kora_backend_ops_t *ops, const kora_backend_ops_t **next);
+
+/**
+ * Remove the top layer
+ *
+ * Calls already inside the layer's functions are not waited for, so
+ * they must not depend on state freed straight after.
+ *
+ * @param ops The table passed to kora_backend_push
+ * @return KORA_SUCCESS, or KORA_ERROR with errno set to EINVAL (not
+ *         pushed) or EBUSY (another layer was pushed above it)
+ */
+int kora_backend_pop(const kora_backend_ops_t *ops);
+
+/**
+ * The host implementation, at the bottom of every stack
+ */
+const kora_backend_ops_t *kora_backend_host(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KORA_BACKEND_H */
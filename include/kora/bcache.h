@@ -0,0 +1,77 @@
+/**
+ * KoraLayer Block Cache
+ *
+ * Image-backed filesystems (kora/fatfs.h) reach their image through one
+ * block cache shared by every mounted image, instead of issuing a host
+ * read or write per sector:
+ *
+ * - Blocks are replaced with ARC, which keeps blocks used more than once
+ *   apart from blocks seen once, so a long sequential pass does not push
+ *   out directories and the FAT.
+ * - Reads that continue a sequential stream fetch a growing window of
+ *   following blocks in the same host read.
+ * - Writes only mark blocks dirty. A background thread writes them back
+ *   every 100 ms, or sooner when a quarter of the cache is dirty, sorted
+ *   by position with adjacent blocks merged into one host write.
+ *
+ * Dirty blocks are also written on unmount, kora_bcache_sync(), exit()
+ * and sys_exit. A forked child leaves the blocks dirty at the fork to
+ * the parent and only writes back its own writes.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>  /* For size_t */
+#include <stdint.h>  /* For uint64_t */
+
+/** Size of a cache block in bytes */
+#define KORA_BCACHE_BLOCK_SIZE 4096
+
+/**
+ * Counters since the process started, and the current occupancy
+ */
+typedef struct {
+    uint64_t hits;              /* Block lookups served from the cache */
+    uint64_t misses;            /* Block lookups that had to read the image */
+    uint64_t reads;             /* Host reads issued for misses */
+    uint64_t readahead;         /* Blocks read ahead of use */
+    uint64_t readahead_hits;    /* Of those, blocks later used */
+    uint64_t evictions;         /* Blocks dropped to make room */
+    uint64_t dirty_evictions;   /* Of those, blocks written first */
+    uint64_t writeback_blocks;  /* Dirty blocks written to images */
+    uint64_t writes;            /* Host writes issued for them */
+    uint64_t cached;            /* Blocks held now */
+    uint64_t dirty;             /* Of those, blocks not yet written */
+    uint64_t capacity;          /* Limit in blocks */
+} kora_bcache_stats_t;
+
+/**
+ * Read the cache counters
+ *
+ * @param stats Filled with the counters
+ */
+void kora_bcache_stats(kora_bcache_stats_t *stats);
+
+/**
+ * Set how much memory the cache may hold (64 MiB by default)
+ *
+ * @param bytes Limit, rounded down to whole blocks and up to 64 blocks
+ * @return KORA_SUCCESS, or KORA_ERROR with errno set to ENOMEM
+ */
+int kora_bcache_set_capacity(size_t bytes);
+
+/**
+ * Write every dirty block back and flush the images to stable storage
+ *
+ * @return KORA_SUCCESS, or KORA_ERROR with errno set to the first error
+ *         met writing any image since the last sync
+ */
+int kora_bcache_sync(void);
+
+#ifdef __cplusplus
+}
+#endif
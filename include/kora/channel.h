@@ -0,0 +1,130 @@
+/**
+ * KoraLayer Shared-Memory Channels
+ *
+ * A kora_channel is a bounded message ring that lives entirely inside a
+ * caller-provided memory block, normally a sys_shm_create mapping shared
+ * with a child started by sys_spawn. Messages are copied once into the
+ * ring and once out of it, and the host is only entered to sleep when the
+ * ring is empty or full.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>  /* For size_t */
+#include <stdint.h>  /* For uint32_t */
+
+/**
+ * Channel modes
+ */
+#define KORA_CHANNEL_SPSC  0  /* One sending and one receiving task */
+#define KORA_CHANNEL_MPMC  1  /* Any number of senders and receivers */
+
+/**
+ * Channel handle
+ *
+ * Points at the start of the shared block, so every process attached to
+ * the block gets a valid handle at its own mapping address.
+ */
+typedef struct kora_channel kora_channel_t;
+
+/**
+ * Get the number of bytes a channel needs
+ *
+ * @param capacity Number of message slots, rounded up to a power of two
+ * @param msg_size Maximum message size in bytes
+ * @return Required size of the memory block, 0 if the parameters are invalid
+ */
+size_t kora_channel_footprint(uint32_t capacity, uint32_t msg_size);
+
+/**
+ * Create a channel inside a memory block
+ *
+ * @param mem Block of at least kora_channel_footprint() bytes, 64-byte aligned
+ * @param mem_size Size of the block
+ * @param capacity Number of message slots, rounded up to a power of two
+ * @param msg_size Maximum message size in bytes
+ * @param mode KORA_CHANNEL_SPSC or KORA_CHANNEL_MPMC
+ * @return Channel handle on success, NULL on failure
+ */
+kora_channel_t *kora_channel_init(void *mem, size_t mem_size, uint32_t capacity,
+                                  uint32_t msg_size, int mode);
+
+/**
+ * Attach to a channel created by another task
+ *
+ * @param mem Mapping of the block passed to kora_channel_init
+ * @return Channel handle on success, NULL if the block holds no channel
+ */
+kora_channel_t *kora_channel_attach(void *mem);
+
+/**
+ * Send one message
+ *
+ * @param ch Channel
+ * @param msg Message bytes
+ * @param len Message length, at most the channel's msg_size
+ * @param timeout_ms Milliseconds to wait while full: -1 forever, 0 not at all
+ * @return KORA_SUCCESS on success, KORA_ERROR with errno set to EAGAIN,
+ *         ETIMEDOUT, EPIPE (channel closed) or EMSGSIZE on failure
+ */
+int kora_channel_send(kora_channel_t *ch, const void *msg, size_t len, int timeout_ms);
+
+/**
+ * Receive one message
+ *
+ * @param ch Channel
+ * @param buf Buffer for the message
+ * @param len Size of buf; longer messages are truncated
+ * @param timeout_ms Milliseconds to wait while empty: -1 forever, 0 not at all
+ * @return Message length on success, KORA_EOF if the channel is closed and
+ *         drained, KORA_ERROR with errno set to EAGAIN or ETIMEDOUT on failure
+ */
+int kora_channel_recv(kora_channel_t *ch, void *buf, size_t len, int timeout_ms);
+
+/**
+ * Send several full-size messages with a single wake-up
+ *
+ * Waits until at least one message fits, then sends as many as fit
+ * without waiting again.
+ *
+ * @param ch Channel
+ * @param msgs Array of count messages, each msg_size bytes
+ * @param count Number of messages in msgs
+ * @param timeout_ms Milliseconds to wait while full: -1 forever, 0 not at all
+ * @return Number of messages sent, KORA_ERROR on failure
+ */
+int kora_channel_send_batch(kora_channel_t *ch, const void *msgs, size_t count,
+                            int timeout_ms);
+
+/**
+ * Receive several messages with a single wake-up
+ *
+ * Waits until at least one message is available, then takes as many as
+ * are queued, up to max.
+ *
+ * @param ch Channel
+ * @param msgs Array receiving up to max messages, each msg_size bytes
+ * @param lens Optional array receiving each message length
+ * @param max Capacity of msgs
+ * @param timeout_ms Milliseconds to wait while empty: -1 forever, 0 not at all
+ * @return Number of messages received, KORA_EOF if closed and drained,
+ *         KORA_ERROR on failure
+ */
+int kora_channel_recv_batch(kora_channel_t *ch, void *msgs, uint32_t *lens,
+                            size_t max, int timeout_ms);
+
+/**
+ * Close a channel
+ *
+ * Wakes all waiters. Further sends fail with EPIPE; receivers drain the
+ * queued messages and then get KORA_EOF.
+ */
+void kora_channel_close(kora_channel_t *ch);
+
+#ifdef __cplusplus
+}
+#endif
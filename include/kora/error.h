@@ -0,0 +1,88 @@
+/**
+ * KoraLayer Error Reporting
+ *
+ * Failing layer calls record the host errno and the SYS_* number of the
+ * call in thread-local storage instead of printing diagnostics. Callers
+ * that want a log of failures can install a diagnostic sink, such as the
+ * built-in lock-free ring buffer, and drain it at their own pace.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>  /* For size_t */
+#include <stdint.h>  /* For uint32_t, uint64_t */
+
+/**
+ * Last error recorded on the calling thread
+ */
+typedef struct {
+    int syscall;      /* SYS_* number of the failing call, 0 if none */
+    int host_errno;   /* errno value reported by the host */
+} kora_error_t;
+
+/**
+ * Diagnostic record delivered to the installed sink
+ */
+typedef struct {
+    uint64_t timestamp_ns;  /* Monotonic time of the failure */
+    uint32_t thread;        /* Layer-assigned thread number, starting at 1 */
+    int syscall;            /* SYS_* number of the failing call */
+    int host_errno;         /* errno value reported by the host */
+} kora_diag_record_t;
+
+/**
+ * Diagnostic sink callback
+ *
+ * Called synchronously on the failing thread, so it must be cheap and
+ * thread-safe.
+ */
+typedef void (*kora_diag_sink_t)(const kora_diag_record_t *rec, void *ctx);
+
+/** Number of records held by the built-in diagnostic ring */
+#define KORA_DIAG_RING_SIZE 1024
+
+/**
+ * Get the last error recorded on the calling thread
+ *
+ * @return The error; syscall is 0 if nothing failed since the last clear
+ */
+kora_error_t kora_last_error(void);
+
+/** Forget the last error recorded on the calling thread */
+void kora_clear_error(void);
+
+/**
+ * Install a diagnostic sink
+ *
+ * @param sink Callback receiving every recorded failure, or NULL to go silent
+ * @param ctx Opaque pointer passed back to the callback
+ */
+void kora_set_diag_sink(kora_diag_sink_t sink, void *ctx);
+
+/**
+ * Built-in sink storing records in a lock-free ring buffer
+ *
+ * Install it with kora_set_diag_sink(kora_diag_ring_sink, NULL). When the
+ * ring is full new records are dropped and counted.
+ */
+void kora_diag_ring_sink(const kora_diag_record_t *rec, void *ctx);
+
+/**
+ * Remove records from the built-in ring, oldest first
+ *
+ * @param out Array receiving the records
+ * @param max Capacity of out
+ * @return Number of records stored in out
+ */
+size_t kora_diag_drain(kora_diag_record_t *out, size_t max);
+
+/** Number of records dropped because the built-in ring was full */
+uint64_t kora_diag_dropped(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,55 @@
+/**
+ * KoraLayer FAT Image Filesystem
+ *
+ * Mounts a FAT12, FAT16 or FAT32 disk image on a path prefix, so that
+ * KoraOS file workloads run against the on-disk format they will meet
+ * on the target instead of the host filesystem. The same calls as the
+ * in-memory filesystem (kora/memfs.h) are served from the image, and
+ * kora_file_info_t.starting_cluster reports the first cluster of the
+ * file's data, 0 for an empty file.
+ *
+ *   sys_mount("disk.img", "/mnt/disk", "vfat", 0, NULL);
+ *
+ * sys_mount accepts the types "fat", "vfat", "msdos", "fat12", "fat16"
+ * and "fat32"; the variant is always detected from the image.
+ *
+ * The image is read and written through the shared block cache
+ * (kora/bcache.h), which writes changes back in the background and on
+ * unmount. The FAT is decoded once at mount time and kept in memory, files
+ * keep their cluster chain so seeking does not walk the FAT, and a
+ * directory is read whole on first use into a hashed table. Long file
+ * names are read and written; names are matched without regard to case,
+ * as on KoraOS. FAT has no links, so sys_link and sys_symlink fail with
+ * EPERM.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Mount a FAT disk image
+ *
+ * @param image Path of the image file on the host
+ * @param prefix Absolute path to serve the image's root directory on
+ * @param flags KORA_MOUNT_RDONLY to refuse every change
+ * @return KORA_SUCCESS on success, KORA_ERROR with errno set to EINVAL
+ *         (not a FAT image, or prefix not absolute), EBUSY (prefix
+ *         already mounted), ENOMEM, ENOTSUP (not available on this
+ *         platform) or the error from opening the image
+ */
+int kora_fatfs_mount(const char *image, const char *prefix, unsigned flags);
+
+/**
+ * Unmount a FAT image, flushing changes to the image file
+ *
+ * @return KORA_SUCCESS on success, KORA_ERROR with errno set to EINVAL
+ *         (no image mounted on prefix) or EBUSY (descriptors still open)
+ */
+int kora_fatfs_unmount(const char *prefix);
+
+#ifdef __cplusplus
+}
+#endif
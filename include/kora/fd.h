@@ -0,0 +1,65 @@
+/**
+ * KoraLayer Descriptor Table
+ *
+ * Every descriptor a sys_* call returns has an entry in one table:
+ * host descriptors under the host's own numbers, and descriptors of
+ * filesystems mounted in the layer (kora/memfs.h, kora/fatfs.h) from
+ * 1 << 24 up. An entry records which backend serves the descriptor and
+ * has KORA_FD_SLOTS extension slots, where features built on the layer
+ * keep per-descriptor state, such as a buffer or the path a file was
+ * opened with. Finding an entry takes two loads and no lock or hash
+ * lookup, so a slot can be read on every sys_read or sys_write.
+ *
+ * Slot values are released with the callback their slot was registered
+ * with when the descriptor is closed through sys_close, sys_closedir or
+ * as the target of sys_dup2. Descriptors from sys_dup start empty. As
+ * with the descriptors themselves, closing one while another thread is
+ * still using its slots is a caller bug.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Extension slots per descriptor */
+#define KORA_FD_SLOTS 8
+
+/** Called with a slot's value when its descriptor is closed */
+typedef void (*kora_fd_release_t)(int fd, void *value);
+
+/**
+ * Claim an extension slot
+ *
+ * @param release Called for each non-NULL value left at close; may be NULL
+ * @return The slot number, or KORA_ERROR with errno ENOSPC when all are taken
+ */
+int kora_fd_slot_register(kora_fd_release_t release);
+
+/**
+ * Store a value in a descriptor's slot, releasing the value it replaces
+ *
+ * @return KORA_SUCCESS, or KORA_ERROR with errno EINVAL (slot not
+ *         registered), EBADF (negative, or a layer descriptor that is
+ *         not open) or ENOMEM
+ */
+int kora_fd_set(int fd, int slot, void *value);
+
+/**
+ * @return The value in a descriptor's slot, or NULL if none was set
+ */
+void *kora_fd_get(int fd, int slot);
+
+/**
+ * Name of the backend serving a descriptor
+ *
+ * @return "host" for host descriptors, the filesystem type ("memfs",
+ *         "fatfs") for a layer descriptor, or NULL if fd is negative or
+ *         a layer descriptor that is not open
+ */
+const char *kora_fd_backend(int fd);
+
+#ifdef __cplusplus
+}
+#endif
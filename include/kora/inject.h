@@ -0,0 +1,90 @@
+/**
+ * KoraLayer Latency and Fault Injection
+ *
+ * Makes chosen sys_* calls slow or fail on purpose, so that retry,
+ * timeout and batching logic can be measured against slow or flaky
+ * storage without touching the code under test. Rules are given as a
+ * spec string, either to kora_inject_configure() or in the KORA_INJECT
+ * environment variable of a program linked against the layer:
+ *
+ *   KORA_INJECT="read:delay=exp(200us),short=5%;write:enospc=0.001;seed=42"
+ *
+ * A malformed KORA_INJECT is ignored without a message, leaving
+ * kora_inject_enabled() at 0.
+ *
+ * A spec is a list of rules separated by ';'. Each rule is a call name
+ * (as returned by kora_syscall_name) or '*' for every call that can be
+ * injected, then ':' and comma-separated options:
+ *
+ *   delay=DIST[@RATE]  Sleep before the call. DIST is fixed(T),
+ *                      uniform(T,T), exp(MEAN) or pareto(MIN,ALPHA), or
+ *                      a bare T for fixed. Up to KORA_INJECT_MAX_DELAYS
+ *                      delays per rule are drawn independently and
+ *                      added, e.g. a small base plus a rare long stall.
+ *   short=RATE         Transfer between 1 and count-1 bytes (read,
+ *                      write, splice and tee).
+ *   eintr=RATE         Fail with EINTR without making the call.
+ *   eagain=RATE        Fail with EAGAIN.
+ *   enospc=RATE        Fail with ENOSPC.
+ *
+ * Times take an ns, us, ms or s suffix (ns if none); rates are a
+ * fraction such as 0.01 or a percentage such as 1%. A later rule for
+ * the same call replaces an earlier one. "seed=N" makes the random
+ * draws repeatable for a given order of thread creation.
+ *
+ * Injected failures use the call's own error convention (-1 with errno,
+ * or a negative errno for the file metadata calls) and are recorded for
+ * kora_last_error like real ones. Building with
+ * -DKORA_INJECT_HOOKS=OFF removes the hooks.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>  /* For uint64_t */
+
+#define KORA_INJECT_MAX_DELAYS 4
+
+/**
+ * Counters for one call since injection was last configured
+ */
+typedef struct {
+    uint64_t calls;      /* Calls that matched a rule */
+    uint64_t delayed;    /* Calls that were slept on */
+    uint64_t delay_ns;   /* Total time slept */
+    uint64_t shortened;  /* Transfers cut short */
+    uint64_t failed;     /* Calls failed without being made */
+} kora_inject_stats_t;
+
+/**
+ * Replace the injection rules
+ *
+ * @param spec Rules as described above; NULL or "" turns injection off
+ * @return KORA_SUCCESS on success, KORA_ERROR with errno set to EINVAL
+ *         (malformed spec, unknown call, or an option the call does not
+ *         support; the previous rules stay in force) or ENOTSUP (hooks
+ *         compiled out)
+ */
+int kora_inject_configure(const char *spec);
+
+/**
+ * Check whether any rule is in force
+ *
+ * @return Non-zero while injecting
+ */
+int kora_inject_enabled(void);
+
+/**
+ * Read the counters of one call
+ *
+ * @param syscall SYS_* number
+ * @param stats Filled with the counters, all zero for calls without a rule
+ */
+void kora_inject_stats(int syscall, kora_inject_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,113 @@
+/**
+ * KoraLayer Raw Linux Backend
+ *
+ * The Linux backend goes through glibc, which brings stdio locking,
+ * errno in thread-local storage and the dynamic loader with it. The
+ * calls here enter the kernel directly instead, with inline assembly on
+ * x86-64 and aarch64, and return what the kernel returned: the result,
+ * or a negative errno value. They never touch errno or any other libc
+ * state, so a program built with -nostdlib -static can link the
+ * koralayer_raw library and call them from its own _start.
+ *
+ * kora_backend_linux_raw() offers the same calls as a backend layer
+ * (kora/backend.h) with the usual sys_* return conventions, so a program
+ * linked against glibc can route its hot calls around it. Calls without
+ * a raw version fall through to the glibc backend.
+ *
+ * clock_gettime here is a real system call; glibc's goes through the
+ * vDSO without entering the kernel and is several times faster.
+ *
+ * KORA_HAVE_LINUX_RAW is defined where these are available.
+ */
+
+#pragma once
+
+#if defined(__linux__) && (defined(__x86_64__) || defined(__aarch64__))
+#define KORA_HAVE_LINUX_RAW 1
+#endif
+
+#include <kora/backend.h>
+#include <kora/syscalls.h>
+
+#if defined(KORA_HAVE_LINUX_RAW)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** True when a pointer returned by kora_raw_mmap holds -errno */
+#define KORA_RAW_MMAP_FAILED(p) ((uintptr_t)(p) > (uintptr_t)-4096)
+
+/**
+ * File I/O
+ *
+ * Flags and seek origins are the KORA_O_* and KORA_SEEK_* values;
+ * created files get mode 0644 and directories 0755, as with sys_open and
+ * sys_mkdir. read, write and seek return the count or offset.
+ */
+int kora_raw_open(const char *path, int flags);
+int kora_raw_close(int fd);
+long kora_raw_read(int fd, void *buf, size_t count);
+long kora_raw_write(int fd, const void *buf, size_t count);
+long kora_raw_seek(int fd, long offset, int whence);
+int kora_raw_dup(int fd);
+int kora_raw_dup2(int oldfd, int newfd);
+int kora_raw_pipe2(int fds[2], int flags);   /* KORA_PIPE_* flags */
+
+/**
+ * Paths
+ *
+ * Same results as the sys_* calls of the same name: mkdir succeeds on an
+ * existing directory, readlink NUL-terminates, exists returns 1 or 0.
+ */
+int kora_raw_mkdir(const char *path);
+int kora_raw_rmdir(const char *path);
+int kora_raw_unlink(const char *path);
+int kora_raw_rename(const char *oldpath, const char *newpath);
+int kora_raw_link(const char *existing, const char *newpath);
+int kora_raw_symlink(const char *target, const char *linkpath);
+int kora_raw_readlink(const char *path, char *buf, size_t size);
+int kora_raw_stat(const char *path, kora_stat_t *st);
+int kora_raw_lstat(const char *path, kora_stat_t *st);
+int kora_raw_fstat(int fd, kora_stat_t *st);
+int kora_raw_exists(const char *path, uint8_t *type);
+int kora_raw_chdir(const char *path);
+int kora_raw_getcwd(char *buf, size_t size);
+int kora_raw_sync(void);
+
+/**
+ * Memory
+ *
+ * prot and flags are the host PROT_* and MAP_* values, as for sys_mmap.
+ * On failure kora_raw_mmap returns -errno cast to a pointer; test it with
+ * KORA_RAW_MMAP_FAILED.
+ */
+void *kora_raw_mmap(void *addr, size_t len, int prot, int flags, int fd, off_t off);
+int kora_raw_munmap(void *addr, size_t len);
+int kora_raw_mprotect(void *addr, size_t len, int prot);
+
+/**
+ * Processes and time
+ */
+pid_t kora_raw_getpid(void);
+pid_t kora_raw_getppid(void);
+pid_t kora_raw_gettid(void);
+int kora_raw_yield(void);
+int kora_raw_kill(pid_t pid, int signum);
+int kora_raw_clock_gettime(clockid_t id, struct timespec *tp);
+int kora_raw_nanosleep(const struct timespec *req, struct timespec *rem);
+_Noreturn void kora_raw_exit(int status);   /* Every thread */
+
+/**
+ * The raw calls as a backend layer, for kora_backend_push
+ *
+ * Unlike the functions above these follow the sys_* conventions,
+ * setting errno and kora_last_error() on failure. Only in koralayer.
+ */
+const kora_backend_ops_t *kora_backend_linux_raw(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KORA_HAVE_LINUX_RAW */
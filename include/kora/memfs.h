@@ -0,0 +1,54 @@
+/**
+ * KoraLayer In-Memory Filesystem
+ *
+ * Serves a path prefix from memory instead of the host filesystem, for
+ * tests and batch jobs whose files are scratch data. Every file and
+ * directory call (sys_open, sys_read, sys_write, sys_seek, sys_mkdir,
+ * sys_rmdir, sys_opendir, sys_readdir, sys_link, sys_symlink,
+ * sys_readlink, sys_rename, sys_unlink and the stat family) on an
+ * absolute path under the prefix, or on a descriptor it returned, is
+ * handled in the layer and never reaches the host. Relative paths and
+ * other calls are unaffected; descriptors from the memory filesystem
+ * cannot be passed to sys_dup, sys_mmap, sys_select or sys_splice.
+ *
+ * Set KORA_MEMFS in the environment of a program linked against the
+ * layer to mount at startup: a colon-separated list of prefixes, each
+ * getting its own empty filesystem, or "1" to serve every absolute path
+ * of the process from memory. A prefix that cannot be mounted is
+ * skipped silently; the failure is recorded as a SYS_MOUNT error for
+ * kora_last_error() and the diagnostic sink.
+ *
+ * Directories are hash tables, so lookups do not slow down as they
+ * grow, and file data is kept in extents of up to 1 MiB that grow in
+ * place on sequential writes. Symbolic links with absolute targets
+ * resolve within the mount. The contents are lost on unmount and at
+ * exit.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Mount an empty in-memory filesystem
+ *
+ * @param prefix Absolute path; "/" serves every absolute path
+ * @return KORA_SUCCESS on success, KORA_ERROR with errno set to EINVAL
+ *         (prefix not absolute), EBUSY (prefix already mounted), ENOMEM
+ *         or ENOTSUP (not available on this platform)
+ */
+int kora_memfs_mount(const char *prefix);
+
+/**
+ * Unmount an in-memory filesystem and free its contents
+ *
+ * @return KORA_SUCCESS on success, KORA_ERROR with errno set to EINVAL
+ *         (nothing mounted on prefix) or EBUSY (descriptors still open)
+ */
+int kora_memfs_unmount(const char *prefix);
+
+#ifdef __cplusplus
+}
+#endif
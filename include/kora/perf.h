@@ -0,0 +1,111 @@
+/**
+ * KoraLayer Hardware Performance Counters
+ *
+ * A kora_perf_counter_t is a group of counters that are started, stopped
+ * and read together, so ratios such as instructions per cycle come from
+ * the same interval. When the host has fewer counters than requested it
+ * time-slices them; kora_perf_counter_read reports both the raw counts
+ * and counts scaled up to the full enabled time.
+ *
+ * Counters are available on Linux through perf_event_open. Elsewhere
+ * kora_perf_counter_open fails with ENOTSUP.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>  /* For size_t */
+#include <stdint.h>  /* For uint64_t */
+
+/**
+ * Events
+ */
+#define KORA_PERF_CYCLES            0  /* CPU cycles */
+#define KORA_PERF_INSTRUCTIONS      1  /* Retired instructions */
+#define KORA_PERF_CACHE_REFERENCES  2  /* Last-level cache accesses */
+#define KORA_PERF_CACHE_MISSES      3  /* Last-level cache misses */
+#define KORA_PERF_BRANCHES          4  /* Retired branch instructions */
+#define KORA_PERF_BRANCH_MISSES     5  /* Mispredicted branches */
+#define KORA_PERF_TASK_CLOCK        6  /* CPU time in nanoseconds (software) */
+#define KORA_PERF_PAGE_FAULTS       7  /* Page faults (software) */
+#define KORA_PERF_CONTEXT_SWITCHES  8  /* Context switches (software) */
+
+#define KORA_PERF_MAX_EVENTS  8  /* Events per group */
+
+/**
+ * Flags for kora_perf_counter_open
+ */
+#define KORA_PERF_INCLUDE_KERNEL  0x0001  /* Also count in the kernel (often needs privilege) */
+
+/**
+ * Counter group handle
+ */
+typedef struct kora_perf_counter kora_perf_counter_t;
+
+/**
+ * Values read from a counter group
+ */
+typedef struct {
+    uint32_t count;                         /* Number of events in the group */
+    uint32_t multiplexed;                   /* Non-zero if the group was not always scheduled */
+    uint64_t time_enabled_ns;               /* Time the group was enabled */
+    uint64_t time_running_ns;               /* Time the group was actually counting */
+    uint64_t raw[KORA_PERF_MAX_EVENTS];     /* Counts while running, in open order */
+    uint64_t scaled[KORA_PERF_MAX_EVENTS];  /* Counts extrapolated to the enabled time */
+} kora_perf_values_t;
+
+/**
+ * Open a counter group for the calling thread
+ *
+ * The group starts disabled and with all counts at zero.
+ *
+ * @param events Array of KORA_PERF_* event identifiers
+ * @param count Number of events, 1 to KORA_PERF_MAX_EVENTS
+ * @param flags KORA_PERF_* flags
+ * @return Group handle on success, NULL with errno set to ENOTSUP (no
+ *         counter support), ENOENT (event not available on this CPU),
+ *         EACCES (not permitted) or EINVAL on failure
+ */
+kora_perf_counter_t *kora_perf_counter_open(const int *events, size_t count, int flags);
+
+/**
+ * Start counting
+ *
+ * @return KORA_SUCCESS on success, KORA_ERROR on failure
+ */
+int kora_perf_counter_enable(kora_perf_counter_t *group);
+
+/**
+ * Stop counting; counts are kept
+ *
+ * @return KORA_SUCCESS on success, KORA_ERROR on failure
+ */
+int kora_perf_counter_disable(kora_perf_counter_t *group);
+
+/**
+ * Set all counts back to zero
+ *
+ * @return KORA_SUCCESS on success, KORA_ERROR on failure
+ */
+int kora_perf_counter_reset(kora_perf_counter_t *group);
+
+/**
+ * Read every counter in the group at once
+ *
+ * @param group Counter group
+ * @param values Receives raw and scaled counts
+ * @return KORA_SUCCESS on success, KORA_ERROR on failure
+ */
+int kora_perf_counter_read(kora_perf_counter_t *group, kora_perf_values_t *values);
+
+/**
+ * Close a counter group and free it
+ */
+void kora_perf_counter_close(kora_perf_counter_t *group);
+
+#ifdef __cplusplus
+}
+#endif
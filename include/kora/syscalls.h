@@ -12,6 +12,7 @@ extern "C" {
 
 #include <stddef.h>  /* For size_t */
 #include <stdint.h>  /* For uint32_t, uint64_t */
+#include <string.h>  /* For memset in KORA_CPU_ZERO */
 #include <sys/types.h> /* For pid_t */
 #include <semaphore.h> /* For sem_t */
 #include <time.h>      /* For timespec */
@@ -77,6 +78,36 @@ extern "C" {
 #define SYS_SYNC       54  /* Flush filesystem buffers */
 #define SYS_REBOOT     55  /* Reboot or power off */
 #define SYS_MOUNT      56  /* Mount a filesystem */
+#define SYS_FADVISE    57  /* Declare an access pattern for file data */
+#define SYS_READAHEAD  58  /* Populate the page cache ahead of reads */
+#define SYS_PIPE2      59  /* Create a pipe with flags */
+#define SYS_PIPE_SIZE  60  /* Query or set pipe capacity */
+#define SYS_SPLICE     61  /* Move data between a pipe and a descriptor */
+#define SYS_TEE        62  /* Duplicate pipe contents into another pipe */
+#define SYS_SHM_CREATE 63  /* Create a shared memory object */
+#define SYS_SHM_OPEN   64  /* Open a named shared memory object */
+#define SYS_SHM_UNLINK 65  /* Remove a named shared memory object */
+#define SYS_SHM_SEAL   66  /* Restrict future changes to a shared memory object */
+#define SYS_SIGACTION  67  /* Examine or change a signal action */
+#define SYS_SIGPROCMASK 68 /* Examine or change blocked signals */
+#define SYS_SIGNALFD   69  /* Create a descriptor for synchronous signals */
+#define SYS_SIGNALFD_READ 70 /* Read queued signals from a signal descriptor */
+#define SYS_SCHED_SETAFFINITY 71 /* Restrict a task to a set of CPUs */
+#define SYS_SCHED_GETAFFINITY 72 /* Get the CPUs a task may run on */
+#define SYS_GETCPU     73  /* Get the CPU and NUMA node of the caller */
+#define SYS_CPU_TOPOLOGY 74 /* Describe cores, caches and NUMA nodes */
+#define SYS_GETTID     75  /* Get the calling thread ID */
+#define SYS_SCHED_SETPOLICY 76 /* Set the scheduling policy of a thread */
+#define SYS_SCHED_GETPOLICY 77 /* Get the scheduling policy of a thread */
+#define SYS_IOPRIO_SET 78  /* Set the I/O scheduling class of a thread */
+#define SYS_IOPRIO_GET 79  /* Get the I/O scheduling class of a thread */
+#define SYS_THREAD_CREATE 80 /* Start a thread in the calling process */
+#define SYS_THREAD_JOIN   81 /* Wait for a thread to finish */
+#define SYS_THREAD_EXIT   82 /* Terminate the calling thread */
+#define SYS_THREAD_SELF   83 /* Get the handle of the calling thread */
+#define SYS_GETRUSAGE  84  /* Get resource usage */
+#define SYS_WAIT4      85  /* Wait for a child and collect its resource usage */
+#define SYS_UMOUNT     86  /* Unmount a filesystem */
 
 /**
  * File open flags
@@ -95,6 +126,80 @@ extern "C" {
 #define KORA_SEEK_CUR  1     /* Set position to current location plus offset */
 #define KORA_SEEK_END  2     /* Set position to EOF plus offset */
 
+/**
+ * Flags for sys_mount
+ */
+#define KORA_MOUNT_RDONLY  0x1  /* Refuse changes to the mounted filesystem */
+
+/**
+ * Access pattern advice for sys_fadvise
+ */
+#define KORA_FADV_NORMAL      0  /* No special treatment */
+#define KORA_FADV_SEQUENTIAL  1  /* Data will be read sequentially */
+#define KORA_FADV_RANDOM      2  /* Data will be accessed randomly */
+#define KORA_FADV_WILLNEED    3  /* Data will be needed soon */
+#define KORA_FADV_DONTNEED    4  /* Data will not be needed again soon */
+#define KORA_FADV_NOREUSE     5  /* Data will be accessed only once */
+
+/**
+ * Pipe creation flags for sys_pipe2
+ */
+#define KORA_PIPE_NONBLOCK  0x0001  /* Non-blocking reads and writes on both ends */
+#define KORA_PIPE_CLOEXEC   0x0002  /* Do not inherit the ends across sys_spawn */
+
+/**
+ * Flags for sys_splice and sys_tee
+ */
+#define KORA_SPLICE_MOVE     0x0001  /* Move pages instead of copying if possible */
+#define KORA_SPLICE_NONBLOCK 0x0002  /* Do not block on pipe I/O */
+#define KORA_SPLICE_MORE     0x0004  /* More data will follow */
+
+/**
+ * Flags for sys_shm_create and sys_shm_open
+ */
+#define KORA_SHM_RDONLY     0x0001  /* Open for reading only (sys_shm_open) */
+#define KORA_SHM_EXCL       0x0002  /* Fail if the named object already exists */
+#define KORA_SHM_CLOEXEC    0x0004  /* Do not inherit the descriptor across sys_spawn */
+#define KORA_SHM_SEALABLE   0x0008  /* Allow sys_shm_seal on an anonymous object */
+
+/**
+ * Seals for sys_shm_seal
+ */
+#define KORA_SHM_SEAL_SEAL    0x0001  /* No further seals may be added */
+#define KORA_SHM_SEAL_SHRINK  0x0002  /* Size may not decrease */
+#define KORA_SHM_SEAL_GROW    0x0004  /* Size may not increase */
+#define KORA_SHM_SEAL_WRITE   0x0008  /* Contents may not be modified */
+
+/**
+ * Flags for sys_signalfd
+ */
+#define KORA_SIGNALFD_NONBLOCK  0x0001  /* sys_signalfd_read does not block */
+#define KORA_SIGNALFD_CLOEXEC   0x0002  /* Do not inherit the descriptor across sys_spawn */
+
+/**
+ * Scheduling policies for sys_sched_setpolicy
+ */
+#define KORA_SCHED_OTHER  0  /* Default time-sharing */
+#define KORA_SCHED_FIFO   1  /* Real-time, run until blocked or preempted */
+#define KORA_SCHED_RR     2  /* Real-time with a time slice */
+#define KORA_SCHED_BATCH  3  /* CPU-bound, non-interactive work */
+#define KORA_SCHED_IDLE   4  /* Run only when nothing else wants the CPU */
+
+/**
+ * I/O scheduling classes for sys_ioprio_set
+ */
+#define KORA_IOPRIO_CLASS_NONE  0  /* Derived from the CPU nice value */
+#define KORA_IOPRIO_CLASS_RT    1  /* Served before all other classes */
+#define KORA_IOPRIO_CLASS_BE    2  /* Best effort, levels 0 (high) to 7 (low) */
+#define KORA_IOPRIO_CLASS_IDLE  3  /* Served only when the disk is otherwise idle */
+
+/**
+ * Targets for sys_getrusage
+ */
+#define KORA_RUSAGE_SELF      0  /* All threads of the calling process */
+#define KORA_RUSAGE_CHILDREN  1  /* Terminated and waited-for descendants */
+#define KORA_RUSAGE_THREAD    2  /* The calling thread only */
+
 /**
  * Status/error codes
  */
@@ -148,6 +253,101 @@ typedef struct {
     uint64_t access_time;        /* Last access time (UNIX timestamp) */
 } kora_file_info_t;
 
+/**
+ * Signal record returned by sys_signalfd_read
+ */
+typedef struct {
+    int32_t signo;    /* Signal number */
+    int32_t code;     /* Signal code (si_code) */
+    int32_t pid;      /* Sending process, if known */
+    uint32_t uid;     /* Real user ID of the sender, if known */
+    int32_t status;   /* Exit status or signal for SIGCHLD */
+    int32_t reserved;
+    uint64_t value;   /* Value passed with sigqueue */
+} kora_siginfo_t;
+
+/**
+ * CPU set for sys_sched_setaffinity and sys_sched_getaffinity
+ */
+#define KORA_CPUSET_SIZE  1024  /* Highest CPU number representable, exclusive */
+
+typedef struct {
+    uint64_t bits[KORA_CPUSET_SIZE / 64];
+} kora_cpuset_t;
+
+#define KORA_CPU_ZERO(set)       memset((set), 0, sizeof(kora_cpuset_t))
+#define KORA_CPU_SET(cpu, set)   ((set)->bits[(cpu) / 64] |= (UINT64_C(1) << ((cpu) % 64)))
+#define KORA_CPU_CLR(cpu, set)   ((set)->bits[(cpu) / 64] &= ~(UINT64_C(1) << ((cpu) % 64)))
+#define KORA_CPU_ISSET(cpu, set) (((set)->bits[(cpu) / 64] >> ((cpu) % 64)) & 1)
+
+/**
+ * System-wide CPU layout returned by sys_cpu_topology
+ *
+ * Cache sizes are in bytes and are 0 when the level is absent or unknown.
+ */
+typedef struct {
+    uint32_t logical_cpus;      /* Online logical CPUs */
+    uint32_t physical_cores;    /* Distinct cores across all packages */
+    uint32_t packages;          /* Physical sockets */
+    uint32_t numa_nodes;        /* Memory nodes (1 on UMA machines) */
+    uint32_t threads_per_core;  /* SMT width of the widest core */
+    uint32_t cache_line;        /* Coherency line size */
+    uint32_t l1d_size;          /* Per-core L1 data cache */
+    uint32_t l1i_size;          /* Per-core L1 instruction cache */
+    uint32_t l2_size;           /* L2 cache */
+    uint32_t l3_size;           /* Last-level cache */
+} kora_cpu_topology_t;
+
+/**
+ * Placement of one logical CPU returned by sys_cpu_topology
+ */
+typedef struct {
+    uint32_t cpu;        /* Logical CPU number as used in kora_cpuset_t */
+    uint32_t core;       /* System-wide core index, shared by SMT siblings */
+    uint32_t package;    /* Physical package */
+    uint32_t node;       /* NUMA node */
+    uint32_t smt_index;  /* Position among the core's siblings, 0 for the first */
+} kora_cpu_info_t;
+
+/**
+ * Resource usage returned by sys_getrusage and sys_wait4
+ *
+ * Counters the host does not track are reported as 0.
+ */
+typedef struct {
+    uint64_t utime_ns;   /* User CPU time */
+    uint64_t stime_ns;   /* System CPU time */
+    uint64_t maxrss_kb;  /* Peak resident set size in KiB */
+    uint64_t minflt;     /* Page faults served without I/O */
+    uint64_t majflt;     /* Page faults that required I/O */
+    uint64_t inblock;    /* Filesystem input operations */
+    uint64_t oublock;    /* Filesystem output operations */
+    uint64_t nvcsw;      /* Voluntary context switches */
+    uint64_t nivcsw;     /* Involuntary context switches */
+} kora_rusage_t;
+
+/**
+ * Thread handle returned by sys_thread_create and sys_thread_self
+ */
+typedef struct kora_thread *kora_thread_t;
+
+/**
+ * Thread creation attributes
+ *
+ * A zeroed structure (or NULL) gives a host-allocated stack and the host
+ * C library's TLS. When tls is set, the thread starts with its thread
+ * pointer at tls and stack is required; such a thread runs outside the
+ * host C library and must not call into it. Of the layer it may only
+ * call sys_thread_self and sys_thread_exit, which on such a thread go
+ * straight to the host: they are not traced and pushed backend layers
+ * do not see them.
+ */
+typedef struct {
+    void *stack;        /* Lowest address of a caller-owned stack, or NULL */
+    size_t stack_size;  /* Size of stack, or requested size when stack is NULL */
+    void *tls;          /* Thread pointer for a caller-managed TLS block, or NULL */
+} kora_thread_attr_t;
+
 /**
  * Simplified file status structure used by sys_stat family
  */
@@ -233,6 +433,32 @@ int sys_write(int fd, const void *buf, size_t count);
  */
 long sys_seek(int fd, long offset, int whence);
 
+/**
+ * Declare the expected access pattern for a range of file data
+ *
+ * Lets the host tune read-ahead and page cache retention, e.g. so a
+ * one-pass scanner does not evict data other tasks are still using.
+ *
+ * @param fd File descriptor
+ * @param offset Start of the range in bytes
+ * @param len Length of the range in bytes, 0 meaning up to end of file
+ * @param advice One of the KORA_FADV_* values
+ * @return 0 on success, negative error code on failure
+ */
+int sys_fadvise(int fd, uint64_t offset, uint64_t len, int advice);
+
+/**
+ * Start reading a range of file data into the page cache
+ *
+ * The call does not wait for the I/O to complete.
+ *
+ * @param fd File descriptor
+ * @param offset Start of the range in bytes
+ * @param count Number of bytes to read ahead
+ * @return 0 on success, negative error code on failure
+ */
+int sys_readahead(int fd, uint64_t offset, size_t count);
+
 /**
  * Device-specific control operations
  * 
@@ -415,6 +641,50 @@ int sys_munmap(void *addr, size_t len);
  */
 int sys_mprotect(void *addr, size_t len, int prot);
 
+/**
+ * Create a shared memory object of the given size
+ *
+ * The returned descriptor is mapped with sys_mmap(..., MAP_SHARED, fd, 0)
+ * and, unless KORA_SHM_CLOEXEC is given, is inherited by children created
+ * with sys_spawn so they can map the same memory.
+ *
+ * @param name Name starting with '/', or NULL for an anonymous object
+ * @param size Size of the object in bytes
+ * @param flags Combination of KORA_SHM_* flags
+ * @return File descriptor on success, -1 on failure
+ */
+int sys_shm_create(const char *name, uint64_t size, int flags);
+
+/**
+ * Open an existing named shared memory object
+ *
+ * @param name Name passed to sys_shm_create
+ * @param flags Combination of KORA_SHM_RDONLY and KORA_SHM_CLOEXEC
+ * @return File descriptor on success, -1 on failure
+ */
+int sys_shm_open(const char *name, int flags);
+
+/**
+ * Remove a named shared memory object
+ *
+ * Existing descriptors and mappings stay valid until closed.
+ *
+ * @param name Name passed to sys_shm_create
+ * @return 0 on success, -1 on failure
+ */
+int sys_shm_unlink(const char *name);
+
+/**
+ * Seal a shared memory object against further changes
+ *
+ * Only anonymous objects created with KORA_SHM_SEALABLE can be sealed.
+ *
+ * @param fd Descriptor returned by sys_shm_create
+ * @param seals Combination of KORA_SHM_SEAL_* values
+ * @return 0 on success, -1 on failure
+ */
+int sys_shm_seal(int fd, unsigned seals);
+
 /**
  * Spawn a new process executing the program at `path`.
  * The child inherits file descriptors and environment.
@@ -442,6 +712,65 @@ void sys_exit(int status) __attribute__((noreturn));
  */
 pid_t sys_wait(pid_t pid, int *status, int options);
 
+/**
+ * Wait for a child process and collect its resource usage.
+ *
+ * @param pid PID to wait for or -1 for any child
+ * @param status Pointer to store exit status
+ * @param options Options passed to waitpid
+ * @param usage Receives the child's resource usage (may be NULL)
+ * @return PID of the exited child, 0 with WNOHANG if none is ready, or -1 on error
+ */
+pid_t sys_wait4(pid_t pid, int *status, int options, kora_rusage_t *usage);
+
+/**
+ * Get resource usage
+ *
+ * @param who One of KORA_RUSAGE_*
+ * @param usage Receives the usage counters
+ * @return 0 on success, -1 on failure with errno set
+ */
+int sys_getrusage(int who, kora_rusage_t *usage);
+
+/**
+ * Start a thread in the calling process
+ *
+ * The layer's per-thread state (see kora_last_error) is initialised before
+ * entry runs. Caller-supplied stacks remain owned by the caller and must
+ * stay valid until sys_thread_join returns.
+ *
+ * @param thread Receives the new thread's handle
+ * @param attr Stack and TLS settings, or NULL for defaults
+ * @param entry Function run by the thread; its result is passed to join
+ * @param arg Argument for entry
+ * @return 0 on success, -1 on failure with errno set
+ */
+int sys_thread_create(kora_thread_t *thread, const kora_thread_attr_t *attr,
+                      void *(*entry)(void *), void *arg);
+
+/**
+ * Wait for a thread to finish and release its handle
+ *
+ * @param thread Handle from sys_thread_create
+ * @param retval Receives the value returned by entry or passed to sys_thread_exit (may be NULL)
+ * @return 0 on success, -1 on failure with errno set
+ */
+int sys_thread_join(kora_thread_t thread, void **retval);
+
+/**
+ * Terminate the calling thread
+ * This function does not return.
+ */
+void sys_thread_exit(void *retval) __attribute__((noreturn));
+
+/**
+ * Get the handle of the calling thread
+ *
+ * Threads not started through sys_thread_create receive a handle on first
+ * use that cannot be joined and stays valid until the thread exits.
+ */
+kora_thread_t sys_thread_self(void);
+
 /**
  * Yield the processor to another runnable task.
  *
@@ -458,9 +787,140 @@ pid_t sys_getppid(void);
 /** Set scheduling priority for a process */
 int sys_setpriority(pid_t pid, int prio);
 
+/** Get the calling thread ID */
+pid_t sys_gettid(void);
+
+/**
+ * Set the scheduling policy of a thread
+ *
+ * The real-time policies usually require elevated privileges. BATCH and
+ * IDLE take no priority and priority must be 0.
+ *
+ * @param tid Thread ID from sys_gettid, 0 for the calling thread
+ * @param policy One of KORA_SCHED_*
+ * @param priority Static priority for FIFO and RR (1-99 on Linux)
+ * @return 0 on success, -1 on failure with errno set
+ */
+int sys_sched_setpolicy(pid_t tid, int policy, int priority);
+
+/**
+ * Get the scheduling policy of a thread
+ *
+ * @param tid Thread ID from sys_gettid, 0 for the calling thread
+ * @param priority Receives the static priority (may be NULL)
+ * @return One of KORA_SCHED_*, or -1 on failure with errno set
+ */
+int sys_sched_getpolicy(pid_t tid, int *priority);
+
+/**
+ * Set the I/O scheduling class of a thread
+ *
+ * @param tid Thread ID from sys_gettid, 0 for the calling thread
+ * @param ioclass One of KORA_IOPRIO_CLASS_*
+ * @param level Priority within the class, 0 (highest) to 7
+ * @return 0 on success, -1 on failure with errno set
+ */
+int sys_ioprio_set(pid_t tid, int ioclass, int level);
+
+/**
+ * Get the I/O scheduling class of a thread
+ *
+ * @param tid Thread ID from sys_gettid, 0 for the calling thread
+ * @param level Receives the priority within the class (may be NULL)
+ * @return One of KORA_IOPRIO_CLASS_*, or -1 on failure with errno set
+ */
+int sys_ioprio_get(pid_t tid, int *level);
+
+/**
+ * Restrict a task to a set of CPUs
+ *
+ * @param pid Process or thread ID, 0 for the calling thread
+ * @param set CPUs the task may run on
+ * @return 0 on success, -1 on failure with errno set
+ */
+int sys_sched_setaffinity(pid_t pid, const kora_cpuset_t *set);
+
+/**
+ * Get the set of CPUs a task may run on
+ *
+ * @param pid Process or thread ID, 0 for the calling thread
+ * @param set Receives the allowed CPUs
+ * @return 0 on success, -1 on failure with errno set
+ */
+int sys_sched_getaffinity(pid_t pid, kora_cpuset_t *set);
+
+/**
+ * Get the CPU and NUMA node the calling thread is running on
+ *
+ * The answer may be stale as soon as it is returned unless the thread is
+ * pinned to a single CPU.
+ *
+ * @param cpu Receives the logical CPU number (may be NULL)
+ * @param node Receives the NUMA node (may be NULL)
+ * @return 0 on success, -1 on failure with errno set
+ */
+int sys_getcpu(unsigned *cpu, unsigned *node);
+
+/**
+ * Describe the CPU layout of the machine
+ *
+ * @param topo Receives system-wide counts and cache sizes
+ * @param cpus Receives one entry per logical CPU (may be NULL)
+ * @param max Capacity of cpus
+ * @return Number of entries written to cpus, or -1 on failure with errno set
+ */
+int sys_cpu_topology(kora_cpu_topology_t *topo, kora_cpu_info_t *cpus, size_t max);
+
 /** Create an anonymous pipe */
 int sys_pipe(int fds[2]);
 
+/**
+ * Create an anonymous pipe with explicit flags
+ *
+ * Unlike sys_pipe, both ends are blocking unless KORA_PIPE_NONBLOCK is given.
+ *
+ * @param fds Receives the read end in fds[0] and the write end in fds[1]
+ * @param flags Combination of KORA_PIPE_* flags
+ * @return 0 on success, -1 on failure
+ */
+int sys_pipe2(int fds[2], int flags);
+
+/**
+ * Query or set the capacity of a pipe
+ *
+ * @param fd Either end of the pipe
+ * @param size New capacity in bytes, or 0 to only query
+ * @return Capacity in bytes after the call, -1 on failure
+ */
+int sys_pipe_size(int fd, int size);
+
+/**
+ * Move data between two descriptors without copying through user space
+ *
+ * At least one of the descriptors must be a pipe.
+ *
+ * @param fd_in Source descriptor
+ * @param off_in Source offset, updated on return; NULL to use the file position
+ * @param fd_out Destination descriptor
+ * @param off_out Destination offset, updated on return; NULL to use the file position
+ * @param len Maximum number of bytes to move
+ * @param flags Combination of KORA_SPLICE_* flags
+ * @return Number of bytes moved, 0 at end of input, -1 on failure
+ */
+long sys_splice(int fd_in, int64_t *off_in, int fd_out, int64_t *off_out,
+                size_t len, unsigned flags);
+
+/**
+ * Duplicate data from one pipe into another without consuming it
+ *
+ * @param fd_in Source pipe read end
+ * @param fd_out Destination pipe write end
+ * @param len Maximum number of bytes to duplicate
+ * @param flags Combination of KORA_SPLICE_* flags
+ * @return Number of bytes duplicated, 0 if the source is empty and closed, -1 on failure
+ */
+long sys_tee(int fd_in, int fd_out, size_t len, unsigned flags);
+
 /** Duplicate a file descriptor */
 int sys_dup(int oldfd);
 
@@ -494,6 +954,51 @@ int sys_setitimer(int which, const struct itimerval *new, struct itimerval *old)
 /** Install a signal handler */
 sighandler_t sys_signal(int signum, sighandler_t handler);
 
+/**
+ * Examine or change the action taken on a signal
+ *
+ * Unlike sys_signal this exposes SA_RESTART, SA_SIGINFO and sa_mask.
+ *
+ * @param signum Signal number
+ * @param act New action, or NULL to only query
+ * @param oldact Receives the previous action, may be NULL
+ * @return 0 on success, -1 on failure
+ */
+int sys_sigaction(int signum, const struct sigaction *act, struct sigaction *oldact);
+
+/**
+ * Examine or change the calling thread's blocked signal mask
+ *
+ * @param how SIG_BLOCK, SIG_UNBLOCK or SIG_SETMASK
+ * @param set Signals to change, or NULL to only query
+ * @param oldset Receives the previous mask, may be NULL
+ * @return 0 on success, -1 on failure
+ */
+int sys_sigprocmask(int how, const sigset_t *set, sigset_t *oldset);
+
+/**
+ * Create a descriptor that receives signals synchronously
+ *
+ * Signals in mask should be blocked with sys_sigprocmask first so they are
+ * queued for the descriptor instead of running a handler. The descriptor
+ * becomes readable in sys_select while a signal is pending.
+ *
+ * @param mask Signals to accept
+ * @param flags Combination of KORA_SIGNALFD_* flags
+ * @return Descriptor on success, -1 on failure
+ */
+int sys_signalfd(const sigset_t *mask, int flags);
+
+/**
+ * Read pending signals from a signal descriptor
+ *
+ * @param fd Descriptor returned by sys_signalfd
+ * @param info Array receiving one record per signal
+ * @param max Capacity of info
+ * @return Number of records read, -1 on failure (EAGAIN if non-blocking and none pending)
+ */
+int sys_signalfd_read(int fd, kora_siginfo_t *info, size_t max);
+
 /** Send a signal to a process or group */
 int sys_kill(pid_t pid, int signum);
 
@@ -506,10 +1011,46 @@ int sys_sync(void);
 /** Reboot or power off */
 int sys_reboot(int cmd);
 
-/** Mount a filesystem */
+/**
+ * Mount a filesystem
+ *
+ * Types the layer implements itself are mounted on tgt, an absolute path
+ * prefix, and serve every absolute path under it:
+ *
+ * - "fat", "vfat", "msdos", "fat12", "fat16" and "fat32" mount the disk
+ *   image src (see kora/fatfs.h).
+ * - "memfs" and "tmpfs" mount an empty in-memory filesystem (see
+ *   kora/memfs.h); src is ignored.
+ * - "host" and "bind" pass paths through to the host directory src, or
+ *   to tgt itself when src is NULL, so a host subtree can be placed
+ *   anywhere or left visible inside another mount. Descriptors are host
+ *   descriptors. The directory is resolved when mounted.
+ *
+ * The longest mounted prefix wins. Other types go to the platform.
+ *
+ * @param flags KORA_MOUNT_* flags
+ * @return KORA_SUCCESS on success, KORA_ERROR on error with errno set
+ */
 int sys_mount(const char *src, const char *tgt, const char *type,
               unsigned flags, const void *data);
 
+/**
+ * Unmount a filesystem mounted with sys_mount
+ *
+ * @return KORA_SUCCESS on success, KORA_ERROR with errno set to EINVAL
+ *         (nothing mounted on tgt) or EBUSY (descriptors still open)
+ */
+int sys_umount(const char *tgt);
+
+/*
+ * Inline dispatch: callers built with KORA_INLINE_DISPATCH call the
+ * platform implementation directly instead of going through the
+ * out-of-line sys_* wrapper. The wrappers are still in the library.
+ */
+#if defined(KORA_INLINE_DISPATCH) && !defined(KORA_DISPATCH) && defined(__GNUC__)
+#include <internal/syscall_impl.h>
+#endif
+
 #ifdef __cplusplus
 }
 #endif 
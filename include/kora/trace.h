@@ -0,0 +1,180 @@
+/**
+ * KoraLayer Syscall Tracing
+ *
+ * While tracing is on, every sys_* call records its SYS_* number,
+ * arguments, result, host errno and timing into a lock-free ring owned
+ * by the calling thread. A background writer drains the rings into a
+ * binary trace file, which tools/kora_trace prints or summarises.
+ *
+ * Tracing starts with kora_trace_start() or by setting KORA_TRACE to a
+ * file path in the environment of a program linked against the layer.
+ * When it is off, each call pays one relaxed atomic load. Building with
+ * -DKORA_TRACE_HOOKS=OFF removes the hooks entirely.
+ *
+ * File layout: one kora_trace_header_t, then a sequence of chunks. Each
+ * chunk is a kora_trace_chunk_t followed by `bytes` of payload. A
+ * KORA_TRACE_CHUNK_RECORDS payload holds `count` records from thread
+ * `tid`, each a kora_trace_record_t followed by `nargs` uint64_t
+ * arguments and, if KORA_TRACE_F_PAYLOAD is set, a kora_trace_payload_t
+ * and its path bytes. The file ends with one KORA_TRACE_CHUNK_END chunk
+ * whose payload is a kora_trace_end_t. All fields are in host byte
+ * order and every record is a multiple of 8 bytes.
+ *
+ * Traces started with KORA_TRACE_PAYLOADS (or KORA_TRACE_PAYLOADS=1 in
+ * the environment) also keep path arguments and a hash of the data
+ * moved by read, write and readlink, which tools/kora_replay needs to
+ * re-issue the calls.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>  /* For size_t */
+#include <stdint.h>  /* For uint64_t */
+
+#define KORA_TRACE_MAGIC    0x4352544bu  /* "KTRC" */
+#define KORA_TRACE_VERSION  3
+#define KORA_TRACE_MAX_ARGS 6
+#define KORA_TRACE_MAX_PATH 256  /* Longest path kept per argument */
+
+/**
+ * Flags for kora_trace_start_flags
+ */
+#define KORA_TRACE_PAYLOADS  0x0001  /* Keep paths and data hashes for replay */
+
+/**
+ * Record flags
+ */
+#define KORA_TRACE_F_PAYLOAD    0x01  /* A kora_trace_payload_t follows the arguments */
+#define KORA_TRACE_F_TRUNCATED  0x02  /* A path was longer than KORA_TRACE_MAX_PATH */
+
+/**
+ * Chunk types
+ */
+#define KORA_TRACE_CHUNK_RECORDS  1  /* Records from one thread */
+#define KORA_TRACE_CHUNK_END      2  /* Final chunk, written by kora_trace_stop */
+
+/**
+ * File header
+ */
+typedef struct {
+    uint32_t magic;              /* KORA_TRACE_MAGIC */
+    uint32_t version;            /* KORA_TRACE_VERSION */
+    uint32_t pid;                /* Traced process */
+    uint32_t reserved;
+    uint64_t start_monotonic_ns; /* Monotonic clock when tracing started */
+    uint64_t start_realtime_ns;  /* Wall clock at the same instant */
+} kora_trace_header_t;
+
+/**
+ * Chunk header
+ */
+typedef struct {
+    uint32_t type;   /* KORA_TRACE_CHUNK_* */
+    uint32_t tid;    /* Thread that made the calls (records chunks) */
+    uint32_t count;  /* Number of records */
+    uint32_t bytes;  /* Payload size following this header */
+} kora_trace_chunk_t;
+
+/**
+ * One traced call, followed in the file by nargs uint64_t arguments
+ *
+ * Pointers are recorded as addresses. host_errno is the errno seen when
+ * the call returned -1 and 0 otherwise. duration_ns minus cpu_ns is the
+ * time the thread spent blocked or runnable but descheduled.
+ */
+typedef struct {
+    uint64_t start_ns;     /* Monotonic clock at entry */
+    uint64_t duration_ns;  /* Wall time spent in the call */
+    uint64_t cpu_ns;       /* Thread CPU time consumed by the call */
+    int64_t result;        /* Return value, sign-extended */
+    int32_t host_errno;    /* errno for -1 results */
+    uint16_t syscall;      /* SYS_* number */
+    uint8_t nargs;         /* Number of arguments that follow */
+    uint8_t flags;         /* KORA_TRACE_F_* */
+} kora_trace_record_t;
+
+/**
+ * Payload of a call, followed by path_bytes[0] + path_bytes[1] bytes of
+ * path text (not NUL-terminated) padded to a multiple of 8
+ *
+ * Paths are the leading path arguments of the call, e.g. both names of
+ * a rename. For read, write and readlink, hash covers the data_bytes
+ * bytes moved, which is the call's result.
+ */
+typedef struct {
+    uint64_t hash;           /* kora_trace_hash of the data, 0 if none */
+    uint32_t data_bytes;     /* Bytes covered by hash */
+    uint16_t path_bytes[2];  /* Length of each path argument */
+} kora_trace_payload_t;
+
+#define KORA_TRACE_PAYLOAD_SIZE(p) \
+    (sizeof(kora_trace_payload_t) + (((size_t)(p)->path_bytes[0] + (p)->path_bytes[1] + 7) & ~(size_t)7))
+
+/**
+ * Payload of the KORA_TRACE_CHUNK_END chunk
+ */
+typedef struct {
+    uint64_t dropped;          /* Records lost because a thread's ring was full */
+    uint64_t stop_monotonic_ns;
+} kora_trace_end_t;
+
+/**
+ * Start tracing into a new file
+ *
+ * @param path File to create or truncate
+ * @return KORA_SUCCESS on success, KORA_ERROR with errno set to EBUSY
+ *         (already tracing), ENOTSUP (hooks compiled out) or the error
+ *         from creating the file
+ */
+int kora_trace_start(const char *path);
+
+/**
+ * Start tracing with KORA_TRACE_* flags
+ *
+ * @see kora_trace_start
+ */
+int kora_trace_start_flags(const char *path, int flags);
+
+/**
+ * Stop tracing, write out every buffered record and close the file
+ *
+ * Also runs at exit and from sys_exit. Does nothing when not tracing.
+ *
+ * @return KORA_SUCCESS on success, KORA_ERROR if writing the file failed
+ */
+int kora_trace_stop(void);
+
+/**
+ * Check whether tracing is on
+ *
+ * @return Non-zero while tracing
+ */
+int kora_trace_enabled(void);
+
+/**
+ * Records dropped since tracing started
+ *
+ * A thread drops records when it makes calls faster than the writer
+ * drains its ring.
+ */
+uint64_t kora_trace_dropped(void);
+
+/**
+ * Hash of a data buffer as stored in kora_trace_payload_t
+ */
+uint64_t kora_trace_hash(const void *data, size_t len);
+
+/**
+ * Name of a syscall number, e.g. "read" for SYS_READ
+ *
+ * @return Static string, or NULL for an unknown number
+ */
+const char *kora_syscall_name(int syscall);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,107 @@
+#include <internal/backend.h>
+#include <kora/backend.h>
+#include <errno.h>
+#include <stdlib.h>
+
+/**
+ * Backend layers
+ *
+ * Each pushed layer gets a complete table, its own entries with the
+ * layer below filling the gaps, so a call only passes through the
+ * layers that take part in it. The top table is published through one
+ * atomic pointer and read without a lock. Popped layers are kept, since
+ * a concurrent call may still be reading one; pushes and pops are rare
+ * and serialised by a spin lock.
+ */
+
+_Atomic(const kora_backend_ops_t *) kora_backend_top = NULL;
+
+typedef struct layer {
+    kora_backend_ops_t table;         /* Complete */
+    const kora_backend_ops_t *ops;    /* As pushed */
+    struct layer *below;
+} layer_t;
+
+static const kora_backend_ops_t host_ops = {
+#define HOST_ENTRY(ret, name, params) .name = KORA_BACKEND_HOST(name),
+    KORA_BACKEND_CALLS(HOST_ENTRY)
+#undef HOST_ENTRY
+};
+
+static layer_t *top_layer;   /* Under control_lock */
+static atomic_flag control_lock = ATOMIC_FLAG_INIT;
+
+static void control_acquire(void) {
+    while (atomic_flag_test_and_set_explicit(&control_lock, memory_order_acquire)) {
+    }
+}
+
+static void control_release(void) {
+    atomic_flag_clear_explicit(&control_lock, memory_order_release);
+}
+
+const kora_backend_ops_t *kora_backend_host(void) {
+    return &host_ops;
+}
+
+int kora_backend_push(const kora_backend_ops_t *ops, const kora_backend_ops_t **next) {
+#if defined(KORA_NO_BACKEND)
+    (void)ops; (void)next;
+    errno = ENOTSUP;
+    return KORA_ERROR;
+#else
+    if (ops == NULL || next == NULL) {
+        errno = EINVAL;
+        return KORA_ERROR;
+    }
+    layer_t *layer = malloc(sizeof(*layer));
+    if (layer == NULL) {
+        errno = ENOMEM;
+        return KORA_ERROR;
+    }
+
+    control_acquire();
+    for (const layer_t *l = top_layer; l != NULL; l = l->below) {
+        if (l->ops == ops) {
+            control_release();
+            free(layer);
+            errno = EINVAL;
+            return KORA_ERROR;
+        }
+    }
+    const kora_backend_ops_t *below = top_layer != NULL ? &top_layer->table : &host_ops;
+#define FILL_ENTRY(ret, name, params) layer->table.name = ops->name != NULL ? ops->name : below->name;
+    KORA_BACKEND_CALLS(FILL_ENTRY)
+#undef FILL_ENTRY
+    layer->ops = ops;
+    layer->below = top_layer;
+    *next = below;
+    top_layer = layer;
+    atomic_store_explicit(&kora_backend_top, &layer->table, memory_order_release);
+    control_release();
+    return KORA_SUCCESS;
+#endif
+}
+
+int kora_backend_pop(const kora_backend_ops_t *ops) {
+    int err = EINVAL;
+
+    control_acquire();
+    for (const layer_t *l = top_layer; l != NULL; l = l->below) {
+        if (l->ops == ops) {
+            err = l == top_layer ? 0 : EBUSY;
+            break;
+        }
+    }
+    if (err == 0) {
+        top_layer = top_layer->below;
+        atomic_store_explicit(&kora_backend_top, top_layer != NULL ? &top_layer->table : NULL,
+                              memory_order_release);
+    }
+    control_release();
+    if (err != 0) {
+        errno = err;
+        return KORA_ERROR;
+    }
+    return KORA_SUCCESS;
+}
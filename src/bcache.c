@@ -0,0 +1,962 @@
+#include <kora/bcache.h>
+#include <kora/syscalls.h>
+#include <internal/bcache.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(KORA_PLATFORM_WINDOWS)
+
+#include <pthread.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * Shared block cache
+ *
+ * Blocks of every device live in one hash table keyed by (device, block
+ * number) and on the four ARC lists: T1 and T2 hold cached blocks seen
+ * once and more than once, B1 and B2 remember the keys of blocks lately
+ * dropped from each. A hit in B1 means T1 was too small and raises the
+ * target size of T1; a hit in B2 lowers it. Blocks read ahead enter T1
+ * and their first use leaves them there, and so does a sequential read
+ * or write that starts in the block the previous one ended in, so a
+ * stream passed over once never reaches T2.
+ *
+ * One mutex covers the tables and the copies in and out of blocks; it is
+ * dropped around host reads and writeback writes. A block being read is
+ * marked loading, and a block being read or written back is pinned so
+ * that it is not evicted meanwhile. Writeback copies a batch of dirty
+ * blocks to a staging buffer under the mutex, so a block written again
+ * during its writeback is simply dirty again afterwards.
+ *
+ * Only clean blocks are evicted. When every unpinned block is dirty the
+ * cache goes over its capacity, and the next lookup runs a writeback
+ * pass itself before evicting back down to it.
+ */
+
+#define BLOCK_SIZE       KORA_BCACHE_BLOCK_SIZE
+#define DEFAULT_CAPACITY ((64u << 20) / BLOCK_SIZE)
+#define MIN_CAPACITY     64
+#define RA_STREAMS       4      /* Sequential streams tracked per device */
+#define RA_FIRST         4      /* Blocks read ahead once a stream is seen */
+#define RA_MAX           64     /* Window limit, 256 KiB */
+#define FETCH_MAX        (256 + RA_MAX)
+#define WB_PERIOD_NS     100000000L
+#define WB_BATCH         1024   /* Blocks per writeback pass */
+#define WB_RUN_MAX       64     /* Blocks per host write */
+
+enum { T1, T2, B1, B2, NLISTS };
+
+typedef struct block block_t;
+
+struct block {
+    kora_bdev_t *dev;
+    uint64_t no;
+    block_t *hnext;
+    block_t *prev, *next;    /* Towards the MRU and LRU ends of its list */
+    block_t *dprev, *dnext;  /* Dirty list */
+    uint8_t *data;           /* NULL for a ghost in B1 or B2 */
+    uint32_t pins;
+    uint8_t list;
+    uint8_t dirty;
+    uint8_t loading;
+    uint8_t readahead;       /* Read ahead and not used yet */
+    uint8_t fresh;           /* Read for a request that has not copied it yet */
+};
+
+typedef struct {
+    block_t *mru, *lru;
+    size_t count;
+} list_t;
+
+typedef struct {
+    uint64_t next;           /* Block a continuing read starts at */
+    uint32_t window;         /* Blocks to read ahead at its next miss */
+    uint64_t used;           /* 0 when the slot is free */
+} stream_t;
+
+typedef struct {
+    stream_t *stream;        /* NULL when the read is not sequential */
+    uint64_t limit;          /* First block not to read ahead */
+} ahead_t;
+
+#define NO_BLOCK UINT64_MAX
+
+struct kora_bdev {
+    int fd;
+    int rdonly;
+    uint64_t size;
+    uint64_t blocks;
+    int error;               /* First write error since the last sync */
+    size_t dirty;
+    uint64_t last_write;     /* Block the latest write ended in */
+    stream_t streams[RA_STREAMS];
+    uint64_t tick;
+    kora_bdev_t *next;
+};
+
+/* Lock order: control_lock, pass_lock, cache_lock */
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t loaded = PTHREAD_COND_INITIALIZER;
+static list_t lists[NLISTS];
+static block_t **table;
+static size_t buckets;               /* Power of two */
+static size_t capacity = DEFAULT_CAPACITY;
+static size_t target;                /* ARC's preferred size of T1 */
+static block_t *dirty_head;
+static size_t dirty_count;
+static kora_bcache_stats_t counters;
+
+static pthread_mutex_t pass_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint8_t *staging;             /* WB_BATCH blocks, under pass_lock */
+
+static pthread_mutex_t control_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t bcache_once = PTHREAD_ONCE_INIT;
+static kora_bdev_t *devices;
+static size_t writable_devices;
+static pthread_t writer;
+static int writer_started;
+static pthread_cond_t writer_wake = PTHREAD_COND_INITIALIZER;
+static int writer_run;               /* Under cache_lock */
+
+/*
+ * Tables, under cache_lock
+ */
+
+static size_t slot_of(const kora_bdev_t *dev, uint64_t no, size_t n) {
+    uint64_t h = ((uint64_t)(uintptr_t)dev >> 4) ^ (no * 0x9E3779B97F4A7C15ull);
+    return (size_t)(h ^ h >> 29) & (n - 1);
+}
+
+/* Grow the hash table to suit the capacity; keeps the old one on failure */
+static int table_fit(void) {
+    size_t want = 64;
+    while (want < 2 * capacity) {
+        want *= 2;
+    }
+    if (want <= buckets) {
+        return 0;
+    }
+    block_t **t = calloc(want, sizeof(*t));
+    if (t == NULL) {
+        return table != NULL ? 0 : -ENOMEM;
+    }
+    for (size_t i = 0; i < buckets; i++) {
+        while (table[i] != NULL) {
+            block_t *b = table[i];
+            table[i] = b->hnext;
+            size_t s = slot_of(b->dev, b->no, want);
+            b->hnext = t[s];
+            t[s] = b;
+        }
+    }
+    free(table);
+    table = t;
+    buckets = want;
+    return 0;
+}
+
+static block_t *lookup(const kora_bdev_t *dev, uint64_t no) {
+    for (block_t *b = table[slot_of(dev, no, buckets)]; b != NULL; b = b->hnext) {
+        if (b->dev == dev && b->no == no) {
+            return b;
+        }
+    }
+    return NULL;
+}
+
+static void hash_remove(block_t *b) {
+    block_t **p = &table[slot_of(b->dev, b->no, buckets)];
+    while (*p != b) {
+        p = &(*p)->hnext;
+    }
+    *p = b->hnext;
+}
+
+static void list_remove(block_t *b) {
+    list_t *l = &lists[b->list];
+    if (b->prev != NULL) {
+        b->prev->next = b->next;
+    } else {
+        l->mru = b->next;
+    }
+    if (b->next != NULL) {
+        b->next->prev = b->prev;
+    } else {
+        l->lru = b->prev;
+    }
+    l->count--;
+}
+
+static void list_push(block_t *b, int which) {
+    list_t *l = &lists[which];
+    b->list = (uint8_t)which;
+    b->prev = NULL;
+    b->next = l->mru;
+    if (l->mru != NULL) {
+        l->mru->prev = b;
+    } else {
+        l->lru = b;
+    }
+    l->mru = b;
+    l->count++;
+}
+
+static void list_move(block_t *b, int which) {
+    list_remove(b);
+    list_push(b, which);
+}
+
+static void mark_dirty(block_t *b) {
+    if (b->dirty) {
+        return;
+    }
+    b->dirty = 1;
+    b->dprev = NULL;
+    b->dnext = dirty_head;
+    if (dirty_head != NULL) {
+        dirty_head->dprev = b;
+    }
+    dirty_head = b;
+    b->dev->dirty++;
+    dirty_count++;
+}
+
+static void mark_clean(block_t *b) {
+    if (!b->dirty) {
+        return;
+    }
+    b->dirty = 0;
+    if (b->dprev != NULL) {
+        b->dprev->dnext = b->dnext;
+    } else {
+        dirty_head = b->dnext;
+    }
+    if (b->dnext != NULL) {
+        b->dnext->dprev = b->dprev;
+    }
+    b->dev->dirty--;
+    dirty_count--;
+}
+
+static void drop(block_t *b) {
+    mark_clean(b);
+    list_remove(b);
+    hash_remove(b);
+    free(b->data);
+    free(b);
+}
+
+/*
+ * Host I/O
+ */
+
+static size_t valid_bytes(const kora_bdev_t *dev, uint64_t no, size_t count) {
+    uint64_t off = no * BLOCK_SIZE;
+    uint64_t len = (uint64_t)count * BLOCK_SIZE;
+    return (size_t)(len < dev->size - off ? len : dev->size - off);
+}
+
+static int write_full(int fd, const uint8_t *p, size_t len, uint64_t off) {
+    while (len > 0) {
+        ssize_t n = pwrite(fd, p, len, (off_t)off);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -errno;
+        }
+        p += n;
+        len -= (size_t)n;
+        off += (uint64_t)n;
+    }
+    return 0;
+}
+
+/* Read count blocks from no into their buffers; bytes past the file's end read as zeros */
+static int read_blocks(kora_bdev_t *dev, uint64_t no, block_t **blocks, size_t count) {
+    struct iovec iov[FETCH_MAX];
+    size_t len = valid_bytes(dev, no, count);
+    for (size_t i = 0; i < count; i++) {
+        iov[i].iov_base = blocks[i]->data;
+        iov[i].iov_len = BLOCK_SIZE;
+        memset(blocks[i]->data, 0, BLOCK_SIZE);
+    }
+    size_t done = 0, first = 0;
+    while (done < len) {
+        ssize_t n = preadv(dev->fd, iov + first, (int)(count - first), (off_t)(no * BLOCK_SIZE + done));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            return -errno;
+        }
+        if (n == 0) {
+            break;  /* The file shrank under us */
+        }
+        done += (size_t)n;
+        while (first < count && (size_t)n >= iov[first].iov_len) {
+            n -= (ssize_t)iov[first].iov_len;
+            first++;
+        }
+        if (first < count) {
+            iov[first].iov_base = (uint8_t *)iov[first].iov_base + n;
+            iov[first].iov_len -= (size_t)n;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Replacement
+ */
+
+static block_t *victim(int which) {
+    for (block_t *b = lists[which].lru; b != NULL; b = b->prev) {
+        if (b->pins == 0 && !b->dirty) {
+            return b;
+        }
+    }
+    return NULL;
+}
+
+/* Turn clean block b into a ghost; returns its buffer */
+static uint8_t *evict(block_t *b) {
+    uint8_t *data = b->data;
+    b->data = NULL;
+    b->readahead = 0;
+    b->fresh = 0;
+    list_move(b, b->list == T1 ? B1 : B2);
+    counters.evictions++;
+    return data;
+}
+
+/*
+ * ARC's REPLACE: evict from T1 or T2 as the target says; NULL if every
+ * block is pinned or dirty, which leaves the cache over its capacity
+ * until shed writes some back
+ */
+static uint8_t *make_room(int hit_b2) {
+    size_t t1 = lists[T1].count;
+    int from = t1 > 0 && (t1 > target || (hit_b2 && t1 == target)) ? T1 : T2;
+    block_t *b = victim(from);
+    if (b == NULL) {
+        b = victim(from == T1 ? T2 : T1);
+    }
+    return b != NULL ? evict(b) : NULL;
+}
+
+static size_t writeback_pass(kora_bdev_t *only);
+
+/*
+ * Evict down to the capacity, writing dirty blocks back first with
+ * cache_lock dropped. Called where the caller holds no block.
+ */
+static void shed(void) {
+    while (lists[T1].count + lists[T2].count > capacity) {
+        uint8_t *data = make_room(0);
+        if (data != NULL) {
+            free(data);
+            continue;
+        }
+        if (dirty_count == 0) {
+            break;  /* The rest are pinned; a later call finishes */
+        }
+        pthread_mutex_unlock(&cache_lock);
+        size_t n = writeback_pass(NULL);
+        pthread_mutex_lock(&cache_lock);
+        counters.dirty_evictions += n;
+        if (n == 0) {
+            break;
+        }
+    }
+}
+
+/* Give block no a buffer and a place in T1 or T2; NULL on ENOMEM */
+static block_t *admit(kora_bdev_t *dev, uint64_t no) {
+    block_t *b = lookup(dev, no);
+    uint8_t *data = NULL;
+    size_t resident = lists[T1].count + lists[T2].count;
+    size_t b1 = lists[B1].count, b2 = lists[B2].count;
+
+    if (b != NULL && b->list == B1) {
+        size_t d = b1 >= b2 ? 1 : b2 / b1;
+        target = target + d < capacity ? target + d : capacity;
+        data = resident >= capacity ? make_room(0) : NULL;
+    } else if (b != NULL) {
+        size_t d = b2 >= b1 ? 1 : b1 / b2;
+        target = target > d ? target - d : 0;
+        data = resident >= capacity ? make_room(1) : NULL;
+    } else if (lists[T1].count + b1 >= capacity) {
+        if (lists[T1].count < capacity && b1 > 0) {
+            drop(lists[B1].lru);
+            data = resident >= capacity ? make_room(0) : NULL;
+        } else {
+            data = make_room(0);
+            if (lists[B1].count > 0) {
+                drop(lists[B1].lru);
+            }
+        }
+    } else if (resident >= capacity) {
+        if (resident + b1 + b2 >= 2 * capacity && b2 > 0) {
+            drop(lists[B2].lru);
+        }
+        data = make_room(0);
+    }
+
+    if (data == NULL && (data = malloc(BLOCK_SIZE)) == NULL) {
+        return NULL;
+    }
+    if (b == NULL) {
+        b = calloc(1, sizeof(*b));
+        if (b == NULL) {
+            free(data);
+            return NULL;
+        }
+        b->dev = dev;
+        b->no = no;
+        size_t s = slot_of(dev, no, buckets);
+        b->hnext = table[s];
+        table[s] = b;
+        list_push(b, T1);
+    } else {
+        list_move(b, T2);
+    }
+    b->data = data;
+    return b;
+}
+
+/*
+ * Lookup and fill
+ */
+
+/*
+ * Note a read of blocks first..last; returns its stream if it continues
+ * one, and sets *again when it starts in the block the last read ended in
+ */
+static stream_t *stream_update(kora_bdev_t *dev, uint64_t first, uint64_t last, uint64_t *again) {
+    stream_t *oldest = &dev->streams[0];
+
+    dev->tick++;
+    for (int i = 0; i < RA_STREAMS; i++) {
+        stream_t *s = &dev->streams[i];
+        if (s->used != 0 && (first == s->next || first + 1 == s->next)) {
+            *again = first + 1 == s->next ? first : NO_BLOCK;
+            if (last >= s->next) {
+                s->next = last + 1;
+            }
+            s->used = dev->tick;
+            return s;
+        }
+        if (s->used < oldest->used) {
+            oldest = s;
+        }
+    }
+    oldest->next = last + 1;
+    oldest->window = RA_FIRST;
+    oldest->used = dev->tick;
+    return NULL;
+}
+
+/*
+ * Read absent blocks from no up to last with one host read, plus a window
+ * past it when the read continues a stream; the first is returned. Drops
+ * cache_lock while reading.
+ */
+static int fetch(kora_bdev_t *dev, uint64_t no, uint64_t last, const ahead_t *ra, block_t **out) {
+    block_t *run[FETCH_MAX];
+    size_t n = 0, extra = 0;
+    uint64_t end = last;
+
+    if (ra != NULL && ra->stream != NULL) {
+        stream_t *s = ra->stream;
+        end = last + s->window < ra->limit ? last + s->window : ra->limit - 1;
+        end = end > last ? end : last;
+        /* Each window that is needed doubles the next, up to an eighth of the cache */
+        size_t cap = capacity / 8 < RA_MAX ? capacity / 8 : RA_MAX;
+        s->window = s->window * 2 < cap ? s->window * 2 : (uint32_t)cap;
+    }
+
+    for (uint64_t k = no; k <= end && n < FETCH_MAX; k++) {
+        block_t *b = k == no ? NULL : lookup(dev, k);
+        if (b != NULL && b->data != NULL) {
+            break;
+        }
+        /* A guess is not a reuse: read-ahead does not adapt on ghosts */
+        if (b != NULL && k > last) {
+            drop(b);
+        }
+        if ((b = admit(dev, k)) == NULL) {
+            break;
+        }
+        b->loading = 1;
+        b->pins++;
+        b->readahead = k > last;
+        b->fresh = k > no && k <= last;
+        extra += k > last;
+        run[n++] = b;
+    }
+    if (n == 0) {
+        return -ENOMEM;
+    }
+
+    pthread_mutex_unlock(&cache_lock);
+    int r = read_blocks(dev, no, run, n);
+    pthread_mutex_lock(&cache_lock);
+
+    for (size_t i = 0; i < n; i++) {
+        run[i]->loading = 0;
+        run[i]->pins--;
+        if (r != 0) {
+            drop(run[i]);
+        }
+    }
+    pthread_cond_broadcast(&loaded);
+    counters.reads++;
+    if (r != 0) {
+        return r;
+    }
+    counters.readahead += extra;
+    *out = run[0];
+    return 0;
+}
+
+/*
+ * Find block no, cached. With fill, a missing block is read (with the
+ * rest of the request up to last, and read-ahead as ra allows); without,
+ * the caller overwrites all of it and it is not read. With again, a hit
+ * is the same use as the last one and does not count as reuse. May drop
+ * cache_lock, to read or to shed an earlier overshoot.
+ */
+static int acquire(kora_bdev_t *dev, uint64_t no, uint64_t last, const ahead_t *ra, int fill, int again,
+                   block_t **out) {
+    if (lists[T1].count + lists[T2].count > capacity) {
+        shed();
+    }
+    for (;;) {
+        block_t *b = lookup(dev, no);
+        if (b != NULL && b->loading) {
+            pthread_cond_wait(&loaded, &cache_lock);
+            continue;
+        }
+        if (b != NULL && b->data != NULL && b->fresh) {
+            b->fresh = 0;
+            counters.misses++;
+            *out = b;
+            return 0;
+        }
+        if (b != NULL && b->data != NULL) {
+            counters.hits++;
+            if (b->readahead) {
+                b->readahead = 0;
+                counters.readahead_hits++;
+                list_move(b, T1);
+            } else if (again) {
+                list_move(b, b->list);
+            } else {
+                list_move(b, T2);
+            }
+            *out = b;
+            return 0;
+        }
+        counters.misses++;
+        if (fill) {
+            return fetch(dev, no, last, ra, out);
+        }
+        *out = admit(dev, no);
+        return *out != NULL ? 0 : -ENOMEM;
+    }
+}
+
+/*
+ * Writeback
+ */
+
+static int block_order(const void *a, const void *b) {
+    const block_t *x = *(const block_t *const *)a, *y = *(const block_t *const *)b;
+    if (x->dev != y->dev) {
+        return (uintptr_t)x->dev < (uintptr_t)y->dev ? -1 : 1;
+    }
+    return x->no < y->no ? -1 : x->no > y->no;
+}
+
+/* Write up to a batch of dirty blocks, of one device or all; returns how many */
+static size_t writeback_pass(kora_bdev_t *only) {
+    block_t *batch[WB_BATCH];
+    size_t n = 0, writes = 0;
+
+    pthread_mutex_lock(&pass_lock);
+    pthread_mutex_lock(&cache_lock);
+    for (block_t *b = dirty_head, *next; b != NULL && n < WB_BATCH; b = next) {
+        next = b->dnext;
+        if (only == NULL || b->dev == only) {
+            mark_clean(b);
+            b->pins++;
+            batch[n++] = b;
+        }
+    }
+    qsort(batch, n, sizeof(*batch), block_order);
+    for (size_t i = 0; i < n; i++) {
+        memcpy(staging + i * BLOCK_SIZE, batch[i]->data, BLOCK_SIZE);
+    }
+    pthread_mutex_unlock(&cache_lock);
+
+    /* Adjacent blocks of a device go out as one write */
+    for (size_t i = 0, j; i < n; i = j) {
+        kora_bdev_t *dev = batch[i]->dev;
+        for (j = i + 1; j < n && j - i < WB_RUN_MAX && batch[j]->dev == dev &&
+                        batch[j]->no == batch[j - 1]->no + 1; j++) {
+        }
+        int err = write_full(dev->fd, staging + i * BLOCK_SIZE, valid_bytes(dev, batch[i]->no, j - i),
+                             batch[i]->no * BLOCK_SIZE);
+        writes++;
+        if (err != 0) {
+            pthread_mutex_lock(&cache_lock);
+            if (dev->error == 0) {
+                dev->error = err;
+            }
+            pthread_mutex_unlock(&cache_lock);
+        }
+    }
+
+    pthread_mutex_lock(&cache_lock);
+    for (size_t i = 0; i < n; i++) {
+        batch[i]->pins--;
+    }
+    counters.writes += writes;
+    counters.writeback_blocks += n;
+    pthread_mutex_unlock(&cache_lock);
+    pthread_mutex_unlock(&pass_lock);
+    return n;
+}
+
+static void *writer_main(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&cache_lock);
+    while (writer_run) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += WB_PERIOD_NS;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+        pthread_cond_timedwait(&writer_wake, &cache_lock, &deadline);
+        while (dirty_count > 0) {
+            pthread_mutex_unlock(&cache_lock);
+            size_t n = writeback_pass(NULL);
+            pthread_mutex_lock(&cache_lock);
+            if (n == 0) {
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&cache_lock);
+    return NULL;
+}
+
+static int sync_device(kora_bdev_t *dev) {
+    int err, dirty;
+
+    /* The first pass also waits out one already writing this device's blocks */
+    do {
+        writeback_pass(dev);
+        pthread_mutex_lock(&cache_lock);
+        dirty = dev->dirty > 0;
+        pthread_mutex_unlock(&cache_lock);
+    } while (dirty);
+
+    int r = fsync(dev->fd) == 0 || dev->rdonly ? 0 : -errno;
+    pthread_mutex_lock(&cache_lock);
+    err = dev->error;
+    dev->error = 0;
+    pthread_mutex_unlock(&cache_lock);
+    return err != 0 ? err : r;
+}
+
+static void bcache_atexit(void) {
+    kora_bcache_sync();
+}
+
+/* Fork with the locks held, taken in the usual order, so the child gets consistent tables */
+static void bcache_atfork_prepare(void) {
+    pthread_mutex_lock(&control_lock);
+    pthread_mutex_lock(&pass_lock);
+    pthread_mutex_lock(&cache_lock);
+}
+
+static void bcache_atfork_parent(void) {
+    pthread_mutex_unlock(&cache_lock);
+    pthread_mutex_unlock(&pass_lock);
+    pthread_mutex_unlock(&control_lock);
+}
+
+static void bcache_atfork_child(void) {
+    /* The writer did not survive the fork, nor did any thread waiting */
+    pthread_cond_init(&loaded, NULL);
+    pthread_cond_init(&writer_wake, NULL);
+    writer_started = 0;
+    writer_run = 0;
+
+    /*
+     * The parent writes back what was dirty at the fork. Written again at
+     * the child's exit, it would land over anything the parent wrote since.
+     */
+    while (dirty_head != NULL) {
+        mark_clean(dirty_head);
+    }
+    /* Blocks another thread was reading would never finish loading */
+    for (int l = T1; l <= T2; l++) {
+        for (block_t *b = lists[l].mru, *next; b != NULL; b = next) {
+            next = b->next;
+            if (b->loading) {
+                drop(b);
+            }
+        }
+    }
+    bcache_atfork_parent();
+}
+
+static void bcache_init(void) {
+    pthread_atfork(bcache_atfork_prepare, bcache_atfork_parent, bcache_atfork_child);
+    atexit(bcache_atexit);
+}
+
+/*
+ * Devices
+ */
+
+int kora_bdev_open(int fd, uint64_t size, int rdonly, kora_bdev_t **out) {
+    pthread_once(&bcache_once, bcache_init);
+
+    kora_bdev_t *dev = calloc(1, sizeof(*dev));
+    if (dev == NULL) {
+        return -ENOMEM;
+    }
+    dev->fd = fd;
+    dev->rdonly = rdonly;
+    dev->size = size;
+    dev->blocks = (size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    dev->last_write = NO_BLOCK;
+
+    pthread_mutex_lock(&control_lock);
+    pthread_mutex_lock(&cache_lock);
+    int r = table_fit();
+    pthread_mutex_unlock(&cache_lock);
+    if (r == 0 && !rdonly) {
+        if (staging == NULL && (staging = malloc((size_t)WB_BATCH * BLOCK_SIZE)) == NULL) {
+            r = -ENOMEM;
+        } else if (!writer_started) {
+            writer_run = 1;
+            r = -pthread_create(&writer, NULL, writer_main, NULL);
+            writer_started = r == 0;
+        }
+        writable_devices += r == 0;
+    }
+    if (r != 0) {
+        pthread_mutex_unlock(&control_lock);
+        free(dev);
+        return r;
+    }
+    dev->next = devices;
+    devices = dev;
+    pthread_mutex_unlock(&control_lock);
+    *out = dev;
+    return 0;
+}
+
+int kora_bdev_close(kora_bdev_t *dev) {
+    int r = dev->rdonly ? 0 : sync_device(dev);
+
+    pthread_mutex_lock(&control_lock);
+    kora_bdev_t **p = &devices;
+    while (*p != dev) {
+        p = &(*p)->next;
+    }
+    *p = dev->next;
+    if (!dev->rdonly && --writable_devices == 0 && writer_started) {
+        pthread_mutex_lock(&cache_lock);
+        writer_run = 0;
+        pthread_cond_signal(&writer_wake);
+        pthread_mutex_unlock(&cache_lock);
+        pthread_join(writer, NULL);
+        writer_started = 0;
+    }
+    pthread_mutex_unlock(&control_lock);
+
+    pthread_mutex_lock(&cache_lock);
+    for (int l = 0; l < NLISTS; l++) {
+        for (block_t *b = lists[l].mru, *next; b != NULL; b = next) {
+            next = b->next;
+            if (b->dev == dev) {
+                drop(b);
+            }
+        }
+    }
+    pthread_mutex_unlock(&cache_lock);
+    close(dev->fd);
+    free(dev);
+    return r;
+}
+
+int kora_bdev_read(kora_bdev_t *dev, uint64_t off, void *buf, size_t len, uint64_t ahead) {
+    if (off > dev->size || len > dev->size - off) {
+        return -EINVAL;
+    }
+    if (len == 0) {
+        return 0;
+    }
+    uint64_t first = off / BLOCK_SIZE, last = (off + len - 1) / BLOCK_SIZE;
+    size_t done = 0;
+    int r = 0;
+
+    if (ahead > dev->size) {
+        ahead = dev->size;
+    }
+    pthread_mutex_lock(&cache_lock);
+    ahead_t ra = { NULL, (ahead + BLOCK_SIZE - 1) / BLOCK_SIZE };
+    uint64_t again = NO_BLOCK;
+    if (ahead > off + len) {
+        ra.stream = stream_update(dev, first, last, &again);
+    }
+    for (uint64_t no = first; no <= last; no++) {
+        block_t *b;
+        if ((r = acquire(dev, no, last, &ra, 1, no == again, &b)) != 0) {
+            break;
+        }
+        size_t within = no == first ? (size_t)(off % BLOCK_SIZE) : 0;
+        size_t n = BLOCK_SIZE - within < len - done ? BLOCK_SIZE - within : len - done;
+        memcpy((uint8_t *)buf + done, b->data + within, n);
+        done += n;
+    }
+    pthread_mutex_unlock(&cache_lock);
+    return r;
+}
+
+/* Copy buf, or zeros when it is NULL, into the cache and mark it dirty */
+static int write_range(kora_bdev_t *dev, uint64_t off, const void *buf, size_t len) {
+    if (dev->rdonly) {
+        return -EROFS;
+    }
+    if (off > dev->size || len > dev->size - off) {
+        return -EINVAL;
+    }
+    if (len == 0) {
+        return 0;
+    }
+    uint64_t first = off / BLOCK_SIZE, last = (off + len - 1) / BLOCK_SIZE;
+    size_t done = 0;
+    int r = 0;
+
+    pthread_mutex_lock(&cache_lock);
+    for (uint64_t no = first; no <= last; no++) {
+        size_t within = no == first ? (size_t)(off % BLOCK_SIZE) : 0;
+        size_t n = BLOCK_SIZE - within < len - done ? BLOCK_SIZE - within : len - done;
+        int whole = within == 0 && n >= valid_bytes(dev, no, 1);
+        block_t *b;
+        if ((r = acquire(dev, no, no, NULL, !whole, no == dev->last_write, &b)) != 0) {
+            break;
+        }
+        if (buf != NULL) {
+            memcpy(b->data + within, (const uint8_t *)buf + done, n);
+        } else {
+            memset(b->data + within, 0, n);
+        }
+        mark_dirty(b);
+        done += n;
+    }
+    dev->last_write = last;
+    if (dirty_count >= capacity / 4) {
+        pthread_cond_signal(&writer_wake);
+    }
+    pthread_mutex_unlock(&cache_lock);
+    return r;
+}
+
+int kora_bdev_write(kora_bdev_t *dev, uint64_t off, const void *buf, size_t len) {
+    return write_range(dev, off, buf, len);
+}
+
+int kora_bdev_zero(kora_bdev_t *dev, uint64_t off, size_t len) {
+    return write_range(dev, off, NULL, len);
+}
+
+int kora_bdev_sync(kora_bdev_t *dev) {
+    return dev->rdonly ? 0 : sync_device(dev);
+}
+
+/*
+ * Public interface
+ */
+
+void kora_bcache_stats(kora_bcache_stats_t *stats) {
+    pthread_mutex_lock(&cache_lock);
+    *stats = counters;
+    stats->cached = lists[T1].count + lists[T2].count;
+    stats->dirty = dirty_count;
+    stats->capacity = capacity;
+    pthread_mutex_unlock(&cache_lock);
+}
+
+int kora_bcache_set_capacity(size_t bytes) {
+    size_t blocks = bytes / BLOCK_SIZE < MIN_CAPACITY ? MIN_CAPACITY : bytes / BLOCK_SIZE;
+
+    pthread_mutex_lock(&cache_lock);
+    size_t old = capacity;
+    capacity = blocks;
+    if (table != NULL && table_fit() != 0) {
+        capacity = old;
+        pthread_mutex_unlock(&cache_lock);
+        errno = ENOMEM;
+        return KORA_ERROR;
+    }
+    if (target > capacity) {
+        target = capacity;
+    }
+    shed();
+    while (lists[T1].count + lists[B1].count > capacity && lists[B1].count > 0) {
+        drop(lists[B1].lru);
+    }
+    while (lists[B1].count + lists[B2].count > capacity && lists[B2].count > 0) {
+        drop(lists[B2].lru);
+    }
+    pthread_mutex_unlock(&cache_lock);
+    return KORA_SUCCESS;
+}
+
+int kora_bcache_sync(void) {
+    int err = 0;
+
+    pthread_mutex_lock(&control_lock);
+    for (kora_bdev_t *dev = devices; dev != NULL; dev = dev->next) {
+        int r = dev->rdonly ? 0 : sync_device(dev);
+        if (err == 0) {
+            err = r;
+        }
+    }
+    pthread_mutex_unlock(&control_lock);
+    if (err != 0) {
+        errno = -err;
+        return KORA_ERROR;
+    }
+    return KORA_SUCCESS;
+}
+
+#else /* KORA_PLATFORM_WINDOWS */
+
+void kora_bcache_stats(kora_bcache_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+}
+
+int kora_bcache_set_capacity(size_t bytes) {
+    (void)bytes;
+    return KORA_SUCCESS;
+}
+
+int kora_bcache_sync(void) {
+    return KORA_SUCCESS;
+}
+
+#endif
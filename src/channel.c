@@ -0,0 +1,454 @@
+#include <internal/syscall_impl.h>
+#include <kora/channel.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+
+#include <unistd.h>
+
+#if defined(KORA_PLATFORM_LINUX)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+/**
+ * Shared-memory message channels
+ *
+ * The ring is the bounded queue design where every slot carries a
+ * sequence number: a slot at position p is free for the producer when its
+ * sequence equals p and holds a message for the consumer when it equals
+ * p + 1. SPSC channels use the same layout but claim positions with plain
+ * stores instead of compare-and-swap.
+ *
+ * Sleeping uses a futex word per direction. A waiter registers itself,
+ * samples the word and re-checks the ring before sleeping; the other side
+ * only bumps the word and enters the kernel when someone is registered,
+ * so the uncontended path never leaves user space.
+ */
+
+#define CHANNEL_MAGIC   0x4b434831u  /* "KCH1" */
+#define CACHE_LINE      64
+#define SPIN_LIMIT      128
+
+struct channel_slot {
+    _Atomic uint64_t seq;
+    uint32_t len;
+    uint32_t reserved;
+    unsigned char data[];
+};
+
+struct kora_channel {
+    uint32_t magic;
+    uint32_t mode;
+    uint32_t capacity;
+    uint32_t msg_size;
+    uint32_t slot_size;
+    atomic_uint closed;
+
+    /* Each index and wait word gets its own cache line */
+    _Alignas(CACHE_LINE) _Atomic uint64_t tail;   /* Next position to send */
+    _Alignas(CACHE_LINE) _Atomic uint64_t head;   /* Next position to receive */
+    _Alignas(CACHE_LINE) atomic_uint data_word;   /* Bumped when messages arrive */
+    atomic_uint recv_waiters;
+    _Alignas(CACHE_LINE) atomic_uint space_word;  /* Bumped when slots free up */
+    atomic_uint send_waiters;
+};
+
+#define SLOTS_OFFSET \
+    ((sizeof(struct kora_channel) + CACHE_LINE - 1) & ~(size_t)(CACHE_LINE - 1))
+
+static inline struct channel_slot *slot_at(kora_channel_t *ch, uint64_t pos) {
+    size_t idx = (size_t)(pos & (ch->capacity - 1));
+    return (struct channel_slot *)((unsigned char *)ch + SLOTS_OFFSET +
+                                   idx * ch->slot_size);
+}
+
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __asm__ __volatile__("pause");
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+static uint32_t round_up_pow2(uint32_t v) {
+    uint32_t p = 1;
+    while (p < v && p < (1u << 31)) {
+        p <<= 1;
+    }
+    return p;
+}
+
+static uint32_t slot_size_for(uint32_t msg_size) {
+    size_t size = sizeof(struct channel_slot) + msg_size;
+    return (uint32_t)((size + CACHE_LINE - 1) & ~(size_t)(CACHE_LINE - 1));
+}
+
+size_t kora_channel_footprint(uint32_t capacity, uint32_t msg_size) {
+    if (capacity == 0 || capacity > (1u << 30) || msg_size == 0 ||
+        msg_size > (1u << 30)) {
+        return 0;
+    }
+    return SLOTS_OFFSET + (size_t)round_up_pow2(capacity) * slot_size_for(msg_size);
+}
+
+kora_channel_t *kora_channel_init(void *mem, size_t mem_size, uint32_t capacity,
+                                  uint32_t msg_size, int mode) {
+    size_t need = kora_channel_footprint(capacity, msg_size);
+    if (mem == NULL || need == 0 || mem_size < need ||
+        ((uintptr_t)mem & (CACHE_LINE - 1)) != 0 ||
+        (mode != KORA_CHANNEL_SPSC && mode != KORA_CHANNEL_MPMC)) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    kora_channel_t *ch = mem;
+    memset(ch, 0, SLOTS_OFFSET);
+    ch->mode = (uint32_t)mode;
+    ch->capacity = round_up_pow2(capacity);
+    ch->msg_size = msg_size;
+    ch->slot_size = slot_size_for(msg_size);
+
+    for (uint32_t i = 0; i < ch->capacity; i++) {
+        atomic_init(&slot_at(ch, i)->seq, i);
+    }
+
+    /* Publish the magic last so attachers never see a half-built ring */
+    atomic_thread_fence(memory_order_release);
+    ch->magic = CHANNEL_MAGIC;
+    return ch;
+}
+
+kora_channel_t *kora_channel_attach(void *mem) {
+    kora_channel_t *ch = mem;
+    if (ch == NULL || ch->magic != CHANNEL_MAGIC) {
+        errno = EINVAL;
+        return NULL;
+    }
+    atomic_thread_fence(memory_order_acquire);
+    return ch;
+}
+
+/*
+ * Wait primitives
+ */
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    sys_clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t deadline_for(int timeout_ms) {
+    if (timeout_ms < 0) {
+        return UINT64_MAX;
+    }
+    return now_ns() + (uint64_t)timeout_ms * 1000000ull;
+}
+
+/**
+ * Sleep until *word changes from expected or the deadline passes
+ */
+static void word_wait(atomic_uint *word, unsigned expected, uint64_t deadline) {
+#if defined(KORA_PLATFORM_LINUX)
+    struct timespec ts;
+    struct timespec *tmo = NULL;
+    if (deadline != UINT64_MAX) {
+        uint64_t now = now_ns();
+        uint64_t left = deadline > now ? deadline - now : 0;
+        ts.tv_sec = (time_t)(left / 1000000000ull);
+        ts.tv_nsec = (long)(left % 1000000000ull);
+        tmo = &ts;
+    }
+    /* Shared futex: the word may be mapped in several processes */
+    syscall(SYS_futex, (unsigned *)word, FUTEX_WAIT, expected, tmo, NULL, 0);
+#else
+    /* No portable cross-process futex; poll with a short sleep instead */
+    (void)deadline;
+    struct timespec ts = {0, 50000};
+    if (atomic_load_explicit(word, memory_order_acquire) == expected) {
+        sys_nanosleep(&ts, NULL);
+    }
+#endif
+}
+
+static void word_wake(atomic_uint *word) {
+    atomic_fetch_add_explicit(word, 1, memory_order_release);
+#if defined(KORA_PLATFORM_LINUX)
+    syscall(SYS_futex, (unsigned *)word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+#endif
+}
+
+static int can_send(kora_channel_t *ch) {
+    uint64_t pos = atomic_load_explicit(&ch->tail, memory_order_relaxed);
+    return atomic_load_explicit(&slot_at(ch, pos)->seq, memory_order_acquire) == pos;
+}
+
+static int can_recv(kora_channel_t *ch) {
+    uint64_t pos = atomic_load_explicit(&ch->head, memory_order_relaxed);
+    return atomic_load_explicit(&slot_at(ch, pos)->seq, memory_order_acquire) == pos + 1;
+}
+
+/**
+ * Spin budget before sleeping
+ *
+ * Spinning only pays off when the peer can run at the same time, so it is
+ * disabled on single-CPU hosts where it just delays the peer.
+ */
+static int spin_limit(void) {
+    static atomic_int limit = -1;
+    int v = atomic_load_explicit(&limit, memory_order_relaxed);
+    if (v < 0) {
+        v = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? SPIN_LIMIT : 0;
+        atomic_store_explicit(&limit, v, memory_order_relaxed);
+    }
+    return v;
+}
+
+/**
+ * Block until ready() holds, the channel closes or the deadline passes
+ *
+ * @return 0 when worth retrying, -1 on timeout
+ */
+static int channel_wait(kora_channel_t *ch, int (*ready)(kora_channel_t *),
+                        atomic_uint *word, atomic_uint *waiters, uint64_t deadline) {
+    /* Short spin first: the peer is often about to act */
+    for (int i = 0, n = spin_limit(); i < n; i++) {
+        if (ready(ch) || atomic_load_explicit(&ch->closed, memory_order_relaxed)) {
+            return 0;
+        }
+        cpu_relax();
+    }
+
+    if (deadline != UINT64_MAX && now_ns() >= deadline) {
+        return -1;
+    }
+
+    atomic_fetch_add_explicit(waiters, 1, memory_order_seq_cst);
+    unsigned seen = atomic_load_explicit(word, memory_order_seq_cst);
+    if (!ready(ch) && !atomic_load_explicit(&ch->closed, memory_order_seq_cst)) {
+        word_wait(word, seen, deadline);
+    }
+    atomic_fetch_sub_explicit(waiters, 1, memory_order_relaxed);
+    return 0;
+}
+
+static void notify(atomic_uint *word, atomic_uint *waiters) {
+    /* Pairs with the waiter's registration so no wake-up is lost */
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(waiters, memory_order_relaxed) != 0) {
+        word_wake(word);
+    }
+}
+
+/*
+ * Non-blocking ring operations
+ */
+
+static int try_send(kora_channel_t *ch, const void *msg, size_t len) {
+    uint64_t pos = atomic_load_explicit(&ch->tail, memory_order_relaxed);
+    struct channel_slot *slot;
+
+    for (;;) {
+        slot = slot_at(ch, pos);
+        uint64_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        int64_t diff = (int64_t)(seq - pos);
+
+        if (diff == 0) {
+            if (ch->mode == KORA_CHANNEL_SPSC) {
+                atomic_store_explicit(&ch->tail, pos + 1, memory_order_relaxed);
+                break;
+            }
+            if (atomic_compare_exchange_weak_explicit(&ch->tail, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return 0;  /* Full */
+        } else {
+            pos = atomic_load_explicit(&ch->tail, memory_order_relaxed);
+        }
+    }
+
+    memcpy(slot->data, msg, len);
+    slot->len = (uint32_t)len;
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+    return 1;
+}
+
+static int try_recv(kora_channel_t *ch, void *buf, size_t len, uint32_t *msg_len) {
+    uint64_t pos = atomic_load_explicit(&ch->head, memory_order_relaxed);
+    struct channel_slot *slot;
+
+    for (;;) {
+        slot = slot_at(ch, pos);
+        uint64_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        int64_t diff = (int64_t)(seq - (pos + 1));
+
+        if (diff == 0) {
+            if (ch->mode == KORA_CHANNEL_SPSC) {
+                atomic_store_explicit(&ch->head, pos + 1, memory_order_relaxed);
+                break;
+            }
+            if (atomic_compare_exchange_weak_explicit(&ch->head, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return 0;  /* Empty */
+        } else {
+            pos = atomic_load_explicit(&ch->head, memory_order_relaxed);
+        }
+    }
+
+    uint32_t n = slot->len;
+    memcpy(buf, slot->data, n < len ? n : len);
+    *msg_len = n;
+    atomic_store_explicit(&slot->seq, pos + ch->capacity, memory_order_release);
+    return 1;
+}
+
+/*
+ * Public API
+ */
+
+static int wait_for_space(kora_channel_t *ch, int timeout_ms, uint64_t *deadline) {
+    if (timeout_ms == 0) {
+        errno = EAGAIN;
+        return -1;
+    }
+    if (*deadline == 0) {
+        *deadline = deadline_for(timeout_ms);
+    }
+    if (channel_wait(ch, can_send, &ch->space_word, &ch->send_waiters, *deadline) != 0) {
+        errno = ETIMEDOUT;
+        return -1;
+    }
+    return 0;
+}
+
+static int wait_for_data(kora_channel_t *ch, int timeout_ms, uint64_t *deadline) {
+    if (timeout_ms == 0) {
+        errno = EAGAIN;
+        return -1;
+    }
+    if (*deadline == 0) {
+        *deadline = deadline_for(timeout_ms);
+    }
+    if (channel_wait(ch, can_recv, &ch->data_word, &ch->recv_waiters, *deadline) != 0) {
+        errno = ETIMEDOUT;
+        return -1;
+    }
+    return 0;
+}
+
+int kora_channel_send(kora_channel_t *ch, const void *msg, size_t len, int timeout_ms) {
+    uint64_t deadline = 0;
+
+    if (len > ch->msg_size) {
+        errno = EMSGSIZE;
+        return KORA_ERROR;
+    }
+
+    for (;;) {
+        if (atomic_load_explicit(&ch->closed, memory_order_acquire)) {
+            errno = EPIPE;
+            return KORA_ERROR;
+        }
+        if (try_send(ch, msg, len)) {
+            notify(&ch->data_word, &ch->recv_waiters);
+            return KORA_SUCCESS;
+        }
+        if (wait_for_space(ch, timeout_ms, &deadline) != 0) {
+            return KORA_ERROR;
+        }
+    }
+}
+
+int kora_channel_recv(kora_channel_t *ch, void *buf, size_t len, int timeout_ms) {
+    uint64_t deadline = 0;
+    uint32_t msg_len;
+
+    for (;;) {
+        if (try_recv(ch, buf, len, &msg_len)) {
+            notify(&ch->space_word, &ch->send_waiters);
+            return (int)msg_len;
+        }
+        /* Re-check after seeing closed so late messages are not lost */
+        if (atomic_load_explicit(&ch->closed, memory_order_acquire) && !can_recv(ch)) {
+            return KORA_EOF;
+        }
+        if (wait_for_data(ch, timeout_ms, &deadline) != 0) {
+            return KORA_ERROR;
+        }
+    }
+}
+
+int kora_channel_send_batch(kora_channel_t *ch, const void *msgs, size_t count,
+                            int timeout_ms) {
+    const unsigned char *p = msgs;
+    uint64_t deadline = 0;
+    size_t sent = 0;
+
+    if (count == 0) {
+        return 0;
+    }
+
+    for (;;) {
+        if (atomic_load_explicit(&ch->closed, memory_order_acquire)) {
+            errno = EPIPE;
+            return KORA_ERROR;
+        }
+        while (sent < count && try_send(ch, p + sent * ch->msg_size, ch->msg_size)) {
+            sent++;
+        }
+        if (sent > 0) {
+            notify(&ch->data_word, &ch->recv_waiters);
+            return (int)sent;
+        }
+        if (wait_for_space(ch, timeout_ms, &deadline) != 0) {
+            return KORA_ERROR;
+        }
+    }
+}
+
+int kora_channel_recv_batch(kora_channel_t *ch, void *msgs, uint32_t *lens,
+                            size_t max, int timeout_ms) {
+    unsigned char *p = msgs;
+    uint64_t deadline = 0;
+    size_t got = 0;
+    uint32_t msg_len;
+
+    if (max == 0) {
+        return 0;
+    }
+
+    for (;;) {
+        while (got < max && try_recv(ch, p + got * ch->msg_size, ch->msg_size, &msg_len)) {
+            if (lens) {
+                lens[got] = msg_len;
+            }
+            got++;
+        }
+        if (got > 0) {
+            notify(&ch->space_word, &ch->send_waiters);
+            return (int)got;
+        }
+        if (atomic_load_explicit(&ch->closed, memory_order_acquire) && !can_recv(ch)) {
+            return KORA_EOF;
+        }
+        if (wait_for_data(ch, timeout_ms, &deadline) != 0) {
+            return KORA_ERROR;
+        }
+    }
+}
+
+void kora_channel_close(kora_channel_t *ch) {
+    atomic_store_explicit(&ch->closed, 1, memory_order_seq_cst);
+    word_wake(&ch->data_word);
+    word_wake(&ch->space_word);
+}
@@ -0,0 +1,143 @@
+#include <internal/syscall_impl.h>
+#include <internal/error.h>
+#include <errno.h>
+#include <time.h>
+
+/**
+ * Thread-local error state and diagnostic sinks
+ */
+
+KORA_THREAD_LOCAL kora_error_t kora_tls_error;
+_Atomic(kora_diag_sink_t) kora_diag_sink = NULL;
+static _Atomic(void *) diag_sink_ctx = NULL;
+
+/* Small per-thread number so records from one thread can be grouped */
+static KORA_THREAD_LOCAL uint32_t thread_number;
+static atomic_uint next_thread_number = 1;
+
+kora_error_t kora_last_error(void) {
+    return kora_tls_error;
+}
+
+void kora_clear_error(void) {
+    kora_tls_error.syscall = 0;
+    kora_tls_error.host_errno = 0;
+}
+
+void kora_set_diag_sink(kora_diag_sink_t sink, void *ctx) {
+    /* Publish the context before the sink that will read it */
+    atomic_store_explicit(&diag_sink_ctx, ctx, memory_order_relaxed);
+    atomic_store_explicit(&kora_diag_sink, sink, memory_order_release);
+}
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+#if defined(KORA_PLATFORM_WINDOWS)
+    timespec_get(&ts, TIME_UTC);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void kora_diag_emit(int syscall, int host_errno) {
+    kora_diag_sink_t sink = atomic_load_explicit(&kora_diag_sink, memory_order_acquire);
+    if (sink == NULL) {
+        return;
+    }
+
+    if (thread_number == 0) {
+        thread_number = atomic_fetch_add_explicit(&next_thread_number, 1,
+                                                  memory_order_relaxed);
+    }
+
+    /* Callers report errno after this; a sink doing stdio must not change it */
+    int saved_errno = errno;
+    kora_diag_record_t rec;
+    rec.timestamp_ns = monotonic_ns();
+    rec.thread = thread_number;
+    rec.syscall = syscall;
+    rec.host_errno = host_errno;
+
+    sink(&rec, atomic_load_explicit(&diag_sink_ctx, memory_order_relaxed));
+    errno = saved_errno;
+}
+
+/*
+ * Built-in ring: a bounded multi-producer/multi-consumer queue where each
+ * slot carries a sequence number telling producers and consumers whose
+ * turn it is. Slot i nominally starts at sequence i; the stored value is
+ * kept relative to the slot index so the zero-initialised array is
+ * already a valid empty ring and no setup call is needed.
+ */
+#define RING_MASK (KORA_DIAG_RING_SIZE - 1)
+
+struct diag_slot {
+    atomic_size_t seq;   /* Sequence number minus slot index */
+    kora_diag_record_t rec;
+};
+
+static struct diag_slot diag_ring[KORA_DIAG_RING_SIZE];
+static atomic_size_t ring_head;   /* Next position to dequeue */
+static atomic_size_t ring_tail;   /* Next position to enqueue */
+static atomic_uint_least64_t ring_dropped;
+
+void kora_diag_ring_sink(const kora_diag_record_t *rec, void *ctx) {
+    (void)ctx;
+    size_t pos = atomic_load_explicit(&ring_tail, memory_order_relaxed);
+
+    for (;;) {
+        size_t idx = pos & RING_MASK;
+        struct diag_slot *slot = &diag_ring[idx];
+        size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire) + idx;
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring_tail, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                slot->rec = *rec;
+                atomic_store_explicit(&slot->seq, pos + 1 - idx, memory_order_release);
+                return;
+            }
+        } else if (diff < 0) {
+            /* Ring full: never block a failing caller, just count the loss */
+            atomic_fetch_add_explicit(&ring_dropped, 1, memory_order_relaxed);
+            return;
+        } else {
+            pos = atomic_load_explicit(&ring_tail, memory_order_relaxed);
+        }
+    }
+}
+
+size_t kora_diag_drain(kora_diag_record_t *out, size_t max) {
+    size_t count = 0;
+
+    while (count < max) {
+        size_t pos = atomic_load_explicit(&ring_head, memory_order_relaxed);
+        size_t idx = pos & RING_MASK;
+        struct diag_slot *slot = &diag_ring[idx];
+        size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire) + idx;
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+
+        if (diff < 0) {
+            break;  /* Empty */
+        }
+        if (diff > 0) {
+            continue;  /* Another consumer took this slot; reload head */
+        }
+        if (atomic_compare_exchange_weak_explicit(&ring_head, &pos, pos + 1,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+            out[count++] = slot->rec;
+            atomic_store_explicit(&slot->seq, pos + KORA_DIAG_RING_SIZE - idx,
+                                  memory_order_release);
+        }
+    }
+
+    return count;
+}
+
+uint64_t kora_diag_dropped(void) {
+    return atomic_load_explicit(&ring_dropped, memory_order_relaxed);
+}
@@ -0,0 +1,2064 @@
+#include <kora/fatfs.h>
+#include <kora/syscalls.h>
+#include <internal/bcache.h>
+#include <internal/vfs.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(KORA_PLATFORM_WINDOWS)
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * FAT image filesystem
+ *
+ * All image I/O goes through the shared block cache (internal/bcache.h),
+ * which turns runs of cluster and sector accesses into few host calls
+ * and writes changes back in the background. On top of it:
+ *
+ * - The FAT is decoded into a uint32_t per cluster at mount time, which
+ *   matters most for FAT12's packed entries; updates go to the cache and
+ *   every FAT copy in the image.
+ * - Every open file and loaded directory keeps its cluster chain as an
+ *   array, so an offset maps to a cluster in O(1).
+ * - A directory is parsed in one pass over its clusters the first time
+ *   it is used, into entries hashed by long and short name, and stays
+ *   loaded until unmount, with a bitmap of the slots in use so that
+ *   finding room for a name reads nothing. Changed slots are written
+ *   back one at a time.
+ *
+ * One rwlock covers the filesystem: data reads and lookups through loaded
+ * directories share it, everything that can change the FAT, a directory
+ * or a chain, or load one, takes it exclusively.
+ */
+
+#define DIRENT_SIZE   32
+#define ATTR_READONLY 0x01
+#define ATTR_HIDDEN   0x02
+#define ATTR_SYSTEM   0x04
+#define ATTR_VOLUME   0x08
+#define ATTR_DIR      0x10
+#define ATTR_ARCHIVE  0x20
+#define ATTR_LFN      0x0F
+#define SLOT_FREE     0xE5
+#define NTRES_LOWER_BASE 0x08
+#define NTRES_LOWER_EXT  0x10
+
+#define FAT_EOC       0x0FFFFFFFu  /* End of chain in the cache, whatever the width */
+#define FAT_BAD       0x0FFFFFF7u
+#define LFN_CHARS     13
+#define NAME_MAX_LEN  255          /* UTF-16 units, as on disk */
+#define DIR_MAX_SLOTS 65536        /* 2 MiB of entries per directory */
+
+/* Clusters worth checking for read-ahead: the most the block cache reads ahead */
+#define RA_CLUSTERS(fs) ((size_t)(256 * 1024 / (fs)->cluster_size) + 1)
+
+typedef struct {
+    uint32_t *v;
+    size_t count;
+    size_t cap;
+} chain_t;
+
+typedef struct fat_dir fat_dir_t;
+typedef struct fat_entry fat_entry_t;
+
+struct fat_entry {
+    char *name;              /* Long name, or the short one when there is none */
+    char short_name[13];     /* 8.3 name as displayed */
+    uint8_t raw[11];         /* 8.3 name as stored */
+    uint8_t attr;
+    uint8_t ntres;
+    uint8_t crt_tenth;
+    uint16_t crt_time, crt_date, acc_date, wrt_time, wrt_date;
+    uint32_t cluster;        /* First cluster, 0 for an empty file */
+    uint32_t size;
+    fat_dir_t *parent;       /* NULL for the root */
+    uint32_t slot;           /* Slot of the short entry in the parent */
+    uint8_t lfn_slots;       /* Long-name slots before it */
+    size_t pos;              /* Index in parent->ents */
+    atomic_int open;         /* Handles; opened under the shared lock too */
+    int deleted;             /* Removed from its directory while open */
+    chain_t chain;           /* Data clusters of a file, once opened */
+    int chain_loaded;
+    fat_dir_t *dir;          /* Contents of a directory, once used */
+    fat_entry_t *next_long;  /* Hash chains */
+    fat_entry_t *next_short;
+};
+
+struct fat_dir {
+    fat_entry_t *self;
+    chain_t chain;           /* Empty for the fixed FAT12/16 root */
+    fat_entry_t **ents;
+    size_t count;
+    size_t cap;
+    fat_entry_t **by_long;
+    fat_entry_t **by_short;
+    size_t buckets;          /* Power of two */
+    uint32_t slots;          /* Capacity in slots */
+    uint32_t end;            /* First slot never used */
+    uint32_t free_hint;      /* No free slot before this one */
+    uint64_t *used;          /* Bitmap of slots holding anything */
+};
+
+typedef struct {
+    kora_vfs_t base;
+    pthread_rwlock_t lock;
+    kora_bdev_t *dev;
+    uint64_t image_size;
+    int rdonly;
+    int bits;                /* 12, 16 or 32 */
+    uint32_t cluster_size;
+    uint32_t clusters;       /* Data clusters, numbered from 2 */
+    uint32_t fat_bytes;      /* Size of one FAT copy */
+    uint32_t num_fats;
+    uint64_t fat_offset;
+    uint64_t root_offset;    /* Fixed root of FAT12/16 */
+    uint32_t root_slots;
+    uint64_t data_offset;
+    uint64_t fsinfo_offset;  /* 0 without an FSInfo sector */
+    uint32_t *fat;           /* Decoded FAT */
+    uint32_t free_count;
+    uint32_t next_free;
+    fat_entry_t root;
+} fatfs_t;
+
+typedef struct {
+    fat_entry_t *entry;
+    int flags;
+    pthread_mutex_t lock;
+    uint64_t pos;
+} fat_file_t;
+
+typedef struct {
+    fat_entry_t *entry;
+    size_t next;             /* 0 and 1 are "." and "..", then entries */
+} fat_handle_t;
+
+static uint16_t get16(const uint8_t *p) {
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static uint32_t get32(const uint8_t *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static void put16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+    put16(p, (uint16_t)v);
+    put16(p + 2, (uint16_t)(v >> 16));
+}
+
+static int chain_push(chain_t *c, uint32_t cluster) {
+    if (c->count == c->cap) {
+        size_t cap = c->cap ? c->cap * 2 : 8;
+        uint32_t *v = realloc(c->v, cap * sizeof(*v));
+        if (v == NULL) {
+            return -ENOMEM;
+        }
+        c->v = v;
+        c->cap = cap;
+    }
+    c->v[c->count++] = cluster;
+    return 0;
+}
+
+/*
+ * Times: FAT stores local date and time fields; the layer treats them as
+ * UTC so that a value written reads back unchanged
+ */
+
+static uint64_t dos_to_unix(uint16_t date, uint16_t dtime) {
+    int y = 1980 + (date >> 9), m = (date >> 5) & 15, d = date & 31;
+    if (m < 1 || m > 12 || d < 1) {
+        return 0;
+    }
+    /* Days from 1970-01-01 to the civil date */
+    y -= m <= 2;
+    int era = y / 400;
+    int yoe = y - era * 400;
+    int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    int64_t days = (int64_t)era * 146097 + doe - 719468;
+    return (uint64_t)(days * 86400 + (dtime >> 11) * 3600 + ((dtime >> 5) & 63) * 60 + (dtime & 31) * 2);
+}
+
+static void unix_to_dos(uint64_t t, uint16_t *date, uint16_t *dtime) {
+    struct tm tm;
+    time_t tt = (time_t)t;
+    if (gmtime_r(&tt, &tm) == NULL || tm.tm_year < 80) {
+        *date = (1 << 5) | 1;  /* 1980-01-01 */
+        *dtime = 0;
+        return;
+    }
+    if (tm.tm_year > 207) {
+        *date = (127 << 9) | (12 << 5) | 31;
+        *dtime = (23 << 11) | (59 << 5) | 29;
+        return;
+    }
+    *date = (uint16_t)((tm.tm_year - 80) << 9 | (tm.tm_mon + 1) << 5 | tm.tm_mday);
+    *dtime = (uint16_t)(tm.tm_hour << 11 | tm.tm_min << 5 | tm.tm_sec / 2);
+}
+
+static void touch(fat_entry_t *e, int modified) {
+    uint16_t dtime;
+    unix_to_dos((uint64_t)time(NULL), &e->acc_date, &dtime);
+    if (modified) {
+        e->wrt_date = e->acc_date;
+        e->wrt_time = dtime;
+    }
+}
+
+/*
+ * FAT
+ */
+
+static uint64_t cluster_offset(const fatfs_t *fs, uint32_t cluster) {
+    return fs->data_offset + (uint64_t)(cluster - 2) * fs->cluster_size;
+}
+
+static int cluster_valid(const fatfs_t *fs, uint32_t cluster) {
+    return cluster >= 2 && cluster < fs->clusters + 2;
+}
+
+static uint32_t fat_decode(const fatfs_t *fs, const uint8_t *fat, uint32_t cluster) {
+    uint32_t v, eoc, bad;
+    switch (fs->bits) {
+    case 12: {
+        uint16_t pair = get16(fat + cluster + cluster / 2);
+        v = cluster & 1 ? pair >> 4 : pair & 0xFFF;
+        eoc = 0xFF8;
+        bad = 0xFF7;
+        break;
+    }
+    case 16:
+        v = get16(fat + cluster * 2);
+        eoc = 0xFFF8;
+        bad = 0xFFF7;
+        break;
+    default:
+        v = get32(fat + cluster * 4) & 0x0FFFFFFF;
+        eoc = 0x0FFFFFF8;
+        bad = 0x0FFFFFF7;
+        break;
+    }
+    if (v == bad) {
+        return FAT_BAD;
+    }
+    /* An out-of-range link ends the chain rather than leaving the image */
+    if (v >= eoc || (v != 0 && !cluster_valid(fs, v))) {
+        return FAT_EOC;
+    }
+    return v;
+}
+
+/*
+ * Update the cache and every FAT copy. Image errors are left for the
+ * block cache to report at the next sync, as for a write-back disk.
+ */
+static void fat_set(fatfs_t *fs, uint32_t cluster, uint32_t value) {
+    uint8_t b[4];
+    size_t width = fs->bits == 12 ? 2 : fs->bits / 8;
+    uint64_t at = fs->bits == 12 ? cluster + cluster / 2 : (uint64_t)cluster * width;
+
+    fs->fat[cluster] = value;
+    for (uint32_t i = 0; i < fs->num_fats; i++) {
+        uint64_t off = fs->fat_offset + (uint64_t)i * fs->fat_bytes + at;
+        switch (fs->bits) {
+        case 12: {
+            uint16_t v = value == FAT_EOC ? 0xFFF : (uint16_t)value;
+            if (kora_bdev_read(fs->dev, off, b, 2, 0) != 0) {
+                continue;
+            }
+            uint16_t pair = get16(b);
+            pair = cluster & 1 ? (uint16_t)((pair & 0x000F) | v << 4) : (uint16_t)((pair & 0xF000) | v);
+            put16(b, pair);
+            break;
+        }
+        case 16:
+            put16(b, value == FAT_EOC ? 0xFFFF : (uint16_t)value);
+            break;
+        default:
+            if (kora_bdev_read(fs->dev, off, b, 4, 0) != 0) {
+                continue;
+            }
+            put32(b, (get32(b) & 0xF0000000) | (value & 0x0FFFFFFF));
+            break;
+        }
+        kora_bdev_write(fs->dev, off, b, width);
+    }
+}
+
+/* Allocate one cluster as the end of a chain; 0 when the image is full */
+static uint32_t cluster_alloc(fatfs_t *fs) {
+    if (fs->free_count == 0) {
+        return 0;
+    }
+    for (uint32_t n = 0; n < fs->clusters; n++) {
+        uint32_t c = 2 + (fs->next_free - 2 + n) % fs->clusters;
+        if (fs->fat[c] == 0) {
+            fat_set(fs, c, FAT_EOC);
+            fs->free_count--;
+            fs->next_free = c + 1 < fs->clusters + 2 ? c + 1 : 2;
+            return c;
+        }
+    }
+    fs->free_count = 0;
+    return 0;
+}
+
+static void chain_free(fatfs_t *fs, uint32_t cluster) {
+    for (uint32_t n = 0; cluster_valid(fs, cluster) && n < fs->clusters; n++) {
+        uint32_t next = fs->fat[cluster];
+        fat_set(fs, cluster, 0);
+        fs->free_count++;
+        cluster = next;
+    }
+}
+
+static int chain_load(fatfs_t *fs, uint32_t cluster, chain_t *chain) {
+    chain->count = 0;
+    while (cluster_valid(fs, cluster)) {
+        if (chain->count == fs->clusters) {
+            return -EIO;  /* A loop */
+        }
+        if (chain_push(chain, cluster) != 0) {
+            return -ENOMEM;
+        }
+        cluster = fs->fat[cluster];
+    }
+    return 0;
+}
+
+/* Grow a chain to count clusters, linking from first; returns how many it holds */
+static size_t chain_extend(fatfs_t *fs, chain_t *chain, uint32_t *first, size_t count) {
+    while (chain->count < count) {
+        uint32_t c = cluster_alloc(fs);
+        if (c == 0) {
+            break;
+        }
+        if (chain_push(chain, c) != 0) {
+            fat_set(fs, c, 0);
+            fs->free_count++;
+            break;
+        }
+        if (chain->count == 1) {
+            *first = c;
+        } else {
+            fat_set(fs, chain->v[chain->count - 2], c);
+        }
+    }
+    return chain->count;
+}
+
+/*
+ * Names
+ */
+
+static int fold(int c) {
+    return c >= 'A' && c <= 'Z' ? c + 'a' - 'A' : c;
+}
+
+static uint32_t name_hash(const char *name, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ (uint32_t)fold((unsigned char)name[i])) * 16777619u;
+    }
+    return h;
+}
+
+static int name_eq(const char *a, const char *b, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (a[i] == '\0' || fold((unsigned char)a[i]) != fold((unsigned char)b[i])) {
+            return 0;
+        }
+    }
+    return a[len] == '\0';
+}
+
+static uint8_t short_checksum(const uint8_t raw[11]) {
+    uint8_t sum = 0;
+    for (int i = 0; i < 11; i++) {
+        sum = (uint8_t)(((sum & 1) << 7) + (sum >> 1) + raw[i]);
+    }
+    return sum;
+}
+
+static void short_display(const uint8_t raw[11], uint8_t ntres, char out[13]) {
+    int n = 0, base = 8, ext = 3;
+    while (base > 0 && raw[base - 1] == ' ') {
+        base--;
+    }
+    while (ext > 0 && raw[8 + ext - 1] == ' ') {
+        ext--;
+    }
+    for (int i = 0; i < base; i++) {
+        int c = i == 0 && raw[0] == 0x05 ? 0xE5 : raw[i];
+        out[n++] = (char)(ntres & NTRES_LOWER_BASE ? fold(c) : c);
+    }
+    if (ext > 0) {
+        out[n++] = '.';
+        for (int i = 0; i < ext; i++) {
+            out[n++] = (char)(ntres & NTRES_LOWER_EXT ? fold(raw[8 + i]) : raw[8 + i]);
+        }
+    }
+    out[n] = '\0';
+}
+
+static size_t utf16_to_utf8(const uint16_t *in, size_t n, char *out) {
+    size_t o = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t c = in[i];
+        if (c >= 0xD800 && c < 0xDC00 && i + 1 < n && in[i + 1] >= 0xDC00 && in[i + 1] < 0xE000) {
+            c = 0x10000 + ((c - 0xD800) << 10) + (in[++i] - 0xDC00);
+        }
+        if (c < 0x80) {
+            out[o++] = (char)c;
+        } else if (c < 0x800) {
+            out[o++] = (char)(0xC0 | c >> 6);
+            out[o++] = (char)(0x80 | (c & 0x3F));
+        } else if (c < 0x10000) {
+            out[o++] = (char)(0xE0 | c >> 12);
+            out[o++] = (char)(0x80 | ((c >> 6) & 0x3F));
+            out[o++] = (char)(0x80 | (c & 0x3F));
+        } else {
+            out[o++] = (char)(0xF0 | c >> 18);
+            out[o++] = (char)(0x80 | ((c >> 12) & 0x3F));
+            out[o++] = (char)(0x80 | ((c >> 6) & 0x3F));
+            out[o++] = (char)(0x80 | (c & 0x3F));
+        }
+    }
+    out[o] = '\0';
+    return o;
+}
+
+/* Returns the number of units, or -1 for invalid UTF-8 or a name that is too long */
+static int utf8_to_utf16(const char *s, uint16_t out[NAME_MAX_LEN]) {
+    const unsigned char *p = (const unsigned char *)s;
+    int n = 0;
+    while (*p) {
+        uint32_t c;
+        int extra;
+        if (*p < 0x80) {
+            c = *p;
+            extra = 0;
+        } else if ((*p & 0xE0) == 0xC0) {
+            c = *p & 0x1F;
+            extra = 1;
+        } else if ((*p & 0xF0) == 0xE0) {
+            c = *p & 0x0F;
+            extra = 2;
+        } else if ((*p & 0xF8) == 0xF0) {
+            c = *p & 0x07;
+            extra = 3;
+        } else {
+            return -1;
+        }
+        p++;
+        for (int i = 0; i < extra; i++, p++) {
+            if ((*p & 0xC0) != 0x80) {
+                return -1;
+            }
+            c = c << 6 | (*p & 0x3F);
+        }
+        if (c >= 0x10000) {
+            if (n + 2 > NAME_MAX_LEN) {
+                return -1;
+            }
+            out[n++] = (uint16_t)(0xD800 + ((c - 0x10000) >> 10));
+            out[n++] = (uint16_t)(0xDC00 + ((c - 0x10000) & 0x3FF));
+        } else {
+            if (n + 1 > NAME_MAX_LEN) {
+                return -1;
+            }
+            out[n++] = (uint16_t)c;
+        }
+    }
+    return n;
+}
+
+static int short_char(int c) {
+    return (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || strchr("!#$%&'()-@^_`{}~", c) != NULL;
+}
+
+/*
+ * Store name as an 8.3 name if that loses nothing: at most 8.3
+ * characters from the short set, each part in a single case
+ */
+static int short_exact(const char *name, uint8_t raw[11], uint8_t *ntres) {
+    const char *dot = strrchr(name, '.');
+    size_t base = dot ? (size_t)(dot - name) : strlen(name);
+    size_t ext = dot ? strlen(dot + 1) : 0;
+    int cases[2] = {0, 0};  /* Bit 1 upper, bit 2 lower, per part */
+
+    if (base == 0 || base > 8 || ext > 3 || (dot && ext == 0)) {
+        return 0;
+    }
+    memset(raw, ' ', 11);
+    for (size_t i = 0; name[i]; i++) {
+        if (name + i == dot) {
+            continue;
+        }
+        int part = dot && name + i > dot;
+        int c = (unsigned char)name[i];
+        if (c >= 'a' && c <= 'z') {
+            cases[part] |= 2;
+            c -= 'a' - 'A';
+        } else if (c >= 'A' && c <= 'Z') {
+            cases[part] |= 1;
+        }
+        if (!short_char(c)) {
+            return 0;
+        }
+        raw[part ? 8 + (size_t)(name + i - dot - 1) : i] = (uint8_t)c;
+    }
+    if (cases[0] == 3 || cases[1] == 3) {
+        return 0;
+    }
+    *ntres = (uint8_t)((cases[0] == 2 ? NTRES_LOWER_BASE : 0) | (cases[1] == 2 ? NTRES_LOWER_EXT : 0));
+    if (raw[0] == 0xE5) {
+        raw[0] = 0x05;
+    }
+    return 1;
+}
+
+/*
+ * Directories
+ */
+
+static void hash_insert(fat_dir_t *dir, fat_entry_t *e) {
+    size_t mask = dir->buckets - 1;
+    size_t l = name_hash(e->name, strlen(e->name)) & mask;
+    size_t s = name_hash(e->short_name, strlen(e->short_name)) & mask;
+    e->next_long = dir->by_long[l];
+    dir->by_long[l] = e;
+    e->next_short = dir->by_short[s];
+    dir->by_short[s] = e;
+}
+
+static void hash_remove(fat_dir_t *dir, fat_entry_t *e) {
+    size_t mask = dir->buckets - 1;
+    fat_entry_t **p = &dir->by_long[name_hash(e->name, strlen(e->name)) & mask];
+    while (*p != e) {
+        p = &(*p)->next_long;
+    }
+    *p = e->next_long;
+    p = &dir->by_short[name_hash(e->short_name, strlen(e->short_name)) & mask];
+    while (*p != e) {
+        p = &(*p)->next_short;
+    }
+    *p = e->next_short;
+}
+
+static int dir_add(fat_dir_t *dir, fat_entry_t *e) {
+    if (dir->count == dir->cap) {
+        size_t cap = dir->cap ? dir->cap * 2 : 16;
+        fat_entry_t **ents = realloc(dir->ents, cap * sizeof(*ents));
+        if (ents == NULL) {
+            return -ENOMEM;
+        }
+        dir->ents = ents;
+        dir->cap = cap;
+    }
+    if (dir->count >= dir->buckets) {
+        size_t buckets = dir->buckets ? dir->buckets * 2 : 16;
+        fat_entry_t **by_long = calloc(buckets, sizeof(*by_long));
+        fat_entry_t **by_short = calloc(buckets, sizeof(*by_short));
+        if (by_long == NULL || by_short == NULL) {
+            free(by_long);
+            free(by_short);
+            return -ENOMEM;
+        }
+        free(dir->by_long);
+        free(dir->by_short);
+        dir->by_long = by_long;
+        dir->by_short = by_short;
+        dir->buckets = buckets;
+        for (size_t i = 0; i < dir->count; i++) {
+            hash_insert(dir, dir->ents[i]);
+        }
+    }
+    e->parent = dir;
+    e->pos = dir->count;
+    dir->ents[dir->count++] = e;
+    hash_insert(dir, e);
+    return 0;
+}
+
+static void dir_del(fat_dir_t *dir, fat_entry_t *e) {
+    hash_remove(dir, e);
+    fat_entry_t *last = dir->ents[--dir->count];
+    dir->ents[e->pos] = last;
+    last->pos = e->pos;
+    e->parent = NULL;
+}
+
+static fat_entry_t *dir_find(const fat_dir_t *dir, const char *name, size_t len) {
+    if (dir->count == 0) {
+        return NULL;
+    }
+    size_t b = name_hash(name, len) & (dir->buckets - 1);
+    for (fat_entry_t *e = dir->by_long[b]; e != NULL; e = e->next_long) {
+        if (name_eq(e->name, name, len)) {
+            return e;
+        }
+    }
+    for (fat_entry_t *e = dir->by_short[b]; e != NULL; e = e->next_short) {
+        if (name_eq(e->short_name, name, len)) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static int dir_is_root_region(const fatfs_t *fs, const fat_dir_t *dir) {
+    return dir->self == &fs->root && fs->bits != 32;
+}
+
+static uint64_t slot_offset(const fatfs_t *fs, const fat_dir_t *dir, uint32_t slot) {
+    uint64_t off = (uint64_t)slot * DIRENT_SIZE;
+    if (dir_is_root_region(fs, dir)) {
+        return fs->root_offset + off;
+    }
+    return cluster_offset(fs, dir->chain.v[off / fs->cluster_size]) + off % fs->cluster_size;
+}
+
+static int slot_used(const fat_dir_t *dir, uint32_t slot) {
+    return (int)(dir->used[slot / 64] >> (slot % 64) & 1);
+}
+
+static void slot_mark(fat_dir_t *dir, uint32_t slot, int used) {
+    uint64_t bit = 1ull << (slot % 64);
+    dir->used[slot / 64] = used ? dir->used[slot / 64] | bit : dir->used[slot / 64] & ~bit;
+}
+
+/* Grow the slot bitmap from dir->slots to slots; 0 or -ENOMEM */
+static int slots_fit(fat_dir_t *dir, uint32_t slots) {
+    size_t old = dir->used != NULL ? dir->slots / 64 + 1 : 0;
+    size_t words = slots / 64 + 1;
+    if (words > old) {
+        uint64_t *used = realloc(dir->used, words * sizeof(*used));
+        if (used == NULL) {
+            return -ENOMEM;
+        }
+        memset(used + old, 0, (words - old) * sizeof(*used));
+        dir->used = used;
+    }
+    return 0;
+}
+
+static void entry_free(fat_entry_t *e);
+
+static void dir_free(fat_dir_t *dir) {
+    for (size_t i = 0; i < dir->count; i++) {
+        entry_free(dir->ents[i]);
+    }
+    free(dir->ents);
+    free(dir->by_long);
+    free(dir->by_short);
+    free(dir->chain.v);
+    free(dir->used);
+    free(dir);
+}
+
+static void entry_free(fat_entry_t *e) {
+    if (e->dir != NULL) {
+        dir_free(e->dir);
+    }
+    free(e->chain.v);
+    free(e->name);
+    free(e);
+}
+
+static void entry_decode(fatfs_t *fs, fat_entry_t *e, const uint8_t *b) {
+    memcpy(e->raw, b, 11);
+    e->attr = b[11];
+    e->ntres = b[12];
+    e->crt_tenth = b[13];
+    e->crt_time = get16(b + 14);
+    e->crt_date = get16(b + 16);
+    e->acc_date = get16(b + 18);
+    e->wrt_time = get16(b + 22);
+    e->wrt_date = get16(b + 24);
+    e->cluster = get16(b + 26) | (fs->bits == 32 ? (uint32_t)get16(b + 20) << 16 : 0);
+    e->size = e->attr & ATTR_DIR ? 0 : get32(b + 28);
+    short_display(e->raw, e->ntres, e->short_name);
+}
+
+static void entry_encode(const fatfs_t *fs, const fat_entry_t *e, uint8_t *b) {
+    memcpy(b, e->raw, 11);
+    b[11] = e->attr;
+    b[12] = e->ntres;
+    b[13] = e->crt_tenth;
+    put16(b + 14, e->crt_time);
+    put16(b + 16, e->crt_date);
+    put16(b + 18, e->acc_date);
+    put16(b + 20, fs->bits == 32 ? (uint16_t)(e->cluster >> 16) : 0);
+    put16(b + 22, e->wrt_time);
+    put16(b + 24, e->wrt_date);
+    put16(b + 26, (uint16_t)e->cluster);
+    put32(b + 28, e->attr & ATTR_DIR ? 0 : e->size);
+}
+
+/* Write an entry's short slot back to its directory */
+static void entry_sync(fatfs_t *fs, const fat_entry_t *e) {
+    uint8_t b[DIRENT_SIZE];
+    if (e->parent != NULL) {
+        entry_encode(fs, e, b);
+        kora_bdev_write(fs->dev, slot_offset(fs, e->parent, e->slot), b, DIRENT_SIZE);
+    }
+}
+
+typedef struct {
+    uint16_t units[20 * LFN_CHARS];
+    int total;               /* Slots announced by the first one */
+    int expect;              /* Next sequence number, 0 when complete */
+    uint8_t sum;
+} lfn_state_t;
+
+static const int lfn_offsets[LFN_CHARS] = {1, 3, 5, 7, 9, 14, 16, 18, 20, 22, 24, 28, 30};
+
+static void lfn_collect(lfn_state_t *lfn, const uint8_t *b) {
+    int seq = b[0] & 0x3F;
+    if (b[0] & 0x40) {
+        lfn->total = lfn->expect = seq;
+        lfn->sum = b[13];
+        if (seq == 0 || seq > 20) {
+            lfn->total = 0;
+            return;
+        }
+    } else if (lfn->total == 0 || seq != lfn->expect || b[13] != lfn->sum) {
+        lfn->total = 0;
+        return;
+    }
+    for (int i = 0; i < LFN_CHARS; i++) {
+        lfn->units[(seq - 1) * LFN_CHARS + i] = get16(b + lfn_offsets[i]);
+    }
+    lfn->expect--;
+}
+
+/* Parse one slot while loading a directory; returns -ENOMEM on failure */
+static int dir_parse_slot(fatfs_t *fs, fat_dir_t *dir, uint32_t slot, const uint8_t *b,
+                          lfn_state_t *lfn) {
+    if (b[0] == SLOT_FREE) {
+        lfn->total = 0;
+        return 0;
+    }
+    if ((b[11] & 0x3F) == ATTR_LFN) {
+        lfn_collect(lfn, b);
+        return 0;
+    }
+    int lfn_slots = lfn->total != 0 && lfn->expect == 0 && lfn->sum == short_checksum(b) ? lfn->total : 0;
+    lfn->total = 0;
+    if ((b[11] & ATTR_VOLUME) || (b[0] == '.' && (b[1] == ' ' || (b[1] == '.' && b[2] == ' ')))) {
+        return 0;
+    }
+
+    fat_entry_t *e = calloc(1, sizeof(*e));
+    if (e == NULL) {
+        return -ENOMEM;
+    }
+    entry_decode(fs, e, b);
+    e->slot = slot;
+    e->lfn_slots = (uint8_t)lfn_slots;
+    if (lfn_slots > 0) {
+        size_t n = 0;
+        while (n < (size_t)lfn_slots * LFN_CHARS && lfn->units[n] != 0) {
+            n++;
+        }
+        char buf[NAME_MAX_LEN * 4 + 1];
+        utf16_to_utf8(lfn->units, n < NAME_MAX_LEN ? n : NAME_MAX_LEN, buf);
+        e->name = strdup(buf);
+    } else {
+        e->name = strdup(e->short_name);
+    }
+    if (e->name == NULL || dir_add(dir, e) != 0) {
+        entry_free(e);
+        return -ENOMEM;
+    }
+    return 0;
+}
+
+/* Read a directory into memory the first time it is used */
+static int dir_load(fatfs_t *fs, fat_entry_t *self) {
+    lfn_state_t lfn = {0};
+
+    if (self->dir != NULL) {
+        return 0;
+    }
+    fat_dir_t *dir = calloc(1, sizeof(*dir));
+    if (dir == NULL) {
+        return -ENOMEM;
+    }
+    dir->self = self;
+    int r = 0;
+    uint32_t slots = fs->root_slots;
+    if (!dir_is_root_region(fs, dir)) {
+        r = chain_load(fs, self->cluster, &dir->chain);
+        slots = (uint32_t)(dir->chain.count * (fs->cluster_size / DIRENT_SIZE));
+    }
+    if (r == 0) {
+        r = slots_fit(dir, slots);
+    }
+    dir->slots = dir->end = slots;
+
+    /* A whole cluster (or the fixed root) at a time */
+    uint32_t per_run = dir_is_root_region(fs, dir) ? dir->slots : fs->cluster_size / DIRENT_SIZE;
+    uint8_t *run = malloc((size_t)per_run * DIRENT_SIZE);
+    if (r == 0 && run == NULL) {
+        r = -ENOMEM;
+    }
+    for (uint32_t slot = 0; r == 0 && slot < dir->slots && dir->end == dir->slots; slot += per_run) {
+        if ((r = kora_bdev_read(fs->dev, slot_offset(fs, dir, slot), run, (size_t)per_run * DIRENT_SIZE, 0)) != 0) {
+            break;
+        }
+        for (uint32_t i = 0; i < per_run; i++) {
+            const uint8_t *b = run + (size_t)i * DIRENT_SIZE;
+            if (b[0] == 0) {
+                dir->end = slot + i;
+                break;
+            }
+            if (b[0] != SLOT_FREE) {
+                slot_mark(dir, slot + i, 1);
+            }
+            if ((r = dir_parse_slot(fs, dir, slot + i, b, &lfn)) != 0) {
+                break;
+            }
+        }
+    }
+    free(run);
+    if (r != 0) {
+        dir_free(dir);
+        return r;
+    }
+    self->dir = dir;
+    return 0;
+}
+
+/* Find need consecutive free slots, growing the directory if necessary */
+static int slots_alloc(fatfs_t *fs, fat_dir_t *dir, uint32_t need, uint32_t *first) {
+    uint32_t run = 0;
+    for (uint32_t i = dir->free_hint; i < dir->end; i++) {
+        if (slot_used(dir, i)) {
+            if (i == dir->free_hint) {
+                dir->free_hint++;
+            }
+            run = 0;
+            continue;
+        }
+        if (++run == need) {
+            *first = i + 1 - need;
+            return 0;
+        }
+    }
+
+    /* Append after the last used slot; the slot after stays the end marker */
+    while (dir->end + need > dir->slots) {
+        uint32_t per_cluster = fs->cluster_size / DIRENT_SIZE;
+        if (dir_is_root_region(fs, dir) || dir->slots + per_cluster > DIR_MAX_SLOTS) {
+            return -ENOSPC;
+        }
+        if (slots_fit(dir, dir->slots + per_cluster) != 0) {
+            return -ENOMEM;
+        }
+        size_t before = dir->chain.count;
+        if (chain_extend(fs, &dir->chain, &dir->self->cluster, before + 1) == before) {
+            return -ENOSPC;
+        }
+        if (before == 0) {
+            entry_sync(fs, dir->self);
+        }
+        kora_bdev_zero(fs->dev, cluster_offset(fs, dir->chain.v[dir->chain.count - 1]), fs->cluster_size);
+        dir->slots += per_cluster;
+    }
+    *first = dir->end;
+    dir->end += need;
+    return 0;
+}
+
+static void slots_free(fatfs_t *fs, fat_dir_t *dir, uint32_t first, uint32_t count) {
+    static const uint8_t mark = SLOT_FREE;
+    for (uint32_t i = first; i < first + count; i++) {
+        kora_bdev_write(fs->dev, slot_offset(fs, dir, i), &mark, 1);
+        slot_mark(dir, i, 0);
+    }
+    if (first < dir->free_hint) {
+        dir->free_hint = first;
+    }
+}
+
+/* Pick a unique 8.3 alias of the form BASE~N.EXT for a long name */
+static int short_alias(const fat_dir_t *dir, const char *name, uint8_t raw[11]) {
+    char base[9] = {0}, ext[4] = {0};
+    const char *dot = strrchr(name, '.');
+    size_t nb = 0, ne = 0;
+
+    if (dot == name) {
+        dot = NULL;  /* ".profile" has no extension */
+    }
+    for (const char *p = name; *p && (dot == NULL || p < dot) && nb < 8; p++) {
+        int c = (unsigned char)*p;
+        c = c >= 'a' && c <= 'z' ? c - ('a' - 'A') : c;
+        if (c == '.' || c == ' ') {
+            continue;
+        }
+        base[nb++] = (char)(short_char(c) ? c : '_');
+    }
+    for (const char *p = dot ? dot + 1 : ""; *p && ne < 3; p++) {
+        int c = (unsigned char)*p;
+        c = c >= 'a' && c <= 'z' ? c - ('a' - 'A') : c;
+        if (c == ' ') {
+            continue;
+        }
+        ext[ne++] = (char)(short_char(c) ? c : '_');
+    }
+    if (nb == 0) {
+        base[nb++] = '_';
+    }
+
+    /* BASE~1 to BASE~4, then a hash of the name to keep collisions rare */
+    uint32_t h = name_hash(name, strlen(name));
+    for (int attempt = 1; attempt < 1000000; attempt++) {
+        char tail[12], cand[13];
+        int keep;
+        if (attempt <= 4) {
+            keep = snprintf(tail, sizeof(tail), "~%d", attempt);
+            keep = 8 - keep;
+            if (keep > (int)nb) {
+                keep = (int)nb;
+            }
+            snprintf(cand, sizeof(cand), "%.*s%s", keep, base, tail);
+        } else {
+            int n = (attempt - 5) % 9 + 1;
+            uint32_t hv = (h + (uint32_t)(attempt - 5) / 9 * 2654435761u) & 0xFFFF;
+            keep = nb < 2 ? (int)nb : 2;
+            snprintf(cand, sizeof(cand), "%.*s%04X~%d", keep, base, (unsigned)hv, n);
+        }
+        char display[20];
+        if (ne > 0) {
+            snprintf(display, sizeof(display), "%s.%s", cand, ext);
+        } else {
+            snprintf(display, sizeof(display), "%s", cand);
+        }
+        if (dir_find(dir, display, strlen(display)) == NULL) {
+            memset(raw, ' ', 11);
+            memcpy(raw, cand, strlen(cand));
+            memcpy(raw + 8, ext, ne);
+            return 0;
+        }
+    }
+    return -EEXIST;
+}
+
+static int name_valid(const char *name) {
+    size_t len = strlen(name);
+    for (const char *p = name; *p; p++) {
+        if ((unsigned char)*p < 0x20 || strchr("\"*/:<>?\\|", *p) != NULL) {
+            return 0;
+        }
+    }
+    /* Trailing dots and spaces are dropped by other implementations */
+    return len > 0 && name[len - 1] != '.' && name[len - 1] != ' ';
+}
+
+/*
+ * Give e the name in dir: choose its short name, write its slots and
+ * add it to the directory's tables
+ */
+static int entry_place(fatfs_t *fs, fat_dir_t *dir, fat_entry_t *e, const char *name) {
+    uint16_t units[NAME_MAX_LEN];
+    uint8_t ntres = 0;
+    uint32_t lfn_slots = 0;
+
+    if (!name_valid(name)) {
+        return -EINVAL;
+    }
+    int n = utf8_to_utf16(name, units);
+    if (n < 0) {
+        return n == -1 && strlen(name) > NAME_MAX_LEN ? -ENAMETOOLONG : -EINVAL;
+    }
+    char *copy = strdup(name);
+    if (copy == NULL) {
+        return -ENOMEM;
+    }
+    if (short_exact(name, e->raw, &ntres) && dir_find(dir, name, strlen(name)) == NULL) {
+        e->ntres = ntres;
+    } else {
+        int r = short_alias(dir, name, e->raw);
+        if (r != 0) {
+            free(copy);
+            return r;
+        }
+        e->ntres = 0;
+        lfn_slots = ((uint32_t)n + LFN_CHARS - 1) / LFN_CHARS;
+    }
+
+    uint32_t first;
+    int r = slots_alloc(fs, dir, lfn_slots + 1, &first);
+    if (r != 0) {
+        free(copy);
+        return r;
+    }
+    e->slot = first + lfn_slots;
+    e->lfn_slots = (uint8_t)lfn_slots;
+    short_display(e->raw, e->ntres, e->short_name);
+    free(e->name);
+    e->name = copy;
+
+    /* Long-name slots precede the short one, last part first */
+    uint8_t sum = short_checksum(e->raw);
+    for (uint32_t k = 1; k <= lfn_slots; k++) {
+        uint8_t b[DIRENT_SIZE] = {0};
+        b[0] = (uint8_t)(k | (k == lfn_slots ? 0x40 : 0));
+        b[11] = ATTR_LFN;
+        b[13] = sum;
+        for (int i = 0; i < LFN_CHARS; i++) {
+            int u = (int)(k - 1) * LFN_CHARS + i;
+            put16(b + lfn_offsets[i], u < n ? units[u] : u == n ? 0x0000 : 0xFFFF);
+        }
+        kora_bdev_write(fs->dev, slot_offset(fs, dir, e->slot - k), b, DIRENT_SIZE);
+    }
+    for (uint32_t i = first; i <= e->slot; i++) {
+        slot_mark(dir, i, 1);
+    }
+    r = dir_add(dir, e);
+    if (r != 0) {
+        slots_free(fs, dir, first, lfn_slots + 1);
+        return r;
+    }
+    entry_sync(fs, e);
+    return 0;
+}
+
+/* Drop e's name from its directory, on disk and in memory */
+static void entry_unplace(fatfs_t *fs, fat_entry_t *e) {
+    fat_dir_t *dir = e->parent;
+    slots_free(fs, dir, e->slot - e->lfn_slots, e->lfn_slots + 1u);
+    dir_del(dir, e);
+}
+
+/* Free a removed entry and its clusters once nothing refers to it */
+static void entry_release(fatfs_t *fs, fat_entry_t *e) {
+    if (e->deleted && e->open == 0) {
+        chain_free(fs, e->cluster);
+        entry_free(e);
+    }
+}
+
+/*
+ * Path resolution. Loading a directory needs the exclusive lock; a
+ * lookup through directories already loaded only needs the shared one.
+ */
+
+static fat_entry_t *parent_of(fatfs_t *fs, const fat_entry_t *e) {
+    return e->parent != NULL ? e->parent->self : &fs->root;
+}
+
+/* Without load, -EAGAIN when a directory on the way is not loaded yet */
+static int walk(fatfs_t *fs, const char *path, int load, fat_entry_t **out) {
+    fat_entry_t *cur = &fs->root;
+    const char *p = path;
+
+    for (;;) {
+        while (*p == '/') {
+            p++;
+        }
+        if (*p == '\0') {
+            break;
+        }
+        size_t len = strcspn(p, "/");
+        if (!(cur->attr & ATTR_DIR)) {
+            return -ENOTDIR;
+        }
+        if (len == 1 && p[0] == '.') {
+            p += len;
+            continue;
+        }
+        if (len == 2 && p[0] == '.' && p[1] == '.') {
+            cur = parent_of(fs, cur);
+            p += len;
+            continue;
+        }
+        if (cur->dir == NULL && !load) {
+            return -EAGAIN;
+        }
+        int r = dir_load(fs, cur);
+        if (r != 0) {
+            return r;
+        }
+        fat_entry_t *e = dir_find(cur->dir, p, len);
+        if (e == NULL) {
+            return len > NAME_MAX_LEN ? -ENAMETOOLONG : -ENOENT;
+        }
+        cur = e;
+        p += len;
+        if (*p == '/' && !(cur->attr & ATTR_DIR)) {
+            return -ENOTDIR;
+        }
+    }
+    *out = cur;
+    return 0;
+}
+
+/* The loaded directory holding path's last component, which is copied to name */
+static int walk_parent(fatfs_t *fs, const char *path, fat_dir_t **dir, char *name, size_t size) {
+    size_t end = strlen(path);
+    while (end > 0 && path[end - 1] == '/') {
+        end--;
+    }
+    size_t start = end;
+    while (start > 0 && path[start - 1] != '/') {
+        start--;
+    }
+    size_t len = end - start;
+    if (len == 0) {
+        return -EBUSY;
+    }
+    if (len >= size) {
+        return -ENAMETOOLONG;
+    }
+    if ((len == 1 && path[start] == '.') || (len == 2 && path[start] == '.' && path[start + 1] == '.')) {
+        return -EINVAL;
+    }
+    memcpy(name, path + start, len);
+    name[len] = '\0';
+
+    char *parent = malloc(start + 1);
+    if (parent == NULL) {
+        return -ENOMEM;
+    }
+    memcpy(parent, path, start);
+    parent[start] = '\0';
+    fat_entry_t *e;
+    int r = walk(fs, parent, 1, &e);
+    free(parent);
+    if (r == 0 && !(e->attr & ATTR_DIR)) {
+        r = -ENOTDIR;
+    }
+    if (r == 0) {
+        r = dir_load(fs, e);
+    }
+    if (r == 0) {
+        *dir = e->dir;
+    }
+    return r;
+}
+
+/*
+ * Walk under the shared lock, retaking it exclusively only when a
+ * directory on the way, or path itself with load_dir, still has to be
+ * loaded. Returns holding fs->lock, exclusively if *exclusive is set.
+ */
+static int walk_shared(fatfs_t *fs, const char *path, int load_dir, fat_entry_t **out,
+                       int *exclusive) {
+    pthread_rwlock_rdlock(&fs->lock);
+    *exclusive = 0;
+    int r = walk(fs, path, 0, out);
+    if (r != -EAGAIN && !(r == 0 && load_dir && ((*out)->attr & ATTR_DIR) && (*out)->dir == NULL)) {
+        return r;
+    }
+    pthread_rwlock_unlock(&fs->lock);
+    pthread_rwlock_wrlock(&fs->lock);
+    *exclusive = 1;
+    r = walk(fs, path, 1, out);
+    if (r == 0 && load_dir && ((*out)->attr & ATTR_DIR)) {
+        r = dir_load(fs, *out);
+    }
+    return r;
+}
+
+#define NAME_BUF (NAME_MAX_LEN * 4 + 1)
+
+static int entry_create(fatfs_t *fs, const char *path, uint8_t attr, uint32_t cluster,
+                        fat_entry_t **out) {
+    char name[NAME_BUF];
+    fat_dir_t *dir;
+
+    int r = walk_parent(fs, path, &dir, name, sizeof(name));
+    if (r != 0) {
+        return r == -EBUSY ? -EEXIST : r;
+    }
+    if (dir_find(dir, name, strlen(name)) != NULL) {
+        return -EEXIST;
+    }
+    fat_entry_t *e = calloc(1, sizeof(*e));
+    if (e == NULL) {
+        return -ENOMEM;
+    }
+    e->attr = attr;
+    e->cluster = cluster;
+    touch(e, 1);
+    e->crt_date = e->wrt_date;
+    e->crt_time = e->wrt_time;
+    r = entry_place(fs, dir, e, name);
+    if (r != 0) {
+        entry_free(e);
+        return r;
+    }
+    *out = e;
+    return 0;
+}
+
+/*
+ * Operations
+ */
+
+#define FATFS(fs) ((fatfs_t *)(fs))
+
+static int writable(int flags) {
+    return (flags & KORA_O_WRONLY) != 0;
+}
+
+static void fill_stat(const fat_entry_t *e, kora_stat_t *st) {
+    memset(st, 0, sizeof(*st));
+    if (e->attr & ATTR_DIR) {
+        st->mode = S_IFDIR | 0755;
+    } else {
+        st->mode = S_IFREG | (e->attr & ATTR_READONLY ? 0444 : 0644);
+        st->size = e->size;
+    }
+    st->mtime = dos_to_unix(e->wrt_date, e->wrt_time);
+}
+
+static void fill_info(const fat_entry_t *e, kora_file_info_t *info) {
+    memset(info, 0, sizeof(*info));
+    info->type = e->attr & ATTR_DIR ? KORA_FILE_TYPE_DIRECTORY : KORA_FILE_TYPE_REGULAR;
+    info->attributes = (uint8_t)((e->attr & ATTR_READONLY ? KORA_FILE_ATTR_READONLY : 0) |
+                                 (e->attr & ATTR_HIDDEN ? KORA_FILE_ATTR_HIDDEN : 0) |
+                                 (e->attr & ATTR_SYSTEM ? KORA_FILE_ATTR_SYSTEM : 0) |
+                                 (e->attr & ATTR_ARCHIVE ? KORA_FILE_ATTR_ARCHIVE : 0));
+    info->starting_cluster = e->cluster;
+    info->size = e->size;
+    info->creation_time = dos_to_unix(e->crt_date, e->crt_time) + e->crt_tenth / 100;
+    info->modified_time = dos_to_unix(e->wrt_date, e->wrt_time);
+    info->access_time = dos_to_unix(e->acc_date, 0);
+}
+
+/* Whether opening what walk found, or creating it, changes the tables */
+static int open_changes(const fat_entry_t *e, int r, int flags) {
+    if (r == -ENOENT) {
+        return (flags & KORA_O_CREAT) != 0;
+    }
+    if (r != 0 || (e->attr & ATTR_DIR)) {
+        return 0;
+    }
+    return !e->chain_loaded ||
+           ((flags & KORA_O_TRUNC) && writable(flags) && (e->size > 0 || e->cluster != 0));
+}
+
+static int fatfs_open(kora_vfs_t *vfs, const char *path, int flags, void **file) {
+    fatfs_t *fs = FATFS(vfs);
+    fat_entry_t *e;
+    int exclusive;
+
+    fat_file_t *f = malloc(sizeof(*f));
+    if (f == NULL) {
+        return -ENOMEM;
+    }
+    int r = walk_shared(fs, path, 0, &e, &exclusive);
+    if (!exclusive && open_changes(e, r, flags)) {
+        pthread_rwlock_unlock(&fs->lock);
+        pthread_rwlock_wrlock(&fs->lock);
+        r = walk(fs, path, 1, &e);
+    }
+    if (r == -ENOENT && (flags & KORA_O_CREAT)) {
+        r = fs->rdonly ? -EROFS : entry_create(fs, path, ATTR_ARCHIVE, 0, &e);
+    }
+    if (r == 0 && writable(flags)) {
+        r = e->attr & ATTR_DIR ? -EISDIR : fs->rdonly ? -EROFS : e->attr & ATTR_READONLY ? -EACCES : 0;
+    }
+    if (r == 0 && !(e->attr & ATTR_DIR) && !e->chain_loaded) {
+        r = chain_load(fs, e->cluster, &e->chain);
+        e->chain_loaded = r == 0;
+    }
+    if (r == 0 && (flags & KORA_O_TRUNC) && writable(flags) && (e->size > 0 || e->cluster != 0)) {
+        chain_free(fs, e->cluster);
+        e->chain.count = 0;
+        e->cluster = 0;
+        e->size = 0;
+        e->attr |= ATTR_ARCHIVE;
+        touch(e, 1);
+        entry_sync(fs, e);
+    }
+    if (r == 0) {
+        e->open++;
+    }
+    pthread_rwlock_unlock(&fs->lock);
+    if (r != 0) {
+        free(f);
+        return r;
+    }
+    f->entry = e;
+    f->flags = flags;
+    f->pos = 0;
+    pthread_mutex_init(&f->lock, NULL);
+    *file = f;
+    return 0;
+}
+
+static int fatfs_close(kora_vfs_t *vfs, void *file) {
+    fatfs_t *fs = FATFS(vfs);
+    fat_file_t *f = file;
+
+    pthread_rwlock_wrlock(&fs->lock);
+    f->entry->open--;
+    entry_release(fs, f->entry);
+    pthread_rwlock_unlock(&fs->lock);
+    pthread_mutex_destroy(&f->lock);
+    free(f);
+    return 0;
+}
+
+/*
+ * Where read-ahead after cluster index of e must stop: the end of the
+ * run of clusters that follow it on disk, or of the data before end
+ */
+static uint64_t ahead_limit(const fatfs_t *fs, const fat_entry_t *e, size_t index, uint64_t end) {
+    size_t k = index, most = index + RA_CLUSTERS(fs);
+    while (k + 1 < e->chain.count && k < most && e->chain.v[k + 1] == e->chain.v[k] + 1) {
+        k++;
+    }
+    uint64_t stop = (uint64_t)(k + 1) * fs->cluster_size;
+    if (stop > end) {
+        stop = end;
+    }
+    return cluster_offset(fs, e->chain.v[index]) + (stop - (uint64_t)index * fs->cluster_size);
+}
+
+static long fatfs_read(kora_vfs_t *vfs, void *file, void *buf, size_t count) {
+    fatfs_t *fs = FATFS(vfs);
+    fat_file_t *f = file;
+    fat_entry_t *e = f->entry;
+
+    if (e->attr & ATTR_DIR) {
+        return -EISDIR;
+    }
+    if ((f->flags & KORA_O_RDWR) == KORA_O_WRONLY) {
+        return -EBADF;
+    }
+    pthread_mutex_lock(&f->lock);
+    pthread_rwlock_rdlock(&fs->lock);
+    uint64_t pos = f->pos;
+    uint64_t end = e->size;
+    /* A chain shorter than the size is damage; stop where it ends */
+    if (end > (uint64_t)e->chain.count * fs->cluster_size) {
+        end = (uint64_t)e->chain.count * fs->cluster_size;
+    }
+    size_t done = 0;
+    int r = 0;
+    if (pos < end) {
+        if (count > end - pos) {
+            count = (size_t)(end - pos);
+        }
+        /* Clusters that follow each other on disk are one request to the cache */
+        while (done < count && r == 0) {
+            uint64_t at = pos + done;
+            size_t index = (size_t)(at / fs->cluster_size);
+            uint32_t within = (uint32_t)(at % fs->cluster_size);
+            size_t n = fs->cluster_size - within;
+            while (n < count - done && index + 1 < e->chain.count && e->chain.v[index + 1] == e->chain.v[index] + 1) {
+                n += fs->cluster_size;
+                index++;
+            }
+            if (n > count - done) {
+                n = count - done;
+            }
+            r = kora_bdev_read(fs->dev, cluster_offset(fs, e->chain.v[at / fs->cluster_size]) + within,
+                               (char *)buf + done, n, ahead_limit(fs, e, index, end));
+            done += r == 0 ? n : 0;
+        }
+    }
+    pthread_rwlock_unlock(&fs->lock);
+    f->pos = pos + done;
+    pthread_mutex_unlock(&f->lock);
+    return done > 0 || r == 0 ? (long)done : r;
+}
+
+static void data_zero(fatfs_t *fs, const fat_entry_t *e, uint64_t from, uint64_t to) {
+    while (from < to) {
+        uint32_t within = (uint32_t)(from % fs->cluster_size);
+        uint64_t n = fs->cluster_size - within;
+        if (n > to - from) {
+            n = to - from;
+        }
+        kora_bdev_zero(fs->dev, cluster_offset(fs, e->chain.v[from / fs->cluster_size]) + within, (size_t)n);
+        from += n;
+    }
+}
+
+static long fatfs_write(kora_vfs_t *vfs, void *file, const void *buf, size_t count) {
+    fatfs_t *fs = FATFS(vfs);
+    fat_file_t *f = file;
+    fat_entry_t *e = f->entry;
+
+    if (!writable(f->flags)) {
+        return -EBADF;
+    }
+    pthread_mutex_lock(&f->lock);
+    pthread_rwlock_wrlock(&fs->lock);
+    if (f->flags & KORA_O_APPEND) {
+        f->pos = e->size;
+    }
+    uint64_t pos = f->pos;
+    uint64_t end = pos + count;
+    long r;
+    if (end > UINT32_MAX) {
+        end = UINT32_MAX;  /* FAT sizes are 32 bits */
+    }
+    if (count > 0 && end <= pos) {
+        r = -EFBIG;
+        goto out;
+    }
+
+    size_t need = (size_t)((end + fs->cluster_size - 1) / fs->cluster_size);
+    size_t have = chain_extend(fs, &e->chain, &e->cluster, need);
+    if ((uint64_t)have * fs->cluster_size < end) {
+        end = (uint64_t)have * fs->cluster_size;
+    }
+    if (count > 0 && end <= pos) {
+        entry_sync(fs, e);  /* The chain may still have grown */
+        r = -ENOSPC;
+        goto out;
+    }
+    /* FAT has no holes: writing past the end fills the gap with zeros */
+    if (pos > e->size) {
+        data_zero(fs, e, e->size, pos);
+    }
+    size_t done = 0;
+    int err = 0;
+    while (pos + done < end && err == 0) {
+        uint64_t at = pos + done;
+        size_t index = (size_t)(at / fs->cluster_size);
+        uint32_t within = (uint32_t)(at % fs->cluster_size);
+        size_t n = fs->cluster_size - within;
+        while (n < end - at && index + 1 < e->chain.count && e->chain.v[index + 1] == e->chain.v[index] + 1) {
+            n += fs->cluster_size;
+            index++;
+        }
+        if (n > end - at) {
+            n = (size_t)(end - at);
+        }
+        err = kora_bdev_write(fs->dev, cluster_offset(fs, e->chain.v[at / fs->cluster_size]) + within,
+                              (const char *)buf + done, n);
+        done += err == 0 ? n : 0;
+    }
+    if (done == 0 && err != 0) {
+        entry_sync(fs, e);
+        r = err;
+        goto out;
+    }
+    end = pos + done;
+    if (end > e->size) {
+        e->size = (uint32_t)end;
+    }
+    e->attr |= ATTR_ARCHIVE;
+    touch(e, 1);
+    entry_sync(fs, e);
+    f->pos = end;
+    r = (long)done;
+out:
+    pthread_rwlock_unlock(&fs->lock);
+    pthread_mutex_unlock(&f->lock);
+    return r;
+}
+
+static long fatfs_seek(kora_vfs_t *vfs, void *file, long offset, int whence) {
+    fatfs_t *fs = FATFS(vfs);
+    fat_file_t *f = file;
+    long base;
+
+    pthread_mutex_lock(&f->lock);
+    switch (whence) {
+    case KORA_SEEK_SET:
+        base = 0;
+        break;
+    case KORA_SEEK_CUR:
+        base = (long)f->pos;
+        break;
+    case KORA_SEEK_END:
+        pthread_rwlock_rdlock(&fs->lock);
+        base = (long)f->entry->size;
+        pthread_rwlock_unlock(&fs->lock);
+        break;
+    default:
+        pthread_mutex_unlock(&f->lock);
+        return -EINVAL;
+    }
+    if (offset < -base) {
+        pthread_mutex_unlock(&f->lock);
+        return -EINVAL;
+    }
+    f->pos = (uint64_t)(base + offset);
+    pthread_mutex_unlock(&f->lock);
+    return base + offset;
+}
+
+static int fatfs_fstat(kora_vfs_t *vfs, void *file, kora_stat_t *st) {
+    fatfs_t *fs = FATFS(vfs);
+    fat_file_t *f = file;
+
+    pthread_rwlock_rdlock(&fs->lock);
+    fill_stat(f->entry, st);
+    pthread_rwlock_unlock(&fs->lock);
+    return 0;
+}
+
+static int fatfs_fget_info(kora_vfs_t *vfs, void *file, kora_file_info_t *info) {
+    fatfs_t *fs = FATFS(vfs);
+    fat_file_t *f = file;
+
+    pthread_rwlock_rdlock(&fs->lock);
+    fill_info(f->entry, info);
+    pthread_rwlock_unlock(&fs->lock);
+    return 0;
+}
+
+static int fatfs_opendir(kora_vfs_t *vfs, const char *path, void **dir) {
+    fatfs_t *fs = FATFS(vfs);
+    fat_entry_t *e;
+    int exclusive;
+
+    fat_handle_t *d = malloc(sizeof(*d));
+    if (d == NULL) {
+        return -ENOMEM;
+    }
+    int r = walk_shared(fs, path, 1, &e, &exclusive);
+    if (r == 0 && !(e->attr & ATTR_DIR)) {
+        r = -ENOTDIR;
+    }
+    if (r == 0) {
+        e->open++;
+    }
+    pthread_rwlock_unlock(&fs->lock);
+    if (r != 0) {
+        free(d);
+        return r;
+    }
+    d->entry = e;
+    d->next = 0;
+    *dir = d;
+    return 0;
+}
+
+static int fatfs_readdir(kora_vfs_t *vfs, void *dir, kora_dirent_t *entry) {
+    fatfs_t *fs = FATFS(vfs);
+    fat_handle_t *d = dir;
+    int r = 1;
+
+    pthread_rwlock_rdlock(&fs->lock);
+    const fat_dir_t *contents = d->entry->dir;
+    if (d->next < 2) {
+        strcpy(entry->name, d->next == 0 ? "." : "..");
+        entry->type = KORA_DT_DIR;
+    } else if (d->next - 2 < contents->count) {
+        const fat_entry_t *e = contents->ents[d->next - 2];
+        size_t len = strlen(e->name);
+        if (len >= sizeof(entry->name)) {
+            len = sizeof(entry->name) - 1;
+        }
+        memcpy(entry->name, e->name, len);
+        entry->name[len] = '\0';
+        entry->type = e->attr & ATTR_DIR ? KORA_DT_DIR : KORA_DT_REG;
+    } else {
+        r = 0;
+    }
+    pthread_rwlock_unlock(&fs->lock);
+    d->next += (size_t)r;
+    return r;
+}
+
+static int fatfs_closedir(kora_vfs_t *vfs, void *dir) {
+    fatfs_t *fs = FATFS(vfs);
+    fat_handle_t *d = dir;
+
+    pthread_rwlock_wrlock(&fs->lock);
+    d->entry->open--;
+    entry_release(fs, d->entry);
+    pthread_rwlock_unlock(&fs->lock);
+    free(d);
+    return 0;
+}
+
+static int fatfs_mkdir(kora_vfs_t *vfs, const char *path) {
+    fatfs_t *fs = FATFS(vfs);
+    fat_entry_t *e, *probe;
+
+    if (fs->rdonly) {
+        return -EROFS;
+    }
+    pthread_rwlock_wrlock(&fs->lock);
+    int r = walk(fs, path, 1, &probe) == 0 ? -EEXIST : 0;
+    uint32_t cluster = r == 0 ? cluster_alloc(fs) : 0;
+    if (r == 0 && cluster == 0) {
+        r = -ENOSPC;
+    }
+    if (r == 0) {
+        r = entry_create(fs, path, ATTR_DIR, cluster, &e);
+        if (r != 0) {
+            chain_free(fs, cluster);
+        }
+    }
+    if (r == 0) {
+        /* "." and ".." lead every directory but the root */
+        uint8_t b[2 * DIRENT_SIZE];
+        fat_entry_t dot = *e;
+        memset(dot.raw, ' ', 11);
+        dot.raw[0] = '.';
+        dot.ntres = 0;
+        entry_encode(fs, &dot, b);
+        dot.raw[1] = '.';
+        fat_entry_t *parent = parent_of(fs, e);
+        dot.cluster = parent == &fs->root ? 0 : parent->cluster;
+        entry_encode(fs, &dot, b + DIRENT_SIZE);
+        kora_bdev_zero(fs->dev, cluster_offset(fs, cluster), fs->cluster_size);
+        kora_bdev_write(fs->dev, cluster_offset(fs, cluster), b, sizeof(b));
+    }
+    pthread_rwlock_unlock(&fs->lock);
+    return r;
+}
+
+static int remove_path(fatfs_t *fs, const char *path, int want_dir) {
+    char name[NAME_BUF];
+    fat_dir_t *dir;
+
+    if (fs->rdonly) {
+        return -EROFS;
+    }
+    int r = walk_parent(fs, path, &dir, name, sizeof(name));
+    if (r != 0) {
+        return r == -EBUSY && !want_dir ? -EISDIR : r;
+    }
+    fat_entry_t *e = dir_find(dir, name, strlen(name));
+    if (e == NULL) {
+        return -ENOENT;
+    }
+    if (want_dir && !(e->attr & ATTR_DIR)) {
+        return -ENOTDIR;
+    }
+    if (!want_dir && (e->attr & ATTR_DIR)) {
+        return -EISDIR;
+    }
+    if (want_dir && (r = dir_load(fs, e)) == 0 && e->dir->count > 0) {
+        r = -ENOTEMPTY;
+    }
+    if (r == 0) {
+        entry_unplace(fs, e);
+        e->deleted = 1;
+        entry_release(fs, e);
+    }
+    return r;
+}
+
+static int fatfs_rmdir(kora_vfs_t *vfs, const char *path) {
+    fatfs_t *fs = FATFS(vfs);
+    pthread_rwlock_wrlock(&fs->lock);
+    int r = remove_path(fs, path, 1);
+    pthread_rwlock_unlock(&fs->lock);
+    return r;
+}
+
+static int fatfs_unlink(kora_vfs_t *vfs, const char *path) {
+    fatfs_t *fs = FATFS(vfs);
+    pthread_rwlock_wrlock(&fs->lock);
+    int r = remove_path(fs, path, 0);
+    pthread_rwlock_unlock(&fs->lock);
+    return r;
+}
+
+static int rename_locked(fatfs_t *fs, const char *from, const char *to) {
+    char src_name[NAME_BUF], dst_name[NAME_BUF];
+    fat_dir_t *src_dir, *dst_dir;
+
+    int r = walk_parent(fs, from, &src_dir, src_name, sizeof(src_name));
+    if (r == 0) {
+        r = walk_parent(fs, to, &dst_dir, dst_name, sizeof(dst_name));
+    }
+    if (r != 0) {
+        return r;
+    }
+    fat_entry_t *e = dir_find(src_dir, src_name, strlen(src_name));
+    if (e == NULL) {
+        return -ENOENT;
+    }
+    fat_entry_t *old = dir_find(dst_dir, dst_name, strlen(dst_name));
+    if (old == e && strcmp(e->name, dst_name) == 0) {
+        return 0;
+    }
+    if (e->attr & ATTR_DIR) {
+        for (fat_entry_t *p = dst_dir->self; p != &fs->root; p = parent_of(fs, p)) {
+            if (p == e) {
+                return -EINVAL;
+            }
+        }
+    }
+    if (old != NULL && old != e) {
+        if ((e->attr & ATTR_DIR) && !(old->attr & ATTR_DIR)) {
+            return -ENOTDIR;
+        }
+        if (!(e->attr & ATTR_DIR) && (old->attr & ATTR_DIR)) {
+            return -EISDIR;
+        }
+        if ((old->attr & ATTR_DIR) && ((r = dir_load(fs, old)) != 0 || old->dir->count > 0)) {
+            return r != 0 ? r : -ENOTEMPTY;
+        }
+    } else {
+        old = NULL;
+    }
+
+    /* Write the new slots before freeing the old ones, so failure keeps the old name */
+    uint32_t slot = e->slot;
+    uint8_t lfn_slots = e->lfn_slots;
+    uint8_t raw[11], ntres = e->ntres;
+    char *name = strdup(e->name);
+    memcpy(raw, e->raw, sizeof(raw));
+    if (name == NULL) {
+        return -ENOMEM;
+    }
+
+    /* The replaced entry lends its name and slots, but stays on disk until the new name is in */
+    uint32_t old_first = old != NULL ? old->slot - old->lfn_slots : 0;
+    if (old != NULL) {
+        for (uint32_t i = old_first; i <= old->slot; i++) {
+            slot_mark(dst_dir, i, 0);
+        }
+        if (old_first < dst_dir->free_hint) {
+            dst_dir->free_hint = old_first;
+        }
+        dir_del(dst_dir, old);
+    }
+    dir_del(src_dir, e);
+    r = entry_place(fs, dst_dir, e, dst_name);
+    if (r != 0) {
+        /* Put both names back; neither one's slots were written */
+        memcpy(e->raw, raw, sizeof(raw));
+        e->ntres = ntres;
+        e->slot = slot;
+        e->lfn_slots = lfn_slots;
+        short_display(raw, ntres, e->short_name);
+        free(e->name);
+        e->name = name;
+        if (old != NULL) {
+            for (uint32_t i = old_first; i <= old->slot; i++) {
+                slot_mark(dst_dir, i, 1);
+            }
+            if (dir_add(dst_dir, old) != 0) {
+                old->deleted = 1;  /* Out of memory: the name is lost in memory only */
+            }
+        }
+        if (dir_add(src_dir, e) != 0) {
+            e->deleted = 1;
+        }
+        return r;
+    }
+    free(name);
+    slots_free(fs, src_dir, slot - lfn_slots, lfn_slots + 1u);
+    if (old != NULL) {
+        /* Free the replaced entry's slots the new name did not take over */
+        for (uint32_t i = old_first; i <= old->slot; i++) {
+            if (!slot_used(dst_dir, i)) {
+                slots_free(fs, dst_dir, i, 1);
+            }
+        }
+        old->deleted = 1;
+        entry_release(fs, old);
+    }
+
+    /* A directory that changes parent must point its ".." at the new one */
+    if ((e->attr & ATTR_DIR) && src_dir != dst_dir && cluster_valid(fs, e->cluster)) {
+        fat_entry_t *parent = dst_dir->self;
+        uint8_t dotdot[DIRENT_SIZE];
+        uint64_t off = cluster_offset(fs, e->cluster) + DIRENT_SIZE;
+        uint32_t c = parent == &fs->root ? 0 : parent->cluster;
+        if (kora_bdev_read(fs->dev, off, dotdot, DIRENT_SIZE, 0) == 0) {
+            put16(dotdot + 26, (uint16_t)c);
+            put16(dotdot + 20, fs->bits == 32 ? (uint16_t)(c >> 16) : 0);
+            kora_bdev_write(fs->dev, off, dotdot, DIRENT_SIZE);
+        }
+    }
+    return 0;
+}
+
+static int fatfs_rename(kora_vfs_t *vfs, const char *from, const char *to) {
+    fatfs_t *fs = FATFS(vfs);
+    if (fs->rdonly) {
+        return -EROFS;
+    }
+    pthread_rwlock_wrlock(&fs->lock);
+    int r = rename_locked(fs, from, to);
+    pthread_rwlock_unlock(&fs->lock);
+    return r;
+}
+
+static int fatfs_link(kora_vfs_t *vfs, const char *existing, const char *path) {
+    (void)vfs; (void)existing; (void)path;
+    return -EPERM;
+}
+
+static int fatfs_symlink(kora_vfs_t *vfs, const char *target, const char *path) {
+    (void)vfs; (void)target; (void)path;
+    return -EPERM;
+}
+
+static int fatfs_readlink(kora_vfs_t *vfs, const char *path, char *buf, size_t size) {
+    fatfs_t *fs = FATFS(vfs);
+    fat_entry_t *e;
+    int exclusive;
+    (void)buf; (void)size;
+
+    int r = walk_shared(fs, path, 0, &e, &exclusive);
+    pthread_rwlock_unlock(&fs->lock);
+    return r != 0 ? r : -EINVAL;
+}
+
+static int fatfs_stat(kora_vfs_t *vfs, const char *path, kora_stat_t *st) {
+    fatfs_t *fs = FATFS(vfs);
+    fat_entry_t *e;
+    int exclusive;
+
+    int r = walk_shared(fs, path, 0, &e, &exclusive);
+    if (r == 0) {
+        fill_stat(e, st);
+    }
+    pthread_rwlock_unlock(&fs->lock);
+    return r;
+}
+
+static int fatfs_get_info(kora_vfs_t *vfs, const char *path, kora_file_info_t *info) {
+    fatfs_t *fs = FATFS(vfs);
+    fat_entry_t *e;
+    int exclusive;
+
+    int r = walk_shared(fs, path, 0, &e, &exclusive);
+    if (r == 0) {
+        fill_info(e, info);
+    }
+    pthread_rwlock_unlock(&fs->lock);
+    return r;
+}
+
+static int fatfs_utime(kora_vfs_t *vfs, const char *path, uint64_t mtime) {
+    fatfs_t *fs = FATFS(vfs);
+    fat_entry_t *e;
+
+    if (fs->rdonly) {
+        return -EROFS;
+    }
+    pthread_rwlock_wrlock(&fs->lock);
+    int r = walk(fs, path, 1, &e);
+    if (r == 0) {
+        touch(e, 0);
+        unix_to_dos(mtime, &e->wrt_date, &e->wrt_time);
+        entry_sync(fs, e);
+    }
+    pthread_rwlock_unlock(&fs->lock);
+    return r;
+}
+
+static void fatfs_destroy(kora_vfs_t *vfs) {
+    fatfs_t *fs = FATFS(vfs);
+
+    /* Free count and allocation hint in the FSInfo sector of FAT32 */
+    if (!fs->rdonly && fs->fsinfo_offset != 0) {
+        uint8_t b[8];
+        put32(b, fs->free_count);
+        put32(b + 4, fs->next_free);
+        kora_bdev_write(fs->dev, fs->fsinfo_offset + 488, b, sizeof(b));
+    }
+    kora_bdev_close(fs->dev);
+    if (fs->root.dir != NULL) {
+        dir_free(fs->root.dir);
+    }
+    free(fs->fat);
+    pthread_rwlock_destroy(&fs->lock);
+    free(fs);
+}
+
+static const kora_vfs_ops_t fatfs_ops = {
+    .name = "fatfs",
+    .open = fatfs_open,
+    .close = fatfs_close,
+    .read = fatfs_read,
+    .write = fatfs_write,
+    .seek = fatfs_seek,
+    .fstat = fatfs_fstat,
+    .fget_info = fatfs_fget_info,
+    .opendir = fatfs_opendir,
+    .readdir = fatfs_readdir,
+    .closedir = fatfs_closedir,
+    .mkdir = fatfs_mkdir,
+    .rmdir = fatfs_rmdir,
+    .unlink = fatfs_unlink,
+    .rename = fatfs_rename,
+    .link = fatfs_link,
+    .symlink = fatfs_symlink,
+    .readlink = fatfs_readlink,
+    .stat = fatfs_stat,
+    .lstat = fatfs_stat,  /* No symlinks */
+    .get_info = fatfs_get_info,
+    .utime = fatfs_utime,
+    .destroy = fatfs_destroy,
+};
+
+/* Check the boot sector and derive the layout; 0 or -EINVAL */
+static int parse_boot_sector(fatfs_t *fs) {
+    uint8_t b[512];
+    if (fs->image_size < 512 || kora_bdev_read(fs->dev, 0, b, sizeof(b), 0) != 0) {
+        return -EINVAL;
+    }
+    uint32_t bps = get16(b + 11);
+    uint32_t spc = b[13];
+    uint32_t reserved = get16(b + 14);
+    uint32_t num_fats = b[16];
+    uint32_t root_entries = get16(b + 17);
+    uint32_t total = get16(b + 19) ? get16(b + 19) : get32(b + 32);
+    uint32_t fat_sectors = get16(b + 22) ? get16(b + 22) : get32(b + 36);
+
+    if ((bps != 512 && bps != 1024 && bps != 2048 && bps != 4096) || spc == 0 || (spc & (spc - 1)) ||
+        reserved == 0 || num_fats == 0 || fat_sectors == 0 || (uint64_t)total * bps > fs->image_size) {
+        return -EINVAL;
+    }
+    uint32_t root_sectors = (root_entries * DIRENT_SIZE + bps - 1) / bps;
+    uint64_t data_sector = reserved + (uint64_t)num_fats * fat_sectors + root_sectors;
+    if (data_sector >= total) {
+        return -EINVAL;
+    }
+    fs->cluster_size = bps * spc;
+    fs->clusters = (uint32_t)((total - data_sector) / spc);
+    fs->bits = fs->clusters < 4085 ? 12 : fs->clusters < 65525 ? 16 : 32;
+    fs->num_fats = num_fats;
+    fs->fat_offset = (uint64_t)reserved * bps;
+    fs->fat_bytes = fat_sectors * bps;
+    fs->root_offset = fs->fat_offset + (uint64_t)num_fats * fs->fat_bytes;
+    fs->root_slots = root_entries;
+    fs->data_offset = data_sector * bps;
+
+    /* The FAT must hold an entry for every cluster */
+    uint64_t fat_need = fs->bits == 12 ? ((uint64_t)fs->clusters + 2) * 3 / 2 + 1 :
+                        ((uint64_t)fs->clusters + 2) * (uint64_t)(fs->bits / 8);
+    if (fat_need > fs->fat_bytes || (fs->bits == 32 ? root_entries != 0 : root_entries == 0)) {
+        return -EINVAL;
+    }
+    fs->root.attr = ATTR_DIR;
+    fs->root.name = NULL;
+    if (fs->bits == 32) {
+        fs->root.cluster = get32(b + 44);
+        if (!cluster_valid(fs, fs->root.cluster)) {
+            return -EINVAL;
+        }
+        uint32_t fsinfo = get16(b + 48);
+        uint8_t sig[4];
+        if (fsinfo != 0 && fsinfo != 0xFFFF && (uint64_t)(fsinfo + 1) * bps <= fs->image_size &&
+            kora_bdev_read(fs->dev, (uint64_t)fsinfo * bps, sig, 4, 0) == 0 && get32(sig) == 0x41615252) {
+            fs->fsinfo_offset = (uint64_t)fsinfo * bps;
+        }
+    }
+    return 0;
+}
+
+static int fatfs_open_image(fatfs_t *fs, const char *image, unsigned flags) {
+    struct stat st;
+
+    fs->rdonly = (flags & KORA_MOUNT_RDONLY) != 0;
+    int fd = open(image, fs->rdonly ? O_RDONLY : O_RDWR);
+    if (fd < 0) {
+        return -errno;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return -EINVAL;
+    }
+    fs->image_size = (uint64_t)st.st_size;
+    int r = kora_bdev_open(fd, fs->image_size, fs->rdonly, &fs->dev);
+    if (r != 0) {
+        close(fd);
+        return r;
+    }
+
+    /* The first FAT copy is read once, through the cache it is then updated in */
+    uint8_t *fat = NULL;
+    r = parse_boot_sector(fs);
+    if (r == 0) {
+        fs->fat = malloc(((size_t)fs->clusters + 2) * sizeof(*fs->fat));
+        fat = malloc(fs->fat_bytes);
+        r = fs->fat != NULL && fat != NULL ? 0 : -ENOMEM;
+    }
+    if (r == 0) {
+        r = kora_bdev_read(fs->dev, fs->fat_offset, fat, fs->fat_bytes, 0);
+    }
+    if (r != 0) {
+        free(fat);
+        free(fs->fat);
+        kora_bdev_close(fs->dev);
+        return r;
+    }
+    fs->fat[0] = fs->fat[1] = FAT_EOC;
+    for (uint32_t c = 2; c < fs->clusters + 2; c++) {
+        fs->fat[c] = fat_decode(fs, fat, c);
+        fs->free_count += fs->fat[c] == 0;
+    }
+    free(fat);
+    fs->next_free = 2;
+    return 0;
+}
+
+int kora_fatfs_mount(const char *image, const char *prefix, unsigned flags) {
+    if (image == NULL || prefix == NULL || prefix[0] != '/') {
+        errno = EINVAL;
+        return KORA_ERROR;
+    }
+    fatfs_t *fs = calloc(1, sizeof(*fs));
+    if (fs == NULL) {
+        errno = ENOMEM;
+        return KORA_ERROR;
+    }
+    int r = fatfs_open_image(fs, image, flags);
+    if (r != 0) {
+        free(fs);
+        errno = -r;
+        return KORA_ERROR;
+    }
+    fs->base.ops = &fatfs_ops;
+    pthread_rwlock_init(&fs->lock, NULL);
+    r = kora_vfs_mount(prefix, &fs->base);
+    if (r != 0) {
+        fatfs_destroy(&fs->base);
+        errno = -r;
+        return KORA_ERROR;
+    }
+    return KORA_SUCCESS;
+}
+
+int kora_fatfs_unmount(const char *prefix) {
+    int r = kora_vfs_unmount(prefix, &fatfs_ops);
+    if (r != 0) {
+        errno = -r;
+        return KORA_ERROR;
+    }
+    return KORA_SUCCESS;
+}
+
+#else /* KORA_PLATFORM_WINDOWS */
+
+int kora_fatfs_mount(const char *image, const char *prefix, unsigned flags) {
+    (void)image; (void)prefix; (void)flags;
+    errno = ENOTSUP;
+    return KORA_ERROR;
+}
+
+int kora_fatfs_unmount(const char *prefix) {
+    (void)prefix;
+    errno = EINVAL;
+    return KORA_ERROR;
+}
+
+#endif
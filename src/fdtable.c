@@ -0,0 +1,256 @@
+#include <internal/fdtable.h>
+#include <kora/syscalls.h>
+#include <errno.h>
+#include <stdlib.h>
+
+#if !defined(KORA_PLATFORM_WINDOWS)
+#include <pthread.h>
+#endif
+
+/**
+ * Descriptor table
+ *
+ * Lookups never lock: chunks are published with a release store and
+ * never freed, and a layer entry's owner is cleared before its number
+ * is reused. fd_lock serialises allocating chunks and numbers and
+ * registering slots. A slot's release callback is written before the
+ * slot count that makes it visible, so it is read without the lock.
+ */
+
+_Atomic(kora_fd_entry_t *) kora_fd_chunks[2][KORA_FD_CHUNKS];
+atomic_int kora_fd_slots_used = 0;
+
+#if !defined(KORA_PLATFORM_WINDOWS)
+
+static pthread_mutex_t fd_lock = PTHREAD_MUTEX_INITIALIZER;
+static kora_fd_release_t releases[KORA_FD_SLOTS];
+static size_t *free_indices;  /* Released layer descriptors, under fd_lock */
+static size_t free_count;
+static size_t free_cap;
+static size_t next_index;     /* First never-used layer descriptor, under fd_lock */
+
+/* Entry in a range, allocating its chunk; under fd_lock */
+static kora_fd_entry_t *entry_create(int layer, size_t index) {
+    _Atomic(kora_fd_entry_t *) *dir = &kora_fd_chunks[layer][index / KORA_FD_CHUNK];
+    kora_fd_entry_t *chunk = atomic_load_explicit(dir, memory_order_relaxed);
+
+    if (chunk == NULL) {
+        chunk = calloc(KORA_FD_CHUNK, sizeof(*chunk));
+        if (chunk == NULL) {
+            return NULL;
+        }
+        atomic_store_explicit(dir, chunk, memory_order_release);
+    }
+    return &chunk[index % KORA_FD_CHUNK];
+}
+
+static void release_slots(int fd, kora_fd_entry_t *e) {
+    int used = atomic_load_explicit(&kora_fd_slots_used, memory_order_acquire);
+
+    for (int i = 0; i < used; i++) {
+        void *value = atomic_exchange_explicit(&e->slots[i], NULL, memory_order_acq_rel);
+        if (value != NULL && releases[i] != NULL) {
+            releases[i](fd, value);
+        }
+    }
+}
+
+int kora_fd_alloc(void *owner, const char *backend, void *handle, unsigned flags) {
+    size_t index;
+
+    pthread_mutex_lock(&fd_lock);
+    int reused = free_count > 0;
+    if (reused) {
+        index = free_indices[--free_count];
+    } else if (next_index < (size_t)KORA_FD_CHUNK * KORA_FD_CHUNKS) {
+        index = next_index++;
+    } else {
+        pthread_mutex_unlock(&fd_lock);
+        return -EMFILE;
+    }
+    kora_fd_entry_t *e = entry_create(1, index);
+    if (e == NULL) {
+        if (reused) {
+            free_count++;
+        } else {
+            next_index--;
+        }
+        pthread_mutex_unlock(&fd_lock);
+        return -ENOMEM;
+    }
+    e->backend = backend;
+    atomic_store_explicit(&e->handle, handle, memory_order_relaxed);
+    e->flags = flags;
+    atomic_store_explicit(&e->owner, owner, memory_order_release);
+    pthread_mutex_unlock(&fd_lock);
+    return KORA_FD_LAYER_BASE + (int)index;
+}
+
+void kora_fd_free(int fd) {
+    kora_fd_entry_t *e = kora_fd_entry(fd);
+
+    release_slots(fd, e);
+    pthread_mutex_lock(&fd_lock);
+    atomic_store_explicit(&e->owner, NULL, memory_order_release);
+    if (free_count == free_cap) {
+        size_t cap = free_cap ? free_cap * 2 : 256;
+        size_t *indices = realloc(free_indices, cap * sizeof(*indices));
+        if (indices == NULL) {
+            /* Leak the number rather than fail the close */
+            pthread_mutex_unlock(&fd_lock);
+            return;
+        }
+        free_indices = indices;
+        free_cap = cap;
+    }
+    free_indices[free_count++] = (size_t)(fd - KORA_FD_LAYER_BASE);
+    pthread_mutex_unlock(&fd_lock);
+}
+
+void kora_fd_closed(int fd) {
+    kora_fd_entry_t *e = kora_fd_entry(fd);
+
+    if (e != NULL) {
+        release_slots(fd, e);
+    }
+}
+
+int kora_fd_attach(int fd, void *handle) {
+    kora_fd_entry_t *e = fd < KORA_FD_LAYER_BASE ? kora_fd_entry(fd) : NULL;
+
+    if (e == NULL) {
+        if (fd < 0 || (size_t)fd >= (size_t)KORA_FD_CHUNK * KORA_FD_CHUNKS) {
+            return -EBADF;
+        }
+        pthread_mutex_lock(&fd_lock);
+        e = entry_create(0, (size_t)fd);
+        pthread_mutex_unlock(&fd_lock);
+        if (e == NULL) {
+            return -ENOMEM;
+        }
+    }
+    atomic_store_explicit(&e->handle, handle, memory_order_release);
+    return 0;
+}
+
+void *kora_fd_detach(int fd) {
+    kora_fd_entry_t *e = fd < KORA_FD_LAYER_BASE ? kora_fd_entry(fd) : NULL;
+
+    return e != NULL ? atomic_exchange_explicit(&e->handle, NULL, memory_order_acq_rel) : NULL;
+}
+
+int kora_fd_slot_register(kora_fd_release_t release) {
+    pthread_mutex_lock(&fd_lock);
+    int slot = atomic_load_explicit(&kora_fd_slots_used, memory_order_relaxed);
+    if (slot == KORA_FD_SLOTS) {
+        pthread_mutex_unlock(&fd_lock);
+        errno = ENOSPC;
+        return KORA_ERROR;
+    }
+    releases[slot] = release;
+    atomic_store_explicit(&kora_fd_slots_used, slot + 1, memory_order_release);
+    pthread_mutex_unlock(&fd_lock);
+    return slot;
+}
+
+int kora_fd_set(int fd, int slot, void *value) {
+    if (slot < 0 || slot >= atomic_load_explicit(&kora_fd_slots_used, memory_order_acquire)) {
+        errno = EINVAL;
+        return KORA_ERROR;
+    }
+    kora_fd_entry_t *e = kora_fd_entry(fd);
+    if (fd >= KORA_FD_LAYER_BASE) {
+        if (e == NULL || atomic_load_explicit(&e->owner, memory_order_acquire) == NULL) {
+            errno = EBADF;
+            return KORA_ERROR;
+        }
+    } else if (e == NULL) {
+        if (fd < 0 || (size_t)fd >= (size_t)KORA_FD_CHUNK * KORA_FD_CHUNKS) {
+            errno = EBADF;
+            return KORA_ERROR;
+        }
+        pthread_mutex_lock(&fd_lock);
+        e = entry_create(0, (size_t)fd);
+        pthread_mutex_unlock(&fd_lock);
+        if (e == NULL) {
+            errno = ENOMEM;
+            return KORA_ERROR;
+        }
+    }
+
+    void *old = atomic_exchange_explicit(&e->slots[slot], value, memory_order_acq_rel);
+    if (old != NULL && old != value && releases[slot] != NULL) {
+        releases[slot](fd, old);
+    }
+    return KORA_SUCCESS;
+}
+
+void *kora_fd_get(int fd, int slot) {
+    if (slot < 0 || slot >= KORA_FD_SLOTS) {
+        return NULL;
+    }
+    kora_fd_entry_t *e = kora_fd_entry(fd);
+    return e != NULL ? atomic_load_explicit(&e->slots[slot], memory_order_acquire) : NULL;
+}
+
+const char *kora_fd_backend(int fd) {
+    if (fd < 0) {
+        return NULL;
+    }
+    if (fd < KORA_FD_LAYER_BASE) {
+        return "host";
+    }
+    kora_fd_entry_t *e = kora_fd_entry(fd);
+    if (e == NULL || atomic_load_explicit(&e->owner, memory_order_acquire) == NULL) {
+        return NULL;
+    }
+    return e->backend;
+}
+
+#else /* KORA_PLATFORM_WINDOWS */
+
+int kora_fd_alloc(void *owner, const char *backend, void *handle, unsigned flags) {
+    (void)owner; (void)backend; (void)handle; (void)flags;
+    return -ENOSYS;
+}
+
+void kora_fd_free(int fd) {
+    (void)fd;
+}
+
+void kora_fd_closed(int fd) {
+    (void)fd;
+}
+
+int kora_fd_attach(int fd, void *handle) {
+    (void)fd; (void)handle;
+    return -ENOSYS;
+}
+
+void *kora_fd_detach(int fd) {
+    (void)fd;
+    return NULL;
+}
+
+int kora_fd_slot_register(kora_fd_release_t release) {
+    (void)release;
+    errno = ENOTSUP;
+    return KORA_ERROR;
+}
+
+int kora_fd_set(int fd, int slot, void *value) {
+    (void)fd; (void)slot; (void)value;
+    errno = EINVAL;
+    return KORA_ERROR;
+}
+
+void *kora_fd_get(int fd, int slot) {
+    (void)fd; (void)slot;
+    return NULL;
+}
+
+const char *kora_fd_backend(int fd) {
+    return fd >= 0 ? "host" : NULL;
+}
+
+#endif
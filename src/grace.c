@@ -0,0 +1,168 @@
+#include <internal/error.h>
+#include <internal/grace.h>
+#include <kora/syscalls.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#if !defined(KORA_PLATFORM_WINDOWS)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/**
+ * Grace periods
+ *
+ * Every thread that enters a section gets a reader of its own, on its
+ * own cache line, so sections on different threads share no writes. The
+ * low half of a reader's word counts the sections it has open, nested
+ * ones included, and the high half is bumped each time that count drops
+ * back to zero. Readers are kept on a list that only grows; one left by
+ * an exited thread is reused by the next new thread.
+ */
+
+#if !defined(KORA_PLATFORM_WINDOWS)
+
+#define CACHE_LINE    64
+#define READER_OPEN   0xffffffffull  /* Low half: sections open */
+#define READER_DONE   (1ull << 32)   /* Added when they drop to zero */
+#define WAIT_BATCH    64             /* Readers a wait tracks at once */
+
+typedef struct reader {
+    _Alignas(CACHE_LINE) atomic_ullong word;
+    struct reader *next;
+    atomic_int live;  /* Owned by a thread; cleared when it exits */
+} reader_t;
+
+/* Shared by threads that could not allocate their own */
+static reader_t spare = { .live = 1 };
+static _Atomic(reader_t *) readers = &spare;
+static KORA_THREAD_LOCAL reader_t *thread_reader;
+static KORA_THREAD_LOCAL int held;
+static pthread_once_t reader_once = PTHREAD_ONCE_INIT;
+static pthread_key_t reader_key;
+
+static void reader_release(void *reader) {
+    atomic_store_explicit(&((reader_t *)reader)->live, 0, memory_order_release);
+}
+
+static void reader_init(void) {
+    pthread_key_create(&reader_key, reader_release);
+}
+
+static reader_t *reader_attach(void) {
+    reader_t *reader;
+
+    pthread_once(&reader_once, reader_init);
+
+    /* Reuse one left by an exited thread; it has no sections open */
+    for (reader = atomic_load_explicit(&readers, memory_order_acquire); reader != NULL;
+         reader = reader->next) {
+        int expected = 0;
+        if (atomic_compare_exchange_strong(&reader->live, &expected, 1)) {
+            break;
+        }
+    }
+    if (reader == NULL) {
+        reader = aligned_alloc(CACHE_LINE, sizeof(*reader));
+        if (reader == NULL) {
+            thread_reader = &spare;
+            return thread_reader;
+        }
+        atomic_init(&reader->word, 0);
+        atomic_init(&reader->live, 1);
+        reader->next = atomic_load_explicit(&readers, memory_order_relaxed);
+        /* seq_cst: a wait that misses the new reader comes before its first section */
+        while (!atomic_compare_exchange_weak_explicit(&readers, &reader->next, reader,
+                                                      memory_order_seq_cst,
+                                                      memory_order_relaxed)) {
+        }
+    }
+    pthread_setspecific(reader_key, reader);
+    thread_reader = reader;
+    return reader;
+}
+
+int kora_grace_enter(void) {
+    int outer = held;
+    reader_t *reader = thread_reader != NULL ? thread_reader : reader_attach();
+    /* seq_cst orders the count before the reader loads what it protects */
+    atomic_fetch_add_explicit(&reader->word, 1, memory_order_seq_cst);
+    held = 1;
+    return outer;
+}
+
+void kora_grace_leave(void) {
+    if (held) {
+        reader_t *reader = thread_reader;
+        uint64_t w = atomic_fetch_sub_explicit(&reader->word, 1, memory_order_release);
+        if ((w & READER_OPEN) == 1) {
+            atomic_fetch_add_explicit(&reader->word, READER_DONE, memory_order_relaxed);
+        }
+        held = 0;
+    }
+}
+
+void kora_grace_exit(int outer) {
+    kora_grace_leave();
+    held = outer;
+}
+
+/*
+ * The readers with sections open are noted a batch at a time, and each
+ * is waited on until its count reaches zero, which bumps its high half
+ * even if a new section starts at once. A pass over the batch yields
+ * once, so many busy readers cost a few passes rather than a yield each.
+ */
+int kora_grace_wait(void) {
+    reader_t *batch[WAIT_BATCH];
+    uint64_t seen[WAIT_BATCH];
+    reader_t *reader = atomic_load_explicit(&readers, memory_order_seq_cst);
+
+    while (reader != NULL) {
+        size_t n = 0;
+        for (; reader != NULL && n < WAIT_BATCH; reader = reader->next) {
+            uint64_t w = atomic_load_explicit(&reader->word, memory_order_seq_cst);
+            if ((w & READER_OPEN) != 0) {
+                batch[n] = reader;
+                seen[n++] = w;
+            }
+        }
+        while (n > 0) {
+            for (size_t i = 0; i < n;) {
+                uint64_t now = atomic_load_explicit(&batch[i]->word, memory_order_acquire);
+                if ((now & READER_OPEN) == 0 || (now >> 32) != (seen[i] >> 32)) {
+                    n--;
+                    batch[i] = batch[n];
+                    seen[i] = seen[n];
+                } else {
+                    i++;
+                }
+            }
+            if (n > 0) {
+                sched_yield();
+            }
+        }
+    }
+    return 0;
+}
+
+#else /* KORA_PLATFORM_WINDOWS */
+
+int kora_grace_enter(void) {
+    return 0;
+}
+
+void kora_grace_leave(void) {
+}
+
+void kora_grace_exit(int outer) {
+    (void)outer;
+}
+
+int kora_grace_wait(void) {
+    return -ENOTSUP;
+}
+
+#endif
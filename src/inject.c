@@ -0,0 +1,534 @@
+#include <internal/error.h>
+#include <internal/grace.h>
+#include <internal/inject.h>
+#include <kora/syscalls.h>
+#include <kora/trace.h>
+#include <ctype.h>
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(KORA_PLATFORM_WINDOWS)
+#include <windows.h>
+#endif
+
+/**
+ * Latency and fault injection
+ *
+ * A configuration is parsed into an immutable table of per-call rules
+ * and published with one atomic pointer store, so the hooks read it
+ * without locks. A replaced table is freed once the calls that may be
+ * using it have left their grace sections; the hooks make every draw
+ * inside the section and sleep after it, so a long injected delay does
+ * not hold up reconfiguring. Random draws come from a per-thread
+ * xorshift generator seeded from the configured seed and the order in
+ * which threads first hit a rule.
+ */
+
+#define INJECT_CALLS 128  /* Above every SYS_* number */
+
+atomic_int kora_inject_active = 0;
+
+#if !defined(KORA_NO_INJECT)
+
+enum { DIST_FIXED, DIST_UNIFORM, DIST_EXP, DIST_PARETO };
+
+typedef struct {
+    int dist;
+    double a;     /* Time, or shape for pareto */
+    double b;
+    double rate;
+} inject_delay_t;
+
+typedef struct {
+    int set;
+    int ndelays;
+    inject_delay_t delays[KORA_INJECT_MAX_DELAYS];
+    double short_rate;
+    double eintr;
+    double eagain;
+    double enospc;
+} inject_rule_t;
+
+typedef struct {
+    uint64_t seed;
+    uint64_t generation;  /* Tells threads to reseed; addresses get reused */
+    inject_rule_t rules[INJECT_CALLS];
+} inject_config_t;
+
+typedef struct {
+    _Atomic uint64_t calls;
+    _Atomic uint64_t delayed;
+    _Atomic uint64_t delay_ns;
+    _Atomic uint64_t shortened;
+    _Atomic uint64_t failed;
+} inject_counters_t;
+
+/* Calls with hooks in internal/dispatch.h, and whether they take a count */
+enum { HOOKED = 1, HOOKED_COUNT = 2 };
+
+static const unsigned char hooked[INJECT_CALLS] = {
+    [SYS_OPEN]          = HOOKED,
+    [SYS_CLOSE]         = HOOKED,
+    [SYS_READ]          = HOOKED | HOOKED_COUNT,
+    [SYS_WRITE]         = HOOKED | HOOKED_COUNT,
+    [SYS_SEEK]          = HOOKED,
+    [SYS_READAHEAD]     = HOOKED,
+    [SYS_MKDIR]         = HOOKED,
+    [SYS_RMDIR]         = HOOKED,
+    [SYS_OPENDIR]       = HOOKED,
+    [SYS_READDIR]       = HOOKED,
+    [SYS_SYMLINK]       = HOOKED,
+    [SYS_READLINK]      = HOOKED,
+    [SYS_GET_FILE_INFO] = HOOKED,
+    [SYS_GET_FD_INFO]   = HOOKED,
+    [SYS_STAT]          = HOOKED,
+    [SYS_FSTAT]         = HOOKED,
+    [SYS_LSTAT]         = HOOKED,
+    [SYS_UNLINK]        = HOOKED,
+    [SYS_RENAME]        = HOOKED,
+    [SYS_LINK]          = HOOKED,
+    [SYS_UTIME]         = HOOKED,
+    [SYS_SPAWN]         = HOOKED,
+    [SYS_WAIT]          = HOOKED,
+    [SYS_WAIT4]         = HOOKED,
+    [SYS_SPLICE]        = HOOKED | HOOKED_COUNT,
+    [SYS_TEE]           = HOOKED | HOOKED_COUNT,
+};
+
+static _Atomic(inject_config_t *) config;  /* Read inside a grace section */
+static inject_counters_t counters[INJECT_CALLS];
+static atomic_uint_fast64_t thread_seq;
+static atomic_uint_fast64_t generations;
+static KORA_THREAD_LOCAL uint64_t rng_state;
+static KORA_THREAD_LOCAL uint64_t rng_generation;
+
+/* xorshift64*, reseeded whenever the thread sees a new configuration */
+static uint64_t next_random(const inject_config_t *cfg) {
+    if (rng_generation != cfg->generation) {
+        uint64_t n = atomic_fetch_add_explicit(&thread_seq, 1, memory_order_relaxed);
+        rng_state = (cfg->seed ^ (n * 0x9e3779b97f4a7c15ull)) | 1;
+        rng_generation = cfg->generation;
+    }
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545f4914f6cdd1dull;
+}
+
+/* Uniform in (0, 1] */
+static double next_unit(const inject_config_t *cfg) {
+    return ((next_random(cfg) >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+static uint64_t sample_delay(const inject_config_t *cfg, const inject_delay_t *d) {
+    double ns;
+    if (d->rate < 1.0 && next_unit(cfg) > d->rate) {
+        return 0;
+    }
+    switch (d->dist) {
+    case DIST_UNIFORM:
+        ns = d->a + (d->b - d->a) * next_unit(cfg);
+        break;
+    case DIST_EXP:
+        ns = -d->a * log(next_unit(cfg));
+        break;
+    case DIST_PARETO:
+        ns = d->a / pow(next_unit(cfg), 1.0 / d->b);
+        break;
+    default:
+        ns = d->a;
+        break;
+    }
+    /* Keep a heavy tail from sleeping for ever */
+    return ns < 3.6e12 ? (uint64_t)ns : (uint64_t)3.6e12;
+}
+
+static void sleep_ns(uint64_t ns) {
+#if defined(KORA_PLATFORM_WINDOWS)
+    Sleep((DWORD)(ns / 1000000u));
+#else
+    struct timespec req = { (time_t)(ns / 1000000000u), (long)(ns % 1000000000u) };
+    while (nanosleep(&req, &req) != 0 && errno == EINTR) {
+    }
+#endif
+}
+
+int kora_inject_enter(int syscall, size_t *count) {
+    if (syscall <= 0 || syscall >= INJECT_CALLS) {
+        return 0;
+    }
+    /* Every draw is made inside the section; the sleep comes after it */
+    int outer = kora_grace_enter();
+    const inject_config_t *cfg = atomic_load_explicit(&config, memory_order_seq_cst);
+    if (cfg == NULL || !cfg->rules[syscall].set) {
+        kora_grace_exit(outer);
+        return 0;
+    }
+    const inject_rule_t *rule = &cfg->rules[syscall];
+    inject_counters_t *c = &counters[syscall];
+    int saved_errno = errno;
+
+    atomic_fetch_add_explicit(&c->calls, 1, memory_order_relaxed);
+
+    uint64_t delay = 0;
+    for (int i = 0; i < rule->ndelays; i++) {
+        delay += sample_delay(cfg, &rule->delays[i]);
+    }
+
+    int err = 0;
+    if (rule->eintr + rule->eagain + rule->enospc > 0) {
+        double u = next_unit(cfg);
+        if (u <= rule->eintr) {
+            err = EINTR;
+        } else if (u <= rule->eintr + rule->eagain) {
+            err = EAGAIN;
+        } else if (u <= rule->eintr + rule->eagain + rule->enospc) {
+            err = ENOSPC;
+        }
+    }
+
+    size_t shortened = 0;
+    if (err == 0 && count != NULL && *count > 1 && rule->short_rate > 0 &&
+        next_unit(cfg) <= rule->short_rate) {
+        shortened = 1 + (size_t)(next_random(cfg) % (*count - 1));
+    }
+    kora_grace_exit(outer);
+
+    if (delay > 0) {
+        sleep_ns(delay);
+        atomic_fetch_add_explicit(&c->delayed, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&c->delay_ns, delay, memory_order_relaxed);
+    }
+    if (err != 0) {
+        atomic_fetch_add_explicit(&c->failed, 1, memory_order_relaxed);
+        kora_record_error(syscall, err);
+        return err;
+    }
+    if (shortened != 0) {
+        *count = shortened;
+        atomic_fetch_add_explicit(&c->shortened, 1, memory_order_relaxed);
+    }
+    errno = saved_errno;
+    return 0;
+}
+
+int kora_inject_enter_errno(int syscall, size_t *count) {
+    int err = kora_inject_enter(syscall, count);
+    if (err != 0) {
+        errno = err;
+    }
+    return err;
+}
+
+/*
+ * Spec parsing; every parser advances *s past what it accepted and
+ * returns -1 on malformed input
+ */
+
+static void skip_space(const char **s) {
+    while (isspace((unsigned char)**s)) {
+        (*s)++;
+    }
+}
+
+static int parse_number(const char **s, double *out) {
+    char *end;
+    skip_space(s);
+    *out = strtod(*s, &end);
+    if (end == *s || *out < 0) {
+        return -1;
+    }
+    *s = end;
+    return 0;
+}
+
+static int parse_time(const char **s, double *ns) {
+    static const struct {
+        const char *suffix;
+        double scale;
+    } units[] = { { "ns", 1 }, { "us", 1e3 }, { "ms", 1e6 }, { "s", 1e9 } };
+
+    if (parse_number(s, ns) != 0) {
+        return -1;
+    }
+    for (size_t i = 0; i < sizeof(units) / sizeof(units[0]); i++) {
+        size_t len = strlen(units[i].suffix);
+        if (strncmp(*s, units[i].suffix, len) == 0) {
+            *ns *= units[i].scale;
+            *s += len;
+            break;
+        }
+    }
+    return 0;
+}
+
+static int parse_rate(const char **s, double *rate) {
+    if (parse_number(s, rate) != 0) {
+        return -1;
+    }
+    if (**s == '%') {
+        *rate /= 100;
+        (*s)++;
+    }
+    return *rate <= 1.0 ? 0 : -1;
+}
+
+static int expect(const char **s, char c) {
+    skip_space(s);
+    if (**s != c) {
+        return -1;
+    }
+    (*s)++;
+    return 0;
+}
+
+static int parse_delay(const char **s, inject_delay_t *d) {
+    static const struct {
+        const char *name;
+        int dist;
+        int params;
+    } dists[] = {
+        { "fixed(", DIST_FIXED, 1 },
+        { "uniform(", DIST_UNIFORM, 2 },
+        { "exp(", DIST_EXP, 1 },
+        { "pareto(", DIST_PARETO, 2 },
+    };
+
+    d->dist = -1;
+    d->rate = 1.0;
+    skip_space(s);
+    for (size_t i = 0; i < sizeof(dists) / sizeof(dists[0]); i++) {
+        size_t len = strlen(dists[i].name);
+        if (strncmp(*s, dists[i].name, len) == 0) {
+            d->dist = dists[i].dist;
+            *s += len;
+            if (parse_time(s, &d->a) != 0) {
+                return -1;
+            }
+            if (dists[i].params == 2) {
+                /* The second pareto parameter is a shape, not a time */
+                int ok = expect(s, ',') == 0 &&
+                         (d->dist == DIST_PARETO ? parse_number(s, &d->b) : parse_time(s, &d->b)) == 0;
+                if (!ok) {
+                    return -1;
+                }
+            }
+            if (expect(s, ')') != 0) {
+                return -1;
+            }
+            break;
+        }
+    }
+    if (d->dist < 0) {
+        d->dist = DIST_FIXED;
+        if (parse_time(s, &d->a) != 0) {
+            return -1;
+        }
+    }
+    if ((d->dist == DIST_UNIFORM && d->b < d->a) || (d->dist == DIST_PARETO && d->b <= 0)) {
+        return -1;
+    }
+    skip_space(s);
+    if (**s == '@') {
+        (*s)++;
+        return parse_rate(s, &d->rate);
+    }
+    return 0;
+}
+
+static int parse_option(const char **s, inject_rule_t *rule, int flags) {
+    static const struct {
+        const char *name;
+        size_t offset;
+    } rates[] = {
+        { "short=", offsetof(inject_rule_t, short_rate) },
+        { "eintr=", offsetof(inject_rule_t, eintr) },
+        { "eagain=", offsetof(inject_rule_t, eagain) },
+        { "enospc=", offsetof(inject_rule_t, enospc) },
+    };
+
+    skip_space(s);
+    if (strncmp(*s, "delay=", 6) == 0) {
+        *s += 6;
+        if (rule->ndelays == KORA_INJECT_MAX_DELAYS) {
+            return -1;
+        }
+        return parse_delay(s, &rule->delays[rule->ndelays++]);
+    }
+    for (size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+        size_t len = strlen(rates[i].name);
+        if (strncmp(*s, rates[i].name, len) == 0) {
+            if (i == 0 && !(flags & HOOKED_COUNT)) {
+                return -1;
+            }
+            *s += len;
+            return parse_rate(s, (double *)((char *)rule + rates[i].offset));
+        }
+    }
+    return -1;
+}
+
+static int lookup_call(const char *name, size_t len) {
+    for (int i = 1; i < INJECT_CALLS; i++) {
+        const char *n = kora_syscall_name(i);
+        if (n != NULL && strlen(n) == len && strncmp(n, name, len) == 0) {
+            return hooked[i] ? i : -1;
+        }
+    }
+    return -1;
+}
+
+static int parse_rule(const char **s, inject_config_t *cfg) {
+    skip_space(s);
+    const char *name = *s;
+    while (**s != '\0' && **s != ':' && **s != '=' && **s != ';' && !isspace((unsigned char)**s)) {
+        (*s)++;
+    }
+    size_t len = (size_t)(*s - name);
+    skip_space(s);
+
+    if (len == 4 && strncmp(name, "seed", 4) == 0 && **s == '=') {
+        char *end;
+        (*s)++;
+        cfg->seed = strtoull(*s, &end, 0);
+        if (end == *s) {
+            return -1;
+        }
+        *s = end;
+        return 0;
+    }
+
+    int all = len == 1 && name[0] == '*';
+    int call = all ? 0 : lookup_call(name, len);
+    if ((!all && call < 0) || expect(s, ':') != 0) {
+        return -1;
+    }
+
+    /* A wildcard rule only gets options that every hooked call supports */
+    inject_rule_t rule = { 0 };
+    rule.set = 1;
+    for (;;) {
+        if (parse_option(s, &rule, all ? HOOKED : hooked[call]) != 0) {
+            return -1;
+        }
+        skip_space(s);
+        if (**s != ',') {
+            break;
+        }
+        (*s)++;
+    }
+
+    for (int i = all ? 1 : call; i <= (all ? INJECT_CALLS - 1 : call); i++) {
+        if (hooked[i]) {
+            cfg->rules[i] = rule;
+        }
+    }
+    return 0;
+}
+
+int kora_inject_configure(const char *spec) {
+    inject_config_t *cfg = NULL;
+    int any = 0;
+
+    if (spec != NULL) {
+        cfg = calloc(1, sizeof(*cfg));
+        if (cfg == NULL) {
+            return KORA_ERROR;
+        }
+        cfg->seed = 0x6b6f7261u;  /* "kora" */
+        cfg->generation = atomic_fetch_add_explicit(&generations, 1, memory_order_relaxed) + 1;
+        const char *s = spec;
+        skip_space(&s);
+        while (*s != '\0') {
+            if (parse_rule(&s, cfg) != 0 || (expect(&s, ';') != 0 && *s != '\0')) {
+                free(cfg);
+                errno = EINVAL;
+                return KORA_ERROR;
+            }
+            skip_space(&s);
+        }
+        for (int i = 0; i < INJECT_CALLS; i++) {
+            any |= cfg->rules[i].set;
+        }
+    }
+
+    atomic_store_explicit(&kora_inject_active, 0, memory_order_relaxed);
+    for (int i = 0; i < INJECT_CALLS; i++) {
+        atomic_store_explicit(&counters[i].calls, 0, memory_order_relaxed);
+        atomic_store_explicit(&counters[i].delayed, 0, memory_order_relaxed);
+        atomic_store_explicit(&counters[i].delay_ns, 0, memory_order_relaxed);
+        atomic_store_explicit(&counters[i].shortened, 0, memory_order_relaxed);
+        atomic_store_explicit(&counters[i].failed, 0, memory_order_relaxed);
+    }
+    if (!any) {
+        free(cfg);
+        cfg = NULL;
+    }
+    atomic_store_explicit(&thread_seq, 0, memory_order_relaxed);
+    inject_config_t *old = atomic_exchange_explicit(&config, cfg, memory_order_seq_cst);
+    atomic_store_explicit(&kora_inject_active, any, memory_order_relaxed);
+    if (old != NULL && kora_grace_wait() == 0) {
+        free(old);
+    }
+    return KORA_SUCCESS;
+}
+
+int kora_inject_enabled(void) {
+    return atomic_load_explicit(&kora_inject_active, memory_order_relaxed);
+}
+
+void kora_inject_stats(int syscall, kora_inject_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    if (syscall <= 0 || syscall >= INJECT_CALLS) {
+        return;
+    }
+    inject_counters_t *c = &counters[syscall];
+    stats->calls = atomic_load_explicit(&c->calls, memory_order_relaxed);
+    stats->delayed = atomic_load_explicit(&c->delayed, memory_order_relaxed);
+    stats->delay_ns = atomic_load_explicit(&c->delay_ns, memory_order_relaxed);
+    stats->shortened = atomic_load_explicit(&c->shortened, memory_order_relaxed);
+    stats->failed = atomic_load_explicit(&c->failed, memory_order_relaxed);
+}
+
+#if defined(__GNUC__)
+__attribute__((constructor))
+static void inject_from_env(void) {
+    const char *spec = getenv("KORA_INJECT");
+    /* A malformed spec is ignored, like a bad KORA_TRACE; the layer never prints */
+    if (spec != NULL && spec[0] != '\0') {
+        kora_inject_configure(spec);
+    }
+}
+#endif
+
+#else /* KORA_NO_INJECT */
+
+int kora_inject_enter(int syscall, size_t *count) {
+    (void)syscall; (void)count;
+    return 0;
+}
+
+int kora_inject_enter_errno(int syscall, size_t *count) {
+    (void)syscall; (void)count;
+    return 0;
+}
+
+int kora_inject_configure(const char *spec) {
+    (void)spec;
+    errno = ENOTSUP;
+    return KORA_ERROR;
+}
+
+int kora_inject_enabled(void) {
+    return 0;
+}
+
+void kora_inject_stats(int syscall, kora_inject_stats_t *stats) {
+    (void)syscall;
+    memset(stats, 0, sizeof(*stats));
+}
+
+#endif
@@ -0,0 +1,219 @@
+#include <kora/linux_raw.h>
+#include <internal/error.h>
+#include <errno.h>
+
+/**
+ * The raw Linux calls as a backend layer
+ *
+ * Turns the kernel's -errno results into each sys_* call's own
+ * convention, with errno and kora_last_error() set on failure the way
+ * src/linux/syscalls_linux.c sets them.
+ */
+
+#if defined(KORA_HAVE_LINUX_RAW)
+
+/* Calls that return KORA_ERROR (or -1) and report through errno */
+static int fail(int syscall, long r) {
+    kora_record_error(syscall, (int)-r);
+    errno = (int)-r;
+    return KORA_ERROR;
+}
+
+/* Calls that return -errno, which glibc also leaves in errno */
+static int fail_neg(int syscall, long r) {
+    kora_record_error(syscall, (int)-r);
+    errno = (int)-r;
+    return (int)r;
+}
+
+#define ERRNO_RESULT(syscall, call)                                                        \
+    long r = call;                                                                         \
+    return r < 0 ? fail(syscall, r) : (int)r
+
+#define NEG_RESULT(syscall, call)                                                          \
+    int r = call;                                                                          \
+    return r < 0 ? fail_neg(syscall, r) : r
+
+static int raw_putc(char c) {
+    long r = kora_raw_write(1, &c, 1);
+    return r < 0 ? fail(SYS_PUTC, r) : KORA_SUCCESS;
+}
+
+static int raw_getc(void) {
+    unsigned char c;
+    long r = kora_raw_read(0, &c, 1);
+    if (r < 0) {
+        return fail(SYS_GETC, r);
+    }
+    return r == 0 ? KORA_EOF : c;
+}
+
+static int raw_open(const char *path, int flags) {
+    ERRNO_RESULT(SYS_OPEN, kora_raw_open(path, flags));
+}
+
+static int raw_close(int fd) {
+    ERRNO_RESULT(SYS_CLOSE, kora_raw_close(fd));
+}
+
+static int raw_read(int fd, void *buf, size_t count) {
+    long r = kora_raw_read(fd, buf, count);
+    if (r < 0) {
+        return fail(SYS_READ, r);
+    }
+    return r == 0 ? KORA_EOF : (int)r;
+}
+
+static int raw_write(int fd, const void *buf, size_t count) {
+    ERRNO_RESULT(SYS_WRITE, kora_raw_write(fd, buf, count));
+}
+
+static long raw_seek(int fd, long offset, int whence) {
+    long r = kora_raw_seek(fd, offset, whence);
+    return r < 0 ? fail(SYS_SEEK, r) : r;
+}
+
+static int raw_mkdir(const char *path) {
+    int r = kora_raw_mkdir(path);
+    return r < 0 ? fail(SYS_MKDIR, r) : KORA_SUCCESS;
+}
+
+static int raw_rmdir(const char *path) {
+    ERRNO_RESULT(SYS_RMDIR, kora_raw_rmdir(path));
+}
+
+static int raw_symlink(const char *target, const char *linkpath) {
+    ERRNO_RESULT(SYS_SYMLINK, kora_raw_symlink(target, linkpath));
+}
+
+static int raw_readlink(const char *path, char *buf, size_t size) {
+    ERRNO_RESULT(SYS_READLINK, kora_raw_readlink(path, buf, size));
+}
+
+static int raw_stat(const char *path, kora_stat_t *st) {
+    NEG_RESULT(SYS_STAT, kora_raw_stat(path, st));
+}
+
+static int raw_fstat(int fd, kora_stat_t *st) {
+    NEG_RESULT(SYS_FSTAT, kora_raw_fstat(fd, st));
+}
+
+static int raw_lstat(const char *path, kora_stat_t *st) {
+    NEG_RESULT(SYS_LSTAT, kora_raw_lstat(path, st));
+}
+
+static int raw_link(const char *existing, const char *newpath) {
+    NEG_RESULT(SYS_LINK, kora_raw_link(existing, newpath));
+}
+
+static int raw_chdir(const char *path) {
+    NEG_RESULT(SYS_CHDIR, kora_raw_chdir(path));
+}
+
+static int raw_getcwd(char *buf, size_t size) {
+    NEG_RESULT(SYS_GETCWD, kora_raw_getcwd(buf, size));
+}
+
+static int raw_exists(const char *path, uint8_t *type) {
+    NEG_RESULT(SYS_EXISTS, kora_raw_exists(path, type));
+}
+
+static int raw_unlink(const char *path) {
+    NEG_RESULT(SYS_UNLINK, kora_raw_unlink(path));
+}
+
+static int raw_rename(const char *oldpath, const char *newpath) {
+    NEG_RESULT(SYS_RENAME, kora_raw_rename(oldpath, newpath));
+}
+
+static void *raw_mmap(void *addr, size_t len, int prot, int flags, int fd, off_t off) {
+    void *p = kora_raw_mmap(addr, len, prot, flags, fd, off);
+    if (KORA_RAW_MMAP_FAILED(p)) {
+        errno = (int)-(long)p;
+        return (void *)-1;
+    }
+    return p;
+}
+
+static int raw_munmap(void *addr, size_t len) {
+    ERRNO_RESULT(SYS_MUNMAP, kora_raw_munmap(addr, len));
+}
+
+static int raw_mprotect(void *addr, size_t len, int prot) {
+    ERRNO_RESULT(SYS_MPROTECT, kora_raw_mprotect(addr, len, prot));
+}
+
+static void raw_exit(int status) {
+    kora_raw_exit(status);
+}
+
+static int raw_yield(void) {
+    ERRNO_RESULT(SYS_YIELD, kora_raw_yield());
+}
+
+static int raw_kill(pid_t pid, int signum) {
+    ERRNO_RESULT(SYS_KILL, kora_raw_kill(pid, signum));
+}
+
+static int raw_pipe2(int fds[2], int flags) {
+    ERRNO_RESULT(SYS_PIPE2, kora_raw_pipe2(fds, flags));
+}
+
+static int raw_dup(int fd) {
+    ERRNO_RESULT(SYS_DUP, kora_raw_dup(fd));
+}
+
+static int raw_dup2(int oldfd, int newfd) {
+    ERRNO_RESULT(SYS_DUP2, kora_raw_dup2(oldfd, newfd));
+}
+
+static int raw_nanosleep(const struct timespec *req, struct timespec *rem) {
+    ERRNO_RESULT(SYS_NANOSLEEP, kora_raw_nanosleep(req, rem));
+}
+
+/*
+ * getpid, getppid, gettid and sync cannot fail. clock_gettime is left to
+ * glibc, whose vDSO path does not enter the kernel.
+ */
+static const kora_backend_ops_t raw_ops = {
+    .putc = raw_putc,
+    .getc = raw_getc,
+    .open = raw_open,
+    .close = raw_close,
+    .read = raw_read,
+    .write = raw_write,
+    .seek = raw_seek,
+    .mkdir = raw_mkdir,
+    .rmdir = raw_rmdir,
+    .symlink = raw_symlink,
+    .readlink = raw_readlink,
+    .stat = raw_stat,
+    .fstat = raw_fstat,
+    .lstat = raw_lstat,
+    .link = raw_link,
+    .chdir = raw_chdir,
+    .getcwd = raw_getcwd,
+    .exists = raw_exists,
+    .unlink = raw_unlink,
+    .rename = raw_rename,
+    .mmap = raw_mmap,
+    .munmap = raw_munmap,
+    .mprotect = raw_mprotect,
+    .exit = raw_exit,
+    .yield = raw_yield,
+    .getpid = kora_raw_getpid,
+    .getppid = kora_raw_getppid,
+    .gettid = kora_raw_gettid,
+    .kill = raw_kill,
+    .pipe2 = raw_pipe2,
+    .dup = raw_dup,
+    .dup2 = raw_dup2,
+    .nanosleep = raw_nanosleep,
+    .sync = kora_raw_sync,
+};
+
+const kora_backend_ops_t *kora_backend_linux_raw(void) {
+    return &raw_ops;
+}
+
+#endif /* KORA_HAVE_LINUX_RAW */
@@ -0,0 +1,293 @@
+#include <internal/linux_raw.h>
+
+/**
+ * Linux implementation of KoraOS system calls without glibc
+ *
+ * Built twice: into koralayer with the other backends, and alone into
+ * koralayer_raw with -ffreestanding and no stack protector, for programs
+ * linked with -nostdlib. Only kernel headers are used for constants, and
+ * nothing here may call a libc function, including the memcpy or memset
+ * a compiler emits for struct copies.
+ */
+
+#if defined(KORA_HAVE_LINUX_RAW)
+
+#include <linux/errno.h>
+#include <linux/fcntl.h>
+#include <linux/stat.h>
+
+/* <linux/stat.h> leaves these to libc when glibc's headers are in use */
+#ifndef S_ISREG
+#define S_ISREG(m) (((m) & 0170000) == 0100000)
+#define S_ISDIR(m) (((m) & 0170000) == 0040000)
+#define S_ISLNK(m) (((m) & 0170000) == 0120000)
+#endif
+
+#define RAW0(nr)                 kora_raw_syscall0(__NR_##nr)
+#define RAW1(nr, a)              kora_raw_syscall1(__NR_##nr, (long)(a))
+#define RAW2(nr, a, b)           kora_raw_syscall2(__NR_##nr, (long)(a), (long)(b))
+#define RAW3(nr, a, b, c)        kora_raw_syscall3(__NR_##nr, (long)(a), (long)(b), (long)(c))
+#define RAW4(nr, a, b, c, d)                                                               \
+    kora_raw_syscall4(__NR_##nr, (long)(a), (long)(b), (long)(c), (long)(d))
+#define RAW5(nr, a, b, c, d, e)                                                            \
+    kora_raw_syscall5(__NR_##nr, (long)(a), (long)(b), (long)(c), (long)(d), (long)(e))
+
+/*
+ * aarch64 only has the *at forms of the path calls, so they are used on
+ * both architectures, relative to the working directory
+ */
+
+int kora_raw_open(const char *path, int flags) {
+    int linux_flags;
+
+    if ((flags & KORA_O_RDWR) == KORA_O_RDWR) {
+        linux_flags = O_RDWR;
+    } else if (flags & KORA_O_WRONLY) {
+        linux_flags = O_WRONLY;
+    } else {
+        linux_flags = O_RDONLY;
+    }
+    if (flags & KORA_O_CREAT) {
+        linux_flags |= O_CREAT;
+    }
+    if (flags & KORA_O_TRUNC) {
+        linux_flags |= O_TRUNC;
+    }
+    if (flags & KORA_O_APPEND) {
+        linux_flags |= O_APPEND;
+    }
+    return (int)RAW4(openat, AT_FDCWD, path, linux_flags | O_LARGEFILE, 0644);
+}
+
+int kora_raw_close(int fd) {
+    return (int)RAW1(close, fd);
+}
+
+long kora_raw_read(int fd, void *buf, size_t count) {
+    return RAW3(read, fd, buf, count);
+}
+
+long kora_raw_write(int fd, const void *buf, size_t count) {
+    return RAW3(write, fd, buf, count);
+}
+
+long kora_raw_seek(int fd, long offset, int whence) {
+    /* KORA_SEEK_* have the host's values */
+    if (whence != KORA_SEEK_SET && whence != KORA_SEEK_CUR && whence != KORA_SEEK_END) {
+        return -EINVAL;
+    }
+    return RAW3(lseek, fd, offset, whence);
+}
+
+int kora_raw_dup(int fd) {
+    return (int)RAW1(dup, fd);
+}
+
+int kora_raw_dup2(int oldfd, int newfd) {
+    /* dup3 refuses equal descriptors, where dup2 only checks oldfd is open */
+    if (oldfd == newfd) {
+        long r = RAW2(fcntl, oldfd, F_GETFD);
+        return r < 0 ? (int)r : newfd;
+    }
+    return (int)RAW3(dup3, oldfd, newfd, 0);
+}
+
+int kora_raw_pipe2(int fds[2], int flags) {
+    int linux_flags = 0;
+
+    if (flags & KORA_PIPE_NONBLOCK) {
+        linux_flags |= O_NONBLOCK;
+    }
+    if (flags & KORA_PIPE_CLOEXEC) {
+        linux_flags |= O_CLOEXEC;
+    }
+    return (int)RAW2(pipe2, fds, linux_flags);
+}
+
+static int raw_statx(int dirfd, const char *path, int flags, struct statx *stx) {
+    return (int)RAW5(statx, dirfd, path, flags,
+                     STATX_TYPE | STATX_MODE | STATX_SIZE | STATX_MTIME, stx);
+}
+
+int kora_raw_mkdir(const char *path) {
+    struct statx stx;
+
+    int r = (int)RAW3(mkdirat, AT_FDCWD, path, 0755);
+    if (r == -EEXIST && raw_statx(AT_FDCWD, path, 0, &stx) == 0 && S_ISDIR(stx.stx_mode)) {
+        return 0;
+    }
+    return r;
+}
+
+int kora_raw_rmdir(const char *path) {
+    return (int)RAW3(unlinkat, AT_FDCWD, path, AT_REMOVEDIR);
+}
+
+int kora_raw_unlink(const char *path) {
+    if (!path) {
+        return -EINVAL;
+    }
+    return (int)RAW3(unlinkat, AT_FDCWD, path, 0);
+}
+
+int kora_raw_rename(const char *oldpath, const char *newpath) {
+    if (!oldpath || !newpath) {
+        return -EINVAL;
+    }
+    return (int)RAW5(renameat2, AT_FDCWD, oldpath, AT_FDCWD, newpath, 0);
+}
+
+int kora_raw_link(const char *existing, const char *newpath) {
+    if (!existing || !newpath) {
+        return -EINVAL;
+    }
+    return (int)RAW5(linkat, AT_FDCWD, existing, AT_FDCWD, newpath, 0);
+}
+
+int kora_raw_symlink(const char *target, const char *linkpath) {
+    return (int)RAW3(symlinkat, target, AT_FDCWD, linkpath);
+}
+
+int kora_raw_readlink(const char *path, char *buf, size_t size) {
+    if (size == 0) {
+        return -EINVAL;
+    }
+    long r = RAW4(readlinkat, AT_FDCWD, path, buf, size - 1);
+    if (r >= 0) {
+        buf[r] = '\0';
+    }
+    return (int)r;
+}
+
+static int stat_common(int dirfd, const char *path, int flags, kora_stat_t *st) {
+    struct statx stx;
+
+    int r = raw_statx(dirfd, path, flags, &stx);
+    if (r != 0) {
+        return r;
+    }
+    st->mode = stx.stx_mode;
+    st->size = stx.stx_size;
+    st->mtime = (uint64_t)stx.stx_mtime.tv_sec;
+    st->uid = 0;
+    st->gid = 0;
+    return 0;
+}
+
+int kora_raw_stat(const char *path, kora_stat_t *st) {
+    if (!path || !st) {
+        return -EINVAL;
+    }
+    return stat_common(AT_FDCWD, path, 0, st);
+}
+
+int kora_raw_lstat(const char *path, kora_stat_t *st) {
+    if (!path || !st) {
+        return -EINVAL;
+    }
+    return stat_common(AT_FDCWD, path, AT_SYMLINK_NOFOLLOW, st);
+}
+
+int kora_raw_fstat(int fd, kora_stat_t *st) {
+    if (fd < 0 || !st) {
+        return -EINVAL;
+    }
+    return stat_common(fd, "", AT_EMPTY_PATH, st);
+}
+
+int kora_raw_exists(const char *path, uint8_t *type) {
+    struct statx stx;
+
+    if (!path) {
+        return -EINVAL;
+    }
+    int r = raw_statx(AT_FDCWD, path, AT_SYMLINK_NOFOLLOW, &stx);
+    if (r == -ENOENT) {
+        return 0;
+    }
+    if (r != 0) {
+        return r;
+    }
+    if (type) {
+        if (S_ISREG(stx.stx_mode)) {
+            *type = KORA_FILE_TYPE_REGULAR;
+        } else if (S_ISDIR(stx.stx_mode)) {
+            *type = KORA_FILE_TYPE_DIRECTORY;
+        } else if (S_ISLNK(stx.stx_mode)) {
+            *type = KORA_FILE_TYPE_SYMLINK;
+        } else {
+            *type = KORA_FILE_TYPE_OTHER;
+        }
+    }
+    return 1;
+}
+
+int kora_raw_chdir(const char *path) {
+    if (!path) {
+        return -EINVAL;
+    }
+    return (int)RAW1(chdir, path);
+}
+
+int kora_raw_getcwd(char *buf, size_t size) {
+    if (!buf || size == 0) {
+        return -EINVAL;
+    }
+    /* The kernel returns the length including the NUL */
+    long r = RAW2(getcwd, buf, size);
+    return r < 0 ? (int)r : 0;
+}
+
+int kora_raw_sync(void) {
+    RAW0(sync);
+    return 0;
+}
+
+void *kora_raw_mmap(void *addr, size_t len, int prot, int flags, int fd, off_t off) {
+    return (void *)kora_raw_syscall6(__NR_mmap, (long)addr, (long)len, prot, flags, fd,
+                                     (long)off);
+}
+
+int kora_raw_munmap(void *addr, size_t len) {
+    return (int)RAW2(munmap, addr, len);
+}
+
+int kora_raw_mprotect(void *addr, size_t len, int prot) {
+    return (int)RAW3(mprotect, addr, len, prot);
+}
+
+pid_t kora_raw_getpid(void) {
+    return (pid_t)RAW0(getpid);
+}
+
+pid_t kora_raw_getppid(void) {
+    return (pid_t)RAW0(getppid);
+}
+
+pid_t kora_raw_gettid(void) {
+    return (pid_t)RAW0(gettid);
+}
+
+int kora_raw_yield(void) {
+    return (int)RAW0(sched_yield);
+}
+
+int kora_raw_kill(pid_t pid, int signum) {
+    return (int)RAW2(kill, pid, signum);
+}
+
+int kora_raw_clock_gettime(clockid_t id, struct timespec *tp) {
+    return (int)RAW2(clock_gettime, id, tp);
+}
+
+int kora_raw_nanosleep(const struct timespec *req, struct timespec *rem) {
+    return (int)RAW2(nanosleep, req, rem);
+}
+
+_Noreturn void kora_raw_exit(int status) {
+    for (;;) {
+        RAW1(exit_group, status);
+    }
+}
+
+#endif /* KORA_HAVE_LINUX_RAW */
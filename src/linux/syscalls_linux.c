@@ -1,4 +1,9 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE  /* For readahead(), pipe2(), splice(), memfd_create(), clone(), getcpu() and CPU sets */
+#endif
 #include <internal/syscall_impl.h>
+#include <internal/error.h>
+#include <internal/fdtable.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <fcntl.h>
@@ -9,6 +14,7 @@
 #include <dirent.h>
 #include <string.h>
 #include <stdint.h>
+#include <limits.h>
 #include <sys/mman.h>
 #include <spawn.h>
 #include <sys/wait.h>
@@ -19,6 +25,11 @@
 #include <time.h>
 #include <sys/time.h>
 #include <signal.h>
+#include <pthread.h>
+#include <sys/signalfd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <stdatomic.h>
 extern char **environ;
 
 /**
@@ -26,27 +37,6 @@ extern char **environ;
  * Uses glibc rather than direct syscalls
  */
 
-// Global array to store DIR pointers
-// This is a simplification for the compatibility layer.
-// In a real implementation, we would use a more sophisticated handle table
-// with proper locking for thread safety and memory management.
-#define MAX_DIR_HANDLES 16
-static DIR* dir_handles[MAX_DIR_HANDLES] = {NULL};
-
-/**
- * Find a free slot in the dir_handles array
- * 
- * @return Index of a free slot or -1 if none available
- */
-static int find_free_dir_handle(void) {
-    for (int i = 0; i < MAX_DIR_HANDLES; i++) {
-        if (dir_handles[i] == NULL) {
-            return i;
-        }
-    }
-    return -1;  // No free slots
-}
-
 int linux_sys_putc(char c) {
     int result = putchar(c);
     if (result == EOF) {
@@ -104,6 +94,7 @@ int linux_sys_open(const char *path, int flags) {
     }
     
     if (fd < 0) {
+        kora_record_error(SYS_OPEN, errno);
         return KORA_ERROR;
     }
     
@@ -113,6 +104,7 @@ int linux_sys_open(const char *path, int flags) {
 int linux_sys_close(int fd) {
     int result = close(fd);
     if (result < 0) {
+        kora_record_error(SYS_CLOSE, errno);
         return KORA_ERROR;
     }
     return KORA_SUCCESS;
@@ -122,6 +114,7 @@ int linux_sys_read(int fd, void *buf, size_t count) {
     ssize_t result = read(fd, buf, count);
     
     if (result < 0) {
+        kora_record_error(SYS_READ, errno);
         return KORA_ERROR;
     }
     
@@ -136,6 +129,7 @@ int linux_sys_write(int fd, const void *buf, size_t count) {
     ssize_t result = write(fd, buf, count);
     
     if (result < 0) {
+        kora_record_error(SYS_WRITE, errno);
         return KORA_ERROR;
     }
     
@@ -163,16 +157,64 @@ long linux_sys_seek(int fd, long offset, int whence) {
     off_t result = lseek(fd, offset, linux_whence);
     
     if (result < 0) {
+        kora_record_error(SYS_SEEK, errno);
         return KORA_ERROR;
     }
     
     return (long)result;
 }
 
+int linux_sys_fadvise(int fd, uint64_t offset, uint64_t len, int advice) {
+    int linux_advice;
+
+    /* Convert Kora advice to posix_fadvise advice */
+    switch (advice) {
+        case KORA_FADV_NORMAL:
+            linux_advice = POSIX_FADV_NORMAL;
+            break;
+        case KORA_FADV_SEQUENTIAL:
+            linux_advice = POSIX_FADV_SEQUENTIAL;
+            break;
+        case KORA_FADV_RANDOM:
+            linux_advice = POSIX_FADV_RANDOM;
+            break;
+        case KORA_FADV_WILLNEED:
+            linux_advice = POSIX_FADV_WILLNEED;
+            break;
+        case KORA_FADV_DONTNEED:
+            linux_advice = POSIX_FADV_DONTNEED;
+            break;
+        case KORA_FADV_NOREUSE:
+            linux_advice = POSIX_FADV_NOREUSE;
+            break;
+        default:
+            return -EINVAL;
+    }
+
+    /* posix_fadvise reports failure through its return value, not errno */
+    int result = posix_fadvise(fd, (off_t)offset, (off_t)len, linux_advice);
+    if (result != 0) {
+        kora_record_error(SYS_FADVISE, result);
+        return -result;
+    }
+
+    return 0;
+}
+
+int linux_sys_readahead(int fd, uint64_t offset, size_t count) {
+    if (readahead(fd, (off64_t)offset, count) != 0) {
+        kora_record_error(SYS_READAHEAD, errno);
+        return -errno;
+    }
+
+    return 0;
+}
+
 int linux_sys_ioctl(int fd, unsigned long request, void *arg) {
     int result = ioctl(fd, request, arg);
     
     if (result < 0) {
+        kora_record_error(SYS_IOCTL, errno);
         return KORA_ERROR;
     }
     
@@ -191,8 +233,7 @@ int linux_sys_mkdir(const char *path) {
             }
         }
         
-        fprintf(stderr, "linux_sys_mkdir: Failed to create directory %s: %s\n", 
-                path, strerror(errno));
+        kora_record_error(SYS_MKDIR, errno);
         return KORA_ERROR;
     }
     
@@ -203,42 +244,46 @@ int linux_sys_rmdir(const char *path) {
     int result = rmdir(path);
     
     if (result < 0) {
+        kora_record_error(SYS_RMDIR, errno);
         return KORA_ERROR;
     }
     
     return KORA_SUCCESS;
 }
 
+/*
+ * A host directory handle is the descriptor under its DIR, which is
+ * attached to that descriptor's entry in the descriptor table. The
+ * kernel keeps the numbers unique, so opening needs no lock and no
+ * search, and there are as many handles as descriptors.
+ */
 int linux_sys_opendir(const char *path) {
     DIR *dir = opendir(path);
     
     if (dir == NULL) {
-        fprintf(stderr, "linux_sys_opendir: Failed to open directory %s: %s\n", 
-                path, strerror(errno));
+        kora_record_error(SYS_OPENDIR, errno);
         return KORA_ERROR;
     }
     
-    // Find a free slot in the handle table
-    int handle = find_free_dir_handle();
-    if (handle < 0) {
-        fprintf(stderr, "linux_sys_opendir: No free DIR handle slots\n");
+    int handle = dirfd(dir);
+    int r = kora_fd_attach(handle, dir);
+    if (r < 0) {
         closedir(dir);
+        errno = -r;
+        kora_record_error(SYS_OPENDIR, errno);
         return KORA_ERROR;
     }
-    
-    // Store the DIR pointer in the handle table
-    dir_handles[handle] = dir;
     return handle;
 }
 
 int linux_sys_readdir(int dir, kora_dirent_t *entry) {
-    if (dir < 0 || dir >= MAX_DIR_HANDLES || dir_handles[dir] == NULL || entry == NULL) {
-        fprintf(stderr, "linux_sys_readdir: Invalid parameters (dir=%d, entry=%p)\n", 
-                dir, (void*)entry);
+    DIR *dirp = kora_fd_attached(dir);
+    if (dirp == NULL || entry == NULL) {
+        errno = EBADF;
+        kora_record_error(SYS_READDIR, EBADF);
         return KORA_ERROR;
     }
     
-    DIR *dirp = dir_handles[dir];
     struct dirent *linux_entry;
     
     errno = 0;
@@ -246,8 +291,7 @@ int linux_sys_readdir(int dir, kora_dirent_t *entry) {
     
     if (linux_entry == NULL) {
         if (errno != 0) {
-            fprintf(stderr, "linux_sys_readdir: Error reading directory: %s\n", 
-                    strerror(errno));
+            kora_record_error(SYS_READDIR, errno);
             return KORA_ERROR;
         }
         return 0;  /* End of directory */
@@ -277,23 +321,19 @@ int linux_sys_readdir(int dir, kora_dirent_t *entry) {
 }
 
 int linux_sys_closedir(int dir) {
-    if (dir < 0 || dir >= MAX_DIR_HANDLES || dir_handles[dir] == NULL) {
-        fprintf(stderr, "linux_sys_closedir: Invalid directory handle %d\n", dir);
+    DIR *dirp = kora_fd_detach(dir);
+    if (dirp == NULL) {
+        errno = EBADF;
+        kora_record_error(SYS_CLOSEDIR, EBADF);
         return KORA_ERROR;
     }
     
-    DIR *dirp = dir_handles[dir];
-    int result = closedir(dirp);
-    
-    if (result < 0) {
-        fprintf(stderr, "linux_sys_closedir: Error closing directory: %s\n", 
-                strerror(errno));
+    /* The descriptor is closed even when closedir reports an error */
+    if (closedir(dirp) < 0) {
+        kora_record_error(SYS_CLOSEDIR, errno);
         return KORA_ERROR;
     }
     
-    // Clear the handle
-    dir_handles[dir] = NULL;
-    
     return KORA_SUCCESS;
 }
 
@@ -301,6 +341,7 @@ int linux_sys_symlink(const char *target, const char *linkpath) {
     int result = symlink(target, linkpath);
     
     if (result < 0) {
+        kora_record_error(SYS_SYMLINK, errno);
         return KORA_ERROR;
     }
     
@@ -311,6 +352,7 @@ int linux_sys_readlink(const char *path, char *buf, size_t size) {
     ssize_t result = readlink(path, buf, size - 1);
     
     if (result < 0) {
+        kora_record_error(SYS_READLINK, errno);
         return KORA_ERROR;
     }
     
@@ -331,6 +373,7 @@ int linux_sys_get_file_info(const char *path, kora_file_info_t *info)
 
     struct stat st;
     if (stat(path, &st) != 0) {
+        kora_record_error(SYS_GET_FILE_INFO, errno);
         return -errno;
     }
 
@@ -379,6 +422,7 @@ int linux_sys_get_fd_info(int fd, kora_file_info_t *info)
 
     struct stat st;
     if (fstat(fd, &st) != 0) {
+        kora_record_error(SYS_GET_FD_INFO, errno);
         return -errno;
     }
 
@@ -422,6 +466,7 @@ int linux_sys_stat(const char *path, kora_stat_t *st)
 
     struct stat host;
     if (stat(path, &host) != 0) {
+        kora_record_error(SYS_STAT, errno);
         return -errno;
     }
 
@@ -442,6 +487,7 @@ int linux_sys_fstat(int fd, kora_stat_t *st)
 
     struct stat host;
     if (fstat(fd, &host) != 0) {
+        kora_record_error(SYS_FSTAT, errno);
         return -errno;
     }
 
@@ -462,6 +508,7 @@ int linux_sys_lstat(const char *path, kora_stat_t *st)
 
     struct stat host;
     if (lstat(path, &host) != 0) {
+        kora_record_error(SYS_LSTAT, errno);
         return -errno;
     }
 
@@ -480,6 +527,7 @@ int linux_sys_link(const char *existing, const char *newpath)
         return -EINVAL;
     }
     if (link(existing, newpath) != 0) {
+        kora_record_error(SYS_LINK, errno);
         return -errno;
     }
     return 0;
@@ -491,6 +539,7 @@ int linux_sys_chdir(const char *path)
         return -EINVAL;
     }
     if (chdir(path) != 0) {
+        kora_record_error(SYS_CHDIR, errno);
         return -errno;
     }
     return 0;
@@ -502,6 +551,7 @@ int linux_sys_getcwd(char *buf, size_t size)
         return -EINVAL;
     }
     if (getcwd(buf, size) == NULL) {
+        kora_record_error(SYS_GETCWD, errno);
         return -errno;
     }
     return 0;
@@ -517,6 +567,7 @@ int linux_sys_utime(const char *path, uint64_t mtime)
     times[0].tv_nsec = 0;
     times[1] = times[0];
     if (utimensat(AT_FDCWD, path, times, 0) != 0) {
+        kora_record_error(SYS_UTIME, errno);
         return -errno;
     }
     return 0;
@@ -540,6 +591,7 @@ int linux_sys_exists(const char *path, uint8_t *type)
             return 0;
         }
         // Error during stat
+        kora_record_error(SYS_EXISTS, errno);
         return -errno;
     }
 
@@ -569,6 +621,7 @@ int linux_sys_unlink(const char *path)
     }
     
     if (unlink(path) != 0) {
+        kora_record_error(SYS_UNLINK, errno);
         return -errno;
     }
     
@@ -585,6 +638,7 @@ int linux_sys_rename(const char *oldpath, const char *newpath)
     }
 
     if (rename(oldpath, newpath) != 0) {
+        kora_record_error(SYS_RENAME, errno);
         return -errno;
     }
 
@@ -623,6 +677,134 @@ int linux_sys_mprotect(void *addr, size_t len, int prot)
     return mprotect(addr, len, prot);
 }
 
+/**
+ * Copy a shared memory name, adding the leading '/' shm_open expects
+ */
+static int normalize_shm_name(const char *name, char *buf, size_t size)
+{
+    int len = snprintf(buf, size, "%s%s", name[0] == '/' ? "" : "/", name);
+    if (len < 0 || (size_t)len >= size) {
+        return -1;
+    }
+    return 0;
+}
+
+int linux_sys_shm_create(const char *name, uint64_t size, int flags)
+{
+    char shm_name[NAME_MAX + 1];
+    int created = 0;   /* This call made the named object */
+    int fd;
+
+    if (name == NULL) {
+        unsigned memfd_flags = 0;
+        if (flags & KORA_SHM_CLOEXEC) {
+            memfd_flags |= MFD_CLOEXEC;
+        }
+        if (flags & KORA_SHM_SEALABLE) {
+            memfd_flags |= MFD_ALLOW_SEALING;
+        }
+        fd = memfd_create("kora-shm", memfd_flags);
+    } else {
+        if (normalize_shm_name(name, shm_name, sizeof(shm_name)) != 0) {
+            errno = ENAMETOOLONG;
+            kora_record_error(SYS_SHM_CREATE, errno);
+            return -1;
+        }
+        /* Try to create it first, so a failure below knows whether to unlink */
+        fd = shm_open(shm_name, O_RDWR | O_CREAT | O_EXCL, 0600);
+        created = fd >= 0;
+        if (fd < 0 && errno == EEXIST && !(flags & KORA_SHM_EXCL)) {
+            fd = shm_open(shm_name, O_RDWR | O_CREAT, 0600);
+        }
+        /* shm_open always sets FD_CLOEXEC; clear it so children inherit */
+        if (fd >= 0 && !(flags & KORA_SHM_CLOEXEC)) {
+            fcntl(fd, F_SETFD, 0);
+        }
+    }
+
+    if (fd < 0) {
+        kora_record_error(SYS_SHM_CREATE, errno);
+        return -1;
+    }
+
+    if (ftruncate(fd, (off_t)size) != 0) {
+        int err = errno;
+        close(fd);
+        /* Leave no half-made name behind to fail the next create with EEXIST */
+        if (created) {
+            shm_unlink(shm_name);
+        }
+        errno = err;
+        kora_record_error(SYS_SHM_CREATE, err);
+        return -1;
+    }
+
+    return fd;
+}
+
+int linux_sys_shm_open(const char *name, int flags)
+{
+    char shm_name[NAME_MAX + 1];
+
+    if (name == NULL || normalize_shm_name(name, shm_name, sizeof(shm_name)) != 0) {
+        errno = name ? ENAMETOOLONG : EINVAL;
+        kora_record_error(SYS_SHM_OPEN, errno);
+        return -1;
+    }
+
+    int fd = shm_open(shm_name, (flags & KORA_SHM_RDONLY) ? O_RDONLY : O_RDWR, 0);
+    if (fd < 0) {
+        kora_record_error(SYS_SHM_OPEN, errno);
+        return -1;
+    }
+    if (!(flags & KORA_SHM_CLOEXEC)) {
+        fcntl(fd, F_SETFD, 0);
+    }
+
+    return fd;
+}
+
+int linux_sys_shm_unlink(const char *name)
+{
+    char shm_name[NAME_MAX + 1];
+
+    if (name == NULL || normalize_shm_name(name, shm_name, sizeof(shm_name)) != 0) {
+        errno = name ? ENAMETOOLONG : EINVAL;
+        kora_record_error(SYS_SHM_UNLINK, errno);
+        return -1;
+    }
+
+    if (shm_unlink(shm_name) != 0) {
+        kora_record_error(SYS_SHM_UNLINK, errno);
+        return -1;
+    }
+    return 0;
+}
+
+int linux_sys_shm_seal(int fd, unsigned seals)
+{
+    int linux_seals = 0;
+
+    if (seals & KORA_SHM_SEAL_SEAL) {
+        linux_seals |= F_SEAL_SEAL;
+    }
+    if (seals & KORA_SHM_SEAL_SHRINK) {
+        linux_seals |= F_SEAL_SHRINK;
+    }
+    if (seals & KORA_SHM_SEAL_GROW) {
+        linux_seals |= F_SEAL_GROW;
+    }
+    if (seals & KORA_SHM_SEAL_WRITE) {
+        linux_seals |= F_SEAL_WRITE;
+    }
+
+    if (fcntl(fd, F_ADD_SEALS, linux_seals) != 0) {
+        kora_record_error(SYS_SHM_SEAL, errno);
+        return -1;
+    }
+    return 0;
+}
+
 pid_t linux_sys_spawn(const char *path, char *const argv[], char *const envp[])
 {
     pid_t pid;
@@ -649,6 +831,286 @@ pid_t linux_sys_wait(pid_t pid, int *status, int options)
     return res;
 }
 
+static uint64_t timeval_to_ns(struct timeval tv)
+{
+    return (uint64_t)tv.tv_sec * 1000000000ull + (uint64_t)tv.tv_usec * 1000ull;
+}
+
+static void convert_rusage(const struct rusage *ru, kora_rusage_t *usage)
+{
+    usage->utime_ns = timeval_to_ns(ru->ru_utime);
+    usage->stime_ns = timeval_to_ns(ru->ru_stime);
+    usage->maxrss_kb = (uint64_t)ru->ru_maxrss;
+    usage->minflt = (uint64_t)ru->ru_minflt;
+    usage->majflt = (uint64_t)ru->ru_majflt;
+    usage->inblock = (uint64_t)ru->ru_inblock;
+    usage->oublock = (uint64_t)ru->ru_oublock;
+    usage->nvcsw = (uint64_t)ru->ru_nvcsw;
+    usage->nivcsw = (uint64_t)ru->ru_nivcsw;
+}
+
+pid_t linux_sys_wait4(pid_t pid, int *status, int options, kora_rusage_t *usage)
+{
+    struct rusage ru;
+    pid_t res = wait4(pid, status, options, &ru);
+    if (res < 0) {
+        kora_record_error(SYS_WAIT4, errno);
+        return -1;
+    }
+    if (usage) {
+        if (res > 0) {
+            convert_rusage(&ru, usage);
+        } else {
+            memset(usage, 0, sizeof(*usage));
+        }
+    }
+    return res;
+}
+
+int linux_sys_getrusage(int who, kora_rusage_t *usage)
+{
+    struct rusage ru;
+    int host;
+
+    switch (who) {
+    case KORA_RUSAGE_SELF:     host = RUSAGE_SELF; break;
+    case KORA_RUSAGE_CHILDREN: host = RUSAGE_CHILDREN; break;
+    case KORA_RUSAGE_THREAD:   host = RUSAGE_THREAD; break;
+    default:
+        errno = EINVAL;
+        kora_record_error(SYS_GETRUSAGE, EINVAL);
+        return -1;
+    }
+
+    if (getrusage(host, &ru) != 0) {
+        kora_record_error(SYS_GETRUSAGE, errno);
+        return -1;
+    }
+    convert_rusage(&ru, usage);
+    return 0;
+}
+
+/*
+ * Threads
+ *
+ * Threads without a caller TLS block are ordinary pthreads, so the host C
+ * library and the layer's thread-local state keep working inside them.
+ * With a TLS block the thread is created by clone() directly and owns
+ * nothing from glibc; it is found again by TID through a small registry
+ * because thread-local variables are not usable there.
+ */
+struct kora_thread {
+    void *(*entry)(void *);
+    void *arg;
+    void *retval;
+    pthread_t pthread;
+    pid_t tid;       /* Raw threads: cleared and futex-woken by the kernel on exit */
+    int raw;
+    int joinable;
+};
+
+#define RAW_THREADS_MAX 256
+
+static _Atomic(struct kora_thread *) raw_threads[RAW_THREADS_MAX];
+static atomic_int raw_thread_count;
+static KORA_THREAD_LOCAL struct kora_thread *current_thread;
+/* Handle of a thread the layer did not start; gone with the thread, so nothing to free */
+static KORA_THREAD_LOCAL struct kora_thread foreign_thread;
+
+static void *thread_trampoline(void *arg)
+{
+    struct kora_thread *t = arg;
+
+    current_thread = t;
+    kora_clear_error();
+    return t->entry(t->arg);
+}
+
+static int raw_thread_trampoline(void *arg)
+{
+    struct kora_thread *t = arg;
+
+    t->retval = t->entry(t->arg);
+    return 0;
+}
+
+static int create_raw_thread(struct kora_thread *t, const kora_thread_attr_t *attr)
+{
+    int slot;
+
+    if (attr->stack == NULL || attr->stack_size < (size_t)PTHREAD_STACK_MIN) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    for (slot = 0; slot < RAW_THREADS_MAX; slot++) {
+        struct kora_thread *expected = NULL;
+        if (atomic_compare_exchange_strong(&raw_threads[slot], &expected, t)) {
+            break;
+        }
+    }
+    if (slot == RAW_THREADS_MAX) {
+        errno = EAGAIN;
+        return -1;
+    }
+    atomic_fetch_add(&raw_thread_count, 1);
+
+    uintptr_t top = ((uintptr_t)attr->stack + attr->stack_size) & ~(uintptr_t)15;
+    int flags = CLONE_VM | CLONE_FS | CLONE_FILES | CLONE_SIGHAND | CLONE_THREAD |
+                CLONE_SYSVSEM | CLONE_SETTLS | CLONE_PARENT_SETTID | CLONE_CHILD_CLEARTID;
+
+    /* PARENT_SETTID stores the TID before the child can run */
+    if (clone(raw_thread_trampoline, (void *)top, flags, t,
+              &t->tid, attr->tls, &t->tid) < 0) {
+        atomic_store(&raw_threads[slot], NULL);
+        atomic_fetch_sub(&raw_thread_count, 1);
+        return -1;
+    }
+    return 0;
+}
+
+int linux_sys_thread_create(kora_thread_t *thread, const kora_thread_attr_t *attr,
+                            void *(*entry)(void *), void *arg)
+{
+    if (thread == NULL || entry == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    struct kora_thread *t = calloc(1, sizeof(*t));
+    if (!t) {
+        kora_record_error(SYS_THREAD_CREATE, ENOMEM);
+        return -1;
+    }
+    t->entry = entry;
+    t->arg = arg;
+    t->joinable = 1;
+
+    if (attr && attr->tls) {
+        t->raw = 1;
+        if (create_raw_thread(t, attr) != 0) {
+            kora_record_error(SYS_THREAD_CREATE, errno);
+            free(t);
+            return -1;
+        }
+        *thread = t;
+        return 0;
+    }
+
+    pthread_attr_t pattr;
+    pthread_attr_init(&pattr);
+    int result = 0;
+    if (attr && attr->stack) {
+        result = pthread_attr_setstack(&pattr, attr->stack, attr->stack_size);
+    } else if (attr && attr->stack_size) {
+        result = pthread_attr_setstacksize(&pattr, attr->stack_size);
+    }
+    if (result == 0) {
+        result = pthread_create(&t->pthread, &pattr, thread_trampoline, t);
+    }
+    pthread_attr_destroy(&pattr);
+
+    if (result != 0) {
+        errno = result;
+        kora_record_error(SYS_THREAD_CREATE, result);
+        free(t);
+        return -1;
+    }
+    *thread = t;
+    return 0;
+}
+
+int linux_sys_thread_join(kora_thread_t thread, void **retval)
+{
+    if (thread == NULL || !thread->joinable) {
+        errno = EINVAL;
+        kora_record_error(SYS_THREAD_JOIN, EINVAL);
+        return -1;
+    }
+
+    if (thread->raw) {
+        pid_t tid;
+        while ((tid = __atomic_load_n(&thread->tid, __ATOMIC_ACQUIRE)) != 0) {
+            syscall(SYS_futex, &thread->tid, FUTEX_WAIT, tid, NULL, NULL, 0);
+        }
+        for (int slot = 0; slot < RAW_THREADS_MAX; slot++) {
+            struct kora_thread *expected = thread;
+            if (atomic_compare_exchange_strong(&raw_threads[slot], &expected, NULL)) {
+                atomic_fetch_sub(&raw_thread_count, 1);
+                break;
+            }
+        }
+        if (retval) {
+            *retval = thread->retval;
+        }
+    } else {
+        void *result_value;
+        int result = pthread_join(thread->pthread, &result_value);
+        if (result != 0) {
+            errno = result;
+            kora_record_error(SYS_THREAD_JOIN, result);
+            return -1;
+        }
+        if (retval) {
+            *retval = result_value;
+        }
+    }
+
+    free(thread);
+    return 0;
+}
+
+/* Must not touch thread-local storage, since raw threads have none of ours */
+static struct kora_thread *find_raw_thread(void)
+{
+    if (atomic_load_explicit(&raw_thread_count, memory_order_relaxed) == 0) {
+        return NULL;
+    }
+
+    pid_t tid = (pid_t)syscall(SYS_gettid);
+    for (int slot = 0; slot < RAW_THREADS_MAX; slot++) {
+        struct kora_thread *t = atomic_load(&raw_threads[slot]);
+        if (t && __atomic_load_n(&t->tid, __ATOMIC_RELAXED) == tid) {
+            return t;
+        }
+    }
+    return NULL;
+}
+
+int linux_sys_thread_raw(void)
+{
+    return find_raw_thread() != NULL;
+}
+
+void linux_sys_thread_exit(void *retval)
+{
+    struct kora_thread *raw = find_raw_thread();
+
+    if (raw) {
+        raw->retval = retval;
+        /* Ends only this thread; the kernel then clears raw->tid */
+        for (;;) {
+            syscall(SYS_exit, 0);
+        }
+    }
+    pthread_exit(retval);
+}
+
+kora_thread_t linux_sys_thread_self(void)
+{
+    struct kora_thread *raw = find_raw_thread();
+
+    if (raw) {
+        return raw;
+    }
+    if (current_thread == NULL) {
+        /* First call from a thread the layer did not start */
+        foreign_thread.pthread = pthread_self();
+        current_thread = &foreign_thread;
+    }
+    return current_thread;
+}
+
 int linux_sys_yield(void)
 {
     return sched_yield();
@@ -669,6 +1131,420 @@ int linux_sys_setpriority(pid_t pid, int prio)
     return setpriority(PRIO_PROCESS, pid, prio);
 }
 
+pid_t linux_sys_gettid(void)
+{
+    return (pid_t)syscall(SYS_gettid);
+}
+
+static int convert_sched_policy(int kora_policy)
+{
+    switch (kora_policy) {
+    case KORA_SCHED_OTHER: return SCHED_OTHER;
+    case KORA_SCHED_FIFO:  return SCHED_FIFO;
+    case KORA_SCHED_RR:    return SCHED_RR;
+    case KORA_SCHED_BATCH: return SCHED_BATCH;
+    case KORA_SCHED_IDLE:  return SCHED_IDLE;
+    default:               return -1;
+    }
+}
+
+int linux_sys_sched_setpolicy(pid_t tid, int policy, int priority)
+{
+    struct sched_param param;
+    int host = convert_sched_policy(policy);
+
+    if (host < 0) {
+        errno = EINVAL;
+        kora_record_error(SYS_SCHED_SETPOLICY, EINVAL);
+        return -1;
+    }
+
+    /* Linux schedules threads individually, so a TID targets one thread */
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = priority;
+    if (sched_setscheduler(tid, host, &param) != 0) {
+        kora_record_error(SYS_SCHED_SETPOLICY, errno);
+        return -1;
+    }
+    return 0;
+}
+
+int linux_sys_sched_getpolicy(pid_t tid, int *priority)
+{
+    struct sched_param param;
+    int host = sched_getscheduler(tid);
+
+    if (host < 0 || sched_getparam(tid, &param) != 0) {
+        kora_record_error(SYS_SCHED_GETPOLICY, errno);
+        return -1;
+    }
+    if (priority) {
+        *priority = param.sched_priority;
+    }
+
+    switch (host & ~SCHED_RESET_ON_FORK) {
+    case SCHED_FIFO:  return KORA_SCHED_FIFO;
+    case SCHED_RR:    return KORA_SCHED_RR;
+    case SCHED_BATCH: return KORA_SCHED_BATCH;
+    case SCHED_IDLE:  return KORA_SCHED_IDLE;
+    default:          return KORA_SCHED_OTHER;
+    }
+}
+
+/* From linux/ioprio.h, which is not always installed */
+#define LINUX_IOPRIO_WHO_PROCESS  1
+#define LINUX_IOPRIO_CLASS_SHIFT  13
+#define LINUX_IOPRIO_PRIO_MASK    ((1 << LINUX_IOPRIO_CLASS_SHIFT) - 1)
+
+int linux_sys_ioprio_set(pid_t tid, int ioclass, int level)
+{
+    if (ioclass < KORA_IOPRIO_CLASS_NONE || ioclass > KORA_IOPRIO_CLASS_IDLE ||
+        level < 0 || level > 7) {
+        errno = EINVAL;
+        kora_record_error(SYS_IOPRIO_SET, EINVAL);
+        return -1;
+    }
+
+    /* The KORA_IOPRIO_CLASS_* values match the kernel's */
+    int value = (ioclass << LINUX_IOPRIO_CLASS_SHIFT) | level;
+    if (syscall(SYS_ioprio_set, LINUX_IOPRIO_WHO_PROCESS, tid, value) != 0) {
+        kora_record_error(SYS_IOPRIO_SET, errno);
+        return -1;
+    }
+    return 0;
+}
+
+int linux_sys_ioprio_get(pid_t tid, int *level)
+{
+    long value = syscall(SYS_ioprio_get, LINUX_IOPRIO_WHO_PROCESS, tid);
+    if (value < 0) {
+        kora_record_error(SYS_IOPRIO_GET, errno);
+        return -1;
+    }
+    if (level) {
+        *level = (int)(value & LINUX_IOPRIO_PRIO_MASK);
+    }
+    return (int)(value >> LINUX_IOPRIO_CLASS_SHIFT);
+}
+
+int linux_sys_sched_setaffinity(pid_t pid, const kora_cpuset_t *set)
+{
+    cpu_set_t host;
+
+    CPU_ZERO(&host);
+    for (int cpu = 0; cpu < KORA_CPUSET_SIZE && cpu < CPU_SETSIZE; cpu++) {
+        if (KORA_CPU_ISSET(cpu, set)) {
+            CPU_SET(cpu, &host);
+        }
+    }
+
+    if (sched_setaffinity(pid, sizeof(host), &host) != 0) {
+        kora_record_error(SYS_SCHED_SETAFFINITY, errno);
+        return -1;
+    }
+    return 0;
+}
+
+int linux_sys_sched_getaffinity(pid_t pid, kora_cpuset_t *set)
+{
+    cpu_set_t host;
+
+    if (sched_getaffinity(pid, sizeof(host), &host) != 0) {
+        kora_record_error(SYS_SCHED_GETAFFINITY, errno);
+        return -1;
+    }
+
+    KORA_CPU_ZERO(set);
+    for (int cpu = 0; cpu < KORA_CPUSET_SIZE && cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &host)) {
+            KORA_CPU_SET(cpu, set);
+        }
+    }
+    return 0;
+}
+
+int linux_sys_getcpu(unsigned *cpu, unsigned *node)
+{
+    unsigned c = 0;
+    unsigned n = 0;
+
+    /* glibc's getcpu uses the vDSO where the kernel provides it */
+    if (getcpu(&c, &n) != 0) {
+        kora_record_error(SYS_GETCPU, errno);
+        return -1;
+    }
+    if (cpu) {
+        *cpu = c;
+    }
+    if (node) {
+        *node = n;
+    }
+    return 0;
+}
+
+#define SYSFS_CPU "/sys/devices/system/cpu"
+#define SYSFS_NODE "/sys/devices/system/node"
+
+static int read_sysfs_line(const char *path, char *buf, size_t size)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        return -1;
+    }
+    if (!fgets(buf, (int)size, f)) {
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+    buf[strcspn(buf, "\n")] = '\0';
+    return 0;
+}
+
+static int read_sysfs_long(const char *path, long *value)
+{
+    char buf[64];
+    if (read_sysfs_line(path, buf, sizeof(buf)) != 0) {
+        return -1;
+    }
+    *value = strtol(buf, NULL, 10);
+    return 0;
+}
+
+/* Parse a kernel CPU list such as "0-3,8,10-11" */
+static int parse_cpu_list(const char *list, kora_cpuset_t *set)
+{
+    const char *p = list;
+
+    KORA_CPU_ZERO(set);
+    while (*p) {
+        char *end;
+        long first = strtol(p, &end, 10);
+        long last = first;
+        if (end == p) {
+            return -1;
+        }
+        if (*end == '-') {
+            p = end + 1;
+            last = strtol(p, &end, 10);
+            if (end == p) {
+                return -1;
+            }
+        }
+        for (long cpu = first; cpu <= last && cpu < KORA_CPUSET_SIZE; cpu++) {
+            if (cpu >= 0) {
+                KORA_CPU_SET(cpu, set);
+            }
+        }
+        p = (*end == ',') ? end + 1 : end;
+        if (*end != ',' && *end != '\0') {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Parse a sysfs cache size such as "32K" */
+static uint32_t parse_cache_size(const char *text)
+{
+    char *end;
+    unsigned long value = strtoul(text, &end, 10);
+
+    if (*end == 'K') {
+        value *= 1024;
+    } else if (*end == 'M') {
+        value *= 1024 * 1024;
+    }
+    return value > UINT32_MAX ? UINT32_MAX : (uint32_t)value;
+}
+
+static void read_cache_sizes(unsigned cpu, kora_cpu_topology_t *topo)
+{
+    char path[128];
+    char type[32];
+    char size[32];
+    long level;
+    long line;
+
+    for (int index = 0; ; index++) {
+        snprintf(path, sizeof(path), SYSFS_CPU "/cpu%u/cache/index%d/level", cpu, index);
+        if (read_sysfs_long(path, &level) != 0) {
+            break;
+        }
+        snprintf(path, sizeof(path), SYSFS_CPU "/cpu%u/cache/index%d/type", cpu, index);
+        if (read_sysfs_line(path, type, sizeof(type)) != 0) {
+            continue;
+        }
+        snprintf(path, sizeof(path), SYSFS_CPU "/cpu%u/cache/index%d/size", cpu, index);
+        if (read_sysfs_line(path, size, sizeof(size)) != 0) {
+            continue;
+        }
+
+        uint32_t bytes = parse_cache_size(size);
+        if (level == 1 && strcmp(type, "Instruction") == 0) {
+            topo->l1i_size = bytes;
+        } else if (level == 1) {
+            topo->l1d_size = bytes;
+            snprintf(path, sizeof(path),
+                     SYSFS_CPU "/cpu%u/cache/index%d/coherency_line_size", cpu, index);
+            if (read_sysfs_long(path, &line) == 0 && line > 0) {
+                topo->cache_line = (uint32_t)line;
+            }
+        } else if (level == 2) {
+            topo->l2_size = bytes;
+        } else if (level == 3) {
+            topo->l3_size = bytes;
+        }
+    }
+
+    /* Containers sometimes hide the cache directory; glibc knows from cpuid */
+#ifdef _SC_LEVEL1_DCACHE_SIZE
+    if (topo->l1d_size == 0) {
+        long v = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+        topo->l1d_size = v > 0 ? (uint32_t)v : 0;
+    }
+    if (topo->l1i_size == 0) {
+        long v = sysconf(_SC_LEVEL1_ICACHE_SIZE);
+        topo->l1i_size = v > 0 ? (uint32_t)v : 0;
+    }
+    if (topo->l2_size == 0) {
+        long v = sysconf(_SC_LEVEL2_CACHE_SIZE);
+        topo->l2_size = v > 0 ? (uint32_t)v : 0;
+    }
+    if (topo->l3_size == 0) {
+        long v = sysconf(_SC_LEVEL3_CACHE_SIZE);
+        topo->l3_size = v > 0 ? (uint32_t)v : 0;
+    }
+    if (topo->cache_line == 0) {
+        long v = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+        topo->cache_line = v > 0 ? (uint32_t)v : 0;
+    }
+#endif
+    if (topo->cache_line == 0) {
+        topo->cache_line = 64;
+    }
+}
+
+int linux_sys_cpu_topology(kora_cpu_topology_t *topo, kora_cpu_info_t *cpus, size_t max)
+{
+    char path[128];
+    char list[1024];
+    kora_cpuset_t online;
+    kora_cpuset_t node_cpus;
+    uint32_t node_of[KORA_CPUSET_SIZE];
+    long core_key[KORA_CPUSET_SIZE];
+    uint32_t core_threads[KORA_CPUSET_SIZE];
+    uint32_t cores = 0;
+    uint32_t packages = 0;
+    long package_seen[64];
+    size_t written = 0;
+
+    if (topo == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    memset(topo, 0, sizeof(*topo));
+
+    if (read_sysfs_line(SYSFS_CPU "/online", list, sizeof(list)) != 0 ||
+        parse_cpu_list(list, &online) != 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        KORA_CPU_ZERO(&online);
+        for (long cpu = 0; cpu < n && cpu < KORA_CPUSET_SIZE; cpu++) {
+            KORA_CPU_SET(cpu, &online);
+        }
+    }
+
+    /* Machines without NUMA have no node directory; everything is node 0 */
+    memset(node_of, 0, sizeof(node_of));
+    DIR *dir = opendir(SYSFS_NODE);
+    if (dir) {
+        struct dirent *ent;
+        while ((ent = readdir(dir)) != NULL) {
+            unsigned node;
+            char tail;
+            if (sscanf(ent->d_name, "node%u%c", &node, &tail) != 1) {
+                continue;
+            }
+            topo->numa_nodes++;
+            snprintf(path, sizeof(path), SYSFS_NODE "/node%u/cpulist", node);
+            if (read_sysfs_line(path, list, sizeof(list)) != 0 ||
+                parse_cpu_list(list, &node_cpus) != 0) {
+                continue;
+            }
+            for (int cpu = 0; cpu < KORA_CPUSET_SIZE; cpu++) {
+                if (KORA_CPU_ISSET(cpu, &node_cpus)) {
+                    node_of[cpu] = node;
+                }
+            }
+        }
+        closedir(dir);
+    }
+    if (topo->numa_nodes == 0) {
+        topo->numa_nodes = 1;
+    }
+
+    int first = -1;
+    for (int cpu = 0; cpu < KORA_CPUSET_SIZE; cpu++) {
+        if (!KORA_CPU_ISSET(cpu, &online)) {
+            continue;
+        }
+        if (first < 0) {
+            first = cpu;
+        }
+        topo->logical_cpus++;
+
+        long package = 0;
+        long core_id = cpu;
+        snprintf(path, sizeof(path), SYSFS_CPU "/cpu%d/topology/physical_package_id", cpu);
+        if (read_sysfs_long(path, &package) != 0 || package < 0) {
+            package = 0;
+        }
+        snprintf(path, sizeof(path), SYSFS_CPU "/cpu%d/topology/core_id", cpu);
+        if (read_sysfs_long(path, &core_id) != 0 || core_id < 0) {
+            core_id = cpu;
+        }
+
+        /* core_id is only unique within a package */
+        long key = (package << 20) | core_id;
+        uint32_t core = 0;
+        while (core < cores && core_key[core] != key) {
+            core++;
+        }
+        if (core == cores) {
+            core_key[cores] = key;
+            core_threads[cores] = 0;
+            cores++;
+        }
+        uint32_t smt_index = core_threads[core]++;
+
+        uint32_t p = 0;
+        while (p < packages && package_seen[p] != package) {
+            p++;
+        }
+        if (p == packages && packages < 64) {
+            package_seen[packages++] = package;
+        }
+
+        if (cpus && written < max) {
+            cpus[written].cpu = (uint32_t)cpu;
+            cpus[written].core = core;
+            cpus[written].package = (uint32_t)package;
+            cpus[written].node = node_of[cpu];
+            cpus[written].smt_index = smt_index;
+            written++;
+        }
+        if (smt_index + 1 > topo->threads_per_core) {
+            topo->threads_per_core = smt_index + 1;
+        }
+    }
+
+    topo->physical_cores = cores;
+    topo->packages = packages;
+    if (first >= 0) {
+        read_cache_sizes((unsigned)first, topo);
+    }
+    return (int)written;
+}
+
 int linux_sys_pipe(int fds[2])
 {
 #ifdef __linux__
@@ -686,6 +1562,95 @@ int linux_sys_pipe(int fds[2])
     return 0;
 }
 
+int linux_sys_pipe2(int fds[2], int flags)
+{
+    int linux_flags = 0;
+
+    if (flags & KORA_PIPE_NONBLOCK) {
+        linux_flags |= O_NONBLOCK;
+    }
+    if (flags & KORA_PIPE_CLOEXEC) {
+        linux_flags |= O_CLOEXEC;
+    }
+
+    if (pipe2(fds, linux_flags) != 0) {
+        kora_record_error(SYS_PIPE2, errno);
+        return -1;
+    }
+    return 0;
+}
+
+int linux_sys_pipe_size(int fd, int size)
+{
+    int result;
+
+    if (size > 0) {
+        /* The kernel rounds the request up to a power-of-two number of pages */
+        result = fcntl(fd, F_SETPIPE_SZ, size);
+    } else {
+        result = fcntl(fd, F_GETPIPE_SZ);
+    }
+
+    if (result < 0) {
+        kora_record_error(SYS_PIPE_SIZE, errno);
+        return -1;
+    }
+    return result;
+}
+
+/**
+ * Convert Kora splice flags to Linux splice flags
+ */
+static unsigned convert_splice_flags(unsigned kora_flags)
+{
+    unsigned linux_flags = 0;
+
+    if (kora_flags & KORA_SPLICE_MOVE) {
+        linux_flags |= SPLICE_F_MOVE;
+    }
+    if (kora_flags & KORA_SPLICE_NONBLOCK) {
+        linux_flags |= SPLICE_F_NONBLOCK;
+    }
+    if (kora_flags & KORA_SPLICE_MORE) {
+        linux_flags |= SPLICE_F_MORE;
+    }
+
+    return linux_flags;
+}
+
+long linux_sys_splice(int fd_in, int64_t *off_in, int fd_out, int64_t *off_out,
+                      size_t len, unsigned flags)
+{
+    loff_t in_pos = off_in ? (loff_t)*off_in : 0;
+    loff_t out_pos = off_out ? (loff_t)*off_out : 0;
+
+    ssize_t result = splice(fd_in, off_in ? &in_pos : NULL,
+                            fd_out, off_out ? &out_pos : NULL,
+                            len, convert_splice_flags(flags));
+    if (result < 0) {
+        kora_record_error(SYS_SPLICE, errno);
+        return -1;
+    }
+
+    if (off_in) {
+        *off_in = (int64_t)in_pos;
+    }
+    if (off_out) {
+        *off_out = (int64_t)out_pos;
+    }
+    return (long)result;
+}
+
+long linux_sys_tee(int fd_in, int fd_out, size_t len, unsigned flags)
+{
+    ssize_t result = tee(fd_in, fd_out, len, convert_splice_flags(flags));
+    if (result < 0) {
+        kora_record_error(SYS_TEE, errno);
+        return -1;
+    }
+    return (long)result;
+}
+
 int linux_sys_dup(int oldfd)
 {
     return dup(oldfd);
@@ -740,7 +1705,90 @@ int linux_sys_setitimer(int which, const struct itimerval *new, struct itimerval
 
 sighandler_t linux_sys_signal(int signum, sighandler_t handler)
 {
-    return signal(signum, handler);
+    struct sigaction act;
+    struct sigaction old;
+
+    /* Spell out BSD semantics rather than relying on glibc feature macros */
+    memset(&act, 0, sizeof(act));
+    act.sa_handler = handler;
+    act.sa_flags = SA_RESTART;
+    sigemptyset(&act.sa_mask);
+
+    if (sigaction(signum, &act, &old) != 0) {
+        kora_record_error(SYS_SIGNAL, errno);
+        return SIG_ERR;
+    }
+    return old.sa_handler;
+}
+
+int linux_sys_sigaction(int signum, const struct sigaction *act, struct sigaction *oldact)
+{
+    if (sigaction(signum, act, oldact) != 0) {
+        kora_record_error(SYS_SIGACTION, errno);
+        return -1;
+    }
+    return 0;
+}
+
+int linux_sys_sigprocmask(int how, const sigset_t *set, sigset_t *oldset)
+{
+    /* Per-thread mask, as sigprocmask is unspecified in threaded programs */
+    int result = pthread_sigmask(how, set, oldset);
+    if (result != 0) {
+        errno = result;
+        kora_record_error(SYS_SIGPROCMASK, result);
+        return -1;
+    }
+    return 0;
+}
+
+int linux_sys_signalfd(const sigset_t *mask, int flags)
+{
+    int linux_flags = 0;
+
+    if (flags & KORA_SIGNALFD_NONBLOCK) {
+        linux_flags |= SFD_NONBLOCK;
+    }
+    if (flags & KORA_SIGNALFD_CLOEXEC) {
+        linux_flags |= SFD_CLOEXEC;
+    }
+
+    int fd = signalfd(-1, mask, linux_flags);
+    if (fd < 0) {
+        kora_record_error(SYS_SIGNALFD, errno);
+        return -1;
+    }
+    return fd;
+}
+
+int linux_sys_signalfd_read(int fd, kora_siginfo_t *info, size_t max)
+{
+    struct signalfd_siginfo host[16];
+    size_t want = max < 16 ? max : 16;
+
+    if (info == NULL || max == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    /* The kernel hands out as many whole records as fit in one read */
+    ssize_t result = read(fd, host, want * sizeof(host[0]));
+    if (result < 0) {
+        kora_record_error(SYS_SIGNALFD_READ, errno);
+        return -1;
+    }
+
+    size_t count = (size_t)result / sizeof(host[0]);
+    for (size_t i = 0; i < count; i++) {
+        info[i].signo = (int32_t)host[i].ssi_signo;
+        info[i].code = host[i].ssi_code;
+        info[i].pid = (int32_t)host[i].ssi_pid;
+        info[i].uid = host[i].ssi_uid;
+        info[i].status = host[i].ssi_status;
+        info[i].reserved = 0;
+        info[i].value = host[i].ssi_ptr;
+    }
+    return (int)count;
 }
 
 int linux_sys_kill(pid_t pid, int signum)
@@ -778,3 +1826,10 @@ int linux_sys_mount(const char *src, const char *tgt, const char *type,
     return -1;
 }
 
+int linux_sys_umount(const char *tgt)
+{
+    (void)tgt;
+    errno = ENOSYS;
+    return -1;
+}
+
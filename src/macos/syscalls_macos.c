@@ -1,4 +1,6 @@
 #include <internal/syscall_impl.h>
+#include <internal/error.h>
+#include <internal/fdtable.h>
 #include <kora/syscalls.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -10,6 +12,7 @@
 #include <dirent.h>
 #include <string.h>
 #include <stdint.h>
+#include <limits.h>
 #include <sys/mman.h>
 #include <spawn.h>
 #include <sys/wait.h>
@@ -20,6 +23,12 @@
 #include <time.h>
 #include <signal.h>
 #include <sys/time.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sys/event.h>
+#include <sys/sysctl.h>
+#include <sys/qos.h>
+#include <mach/mach.h>
 extern char **environ;
 
 /**
@@ -31,27 +40,6 @@ extern char **environ;
 
 #if defined(KORA_PLATFORM_MACOS)
 
-// Global array to store DIR pointers
-// This is a simplification for the compatibility layer.
-// In a real implementation, we would use a more sophisticated handle table
-// with proper locking for thread safety and memory management.
-#define MAX_DIR_HANDLES 16
-static DIR* dir_handles[MAX_DIR_HANDLES] = {NULL};
-
-/**
- * Find a free slot in the dir_handles array
- * 
- * @return Index of a free slot or -1 if none available
- */
-static int find_free_dir_handle(void) {
-    for (int i = 0; i < MAX_DIR_HANDLES; i++) {
-        if (dir_handles[i] == NULL) {
-            return i;
-        }
-    }
-    return -1;  // No free slots
-}
-
 int macos_sys_putc(char c) {
     int result = putchar(c);
     if (result == EOF) {
@@ -109,6 +97,7 @@ int macos_sys_open(const char *path, int flags) {
     }
     
     if (fd < 0) {
+        kora_record_error(SYS_OPEN, errno);
         return KORA_ERROR;
     }
     
@@ -118,6 +107,7 @@ int macos_sys_open(const char *path, int flags) {
 int macos_sys_close(int fd) {
     int result = close(fd);
     if (result < 0) {
+        kora_record_error(SYS_CLOSE, errno);
         return KORA_ERROR;
     }
     return KORA_SUCCESS;
@@ -127,6 +117,7 @@ int macos_sys_read(int fd, void *buf, size_t count) {
     ssize_t result = read(fd, buf, count);
     
     if (result < 0) {
+        kora_record_error(SYS_READ, errno);
         return KORA_ERROR;
     }
     
@@ -141,6 +132,7 @@ int macos_sys_write(int fd, const void *buf, size_t count) {
     ssize_t result = write(fd, buf, count);
     
     if (result < 0) {
+        kora_record_error(SYS_WRITE, errno);
         return KORA_ERROR;
     }
     
@@ -168,16 +160,81 @@ long macos_sys_seek(int fd, long offset, int whence) {
     off_t result = lseek(fd, offset, macos_whence);
     
     if (result < 0) {
+        kora_record_error(SYS_SEEK, errno);
         return KORA_ERROR;
     }
     
     return (long)result;
 }
 
+int macos_sys_readahead(int fd, uint64_t offset, size_t count) {
+    struct radvisory ra;
+
+    /* F_RDADVISE takes an int count, so clamp very large requests */
+    ra.ra_offset = (off_t)offset;
+    ra.ra_count = count > INT_MAX ? INT_MAX : (int)count;
+
+    if (fcntl(fd, F_RDADVISE, &ra) < 0) {
+        kora_record_error(SYS_READAHEAD, errno);
+        return -errno;
+    }
+
+    return 0;
+}
+
+int macos_sys_fadvise(int fd, uint64_t offset, uint64_t len, int advice) {
+    int result;
+
+    /*
+     * macOS has no posix_fadvise. Read-ahead can be toggled per descriptor
+     * with F_RDAHEAD, prefetching is requested with F_RDADVISE and F_NOCACHE
+     * keeps single-use data out of the unified buffer cache.
+     */
+    switch (advice) {
+        case KORA_FADV_NORMAL:
+        case KORA_FADV_SEQUENTIAL:
+            result = fcntl(fd, F_RDAHEAD, 1);
+            break;
+        case KORA_FADV_RANDOM:
+            result = fcntl(fd, F_RDAHEAD, 0);
+            break;
+        case KORA_FADV_WILLNEED:
+            if (len == 0) {
+                struct stat st;
+                if (fstat(fd, &st) != 0) {
+                    kora_record_error(SYS_FADVISE, errno);
+                    return -errno;
+                }
+                if ((uint64_t)st.st_size <= offset) {
+                    return 0;
+                }
+                len = (uint64_t)st.st_size - offset;
+            }
+            return macos_sys_readahead(fd, offset, (size_t)len);
+        case KORA_FADV_DONTNEED:
+            /* No way to drop cached pages; only validate the descriptor */
+            result = fcntl(fd, F_GETFL);
+            break;
+        case KORA_FADV_NOREUSE:
+            result = fcntl(fd, F_NOCACHE, 1);
+            break;
+        default:
+            return -EINVAL;
+    }
+
+    if (result < 0) {
+        kora_record_error(SYS_FADVISE, errno);
+        return -errno;
+    }
+
+    return 0;
+}
+
 int macos_sys_ioctl(int fd, unsigned long request, void *arg) {
     int result = ioctl(fd, request, arg);
     
     if (result < 0) {
+        kora_record_error(SYS_IOCTL, errno);
         return KORA_ERROR;
     }
     
@@ -196,8 +253,7 @@ int macos_sys_mkdir(const char *path) {
             }
         }
         
-        fprintf(stderr, "macos_sys_mkdir: Failed to create directory %s: %s\n", 
-                path, strerror(errno));
+        kora_record_error(SYS_MKDIR, errno);
         return KORA_ERROR;
     }
     
@@ -208,42 +264,46 @@ int macos_sys_rmdir(const char *path) {
     int result = rmdir(path);
     
     if (result < 0) {
+        kora_record_error(SYS_RMDIR, errno);
         return KORA_ERROR;
     }
     
     return KORA_SUCCESS;
 }
 
+/*
+ * A host directory handle is the descriptor under its DIR, which is
+ * attached to that descriptor's entry in the descriptor table. The
+ * kernel keeps the numbers unique, so opening needs no lock and no
+ * search, and there are as many handles as descriptors.
+ */
 int macos_sys_opendir(const char *path) {
     DIR *dir = opendir(path);
     
     if (dir == NULL) {
-        fprintf(stderr, "macos_sys_opendir: Failed to open directory %s: %s\n", 
-                path, strerror(errno));
+        kora_record_error(SYS_OPENDIR, errno);
         return KORA_ERROR;
     }
     
-    // Find a free slot in the handle table
-    int handle = find_free_dir_handle();
-    if (handle < 0) {
-        fprintf(stderr, "macos_sys_opendir: No free DIR handle slots\n");
+    int handle = dirfd(dir);
+    int r = kora_fd_attach(handle, dir);
+    if (r < 0) {
         closedir(dir);
+        errno = -r;
+        kora_record_error(SYS_OPENDIR, errno);
         return KORA_ERROR;
     }
-    
-    // Store the DIR pointer in the handle table
-    dir_handles[handle] = dir;
     return handle;
 }
 
 int macos_sys_readdir(int dir, kora_dirent_t *entry) {
-    if (dir < 0 || dir >= MAX_DIR_HANDLES || dir_handles[dir] == NULL || entry == NULL) {
-        fprintf(stderr, "macos_sys_readdir: Invalid parameters (dir=%d, entry=%p)\n", 
-                dir, (void*)entry);
+    DIR *dirp = kora_fd_attached(dir);
+    if (dirp == NULL || entry == NULL) {
+        errno = EBADF;
+        kora_record_error(SYS_READDIR, EBADF);
         return KORA_ERROR;
     }
     
-    DIR *dirp = dir_handles[dir];
     struct dirent *macos_entry;
     
     errno = 0;
@@ -251,8 +311,7 @@ int macos_sys_readdir(int dir, kora_dirent_t *entry) {
     
     if (macos_entry == NULL) {
         if (errno != 0) {
-            fprintf(stderr, "macos_sys_readdir: Error reading directory: %s\n", 
-                    strerror(errno));
+            kora_record_error(SYS_READDIR, errno);
             return KORA_ERROR;
         }
         return 0;  /* End of directory */
@@ -284,23 +343,19 @@ int macos_sys_readdir(int dir, kora_dirent_t *entry) {
 }
 
 int macos_sys_closedir(int dir) {
-    if (dir < 0 || dir >= MAX_DIR_HANDLES || dir_handles[dir] == NULL) {
-        fprintf(stderr, "macos_sys_closedir: Invalid directory handle %d\n", dir);
+    DIR *dirp = kora_fd_detach(dir);
+    if (dirp == NULL) {
+        errno = EBADF;
+        kora_record_error(SYS_CLOSEDIR, EBADF);
         return KORA_ERROR;
     }
     
-    DIR *dirp = dir_handles[dir];
-    int result = closedir(dirp);
-    
-    if (result < 0) {
-        fprintf(stderr, "macos_sys_closedir: Error closing directory: %s\n", 
-                strerror(errno));
+    /* The descriptor is closed even when closedir reports an error */
+    if (closedir(dirp) < 0) {
+        kora_record_error(SYS_CLOSEDIR, errno);
         return KORA_ERROR;
     }
     
-    // Clear the handle
-    dir_handles[dir] = NULL;
-    
     return KORA_SUCCESS;
 }
 
@@ -308,6 +363,7 @@ int macos_sys_symlink(const char *target, const char *linkpath) {
     int result = symlink(target, linkpath);
     
     if (result < 0) {
+        kora_record_error(SYS_SYMLINK, errno);
         return KORA_ERROR;
     }
     
@@ -318,6 +374,7 @@ int macos_sys_readlink(const char *path, char *buf, size_t size) {
     ssize_t result = readlink(path, buf, size - 1);
     
     if (result < 0) {
+        kora_record_error(SYS_READLINK, errno);
         return KORA_ERROR;
     }
     
@@ -338,6 +395,7 @@ int macos_sys_get_file_info(const char *path, kora_file_info_t *info)
 
     struct stat st;
     if (stat(path, &st) != 0) {
+        kora_record_error(SYS_GET_FILE_INFO, errno);
         return -errno;
     }
 
@@ -386,6 +444,7 @@ int macos_sys_get_fd_info(int fd, kora_file_info_t *info)
 
     struct stat st;
     if (fstat(fd, &st) != 0) {
+        kora_record_error(SYS_GET_FD_INFO, errno);
         return -errno;
     }
 
@@ -429,6 +488,7 @@ int macos_sys_stat(const char *path, kora_stat_t *st)
 
     struct stat host;
     if (stat(path, &host) != 0) {
+        kora_record_error(SYS_STAT, errno);
         return -errno;
     }
 
@@ -449,6 +509,7 @@ int macos_sys_fstat(int fd, kora_stat_t *st)
 
     struct stat host;
     if (fstat(fd, &host) != 0) {
+        kora_record_error(SYS_FSTAT, errno);
         return -errno;
     }
 
@@ -469,6 +530,7 @@ int macos_sys_lstat(const char *path, kora_stat_t *st)
 
     struct stat host;
     if (lstat(path, &host) != 0) {
+        kora_record_error(SYS_LSTAT, errno);
         return -errno;
     }
 
@@ -487,6 +549,7 @@ int macos_sys_link(const char *existing, const char *newpath)
         return -EINVAL;
     }
     if (link(existing, newpath) != 0) {
+        kora_record_error(SYS_LINK, errno);
         return -errno;
     }
     return 0;
@@ -498,6 +561,7 @@ int macos_sys_chdir(const char *path)
         return -EINVAL;
     }
     if (chdir(path) != 0) {
+        kora_record_error(SYS_CHDIR, errno);
         return -errno;
     }
     return 0;
@@ -509,6 +573,7 @@ int macos_sys_getcwd(char *buf, size_t size)
         return -EINVAL;
     }
     if (getcwd(buf, size) == NULL) {
+        kora_record_error(SYS_GETCWD, errno);
         return -errno;
     }
     return 0;
@@ -524,6 +589,7 @@ int macos_sys_utime(const char *path, uint64_t mtime)
     tv[0].tv_usec = 0;
     tv[1] = tv[0];
     if (utimes(path, tv) != 0) {
+        kora_record_error(SYS_UTIME, errno);
         return -errno;
     }
     return 0;
@@ -547,6 +613,7 @@ int macos_sys_exists(const char *path, uint8_t *type)
             return 0;
         }
         // Error during stat
+        kora_record_error(SYS_EXISTS, errno);
         return -errno;
     }
 
@@ -576,6 +643,7 @@ int macos_sys_unlink(const char *path)
     }
     
     if (unlink(path) != 0) {
+        kora_record_error(SYS_UNLINK, errno);
         return -errno;
     }
     
@@ -591,6 +659,7 @@ int macos_sys_rename(const char *oldpath, const char *newpath)
         return -EINVAL;
     }
     if (rename(oldpath, newpath) != 0) {
+        kora_record_error(SYS_RENAME, errno);
         return -errno;
     }
     return 0;
@@ -628,6 +697,119 @@ int macos_sys_mprotect(void *addr, size_t len, int prot)
     return mprotect(addr, len, prot);
 }
 
+/**
+ * Copy a shared memory name, adding the leading '/' shm_open expects
+ */
+static int normalize_shm_name(const char *name, char *buf, size_t size)
+{
+    int len = snprintf(buf, size, "%s%s", name[0] == '/' ? "" : "/", name);
+    if (len < 0 || (size_t)len >= size) {
+        return -1;
+    }
+    return 0;
+}
+
+static atomic_uint anon_shm_counter;
+
+int macos_sys_shm_create(const char *name, uint64_t size, int flags)
+{
+    char shm_name[PATH_MAX];
+    int created;   /* This call made the named object */
+    int fd;
+
+    if (name == NULL) {
+        /* No memfd on macOS: create a uniquely named object and unlink it */
+        snprintf(shm_name, sizeof(shm_name), "/kora.%d.%u", (int)getpid(),
+                 atomic_fetch_add(&anon_shm_counter, 1));
+    } else if (normalize_shm_name(name, shm_name, sizeof(shm_name)) != 0) {
+        errno = ENAMETOOLONG;
+        kora_record_error(SYS_SHM_CREATE, errno);
+        return -1;
+    }
+
+    /* Try to create it first, so a failure below knows whether to unlink */
+    fd = shm_open(shm_name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    created = fd >= 0;
+    if (fd < 0 && errno == EEXIST && name != NULL && !(flags & KORA_SHM_EXCL)) {
+        fd = shm_open(shm_name, O_RDWR | O_CREAT, 0600);
+    }
+    if (fd < 0) {
+        kora_record_error(SYS_SHM_CREATE, errno);
+        return -1;
+    }
+    if (name == NULL) {
+        shm_unlink(shm_name);
+        created = 0;
+    }
+    /* shm_open always sets FD_CLOEXEC; clear it so children inherit */
+    if (!(flags & KORA_SHM_CLOEXEC)) {
+        fcntl(fd, F_SETFD, 0);
+    }
+
+    if (ftruncate(fd, (off_t)size) != 0) {
+        int err = errno;
+        close(fd);
+        /* Leave no half-made name behind to fail the next create with EEXIST */
+        if (created) {
+            shm_unlink(shm_name);
+        }
+        errno = err;
+        kora_record_error(SYS_SHM_CREATE, err);
+        return -1;
+    }
+
+    return fd;
+}
+
+int macos_sys_shm_open(const char *name, int flags)
+{
+    char shm_name[PATH_MAX];
+
+    if (name == NULL || normalize_shm_name(name, shm_name, sizeof(shm_name)) != 0) {
+        errno = name ? ENAMETOOLONG : EINVAL;
+        kora_record_error(SYS_SHM_OPEN, errno);
+        return -1;
+    }
+
+    int fd = shm_open(shm_name, (flags & KORA_SHM_RDONLY) ? O_RDONLY : O_RDWR, 0);
+    if (fd < 0) {
+        kora_record_error(SYS_SHM_OPEN, errno);
+        return -1;
+    }
+    if (!(flags & KORA_SHM_CLOEXEC)) {
+        fcntl(fd, F_SETFD, 0);
+    }
+
+    return fd;
+}
+
+int macos_sys_shm_unlink(const char *name)
+{
+    char shm_name[PATH_MAX];
+
+    if (name == NULL || normalize_shm_name(name, shm_name, sizeof(shm_name)) != 0) {
+        errno = name ? ENAMETOOLONG : EINVAL;
+        kora_record_error(SYS_SHM_UNLINK, errno);
+        return -1;
+    }
+
+    if (shm_unlink(shm_name) != 0) {
+        kora_record_error(SYS_SHM_UNLINK, errno);
+        return -1;
+    }
+    return 0;
+}
+
+int macos_sys_shm_seal(int fd, unsigned seals)
+{
+    (void)fd;
+    (void)seals;
+    /* File sealing is Linux-specific */
+    errno = ENOTSUP;
+    kora_record_error(SYS_SHM_SEAL, ENOTSUP);
+    return -1;
+}
+
 pid_t macos_sys_spawn(const char *path, char *const argv[], char *const envp[])
 {
     pid_t pid;
@@ -654,6 +836,181 @@ pid_t macos_sys_wait(pid_t pid, int *status, int options)
     return res;
 }
 
+static uint64_t timeval_to_ns(struct timeval tv)
+{
+    return (uint64_t)tv.tv_sec * 1000000000ull + (uint64_t)tv.tv_usec * 1000ull;
+}
+
+static void convert_rusage(const struct rusage *ru, kora_rusage_t *usage)
+{
+    usage->utime_ns = timeval_to_ns(ru->ru_utime);
+    usage->stime_ns = timeval_to_ns(ru->ru_stime);
+    usage->maxrss_kb = (uint64_t)ru->ru_maxrss / 1024;  /* Darwin reports bytes */
+    usage->minflt = (uint64_t)ru->ru_minflt;
+    usage->majflt = (uint64_t)ru->ru_majflt;
+    usage->inblock = (uint64_t)ru->ru_inblock;
+    usage->oublock = (uint64_t)ru->ru_oublock;
+    usage->nvcsw = (uint64_t)ru->ru_nvcsw;
+    usage->nivcsw = (uint64_t)ru->ru_nivcsw;
+}
+
+pid_t macos_sys_wait4(pid_t pid, int *status, int options, kora_rusage_t *usage)
+{
+    struct rusage ru;
+    pid_t res = wait4(pid, status, options, &ru);
+    if (res < 0) {
+        kora_record_error(SYS_WAIT4, errno);
+        return -1;
+    }
+    if (usage) {
+        if (res > 0) {
+            convert_rusage(&ru, usage);
+        } else {
+            memset(usage, 0, sizeof(*usage));
+        }
+    }
+    return res;
+}
+
+int macos_sys_getrusage(int who, kora_rusage_t *usage)
+{
+    struct rusage ru;
+
+    if (who == KORA_RUSAGE_THREAD) {
+        /* No RUSAGE_THREAD on Darwin; Mach reports per-thread CPU time only */
+        thread_basic_info_data_t info;
+        mach_msg_type_number_t count = THREAD_BASIC_INFO_COUNT;
+        mach_port_t self = mach_thread_self();
+        kern_return_t kr = thread_info(self, THREAD_BASIC_INFO, (thread_info_t)&info, &count);
+        mach_port_deallocate(mach_task_self(), self);
+        if (kr != KERN_SUCCESS) {
+            errno = EINVAL;
+            kora_record_error(SYS_GETRUSAGE, EINVAL);
+            return -1;
+        }
+        memset(usage, 0, sizeof(*usage));
+        usage->utime_ns = (uint64_t)info.user_time.seconds * 1000000000ull +
+                          (uint64_t)info.user_time.microseconds * 1000ull;
+        usage->stime_ns = (uint64_t)info.system_time.seconds * 1000000000ull +
+                          (uint64_t)info.system_time.microseconds * 1000ull;
+        return 0;
+    }
+    if (who != KORA_RUSAGE_SELF && who != KORA_RUSAGE_CHILDREN) {
+        errno = EINVAL;
+        kora_record_error(SYS_GETRUSAGE, EINVAL);
+        return -1;
+    }
+
+    if (getrusage(who == KORA_RUSAGE_SELF ? RUSAGE_SELF : RUSAGE_CHILDREN, &ru) != 0) {
+        kora_record_error(SYS_GETRUSAGE, errno);
+        return -1;
+    }
+    convert_rusage(&ru, usage);
+    return 0;
+}
+
+/*
+ * Threads are plain pthreads. There is no supported way to start a thread
+ * with a foreign thread pointer on Darwin, so a caller TLS block is refused.
+ */
+struct kora_thread {
+    void *(*entry)(void *);
+    void *arg;
+    pthread_t pthread;
+    int joinable;
+};
+
+static KORA_THREAD_LOCAL struct kora_thread *current_thread;
+/* Handle of a thread the layer did not start; gone with the thread, so nothing to free */
+static KORA_THREAD_LOCAL struct kora_thread foreign_thread;
+
+static void *thread_trampoline(void *arg)
+{
+    struct kora_thread *t = arg;
+
+    current_thread = t;
+    kora_clear_error();
+    return t->entry(t->arg);
+}
+
+int macos_sys_thread_create(kora_thread_t *thread, const kora_thread_attr_t *attr,
+                            void *(*entry)(void *), void *arg)
+{
+    if (thread == NULL || entry == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (attr && attr->tls) {
+        errno = ENOTSUP;
+        kora_record_error(SYS_THREAD_CREATE, ENOTSUP);
+        return -1;
+    }
+
+    struct kora_thread *t = calloc(1, sizeof(*t));
+    if (!t) {
+        kora_record_error(SYS_THREAD_CREATE, ENOMEM);
+        return -1;
+    }
+    t->entry = entry;
+    t->arg = arg;
+    t->joinable = 1;
+
+    pthread_attr_t pattr;
+    pthread_attr_init(&pattr);
+    int result = 0;
+    if (attr && attr->stack) {
+        result = pthread_attr_setstack(&pattr, attr->stack, attr->stack_size);
+    } else if (attr && attr->stack_size) {
+        result = pthread_attr_setstacksize(&pattr, attr->stack_size);
+    }
+    if (result == 0) {
+        result = pthread_create(&t->pthread, &pattr, thread_trampoline, t);
+    }
+    pthread_attr_destroy(&pattr);
+
+    if (result != 0) {
+        errno = result;
+        kora_record_error(SYS_THREAD_CREATE, result);
+        free(t);
+        return -1;
+    }
+    *thread = t;
+    return 0;
+}
+
+int macos_sys_thread_join(kora_thread_t thread, void **retval)
+{
+    if (thread == NULL || !thread->joinable) {
+        errno = EINVAL;
+        kora_record_error(SYS_THREAD_JOIN, EINVAL);
+        return -1;
+    }
+
+    int result = pthread_join(thread->pthread, retval);
+    if (result != 0) {
+        errno = result;
+        kora_record_error(SYS_THREAD_JOIN, result);
+        return -1;
+    }
+    free(thread);
+    return 0;
+}
+
+void macos_sys_thread_exit(void *retval)
+{
+    pthread_exit(retval);
+}
+
+kora_thread_t macos_sys_thread_self(void)
+{
+    if (current_thread == NULL) {
+        /* First call from a thread the layer did not start */
+        foreign_thread.pthread = pthread_self();
+        current_thread = &foreign_thread;
+    }
+    return current_thread;
+}
+
 int macos_sys_yield(void)
 {
     return sched_yield();
@@ -674,6 +1031,268 @@ int macos_sys_setpriority(pid_t pid, int prio)
     return setpriority(PRIO_PROCESS, pid, prio);
 }
 
+pid_t macos_sys_gettid(void)
+{
+    uint64_t tid = 0;
+    pthread_threadid_np(NULL, &tid);
+    return (pid_t)tid;
+}
+
+/*
+ * pthread scheduling only applies to the calling thread here; there is no
+ * way to reach another thread by ID.
+ */
+static int is_self_thread(pid_t tid)
+{
+    return tid == 0 || tid == macos_sys_gettid();
+}
+
+int macos_sys_sched_setpolicy(pid_t tid, int policy, int priority)
+{
+    struct sched_param param;
+    int host;
+    int result;
+
+    if (!is_self_thread(tid)) {
+        errno = ENOTSUP;
+        kora_record_error(SYS_SCHED_SETPOLICY, ENOTSUP);
+        return -1;
+    }
+
+    switch (policy) {
+    case KORA_SCHED_OTHER:
+        result = pthread_set_qos_class_self_np(QOS_CLASS_DEFAULT, 0);
+        host = SCHED_OTHER;
+        break;
+    case KORA_SCHED_FIFO:
+        result = 0;
+        host = SCHED_FIFO;
+        break;
+    case KORA_SCHED_RR:
+        result = 0;
+        host = SCHED_RR;
+        break;
+    case KORA_SCHED_BATCH:
+        /* Quality-of-service classes are the closest match */
+        result = pthread_set_qos_class_self_np(QOS_CLASS_UTILITY, 0);
+        host = -1;
+        break;
+    case KORA_SCHED_IDLE:
+        result = pthread_set_qos_class_self_np(QOS_CLASS_BACKGROUND, 0);
+        host = -1;
+        break;
+    default:
+        errno = EINVAL;
+        kora_record_error(SYS_SCHED_SETPOLICY, EINVAL);
+        return -1;
+    }
+
+    if (result == 0 && host >= 0) {
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = priority;
+        result = pthread_setschedparam(pthread_self(), host, &param);
+    }
+    if (result != 0) {
+        errno = result;
+        kora_record_error(SYS_SCHED_SETPOLICY, result);
+        return -1;
+    }
+    return 0;
+}
+
+int macos_sys_sched_getpolicy(pid_t tid, int *priority)
+{
+    struct sched_param param;
+    int host;
+    qos_class_t qos;
+
+    if (!is_self_thread(tid)) {
+        errno = ENOTSUP;
+        kora_record_error(SYS_SCHED_GETPOLICY, ENOTSUP);
+        return -1;
+    }
+
+    int result = pthread_getschedparam(pthread_self(), &host, &param);
+    if (result != 0) {
+        errno = result;
+        kora_record_error(SYS_SCHED_GETPOLICY, result);
+        return -1;
+    }
+    if (priority) {
+        *priority = param.sched_priority;
+    }
+
+    if (host == SCHED_FIFO) {
+        return KORA_SCHED_FIFO;
+    }
+    if (host == SCHED_RR) {
+        return KORA_SCHED_RR;
+    }
+    qos = qos_class_self();
+    if (qos == QOS_CLASS_UTILITY) {
+        return KORA_SCHED_BATCH;
+    }
+    if (qos == QOS_CLASS_BACKGROUND) {
+        return KORA_SCHED_IDLE;
+    }
+    return KORA_SCHED_OTHER;
+}
+
+int macos_sys_ioprio_set(pid_t tid, int ioclass, int level)
+{
+    int policy;
+
+    if (!is_self_thread(tid)) {
+        errno = ENOTSUP;
+        kora_record_error(SYS_IOPRIO_SET, ENOTSUP);
+        return -1;
+    }
+
+    /* Darwin has I/O tiers rather than levels within a class */
+    (void)level;
+    switch (ioclass) {
+    case KORA_IOPRIO_CLASS_NONE: policy = IOPOL_DEFAULT; break;
+    case KORA_IOPRIO_CLASS_RT:   policy = IOPOL_IMPORTANT; break;
+    case KORA_IOPRIO_CLASS_BE:   policy = IOPOL_STANDARD; break;
+    case KORA_IOPRIO_CLASS_IDLE: policy = IOPOL_THROTTLE; break;
+    default:
+        errno = EINVAL;
+        kora_record_error(SYS_IOPRIO_SET, EINVAL);
+        return -1;
+    }
+
+    if (setiopolicy_np(IOPOL_TYPE_DISK, IOPOL_SCOPE_THREAD, policy) != 0) {
+        kora_record_error(SYS_IOPRIO_SET, errno);
+        return -1;
+    }
+    return 0;
+}
+
+int macos_sys_ioprio_get(pid_t tid, int *level)
+{
+    if (!is_self_thread(tid)) {
+        errno = ENOTSUP;
+        kora_record_error(SYS_IOPRIO_GET, ENOTSUP);
+        return -1;
+    }
+
+    int policy = getiopolicy_np(IOPOL_TYPE_DISK, IOPOL_SCOPE_THREAD);
+    if (policy < 0) {
+        kora_record_error(SYS_IOPRIO_GET, errno);
+        return -1;
+    }
+    if (level) {
+        *level = 0;
+    }
+
+    switch (policy) {
+    case IOPOL_IMPORTANT: return KORA_IOPRIO_CLASS_RT;
+    case IOPOL_STANDARD:  return KORA_IOPRIO_CLASS_BE;
+    case IOPOL_THROTTLE:
+    case IOPOL_UTILITY:   return KORA_IOPRIO_CLASS_IDLE;
+    default:              return KORA_IOPRIO_CLASS_NONE;
+    }
+}
+
+int macos_sys_sched_setaffinity(pid_t pid, const kora_cpuset_t *set)
+{
+    /*
+     * Mach only offers affinity tags, which are scheduling hints between
+     * threads rather than a CPU mask, so hard pinning is not possible.
+     */
+    (void)pid; (void)set;
+    errno = ENOTSUP;
+    kora_record_error(SYS_SCHED_SETAFFINITY, ENOTSUP);
+    return -1;
+}
+
+int macos_sys_sched_getaffinity(pid_t pid, kora_cpuset_t *set)
+{
+    (void)pid;
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+
+    /* Every task may run on every CPU */
+    KORA_CPU_ZERO(set);
+    for (long cpu = 0; cpu < n && cpu < KORA_CPUSET_SIZE; cpu++) {
+        KORA_CPU_SET(cpu, set);
+    }
+    return 0;
+}
+
+int macos_sys_getcpu(unsigned *cpu, unsigned *node)
+{
+    (void)cpu; (void)node;
+    errno = ENOTSUP;
+    kora_record_error(SYS_GETCPU, ENOTSUP);
+    return -1;
+}
+
+static uint32_t sysctl_u32(const char *name)
+{
+    uint64_t value = 0;
+    size_t len = sizeof(value);
+
+    /* Some keys are 32-bit and some 64-bit; the buffer fits either */
+    if (sysctlbyname(name, &value, &len, NULL, 0) != 0) {
+        return 0;
+    }
+    if (len == sizeof(uint32_t)) {
+        uint32_t v32;
+        memcpy(&v32, &value, sizeof(v32));
+        return v32;
+    }
+    return value > UINT32_MAX ? UINT32_MAX : (uint32_t)value;
+}
+
+int macos_sys_cpu_topology(kora_cpu_topology_t *topo, kora_cpu_info_t *cpus, size_t max)
+{
+    if (topo == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    memset(topo, 0, sizeof(*topo));
+
+    topo->logical_cpus = sysctl_u32("hw.logicalcpu");
+    topo->physical_cores = sysctl_u32("hw.physicalcpu");
+    topo->packages = sysctl_u32("hw.packages");
+    topo->numa_nodes = 1;
+    topo->cache_line = sysctl_u32("hw.cachelinesize");
+    topo->l1d_size = sysctl_u32("hw.l1dcachesize");
+    topo->l1i_size = sysctl_u32("hw.l1icachesize");
+    topo->l2_size = sysctl_u32("hw.l2cachesize");
+    topo->l3_size = sysctl_u32("hw.l3cachesize");
+
+    if (topo->logical_cpus == 0) {
+        kora_record_error(SYS_CPU_TOPOLOGY, errno);
+        return -1;
+    }
+    if (topo->physical_cores == 0) {
+        topo->physical_cores = topo->logical_cpus;
+    }
+    if (topo->packages == 0) {
+        topo->packages = 1;
+    }
+    if (topo->cache_line == 0) {
+        topo->cache_line = 64;
+    }
+    topo->threads_per_core = topo->logical_cpus / topo->physical_cores;
+    if (topo->threads_per_core == 0) {
+        topo->threads_per_core = 1;
+    }
+
+    /* XNU numbers SMT siblings adjacently */
+    size_t written = 0;
+    for (uint32_t cpu = 0; cpus && cpu < topo->logical_cpus && written < max; cpu++) {
+        cpus[written].cpu = cpu;
+        cpus[written].core = cpu / topo->threads_per_core;
+        cpus[written].package = cpus[written].core * topo->packages / topo->physical_cores;
+        cpus[written].node = 0;
+        cpus[written].smt_index = cpu % topo->threads_per_core;
+        written++;
+    }
+    return (int)written;
+}
+
 int macos_sys_pipe(int fds[2])
 {
     if (pipe(fds) != 0) {
@@ -684,6 +1303,98 @@ int macos_sys_pipe(int fds[2])
     return 0;
 }
 
+int macos_sys_pipe2(int fds[2], int flags)
+{
+    if (pipe(fds) != 0) {
+        kora_record_error(SYS_PIPE2, errno);
+        return -1;
+    }
+
+    /* No pipe2 on macOS, so apply the flags after creation */
+    for (int i = 0; i < 2; i++) {
+        if ((flags & KORA_PIPE_NONBLOCK) &&
+            fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK) < 0) {
+            goto fail;
+        }
+        if ((flags & KORA_PIPE_CLOEXEC) &&
+            fcntl(fds[i], F_SETFD, FD_CLOEXEC) < 0) {
+            goto fail;
+        }
+    }
+    return 0;
+
+fail:
+    kora_record_error(SYS_PIPE2, errno);
+    close(fds[0]);
+    close(fds[1]);
+    return -1;
+}
+
+int macos_sys_pipe_size(int fd, int size)
+{
+    (void)fd;
+    (void)size;
+    /* Pipe buffers grow on demand and cannot be sized explicitly */
+    errno = ENOTSUP;
+    kora_record_error(SYS_PIPE_SIZE, ENOTSUP);
+    return -1;
+}
+
+long macos_sys_splice(int fd_in, int64_t *off_in, int fd_out, int64_t *off_out,
+                      size_t len, unsigned flags)
+{
+    char buf[16384];
+    ssize_t got;
+    ssize_t put = 0;
+
+    (void)flags;
+
+    /*
+     * There is no splice on macOS. Fall back to a single bounded copy
+     * through a stack buffer so callers still make progress.
+     */
+    if (len > sizeof(buf)) {
+        len = sizeof(buf);
+    }
+
+    got = off_in ? pread(fd_in, buf, len, (off_t)*off_in) : read(fd_in, buf, len);
+    if (got < 0) {
+        kora_record_error(SYS_SPLICE, errno);
+        return -1;
+    }
+
+    while (put < got) {
+        ssize_t n = off_out ? pwrite(fd_out, buf + put, (size_t)(got - put),
+                                     (off_t)(*off_out + put))
+                            : write(fd_out, buf + put, (size_t)(got - put));
+        if (n < 0) {
+            kora_record_error(SYS_SPLICE, errno);
+            return -1;
+        }
+        put += n;
+    }
+
+    if (off_in) {
+        *off_in += got;
+    }
+    if (off_out) {
+        *off_out += got;
+    }
+    return (long)got;
+}
+
+long macos_sys_tee(int fd_in, int fd_out, size_t len, unsigned flags)
+{
+    (void)fd_in;
+    (void)fd_out;
+    (void)len;
+    (void)flags;
+    /* Duplicating pipe contents without consuming them is not possible */
+    errno = ENOTSUP;
+    kora_record_error(SYS_TEE, ENOTSUP);
+    return -1;
+}
+
 int macos_sys_dup(int oldfd)
 {
     return dup(oldfd);
@@ -741,6 +1452,103 @@ sighandler_t macos_sys_signal(int signum, sighandler_t handler)
     return signal(signum, handler);
 }
 
+int macos_sys_sigaction(int signum, const struct sigaction *act, struct sigaction *oldact)
+{
+    if (sigaction(signum, act, oldact) != 0) {
+        kora_record_error(SYS_SIGACTION, errno);
+        return -1;
+    }
+    return 0;
+}
+
+int macos_sys_sigprocmask(int how, const sigset_t *set, sigset_t *oldset)
+{
+    int result = pthread_sigmask(how, set, oldset);
+    if (result != 0) {
+        errno = result;
+        kora_record_error(SYS_SIGPROCMASK, result);
+        return -1;
+    }
+    return 0;
+}
+
+int macos_sys_signalfd(const sigset_t *mask, int flags)
+{
+    /*
+     * There is no signalfd on macOS. A kqueue with EVFILT_SIGNAL filters
+     * sees every signal posted to the process, blocked or not, and the
+     * kqueue descriptor itself works with select().
+     */
+    int kq = kqueue();
+    if (kq < 0) {
+        kora_record_error(SYS_SIGNALFD, errno);
+        return -1;
+    }
+
+    for (int signo = 1; signo < NSIG; signo++) {
+        if (sigismember(mask, signo) == 1) {
+            struct kevent ev;
+            EV_SET(&ev, signo, EVFILT_SIGNAL, EV_ADD, 0, 0, NULL);
+            if (kevent(kq, &ev, 1, NULL, 0, NULL) < 0) {
+                kora_record_error(SYS_SIGNALFD, errno);
+                close(kq);
+                return -1;
+            }
+        }
+    }
+
+    if (flags & KORA_SIGNALFD_NONBLOCK) {
+        fcntl(kq, F_SETFL, fcntl(kq, F_GETFL) | O_NONBLOCK);
+    }
+    if (!(flags & KORA_SIGNALFD_CLOEXEC)) {
+        fcntl(kq, F_SETFD, 0);
+    }
+    return kq;
+}
+
+int macos_sys_signalfd_read(int fd, kora_siginfo_t *info, size_t max)
+{
+    struct kevent evs[16];
+    struct timespec zero = {0, 0};
+    int want = max < 16 ? (int)max : 16;
+
+    if (info == NULL || max == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    int nonblock = (fcntl(fd, F_GETFL) & O_NONBLOCK) != 0;
+    int n = kevent(fd, NULL, 0, evs, want, nonblock ? &zero : NULL);
+    if (n < 0) {
+        kora_record_error(SYS_SIGNALFD_READ, errno);
+        return -1;
+    }
+    if (n == 0) {
+        errno = EAGAIN;
+        kora_record_error(SYS_SIGNALFD_READ, EAGAIN);
+        return -1;
+    }
+
+    for (int i = 0; i < n; i++) {
+        int signo = (int)evs[i].ident;
+        sigset_t pending;
+
+        /* Consume the signal if it is being held pending by a block */
+        sigpending(&pending);
+        if (sigismember(&pending, signo) == 1) {
+            sigset_t one;
+            int got;
+            sigemptyset(&one);
+            sigaddset(&one, signo);
+            sigwait(&one, &got);
+        }
+
+        memset(&info[i], 0, sizeof(info[i]));
+        info[i].signo = signo;
+    }
+    return n;
+}
+
 int macos_sys_kill(pid_t pid, int signum)
 {
     return kill(pid, signum);
@@ -776,4 +1584,11 @@ int macos_sys_mount(const char *src, const char *tgt, const char *type,
     return -1;
 }
 
+int macos_sys_umount(const char *tgt)
+{
+    (void)tgt;
+    errno = ENOSYS;
+    return -1;
+}
+
 #endif // KORA_PLATFORM_MACOS
@@ -0,0 +1,1186 @@
+#include <kora/memfs.h>
+#include <kora/syscalls.h>
+#include <internal/vfs.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(KORA_PLATFORM_WINDOWS)
+
+#include <pthread.h>
+#include <sys/stat.h>
+#include <time.h>
+
+/**
+ * In-memory filesystem
+ *
+ * One rwlock per filesystem guards the namespace: directory contents,
+ * link counts and symlink targets. Each node has its own rwlock for its
+ * data, so reads and writes of different files, or reads of the same
+ * file, proceed in parallel. The namespace lock is always taken first.
+ *
+ * A node lives while it has a name or an open handle; the last of
+ * unlink/rmdir/close frees it.
+ */
+
+#define EXTENT_MIN   4096
+#define EXTENT_MAX   (1024 * 1024)
+#define NAME_MAX_LEN 255
+#define SYMLOOP_MAX  40
+#define INDEX_MIN    16
+#define TOMBSTONE    UINT32_MAX
+
+typedef struct mem_node mem_node_t;
+
+typedef struct {
+    uint64_t off;
+    size_t len;
+    size_t cap;
+    char *data;
+} extent_t;
+
+typedef struct {
+    char *name;
+    mem_node_t *node;
+} entry_t;
+
+struct mem_node {
+    uint8_t type;       /* KORA_FILE_TYPE_* */
+    uint32_t ino;
+    int nlink;          /* Names referring to the node */
+    atomic_int open;    /* Open handles */
+    uint64_t ctime;
+    uint64_t mtime;
+    uint64_t atime;
+    pthread_rwlock_t lock;
+    union {
+        struct {
+            extent_t *ext;   /* Sorted by offset, never overlapping */
+            size_t count;
+            size_t cap;
+            uint64_t size;
+        } file;
+        struct {
+            entry_t *ent;    /* Dense, in no particular order */
+            size_t count;
+            size_t cap;
+            uint32_t *index; /* Open addressing over ent: position + 1, 0 or TOMBSTONE */
+            size_t slots;    /* Power of two */
+            size_t used;     /* Live and tombstone slots */
+            mem_node_t *parent;
+        } dir;
+        char *target;
+    } u;
+};
+
+typedef struct {
+    kora_vfs_t base;
+    pthread_rwlock_t ns;
+    mem_node_t *root;
+    uint32_t next_ino;
+} memfs_t;
+
+typedef struct {
+    mem_node_t *node;
+    int flags;
+    pthread_mutex_t lock;
+    uint64_t pos;
+} mem_file_t;
+
+typedef struct {
+    mem_node_t *node;
+    size_t next;        /* 0 and 1 are "." and "..", then entries */
+} mem_dir_t;
+
+static uint64_t now(void) {
+    return (uint64_t)time(NULL);
+}
+
+/*
+ * Nodes
+ */
+
+static mem_node_t *node_new(memfs_t *fs, uint8_t type) {
+    mem_node_t *node = calloc(1, sizeof(*node));
+    if (node == NULL) {
+        return NULL;
+    }
+    node->type = type;
+    node->ino = ++fs->next_ino;
+    node->ctime = node->mtime = node->atime = now();
+    pthread_rwlock_init(&node->lock, NULL);
+    return node;
+}
+
+static void node_free(mem_node_t *node) {
+    if (node->type == KORA_FILE_TYPE_REGULAR) {
+        for (size_t i = 0; i < node->u.file.count; i++) {
+            free(node->u.file.ext[i].data);
+        }
+        free(node->u.file.ext);
+    } else if (node->type == KORA_FILE_TYPE_DIRECTORY) {
+        for (size_t i = 0; i < node->u.dir.count; i++) {
+            free(node->u.dir.ent[i].name);
+        }
+        free(node->u.dir.ent);
+        free(node->u.dir.index);
+    } else {
+        free(node->u.target);
+    }
+    pthread_rwlock_destroy(&node->lock);
+    free(node);
+}
+
+/* Called under the namespace write lock after dropping a name or a handle */
+static void node_release(mem_node_t *node) {
+    if (node->nlink == 0 && atomic_load_explicit(&node->open, memory_order_relaxed) == 0) {
+        node_free(node);
+    }
+}
+
+static void tree_free(mem_node_t *node) {
+    if (node->type == KORA_FILE_TYPE_DIRECTORY) {
+        for (size_t i = 0; i < node->u.dir.count; i++) {
+            mem_node_t *child = node->u.dir.ent[i].node;
+            if (--child->nlink == 0) {
+                tree_free(child);
+            }
+        }
+    }
+    node_free(node);
+}
+
+static void fill_stat(const mem_node_t *node, void *out) {
+    kora_stat_t *st = out;
+    memset(st, 0, sizeof(*st));
+    switch (node->type) {
+    case KORA_FILE_TYPE_REGULAR:
+        st->mode = S_IFREG | 0644;
+        st->size = node->u.file.size;
+        break;
+    case KORA_FILE_TYPE_DIRECTORY:
+        st->mode = S_IFDIR | 0755;
+        break;
+    default:
+        st->mode = S_IFLNK | 0777;
+        st->size = strlen(node->u.target);
+        break;
+    }
+    st->mtime = node->mtime;
+}
+
+static void fill_info(const mem_node_t *node, void *out) {
+    kora_file_info_t *info = out;
+    memset(info, 0, sizeof(*info));
+    info->type = node->type;
+    info->starting_cluster = node->ino;
+    if (node->type == KORA_FILE_TYPE_REGULAR) {
+        info->size = node->u.file.size;
+    } else if (node->type == KORA_FILE_TYPE_SYMLINK) {
+        info->size = strlen(node->u.target);
+    }
+    info->creation_time = node->ctime;
+    info->modified_time = node->mtime;
+    info->access_time = node->atime;
+}
+
+/*
+ * Directories
+ */
+
+static uint32_t name_hash(const char *name, size_t len) {
+    uint32_t h = 2166136261u;  /* FNV-1a */
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ (unsigned char)name[i]) * 16777619u;
+    }
+    return h;
+}
+
+/* Index slot holding name, or the slot where it would go */
+static size_t dir_probe(const mem_node_t *dir, const char *name, size_t len, int *found) {
+    size_t mask = dir->u.dir.slots - 1;
+    size_t i = name_hash(name, len) & mask;
+    size_t insert = SIZE_MAX;
+
+    for (;;) {
+        uint32_t v = dir->u.dir.index[i];
+        if (v == 0) {
+            *found = 0;
+            return insert != SIZE_MAX ? insert : i;
+        }
+        if (v == TOMBSTONE) {
+            if (insert == SIZE_MAX) {
+                insert = i;
+            }
+        } else {
+            const char *other = dir->u.dir.ent[v - 1].name;
+            if (strncmp(other, name, len) == 0 && other[len] == '\0') {
+                *found = 1;
+                return i;
+            }
+        }
+        i = (i + 1) & mask;
+    }
+}
+
+static mem_node_t *dir_lookup(const mem_node_t *dir, const char *name, size_t len) {
+    int found;
+    if (dir->u.dir.count == 0) {
+        return NULL;
+    }
+    size_t slot = dir_probe(dir, name, len, &found);
+    return found ? dir->u.dir.ent[dir->u.dir.index[slot] - 1].node : NULL;
+}
+
+static int dir_rehash(mem_node_t *dir, size_t slots) {
+    uint32_t *index = calloc(slots, sizeof(*index));
+    if (index == NULL) {
+        return -ENOMEM;
+    }
+    free(dir->u.dir.index);
+    dir->u.dir.index = index;
+    dir->u.dir.slots = slots;
+    dir->u.dir.used = dir->u.dir.count;
+    for (size_t e = 0; e < dir->u.dir.count; e++) {
+        const char *name = dir->u.dir.ent[e].name;
+        size_t i = name_hash(name, strlen(name)) & (slots - 1);
+        while (index[i] != 0) {
+            i = (i + 1) & (slots - 1);
+        }
+        index[i] = (uint32_t)(e + 1);
+    }
+    return 0;
+}
+
+/* The name must not be present; takes a reference on node */
+static int dir_insert(mem_node_t *dir, const char *name, mem_node_t *node) {
+    size_t len = strlen(name);
+    int found;
+
+    if (dir->u.dir.count == dir->u.dir.cap) {
+        size_t cap = dir->u.dir.cap ? dir->u.dir.cap * 2 : 8;
+        entry_t *ent = realloc(dir->u.dir.ent, cap * sizeof(*ent));
+        if (ent == NULL) {
+            return -ENOMEM;
+        }
+        dir->u.dir.ent = ent;
+        dir->u.dir.cap = cap;
+    }
+    /* Keep at most three quarters of the slots in use, tombstones included */
+    if ((dir->u.dir.used + 1) * 4 > dir->u.dir.slots * 3) {
+        size_t slots = dir->u.dir.slots ? dir->u.dir.slots : INDEX_MIN;
+        while ((dir->u.dir.count + 1) * 2 > slots) {
+            slots *= 2;
+        }
+        if (dir_rehash(dir, slots) != 0) {
+            return -ENOMEM;
+        }
+    }
+    char *copy = malloc(len + 1);
+    if (copy == NULL) {
+        return -ENOMEM;
+    }
+    memcpy(copy, name, len + 1);
+
+    size_t slot = dir_probe(dir, name, len, &found);
+    if (dir->u.dir.index[slot] == 0) {
+        dir->u.dir.used++;
+    }
+    dir->u.dir.ent[dir->u.dir.count] = (entry_t){ copy, node };
+    dir->u.dir.index[slot] = (uint32_t)++dir->u.dir.count;
+    node->nlink++;
+    if (node->type == KORA_FILE_TYPE_DIRECTORY) {
+        node->u.dir.parent = dir;
+    }
+    dir->mtime = now();
+    return 0;
+}
+
+/* Drops the name; the caller releases the node */
+static void dir_remove(mem_node_t *dir, const char *name) {
+    int found;
+    size_t slot = dir_probe(dir, name, strlen(name), &found);
+    size_t pos = dir->u.dir.index[slot] - 1;
+    size_t last = dir->u.dir.count - 1;
+
+    dir->u.dir.index[slot] = TOMBSTONE;
+    dir->u.dir.ent[pos].node->nlink--;
+    free(dir->u.dir.ent[pos].name);
+    if (pos != last) {
+        /* Move the last entry into the hole and repoint its slot */
+        const char *moved = dir->u.dir.ent[last].name;
+        dir->u.dir.index[dir_probe(dir, moved, strlen(moved), &found)] = (uint32_t)(pos + 1);
+        dir->u.dir.ent[pos] = dir->u.dir.ent[last];
+    }
+    dir->u.dir.count--;
+    dir->mtime = now();
+}
+
+/*
+ * Path resolution, under the namespace lock
+ */
+
+static int walk(memfs_t *fs, mem_node_t *cur, const char *path, int follow, int *links,
+                mem_node_t **out);
+
+static int follow_link(memfs_t *fs, mem_node_t *dir, const mem_node_t *link, int *links,
+                       mem_node_t **out) {
+    const char *target = link->u.target;
+
+    if (++*links > SYMLOOP_MAX) {
+        return -ELOOP;
+    }
+    if (target[0] == '/') {
+        /* Absolute targets name paths of the process; only those inside the mount resolve */
+        const char *prefix = fs->base.prefix;
+        size_t len = strcmp(prefix, "/") == 0 ? 0 : strlen(prefix);
+        if (strncmp(target, prefix, len) != 0 || (target[len] != '/' && target[len] != '\0')) {
+            return -ENOENT;
+        }
+        return walk(fs, fs->root, target + len, 1, links, out);
+    }
+    return walk(fs, dir, target, 1, links, out);
+}
+
+static int walk(memfs_t *fs, mem_node_t *cur, const char *path, int follow, int *links,
+                mem_node_t **out) {
+    const char *p = path;
+
+    for (;;) {
+        while (*p == '/') {
+            p++;
+        }
+        if (*p == '\0') {
+            break;
+        }
+        size_t len = strcspn(p, "/");
+        if (len > NAME_MAX_LEN) {
+            return -ENAMETOOLONG;
+        }
+        if (cur->type != KORA_FILE_TYPE_DIRECTORY) {
+            return -ENOTDIR;
+        }
+        const char *next = p + len;
+        int last = next[strspn(next, "/")] == '\0';
+        if (len == 1 && p[0] == '.') {
+            p = next;
+            continue;
+        }
+        if (len == 2 && p[0] == '.' && p[1] == '.') {
+            if (cur->u.dir.parent != NULL) {
+                cur = cur->u.dir.parent;
+            }
+            p = next;
+            continue;
+        }
+        mem_node_t *node = dir_lookup(cur, p, len);
+        if (node == NULL) {
+            return -ENOENT;
+        }
+        /* A trailing slash asks for the directory a final symlink names */
+        if (node->type == KORA_FILE_TYPE_SYMLINK && (!last || follow || *next == '/')) {
+            int r = follow_link(fs, cur, node, links, &node);
+            if (r != 0) {
+                return r;
+            }
+        }
+        if (last && *next == '/' && node->type != KORA_FILE_TYPE_DIRECTORY) {
+            return -ENOTDIR;
+        }
+        cur = node;
+        p = next;
+    }
+    *out = cur;
+    return 0;
+}
+
+static int lookup(memfs_t *fs, const char *path, int follow, mem_node_t **out) {
+    int links = 0;
+    return walk(fs, fs->root, path, follow, &links, out);
+}
+
+/*
+ * Find the directory that holds the last component of path and copy the
+ * component to name; fails for paths that end in ".", ".." or the root
+ */
+static int lookup_parent(memfs_t *fs, const char *path, mem_node_t **dir, char name[NAME_MAX_LEN + 1]) {
+    size_t end = strlen(path);
+    while (end > 0 && path[end - 1] == '/') {
+        end--;
+    }
+    size_t start = end;
+    while (start > 0 && path[start - 1] != '/') {
+        start--;
+    }
+    size_t len = end - start;
+    if (len == 0) {
+        return -EBUSY;
+    }
+    if (len > NAME_MAX_LEN) {
+        return -ENAMETOOLONG;
+    }
+    if ((len == 1 && path[start] == '.') || (len == 2 && path[start] == '.' && path[start + 1] == '.')) {
+        return -EINVAL;
+    }
+    memcpy(name, path + start, len);
+    name[len] = '\0';
+
+    char *parent = malloc(start + 1);
+    if (parent == NULL) {
+        return -ENOMEM;
+    }
+    memcpy(parent, path, start);
+    parent[start] = '\0';
+    int r = lookup(fs, parent, 1, dir);
+    free(parent);
+    if (r == 0 && (*dir)->type != KORA_FILE_TYPE_DIRECTORY) {
+        r = -ENOTDIR;
+    }
+    return r;
+}
+
+/*
+ * File data, under the node lock
+ */
+
+/* Index of the first extent ending after off */
+static size_t extent_find(const mem_node_t *node, uint64_t off) {
+    size_t lo = 0, hi = node->u.file.count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        const extent_t *e = &node->u.file.ext[mid];
+        if (e->off + e->len <= off) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static size_t data_read(const mem_node_t *node, uint64_t off, char *buf, size_t count) {
+    if (off >= node->u.file.size) {
+        return 0;
+    }
+    if (count > node->u.file.size - off) {
+        count = (size_t)(node->u.file.size - off);
+    }
+    size_t i = extent_find(node, off);
+    size_t done = 0;
+    while (done < count) {
+        uint64_t pos = off + done;
+        size_t n = count - done;
+        if (i < node->u.file.count && node->u.file.ext[i].off <= pos) {
+            const extent_t *e = &node->u.file.ext[i++];
+            size_t skip = (size_t)(pos - e->off);
+            if (n > e->len - skip) {
+                n = e->len - skip;
+            }
+            memcpy(buf + done, e->data + skip, n);
+        } else {
+            /* Hole up to the next extent */
+            if (i < node->u.file.count && node->u.file.ext[i].off - pos < n) {
+                n = (size_t)(node->u.file.ext[i].off - pos);
+            }
+            memset(buf + done, 0, n);
+        }
+        done += n;
+    }
+    return count;
+}
+
+static int extent_reserve(extent_t *e, size_t len) {
+    if (len <= e->cap) {
+        return 0;
+    }
+    size_t cap = e->cap ? e->cap : EXTENT_MIN;
+    while (cap < len) {
+        cap *= 2;
+    }
+    if (cap > EXTENT_MAX) {
+        cap = EXTENT_MAX;
+    }
+    char *data = realloc(e->data, cap);
+    if (data == NULL) {
+        return -ENOMEM;
+    }
+    e->data = data;
+    e->cap = cap;
+    return 0;
+}
+
+static int extent_insert(mem_node_t *node, size_t i, uint64_t off) {
+    if (node->u.file.count == node->u.file.cap) {
+        size_t cap = node->u.file.cap ? node->u.file.cap * 2 : 4;
+        extent_t *ext = realloc(node->u.file.ext, cap * sizeof(*ext));
+        if (ext == NULL) {
+            return -ENOMEM;
+        }
+        node->u.file.ext = ext;
+        node->u.file.cap = cap;
+    }
+    memmove(&node->u.file.ext[i + 1], &node->u.file.ext[i],
+            (node->u.file.count - i) * sizeof(extent_t));
+    node->u.file.ext[i] = (extent_t){ off, 0, 0, NULL };
+    node->u.file.count++;
+    return 0;
+}
+
+/* Returns the bytes written, short only when memory runs out */
+static long data_write(mem_node_t *node, uint64_t off, const char *buf, size_t count) {
+    size_t done = 0;
+
+    while (done < count) {
+        uint64_t pos = off + done;
+        size_t n = count - done;
+        size_t i = extent_find(node, pos);
+        extent_t *e;
+
+        if (i < node->u.file.count && node->u.file.ext[i].off <= pos) {
+            /* Overwrite in place */
+            e = &node->u.file.ext[i];
+        } else if (i > 0 && node->u.file.ext[i - 1].off + node->u.file.ext[i - 1].len == pos &&
+                   node->u.file.ext[i - 1].len < EXTENT_MAX) {
+            /* Append to the extent ending here, as sequential writes do */
+            e = &node->u.file.ext[i - 1];
+        } else {
+            if (extent_insert(node, i, pos) != 0) {
+                break;
+            }
+            e = &node->u.file.ext[i];
+        }
+
+        size_t skip = (size_t)(pos - e->off);
+        size_t room = EXTENT_MAX - skip;
+        if (n > room) {
+            n = room;
+        }
+        /* Growing must stop short of the next extent */
+        extent_t *next = e + 1 < node->u.file.ext + node->u.file.count ? e + 1 : NULL;
+        if (next != NULL && next->off - pos < n) {
+            n = (size_t)(next->off - pos);
+        }
+        if (skip + n > e->len) {
+            if (extent_reserve(e, skip + n) != 0) {
+                if (e->len == 0) {
+                    /* Drop the extent just inserted */
+                    size_t after = (size_t)(node->u.file.ext + node->u.file.count - (e + 1));
+                    memmove(e, e + 1, after * sizeof(*e));
+                    node->u.file.count--;
+                }
+                break;
+            }
+            e->len = skip + n;
+        }
+        memcpy(e->data + skip, buf + done, n);
+        done += n;
+    }
+    if (done > 0 && off + done > node->u.file.size) {
+        node->u.file.size = off + done;
+    }
+    return done > 0 || count == 0 ? (long)done : -ENOMEM;
+}
+
+static void data_truncate(mem_node_t *node) {
+    for (size_t i = 0; i < node->u.file.count; i++) {
+        free(node->u.file.ext[i].data);
+    }
+    node->u.file.count = 0;
+    node->u.file.size = 0;
+}
+
+/*
+ * Operations
+ */
+
+#define MEMFS(fs) ((memfs_t *)(fs))
+
+static int readable(int flags) {
+    return (flags & KORA_O_RDWR) != KORA_O_WRONLY;
+}
+
+static int writable(int flags) {
+    return (flags & KORA_O_WRONLY) != 0;
+}
+
+static int create_file(memfs_t *fs, const char *path, mem_node_t **out) {
+    char name[NAME_MAX_LEN + 1];
+    mem_node_t *dir;
+
+    int r = lookup_parent(fs, path, &dir, name);
+    if (r != 0) {
+        return r == -EBUSY ? -EISDIR : r;
+    }
+    if (dir_lookup(dir, name, strlen(name)) != NULL) {
+        return -ENOENT;  /* A dangling symlink */
+    }
+    mem_node_t *node = node_new(fs, KORA_FILE_TYPE_REGULAR);
+    if (node == NULL) {
+        return -ENOMEM;
+    }
+    r = dir_insert(dir, name, node);
+    if (r != 0) {
+        node_free(node);
+        return r;
+    }
+    *out = node;
+    return 0;
+}
+
+static int memfs_open(kora_vfs_t *vfs, const char *path, int flags, void **file) {
+    memfs_t *fs = MEMFS(vfs);
+    mem_node_t *node;
+    int create = (flags & KORA_O_CREAT) != 0;
+
+    mem_file_t *f = malloc(sizeof(*f));
+    if (f == NULL) {
+        return -ENOMEM;
+    }
+    if (create) {
+        pthread_rwlock_wrlock(&fs->ns);
+    } else {
+        pthread_rwlock_rdlock(&fs->ns);
+    }
+    int r = lookup(fs, path, 1, &node);
+    if (r == -ENOENT && create) {
+        r = create_file(fs, path, &node);
+    }
+    if (r == 0 && node->type == KORA_FILE_TYPE_DIRECTORY && writable(flags)) {
+        r = -EISDIR;
+    }
+    if (r != 0) {
+        pthread_rwlock_unlock(&fs->ns);
+        free(f);
+        return r;
+    }
+    atomic_fetch_add_explicit(&node->open, 1, memory_order_relaxed);
+    if ((flags & KORA_O_TRUNC) && writable(flags) && node->type == KORA_FILE_TYPE_REGULAR) {
+        pthread_rwlock_wrlock(&node->lock);
+        data_truncate(node);
+        node->mtime = now();
+        pthread_rwlock_unlock(&node->lock);
+    }
+    pthread_rwlock_unlock(&fs->ns);
+
+    f->node = node;
+    f->flags = flags;
+    f->pos = 0;
+    pthread_mutex_init(&f->lock, NULL);
+    *file = f;
+    return 0;
+}
+
+static int memfs_close(kora_vfs_t *vfs, void *file) {
+    memfs_t *fs = MEMFS(vfs);
+    mem_file_t *f = file;
+
+    pthread_rwlock_wrlock(&fs->ns);
+    atomic_fetch_sub_explicit(&f->node->open, 1, memory_order_relaxed);
+    node_release(f->node);
+    pthread_rwlock_unlock(&fs->ns);
+    pthread_mutex_destroy(&f->lock);
+    free(f);
+    return 0;
+}
+
+static long memfs_read(kora_vfs_t *vfs, void *file, void *buf, size_t count) {
+    mem_file_t *f = file;
+    (void)vfs;
+
+    if (f->node->type == KORA_FILE_TYPE_DIRECTORY) {
+        return -EISDIR;
+    }
+    if (!readable(f->flags)) {
+        return -EBADF;
+    }
+    pthread_mutex_lock(&f->lock);
+    pthread_rwlock_rdlock(&f->node->lock);
+    size_t n = data_read(f->node, f->pos, buf, count);
+    pthread_rwlock_unlock(&f->node->lock);
+    f->pos += n;
+    pthread_mutex_unlock(&f->lock);
+    return (long)n;
+}
+
+static long memfs_write(kora_vfs_t *vfs, void *file, const void *buf, size_t count) {
+    mem_file_t *f = file;
+    (void)vfs;
+
+    if (!writable(f->flags)) {
+        return -EBADF;
+    }
+    pthread_mutex_lock(&f->lock);
+    pthread_rwlock_wrlock(&f->node->lock);
+    if (f->flags & KORA_O_APPEND) {
+        f->pos = f->node->u.file.size;
+    }
+    long n = data_write(f->node, f->pos, buf, count);
+    if (n > 0) {
+        f->node->mtime = now();
+        f->pos += (uint64_t)n;
+    }
+    pthread_rwlock_unlock(&f->node->lock);
+    pthread_mutex_unlock(&f->lock);
+    return n;
+}
+
+static long memfs_seek(kora_vfs_t *vfs, void *file, long offset, int whence) {
+    mem_file_t *f = file;
+    long base;
+    (void)vfs;
+
+    pthread_mutex_lock(&f->lock);
+    switch (whence) {
+    case KORA_SEEK_SET:
+        base = 0;
+        break;
+    case KORA_SEEK_CUR:
+        base = (long)f->pos;
+        break;
+    case KORA_SEEK_END:
+        pthread_rwlock_rdlock(&f->node->lock);
+        base = f->node->type == KORA_FILE_TYPE_REGULAR ? (long)f->node->u.file.size : 0;
+        pthread_rwlock_unlock(&f->node->lock);
+        break;
+    default:
+        pthread_mutex_unlock(&f->lock);
+        return -EINVAL;
+    }
+    if (offset < -base) {
+        pthread_mutex_unlock(&f->lock);
+        return -EINVAL;
+    }
+    f->pos = (uint64_t)(base + offset);
+    pthread_mutex_unlock(&f->lock);
+    return base + offset;
+}
+
+static int memfs_fstat(kora_vfs_t *vfs, void *file, kora_stat_t *st) {
+    memfs_t *fs = MEMFS(vfs);
+    mem_file_t *f = file;
+
+    pthread_rwlock_rdlock(&fs->ns);
+    pthread_rwlock_rdlock(&f->node->lock);
+    fill_stat(f->node, st);
+    pthread_rwlock_unlock(&f->node->lock);
+    pthread_rwlock_unlock(&fs->ns);
+    return 0;
+}
+
+static int memfs_fget_info(kora_vfs_t *vfs, void *file, kora_file_info_t *info) {
+    memfs_t *fs = MEMFS(vfs);
+    mem_file_t *f = file;
+
+    pthread_rwlock_rdlock(&fs->ns);
+    pthread_rwlock_rdlock(&f->node->lock);
+    fill_info(f->node, info);
+    pthread_rwlock_unlock(&f->node->lock);
+    pthread_rwlock_unlock(&fs->ns);
+    return 0;
+}
+
+static int memfs_opendir(kora_vfs_t *vfs, const char *path, void **dir) {
+    memfs_t *fs = MEMFS(vfs);
+    mem_node_t *node;
+
+    mem_dir_t *d = malloc(sizeof(*d));
+    if (d == NULL) {
+        return -ENOMEM;
+    }
+    pthread_rwlock_rdlock(&fs->ns);
+    int r = lookup(fs, path, 1, &node);
+    if (r == 0 && node->type != KORA_FILE_TYPE_DIRECTORY) {
+        r = -ENOTDIR;
+    }
+    if (r == 0) {
+        atomic_fetch_add_explicit(&node->open, 1, memory_order_relaxed);
+    }
+    pthread_rwlock_unlock(&fs->ns);
+    if (r != 0) {
+        free(d);
+        return r;
+    }
+    d->node = node;
+    d->next = 0;
+    *dir = d;
+    return 0;
+}
+
+static uint8_t dirent_type(const mem_node_t *node) {
+    switch (node->type) {
+    case KORA_FILE_TYPE_REGULAR:
+        return KORA_DT_REG;
+    case KORA_FILE_TYPE_DIRECTORY:
+        return KORA_DT_DIR;
+    default:
+        return KORA_DT_SYMLINK;
+    }
+}
+
+/* Entries added or removed while reading may or may not be returned */
+static int memfs_readdir(kora_vfs_t *vfs, void *dir, kora_dirent_t *entry) {
+    memfs_t *fs = MEMFS(vfs);
+    mem_dir_t *d = dir;
+    int r = 1;
+
+    pthread_rwlock_rdlock(&fs->ns);
+    if (d->next < 2) {
+        strcpy(entry->name, d->next == 0 ? "." : "..");
+        entry->type = KORA_DT_DIR;
+    } else if (d->next - 2 < d->node->u.dir.count) {
+        const entry_t *e = &d->node->u.dir.ent[d->next - 2];
+        strcpy(entry->name, e->name);
+        entry->type = dirent_type(e->node);
+    } else {
+        r = 0;
+    }
+    pthread_rwlock_unlock(&fs->ns);
+    d->next += (size_t)r;
+    return r;
+}
+
+static int memfs_closedir(kora_vfs_t *vfs, void *dir) {
+    memfs_t *fs = MEMFS(vfs);
+    mem_dir_t *d = dir;
+
+    pthread_rwlock_wrlock(&fs->ns);
+    atomic_fetch_sub_explicit(&d->node->open, 1, memory_order_relaxed);
+    node_release(d->node);
+    pthread_rwlock_unlock(&fs->ns);
+    free(d);
+    return 0;
+}
+
+static int memfs_mkdir(kora_vfs_t *vfs, const char *path) {
+    memfs_t *fs = MEMFS(vfs);
+    char name[NAME_MAX_LEN + 1];
+    mem_node_t *dir;
+
+    pthread_rwlock_wrlock(&fs->ns);
+    int r = lookup_parent(fs, path, &dir, name);
+    if (r == -EBUSY || (r == 0 && dir_lookup(dir, name, strlen(name)) != NULL)) {
+        r = -EEXIST;
+    } else if (r == 0) {
+        mem_node_t *node = node_new(fs, KORA_FILE_TYPE_DIRECTORY);
+        r = node != NULL ? dir_insert(dir, name, node) : -ENOMEM;
+        if (r != 0 && node != NULL) {
+            node_free(node);
+        }
+    }
+    pthread_rwlock_unlock(&fs->ns);
+    return r;
+}
+
+static int memfs_rmdir(kora_vfs_t *vfs, const char *path) {
+    memfs_t *fs = MEMFS(vfs);
+    char name[NAME_MAX_LEN + 1];
+    mem_node_t *dir, *node;
+
+    pthread_rwlock_wrlock(&fs->ns);
+    int r = lookup_parent(fs, path, &dir, name);
+    if (r == 0) {
+        node = dir_lookup(dir, name, strlen(name));
+        if (node == NULL) {
+            r = -ENOENT;
+        } else if (node->type != KORA_FILE_TYPE_DIRECTORY) {
+            r = -ENOTDIR;
+        } else if (node->u.dir.count > 0) {
+            r = -ENOTEMPTY;
+        } else {
+            dir_remove(dir, name);
+            node_release(node);
+        }
+    }
+    pthread_rwlock_unlock(&fs->ns);
+    return r;
+}
+
+static int memfs_unlink(kora_vfs_t *vfs, const char *path) {
+    memfs_t *fs = MEMFS(vfs);
+    char name[NAME_MAX_LEN + 1];
+    mem_node_t *dir, *node;
+
+    pthread_rwlock_wrlock(&fs->ns);
+    int r = lookup_parent(fs, path, &dir, name);
+    if (r == -EBUSY) {
+        r = -EISDIR;
+    } else if (r == 0) {
+        node = dir_lookup(dir, name, strlen(name));
+        if (node == NULL) {
+            r = -ENOENT;
+        } else if (node->type == KORA_FILE_TYPE_DIRECTORY) {
+            r = -EISDIR;
+        } else {
+            dir_remove(dir, name);
+            node_release(node);
+        }
+    }
+    pthread_rwlock_unlock(&fs->ns);
+    return r;
+}
+
+static int is_within(const mem_node_t *dir, const mem_node_t *ancestor) {
+    for (; dir != NULL; dir = dir->u.dir.parent) {
+        if (dir == ancestor) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int rename_locked(memfs_t *fs, const char *from, const char *to) {
+    char src_name[NAME_MAX_LEN + 1], dst_name[NAME_MAX_LEN + 1];
+    mem_node_t *src_dir, *dst_dir;
+
+    int r = lookup_parent(fs, from, &src_dir, src_name);
+    if (r == 0) {
+        r = lookup_parent(fs, to, &dst_dir, dst_name);
+    }
+    if (r != 0) {
+        return r;
+    }
+    mem_node_t *node = dir_lookup(src_dir, src_name, strlen(src_name));
+    if (node == NULL) {
+        return -ENOENT;
+    }
+    mem_node_t *old = dir_lookup(dst_dir, dst_name, strlen(dst_name));
+    if (old == node) {
+        return 0;
+    }
+    if (node->type == KORA_FILE_TYPE_DIRECTORY) {
+        if (is_within(dst_dir, node)) {
+            return -EINVAL;
+        }
+        if (old != NULL && old->type != KORA_FILE_TYPE_DIRECTORY) {
+            return -ENOTDIR;
+        }
+        if (old != NULL && old->u.dir.count > 0) {
+            return -ENOTEMPTY;
+        }
+    } else if (old != NULL && old->type == KORA_FILE_TYPE_DIRECTORY) {
+        return -EISDIR;
+    }
+
+    /* Insert first so that running out of memory leaves both names intact */
+    if (old != NULL) {
+        dir_remove(dst_dir, dst_name);
+    }
+    r = dir_insert(dst_dir, dst_name, node);
+    if (r != 0) {
+        if (old != NULL && dir_insert(dst_dir, dst_name, old) != 0) {
+            node_release(old);
+        }
+        return r;
+    }
+    if (old != NULL) {
+        node_release(old);
+    }
+    /* dir_insert pointed a directory's parent at dst_dir already */
+    dir_remove(src_dir, src_name);
+    return 0;
+}
+
+static int memfs_rename(kora_vfs_t *vfs, const char *from, const char *to) {
+    memfs_t *fs = MEMFS(vfs);
+    pthread_rwlock_wrlock(&fs->ns);
+    int r = rename_locked(fs, from, to);
+    pthread_rwlock_unlock(&fs->ns);
+    return r;
+}
+
+static int memfs_link(kora_vfs_t *vfs, const char *existing, const char *path) {
+    memfs_t *fs = MEMFS(vfs);
+    char name[NAME_MAX_LEN + 1];
+    mem_node_t *dir, *node;
+
+    pthread_rwlock_wrlock(&fs->ns);
+    int r = lookup(fs, existing, 0, &node);
+    if (r == 0 && node->type == KORA_FILE_TYPE_DIRECTORY) {
+        r = -EPERM;
+    }
+    if (r == 0) {
+        r = lookup_parent(fs, path, &dir, name);
+        if (r == -EBUSY || (r == 0 && dir_lookup(dir, name, strlen(name)) != NULL)) {
+            r = -EEXIST;
+        } else if (r == 0) {
+            r = dir_insert(dir, name, node);
+        }
+    }
+    pthread_rwlock_unlock(&fs->ns);
+    return r;
+}
+
+static int memfs_symlink(kora_vfs_t *vfs, const char *target, const char *path) {
+    memfs_t *fs = MEMFS(vfs);
+    char name[NAME_MAX_LEN + 1];
+    mem_node_t *dir;
+
+    if (target[0] == '\0') {
+        return -ENOENT;
+    }
+    pthread_rwlock_wrlock(&fs->ns);
+    int r = lookup_parent(fs, path, &dir, name);
+    if (r == -EBUSY || (r == 0 && dir_lookup(dir, name, strlen(name)) != NULL)) {
+        r = -EEXIST;
+    } else if (r == 0) {
+        mem_node_t *node = node_new(fs, KORA_FILE_TYPE_SYMLINK);
+        if (node != NULL) {
+            node->u.target = strdup(target);
+        }
+        r = node != NULL && node->u.target != NULL ? dir_insert(dir, name, node) : -ENOMEM;
+        if (r != 0 && node != NULL) {
+            node_free(node);
+        }
+    }
+    pthread_rwlock_unlock(&fs->ns);
+    return r;
+}
+
+static int memfs_readlink(kora_vfs_t *vfs, const char *path, char *buf, size_t size) {
+    memfs_t *fs = MEMFS(vfs);
+    mem_node_t *node;
+
+    pthread_rwlock_rdlock(&fs->ns);
+    int r = lookup(fs, path, 0, &node);
+    if (r == 0 && node->type != KORA_FILE_TYPE_SYMLINK) {
+        r = -EINVAL;
+    }
+    if (r == 0) {
+        size_t len = strlen(node->u.target);
+        if (len > size) {
+            len = size;
+        }
+        memcpy(buf, node->u.target, len);
+        r = (int)len;
+    }
+    pthread_rwlock_unlock(&fs->ns);
+    return r;
+}
+
+static int stat_path(kora_vfs_t *vfs, const char *path, int follow,
+                     void (*fill)(const mem_node_t *, void *), void *out) {
+    memfs_t *fs = MEMFS(vfs);
+    mem_node_t *node;
+
+    pthread_rwlock_rdlock(&fs->ns);
+    int r = lookup(fs, path, follow, &node);
+    if (r == 0) {
+        pthread_rwlock_rdlock(&node->lock);
+        fill(node, out);
+        pthread_rwlock_unlock(&node->lock);
+    }
+    pthread_rwlock_unlock(&fs->ns);
+    return r;
+}
+
+static int memfs_stat(kora_vfs_t *vfs, const char *path, kora_stat_t *st) {
+    return stat_path(vfs, path, 1, fill_stat, st);
+}
+
+static int memfs_lstat(kora_vfs_t *vfs, const char *path, kora_stat_t *st) {
+    return stat_path(vfs, path, 0, fill_stat, st);
+}
+
+static int memfs_get_info(kora_vfs_t *vfs, const char *path, kora_file_info_t *info) {
+    return stat_path(vfs, path, 1, fill_info, info);
+}
+
+static int memfs_utime(kora_vfs_t *vfs, const char *path, uint64_t mtime) {
+    memfs_t *fs = MEMFS(vfs);
+    mem_node_t *node;
+
+    pthread_rwlock_rdlock(&fs->ns);
+    int r = lookup(fs, path, 1, &node);
+    if (r == 0) {
+        pthread_rwlock_wrlock(&node->lock);
+        node->mtime = mtime;
+        node->atime = now();
+        pthread_rwlock_unlock(&node->lock);
+    }
+    pthread_rwlock_unlock(&fs->ns);
+    return r;
+}
+
+static void memfs_destroy(kora_vfs_t *vfs) {
+    memfs_t *fs = MEMFS(vfs);
+    tree_free(fs->root);
+    pthread_rwlock_destroy(&fs->ns);
+    free(fs);
+}
+
+static const kora_vfs_ops_t memfs_ops = {
+    .name = "memfs",
+    .open = memfs_open,
+    .close = memfs_close,
+    .read = memfs_read,
+    .write = memfs_write,
+    .seek = memfs_seek,
+    .fstat = memfs_fstat,
+    .fget_info = memfs_fget_info,
+    .opendir = memfs_opendir,
+    .readdir = memfs_readdir,
+    .closedir = memfs_closedir,
+    .mkdir = memfs_mkdir,
+    .rmdir = memfs_rmdir,
+    .unlink = memfs_unlink,
+    .rename = memfs_rename,
+    .link = memfs_link,
+    .symlink = memfs_symlink,
+    .readlink = memfs_readlink,
+    .stat = memfs_stat,
+    .lstat = memfs_lstat,
+    .get_info = memfs_get_info,
+    .utime = memfs_utime,
+    .destroy = memfs_destroy,
+};
+
+int kora_memfs_mount(const char *prefix) {
+    memfs_t *fs = calloc(1, sizeof(*fs));
+    if (fs == NULL) {
+        errno = ENOMEM;
+        return KORA_ERROR;
+    }
+    fs->base.ops = &memfs_ops;
+    pthread_rwlock_init(&fs->ns, NULL);
+    fs->root = node_new(fs, KORA_FILE_TYPE_DIRECTORY);
+    if (fs->root == NULL) {
+        pthread_rwlock_destroy(&fs->ns);
+        free(fs);
+        errno = ENOMEM;
+        return KORA_ERROR;
+    }
+    fs->root->nlink = 1;
+
+    int r = kora_vfs_mount(prefix, &fs->base);
+    if (r != 0) {
+        memfs_destroy(&fs->base);
+        errno = -r;
+        return KORA_ERROR;
+    }
+    return KORA_SUCCESS;
+}
+
+int kora_memfs_unmount(const char *prefix) {
+    int r = kora_vfs_unmount(prefix, &memfs_ops);
+    if (r != 0) {
+        errno = -r;
+        return KORA_ERROR;
+    }
+    return KORA_SUCCESS;
+}
+
+#else /* KORA_PLATFORM_WINDOWS */
+
+int kora_memfs_mount(const char *prefix) {
+    (void)prefix;
+    errno = ENOTSUP;
+    return KORA_ERROR;
+}
+
+int kora_memfs_unmount(const char *prefix) {
+    (void)prefix;
+    errno = EINVAL;
+    return KORA_ERROR;
+}
+
+#endif
@@ -0,0 +1,245 @@
+#include <internal/syscall_impl.h>
+#include <kora/perf.h>
+#include <kora/syscalls.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(KORA_PLATFORM_LINUX)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Hardware performance counter groups
+ *
+ * On Linux every group is one perf_event_open leader plus its members.
+ * Only the leader is created disabled, so the members follow it and the
+ * group is enabled, disabled and read as a unit with PERF_FORMAT_GROUP.
+ */
+
+#if defined(KORA_PLATFORM_LINUX)
+
+struct kora_perf_counter {
+    uint32_t count;
+    int fds[KORA_PERF_MAX_EVENTS];
+    uint64_t ids[KORA_PERF_MAX_EVENTS];
+};
+
+static int event_to_attr(int event, struct perf_event_attr *attr)
+{
+    static const struct {
+        uint32_t type;
+        uint64_t config;
+    } map[] = {
+        [KORA_PERF_CYCLES]           = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        [KORA_PERF_INSTRUCTIONS]     = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        [KORA_PERF_CACHE_REFERENCES] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES },
+        [KORA_PERF_CACHE_MISSES]     = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+        [KORA_PERF_BRANCHES]         = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS },
+        [KORA_PERF_BRANCH_MISSES]    = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+        [KORA_PERF_TASK_CLOCK]       = { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK },
+        [KORA_PERF_PAGE_FAULTS]      = { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS },
+        [KORA_PERF_CONTEXT_SWITCHES] = { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES },
+    };
+
+    if (event < 0 || (size_t)event >= sizeof(map) / sizeof(map[0])) {
+        return -1;
+    }
+    attr->type = map[event].type;
+    attr->config = map[event].config;
+    return 0;
+}
+
+kora_perf_counter_t *kora_perf_counter_open(const int *events, size_t count, int flags)
+{
+    if (events == NULL || count == 0 || count > KORA_PERF_MAX_EVENTS) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    kora_perf_counter_t *group = calloc(1, sizeof(*group));
+    if (!group) {
+        return NULL;
+    }
+    for (size_t i = 0; i < KORA_PERF_MAX_EVENTS; i++) {
+        group->fds[i] = -1;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        if (event_to_attr(events[i], &attr) != 0) {
+            errno = EINVAL;
+            goto fail;
+        }
+        attr.disabled = (i == 0);
+        attr.exclude_kernel = !(flags & KORA_PERF_INCLUDE_KERNEL);
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID |
+                           PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        int leader = (i == 0) ? -1 : group->fds[0];
+        int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, leader, PERF_FLAG_FD_CLOEXEC);
+        if (fd < 0) {
+            /* Normalise the host's ways of saying "no such counter" */
+            if (errno == ENODEV || errno == EOPNOTSUPP) {
+                errno = ENOENT;
+            } else if (errno == EPERM) {
+                errno = EACCES;
+            } else if (errno == ENOSYS) {
+                errno = ENOTSUP;
+            }
+            goto fail;
+        }
+        group->fds[i] = fd;
+        group->count++;
+
+        if (ioctl(fd, PERF_EVENT_IOC_ID, &group->ids[i]) != 0) {
+            goto fail;
+        }
+    }
+    return group;
+
+fail:
+    {
+        int saved = errno;
+        kora_perf_counter_close(group);
+        errno = saved;
+    }
+    return NULL;
+}
+
+static int group_ioctl(kora_perf_counter_t *group, unsigned long request)
+{
+    if (group == NULL) {
+        errno = EINVAL;
+        return KORA_ERROR;
+    }
+    if (ioctl(group->fds[0], request, PERF_IOC_FLAG_GROUP) != 0) {
+        return KORA_ERROR;
+    }
+    return KORA_SUCCESS;
+}
+
+int kora_perf_counter_enable(kora_perf_counter_t *group)
+{
+    return group_ioctl(group, PERF_EVENT_IOC_ENABLE);
+}
+
+int kora_perf_counter_disable(kora_perf_counter_t *group)
+{
+    return group_ioctl(group, PERF_EVENT_IOC_DISABLE);
+}
+
+int kora_perf_counter_reset(kora_perf_counter_t *group)
+{
+    return group_ioctl(group, PERF_EVENT_IOC_RESET);
+}
+
+int kora_perf_counter_read(kora_perf_counter_t *group, kora_perf_values_t *values)
+{
+    /* nr, time_enabled, time_running, then {value, id} per event */
+    uint64_t buf[3 + 2 * KORA_PERF_MAX_EVENTS];
+
+    if (group == NULL || values == NULL) {
+        errno = EINVAL;
+        return KORA_ERROR;
+    }
+
+    ssize_t n = read(group->fds[0], buf, sizeof(buf));
+    if (n < (ssize_t)(3 * sizeof(uint64_t))) {
+        if (n >= 0) {
+            errno = EIO;
+        }
+        return KORA_ERROR;
+    }
+
+    memset(values, 0, sizeof(*values));
+    values->count = group->count;
+    values->time_enabled_ns = buf[1];
+    values->time_running_ns = buf[2];
+    values->multiplexed = buf[2] < buf[1];
+
+    uint64_t nr = buf[0];
+    for (uint64_t i = 0; i < nr && i < KORA_PERF_MAX_EVENTS; i++) {
+        uint64_t value = buf[3 + 2 * i];
+        uint64_t id = buf[4 + 2 * i];
+
+        for (uint32_t slot = 0; slot < group->count; slot++) {
+            if (group->ids[slot] != id) {
+                continue;
+            }
+            values->raw[slot] = value;
+            if (buf[2] == 0) {
+                values->scaled[slot] = 0;
+            } else if (buf[2] == buf[1]) {
+                values->scaled[slot] = value;
+            } else {
+                values->scaled[slot] = (uint64_t)((double)value * (double)buf[1] / (double)buf[2]);
+            }
+        }
+    }
+    return KORA_SUCCESS;
+}
+
+void kora_perf_counter_close(kora_perf_counter_t *group)
+{
+    if (group == NULL) {
+        return;
+    }
+    /* Members before the leader */
+    for (int i = KORA_PERF_MAX_EVENTS - 1; i >= 0; i--) {
+        if (group->fds[i] >= 0) {
+            close(group->fds[i]);
+        }
+    }
+    free(group);
+}
+
+#else /* !KORA_PLATFORM_LINUX */
+
+kora_perf_counter_t *kora_perf_counter_open(const int *events, size_t count, int flags)
+{
+    (void)events; (void)count; (void)flags;
+    errno = ENOTSUP;
+    return NULL;
+}
+
+int kora_perf_counter_enable(kora_perf_counter_t *group)
+{
+    (void)group;
+    errno = ENOTSUP;
+    return KORA_ERROR;
+}
+
+int kora_perf_counter_disable(kora_perf_counter_t *group)
+{
+    (void)group;
+    errno = ENOTSUP;
+    return KORA_ERROR;
+}
+
+int kora_perf_counter_reset(kora_perf_counter_t *group)
+{
+    (void)group;
+    errno = ENOTSUP;
+    return KORA_ERROR;
+}
+
+int kora_perf_counter_read(kora_perf_counter_t *group, kora_perf_values_t *values)
+{
+    (void)group; (void)values;
+    errno = ENOTSUP;
+    return KORA_ERROR;
+}
+
+void kora_perf_counter_close(kora_perf_counter_t *group)
+{
+    (void)group;
+}
+
+#endif
@@ -0,0 +1,623 @@
+#include <internal/syscall_impl.h>
+#include <internal/error.h>
+#include <internal/trace.h>
+#include <kora/syscalls.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if !defined(KORA_PLATFORM_WINDOWS) && !defined(KORA_NO_TRACE)
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Syscall trace recorder
+ *
+ * Each thread that makes a call while tracing owns one SPSC byte ring:
+ * the thread is the only producer and the writer thread the only
+ * consumer, so recording is encoding the record, one copy and a release
+ * of the head index. Records are variable length (arguments, optional
+ * payload) and stored exactly as they appear in the file. Rings
+ * are linked into a push-only list and never freed; when a thread exits
+ * its ring is marked free and handed to the next new thread once the
+ * writer has emptied it. A full ring drops the record and counts it.
+ */
+
+static const char *const syscall_names[] = {
+    [SYS_PUTC]              = "putc",
+    [SYS_GETC]              = "getc",
+    [SYS_OPEN]              = "open",
+    [SYS_CLOSE]             = "close",
+    [SYS_READ]              = "read",
+    [SYS_WRITE]             = "write",
+    [SYS_SEEK]              = "seek",
+    [SYS_IOCTL]             = "ioctl",
+    [SYS_MKDIR]             = "mkdir",
+    [SYS_RMDIR]             = "rmdir",
+    [SYS_OPENDIR]           = "opendir",
+    [SYS_READDIR]           = "readdir",
+    [SYS_CLOSEDIR]          = "closedir",
+    [SYS_SYMLINK]           = "symlink",
+    [SYS_READLINK]          = "readlink",
+    [SYS_UNLINK]            = "unlink",
+    [SYS_GET_FILE_INFO]     = "get_file_info",
+    [SYS_GET_FD_INFO]       = "get_fd_info",
+    [SYS_EXISTS]            = "exists",
+    [SYS_RENAME]            = "rename",
+    [SYS_BRK]               = "brk",
+    [SYS_SBRK]              = "sbrk",
+    [SYS_MMAP]              = "mmap",
+    [SYS_MUNMAP]            = "munmap",
+    [SYS_MPROTECT]          = "mprotect",
+    [SYS_SPAWN]             = "spawn",
+    [SYS_EXIT]              = "exit",
+    [SYS_WAIT]              = "wait",
+    [SYS_YIELD]             = "yield",
+    [SYS_GETPID]            = "getpid",
+    [SYS_GETPPID]           = "getppid",
+    [SYS_SETPRIORITY]       = "setpriority",
+    [SYS_PIPE]              = "pipe",
+    [SYS_DUP]               = "dup",
+    [SYS_DUP2]              = "dup2",
+    [SYS_SELECT]            = "select",
+    [SYS_SEM_WAIT]          = "sem_wait",
+    [SYS_SEM_POST]          = "sem_post",
+    [SYS_CLOCK_GETTIME]     = "clock_gettime",
+    [SYS_GETTIMEOFDAY]      = "gettimeofday",
+    [SYS_NANOSLEEP]         = "nanosleep",
+    [SYS_SLEEP]             = "sleep",
+    [SYS_SETITIMER]         = "setitimer",
+    [SYS_STAT]              = "stat",
+    [SYS_FSTAT]             = "fstat",
+    [SYS_LSTAT]             = "lstat",
+    [SYS_LINK]              = "link",
+    [SYS_CHDIR]             = "chdir",
+    [SYS_GETCWD]            = "getcwd",
+    [SYS_UTIME]             = "utime",
+    [SYS_SIGNAL]            = "signal",
+    [SYS_KILL]              = "kill",
+    [SYS_SIGRETURN]         = "sigreturn",
+    [SYS_SYNC]              = "sync",
+    [SYS_REBOOT]            = "reboot",
+    [SYS_MOUNT]             = "mount",
+    [SYS_FADVISE]           = "fadvise",
+    [SYS_READAHEAD]         = "readahead",
+    [SYS_PIPE2]             = "pipe2",
+    [SYS_PIPE_SIZE]         = "pipe_size",
+    [SYS_SPLICE]            = "splice",
+    [SYS_TEE]               = "tee",
+    [SYS_SHM_CREATE]        = "shm_create",
+    [SYS_SHM_OPEN]          = "shm_open",
+    [SYS_SHM_UNLINK]        = "shm_unlink",
+    [SYS_SHM_SEAL]          = "shm_seal",
+    [SYS_SIGACTION]         = "sigaction",
+    [SYS_SIGPROCMASK]       = "sigprocmask",
+    [SYS_SIGNALFD]          = "signalfd",
+    [SYS_SIGNALFD_READ]     = "signalfd_read",
+    [SYS_SCHED_SETAFFINITY] = "sched_setaffinity",
+    [SYS_SCHED_GETAFFINITY] = "sched_getaffinity",
+    [SYS_GETCPU]            = "getcpu",
+    [SYS_CPU_TOPOLOGY]      = "cpu_topology",
+    [SYS_GETTID]            = "gettid",
+    [SYS_SCHED_SETPOLICY]   = "sched_setpolicy",
+    [SYS_SCHED_GETPOLICY]   = "sched_getpolicy",
+    [SYS_IOPRIO_SET]        = "ioprio_set",
+    [SYS_IOPRIO_GET]        = "ioprio_get",
+    [SYS_THREAD_CREATE]     = "thread_create",
+    [SYS_THREAD_JOIN]       = "thread_join",
+    [SYS_THREAD_EXIT]       = "thread_exit",
+    [SYS_THREAD_SELF]       = "thread_self",
+    [SYS_GETRUSAGE]         = "getrusage",
+    [SYS_WAIT4]             = "wait4",
+    [SYS_UMOUNT]            = "umount",
+};
+
+const char *kora_syscall_name(int syscall) {
+    if (syscall <= 0 || (size_t)syscall >= sizeof(syscall_names) / sizeof(syscall_names[0])) {
+        return NULL;
+    }
+    return syscall_names[syscall];
+}
+
+atomic_int kora_trace_active = 0;
+
+uint64_t kora_trace_clock(void) {
+    struct timespec ts;
+#if defined(KORA_PLATFORM_WINDOWS)
+    timespec_get(&ts, TIME_UTC);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+uint64_t kora_trace_hash(const void *data, size_t len) {
+    const unsigned char *p = data;
+    uint64_t h = 0xcbf29ce484222325ull ^ len;
+
+    /* FNV-1a over 64-bit words, then the tail bytes */
+    for (; len >= 8; p += 8, len -= 8) {
+        uint64_t w;
+        memcpy(&w, p, sizeof(w));
+        h = (h ^ w) * 0x100000001b3ull;
+        h ^= h >> 29;
+    }
+    for (; len > 0; p++, len--) {
+        h = (h ^ *p) * 0x100000001b3ull;
+    }
+    return h;
+}
+
+#if !defined(KORA_PLATFORM_WINDOWS) && !defined(KORA_NO_TRACE)
+
+static uint64_t thread_cpu_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+#define RING_BYTES       (256 * 1024)       /* Per thread, power of two */
+#define RING_WAKE        (RING_BYTES / 2)   /* Fill level that wakes the writer early */
+#define WRITER_PERIOD_NS 10000000           /* Writer drains at least every 10 ms */
+
+/* Largest encoded record: header, arguments, payload and two full paths */
+#define RECORD_MAX (sizeof(kora_trace_record_t) + KORA_TRACE_MAX_ARGS * sizeof(uint64_t) + \
+                    sizeof(kora_trace_payload_t) + 2 * KORA_TRACE_MAX_PATH)
+
+enum { RING_LIVE, RING_FREE };
+
+/* Records are stored already encoded as in the file, so a drain is a copy */
+typedef struct trace_ring {
+    _Atomic uint64_t head;          /* Bytes written; owner thread only */
+    char pad0[64 - sizeof(uint64_t)];
+    _Atomic uint64_t tail;          /* Bytes drained; writer only */
+    char pad1[64 - sizeof(uint64_t)];
+    atomic_int state;
+    uint32_t tid;
+    struct trace_ring *next;
+    unsigned char data[RING_BYTES];
+} trace_ring_t;
+
+/*
+ * Calls whose payload is worth keeping: the number of leading path
+ * arguments, and the 1-based argument holding a buffer whose first
+ * `result` bytes are hashed
+ */
+static const struct {
+    uint8_t paths;
+    uint8_t data;
+} payload_args[] = {
+    [SYS_OPEN]          = { 1, 0 },
+    [SYS_READ]          = { 0, 2 },
+    [SYS_WRITE]         = { 0, 2 },
+    [SYS_MKDIR]         = { 1, 0 },
+    [SYS_RMDIR]         = { 1, 0 },
+    [SYS_OPENDIR]       = { 1, 0 },
+    [SYS_SYMLINK]       = { 2, 0 },
+    [SYS_READLINK]      = { 1, 2 },
+    [SYS_UNLINK]        = { 1, 0 },
+    [SYS_GET_FILE_INFO] = { 1, 0 },
+    [SYS_EXISTS]        = { 1, 0 },
+    [SYS_RENAME]        = { 2, 0 },
+    [SYS_SPAWN]         = { 1, 0 },
+    [SYS_STAT]          = { 1, 0 },
+    [SYS_LSTAT]         = { 1, 0 },
+    [SYS_LINK]          = { 2, 0 },
+    [SYS_CHDIR]         = { 1, 0 },
+    [SYS_UTIME]         = { 1, 0 },
+    [SYS_MOUNT]         = { 2, 0 },
+    [SYS_UMOUNT]        = { 1, 0 },
+    [SYS_SHM_CREATE]    = { 1, 0 },
+    [SYS_SHM_OPEN]      = { 1, 0 },
+    [SYS_SHM_UNLINK]    = { 1, 0 },
+};
+
+static _Atomic(trace_ring_t *) rings = NULL;
+static KORA_THREAD_LOCAL trace_ring_t *thread_ring;
+static atomic_ullong dropped = 0;
+static int trace_flags;
+
+static pthread_once_t trace_once = PTHREAD_ONCE_INIT;
+static pthread_key_t ring_key;
+static pthread_mutex_t control_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t writer;
+static pthread_mutex_t writer_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t writer_wake = PTHREAD_COND_INITIALIZER;
+static atomic_int writer_run = 0;
+static int trace_fd = -1;
+static int write_failed;
+static unsigned char *staging;   /* One drained ring behind a chunk header */
+
+static pid_t host_gettid(void) {
+#if defined(KORA_PLATFORM_LINUX)
+    return linux_sys_gettid();
+#elif defined(KORA_PLATFORM_MACOS)
+    return macos_sys_gettid();
+#endif
+}
+
+static void ring_release(void *ring) {
+    atomic_store_explicit(&((trace_ring_t *)ring)->state, RING_FREE, memory_order_release);
+}
+
+static void trace_atexit(void) {
+    kora_trace_stop();
+}
+
+static void trace_atfork_child(void) {
+    /* The writer thread did not survive the fork; the parent owns the file */
+    atomic_store_explicit(&kora_trace_active, 0, memory_order_relaxed);
+    atomic_store_explicit(&writer_run, 0, memory_order_relaxed);
+    pthread_mutex_init(&control_lock, NULL);
+    pthread_mutex_init(&writer_lock, NULL);
+    if (trace_fd >= 0) {
+        close(trace_fd);
+        trace_fd = -1;
+    }
+}
+
+static void trace_init(void) {
+    pthread_key_create(&ring_key, ring_release);
+    pthread_atfork(NULL, NULL, trace_atfork_child);
+    atexit(trace_atexit);
+}
+
+static trace_ring_t *ring_attach(void) {
+    trace_ring_t *ring;
+
+    pthread_once(&trace_once, trace_init);
+
+    /* Reuse an emptied ring left by an exited thread */
+    for (ring = atomic_load_explicit(&rings, memory_order_acquire); ring != NULL; ring = ring->next) {
+        int expected = RING_FREE;
+        if (atomic_load_explicit(&ring->head, memory_order_relaxed) ==
+                atomic_load_explicit(&ring->tail, memory_order_acquire) &&
+            atomic_compare_exchange_strong(&ring->state, &expected, RING_LIVE)) {
+            break;
+        }
+    }
+
+    if (ring == NULL) {
+        ring = calloc(1, sizeof(*ring));
+        if (ring == NULL) {
+            return NULL;
+        }
+        atomic_init(&ring->state, RING_LIVE);
+        ring->next = atomic_load_explicit(&rings, memory_order_relaxed);
+        while (!atomic_compare_exchange_weak_explicit(&rings, &ring->next, ring,
+                                                      memory_order_release,
+                                                      memory_order_relaxed)) {
+        }
+    }
+
+    ring->tid = (uint32_t)host_gettid();
+    pthread_setspecific(ring_key, ring);
+    thread_ring = ring;
+    return ring;
+}
+
+/* Append the payload after the arguments; returns its encoded size */
+static size_t encode_payload(unsigned char *out, int syscall, int64_t result,
+                             int nargs, const uint64_t *args, uint8_t *flags) {
+    kora_trace_payload_t payload = { 0, 0, { 0, 0 } };
+    unsigned char *text = out + sizeof(payload);
+    size_t text_len = 0;
+
+    for (int i = 0; i < payload_args[syscall].paths && i < nargs; i++) {
+        const char *path = (const char *)(uintptr_t)args[i];
+        size_t len = path != NULL ? strlen(path) : 0;
+        if (len > KORA_TRACE_MAX_PATH) {
+            len = KORA_TRACE_MAX_PATH;
+            *flags |= KORA_TRACE_F_TRUNCATED;
+        }
+        if (len > 0) {
+            memcpy(text + text_len, path, len);
+        }
+        payload.path_bytes[i] = (uint16_t)len;
+        text_len += len;
+    }
+
+    int data = payload_args[syscall].data;
+    if (data != 0 && data <= nargs && result > 0) {
+        payload.data_bytes = (uint32_t)result;
+        payload.hash = kora_trace_hash((const void *)(uintptr_t)args[data - 1], (size_t)result);
+    }
+
+    memset(text + text_len, 0, KORA_TRACE_PAYLOAD_SIZE(&payload) - sizeof(payload) - text_len);
+    memcpy(out, &payload, sizeof(payload));
+    *flags |= KORA_TRACE_F_PAYLOAD;
+    return KORA_TRACE_PAYLOAD_SIZE(&payload);
+}
+
+/* The CPU interval is sampled inside the wall interval so cpu <= duration */
+void kora_trace_begin(kora_trace_span_t *span) {
+    span->start_ns = kora_trace_clock();
+    span->cpu_ns = thread_cpu_ns();
+}
+
+void kora_trace_record(int syscall, const kora_trace_span_t *span, int64_t result,
+                       int nargs, const uint64_t *args) {
+    int saved_errno = errno;
+    uint64_t cpu_end = thread_cpu_ns();
+    uint64_t end = kora_trace_clock();
+    trace_ring_t *ring = thread_ring;
+
+    if (ring == NULL && (ring = ring_attach()) == NULL) {
+        atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+        errno = saved_errno;
+        return;
+    }
+
+    _Alignas(8) unsigned char buf[RECORD_MAX];
+    kora_trace_record_t rec;
+    rec.start_ns = span->start_ns;
+    rec.duration_ns = end - span->start_ns;
+    rec.cpu_ns = cpu_end - span->cpu_ns;
+    rec.result = result;
+    rec.host_errno = result == -1 ? saved_errno : 0;
+    rec.syscall = (uint16_t)syscall;
+    rec.nargs = (uint8_t)nargs;
+    rec.flags = 0;
+
+    size_t len = sizeof(rec);
+    memcpy(buf + len, args, (size_t)nargs * sizeof(uint64_t));
+    len += (size_t)nargs * sizeof(uint64_t);
+    if ((trace_flags & KORA_TRACE_PAYLOADS) &&
+        (size_t)syscall < sizeof(payload_args) / sizeof(payload_args[0]) &&
+        (payload_args[syscall].paths != 0 || payload_args[syscall].data != 0)) {
+        len += encode_payload(buf + len, syscall, result, nargs, args, &rec.flags);
+    }
+    memcpy(buf, &rec, sizeof(rec));
+
+    uint64_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint64_t used = head - atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (used + len > RING_BYTES) {
+        atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+    } else {
+        size_t pos = head & (RING_BYTES - 1);
+        size_t first = len < RING_BYTES - pos ? len : RING_BYTES - pos;
+        memcpy(ring->data + pos, buf, first);
+        memcpy(ring->data, buf + first, len - first);
+        atomic_store_explicit(&ring->head, head + len, memory_order_release);
+
+        /* A missed wakeup only delays the drain to the next period */
+        if (used < RING_WAKE && used + len >= RING_WAKE) {
+            pthread_cond_signal(&writer_wake);
+        }
+    }
+
+    /* Nothing runs after sys_exit to flush the rings */
+    if (syscall == SYS_EXIT) {
+        kora_trace_stop();
+    }
+
+    errno = saved_errno;
+}
+
+static void write_all(const void *buf, size_t len) {
+    const unsigned char *p = buf;
+    while (len > 0 && !write_failed) {
+        ssize_t n = write(trace_fd, p, len);
+        if (n < 0) {
+            if (errno != EINTR) {
+                write_failed = errno;
+            }
+            continue;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+}
+
+/* Writer thread only, or the stopping thread once the writer is joined */
+static void drain_rings(void) {
+    for (trace_ring_t *ring = atomic_load_explicit(&rings, memory_order_acquire);
+         ring != NULL; ring = ring->next) {
+        uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        uint64_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        if (head == tail) {
+            continue;
+        }
+
+        size_t len = (size_t)(head - tail);
+        size_t pos = tail & (RING_BYTES - 1);
+        size_t first = len < RING_BYTES - pos ? len : RING_BYTES - pos;
+        unsigned char *records = staging + sizeof(kora_trace_chunk_t);
+        memcpy(records, ring->data + pos, first);
+        memcpy(records + first, ring->data, len - first);
+        atomic_store_explicit(&ring->tail, head, memory_order_release);
+
+        kora_trace_chunk_t chunk = { KORA_TRACE_CHUNK_RECORDS, ring->tid, 0, (uint32_t)len };
+        for (size_t off = 0; off < len; chunk.count++) {
+            kora_trace_record_t rec;
+            memcpy(&rec, records + off, sizeof(rec));
+            off += sizeof(rec) + rec.nargs * sizeof(uint64_t);
+            if (rec.flags & KORA_TRACE_F_PAYLOAD) {
+                kora_trace_payload_t payload;
+                memcpy(&payload, records + off, sizeof(payload));
+                off += KORA_TRACE_PAYLOAD_SIZE(&payload);
+            }
+        }
+        memcpy(staging, &chunk, sizeof(chunk));
+        write_all(staging, sizeof(chunk) + len);
+    }
+}
+
+static void *writer_main(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&writer_lock);
+    while (atomic_load_explicit(&writer_run, memory_order_acquire)) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += WRITER_PERIOD_NS;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+        pthread_cond_timedwait(&writer_wake, &writer_lock, &deadline);
+        drain_rings();
+    }
+    pthread_mutex_unlock(&writer_lock);
+    return NULL;
+}
+
+int kora_trace_start(const char *path) {
+    return kora_trace_start_flags(path, 0);
+}
+
+int kora_trace_start_flags(const char *path, int flags) {
+    pthread_once(&trace_once, trace_init);
+    pthread_mutex_lock(&control_lock);
+
+    if (trace_fd >= 0) {
+        pthread_mutex_unlock(&control_lock);
+        errno = EBUSY;
+        return KORA_ERROR;
+    }
+
+    if (staging == NULL) {
+        staging = malloc(sizeof(kora_trace_chunk_t) + RING_BYTES);
+        if (staging == NULL) {
+            pthread_mutex_unlock(&control_lock);
+            errno = ENOMEM;
+            return KORA_ERROR;
+        }
+    }
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        pthread_mutex_unlock(&control_lock);
+        return KORA_ERROR;
+    }
+    trace_fd = fd;
+    trace_flags = flags;
+    write_failed = 0;
+
+    /* Records left over from an earlier session belong to nobody */
+    for (trace_ring_t *ring = atomic_load_explicit(&rings, memory_order_acquire);
+         ring != NULL; ring = ring->next) {
+        atomic_store_explicit(&ring->tail, atomic_load_explicit(&ring->head, memory_order_acquire),
+                              memory_order_release);
+    }
+    atomic_store_explicit(&dropped, 0, memory_order_relaxed);
+
+    struct timespec real;
+    clock_gettime(CLOCK_REALTIME, &real);
+    kora_trace_header_t header;
+    memset(&header, 0, sizeof(header));
+    header.magic = KORA_TRACE_MAGIC;
+    header.version = KORA_TRACE_VERSION;
+    header.pid = (uint32_t)getpid();
+    header.start_monotonic_ns = kora_trace_clock();
+    header.start_realtime_ns = (uint64_t)real.tv_sec * 1000000000ull + (uint64_t)real.tv_nsec;
+    write_all(&header, sizeof(header));
+
+    atomic_store_explicit(&writer_run, 1, memory_order_release);
+    int err = pthread_create(&writer, NULL, writer_main, NULL);
+    if (err != 0) {
+        atomic_store_explicit(&writer_run, 0, memory_order_relaxed);
+        close(trace_fd);
+        trace_fd = -1;
+        pthread_mutex_unlock(&control_lock);
+        errno = err;
+        return KORA_ERROR;
+    }
+
+    atomic_store_explicit(&kora_trace_active, 1, memory_order_release);
+    pthread_mutex_unlock(&control_lock);
+    return KORA_SUCCESS;
+}
+
+int kora_trace_stop(void) {
+    pthread_mutex_lock(&control_lock);
+
+    if (trace_fd < 0) {
+        pthread_mutex_unlock(&control_lock);
+        return KORA_SUCCESS;
+    }
+
+    atomic_store_explicit(&kora_trace_active, 0, memory_order_relaxed);
+    atomic_store_explicit(&writer_run, 0, memory_order_release);
+    pthread_cond_signal(&writer_wake);
+    pthread_join(writer, NULL);
+    drain_rings();
+
+    kora_trace_chunk_t chunk = { KORA_TRACE_CHUNK_END, 0, 0, sizeof(kora_trace_end_t) };
+    kora_trace_end_t end;
+    end.dropped = atomic_load_explicit(&dropped, memory_order_relaxed);
+    end.stop_monotonic_ns = kora_trace_clock();
+    write_all(&chunk, sizeof(chunk));
+    write_all(&end, sizeof(end));
+
+    int err = write_failed;
+    if (close(trace_fd) != 0 && err == 0) {
+        err = errno;
+    }
+    trace_fd = -1;
+    pthread_mutex_unlock(&control_lock);
+
+    if (err != 0) {
+        errno = err;
+        return KORA_ERROR;
+    }
+    return KORA_SUCCESS;
+}
+
+int kora_trace_enabled(void) {
+    return atomic_load_explicit(&kora_trace_active, memory_order_relaxed);
+}
+
+uint64_t kora_trace_dropped(void) {
+    return atomic_load_explicit(&dropped, memory_order_relaxed);
+}
+
+#if defined(__GNUC__)
+__attribute__((constructor))
+static void trace_from_env(void) {
+    const char *path = getenv("KORA_TRACE");
+    const char *payloads = getenv("KORA_TRACE_PAYLOADS");
+    if (path != NULL && path[0] != '\0') {
+        kora_trace_start_flags(path, payloads != NULL && strcmp(payloads, "1") == 0
+                                         ? KORA_TRACE_PAYLOADS : 0);
+    }
+}
+#endif
+
+#else /* KORA_PLATFORM_WINDOWS || KORA_NO_TRACE */
+
+void kora_trace_begin(kora_trace_span_t *span) {
+    span->start_ns = 0;
+    span->cpu_ns = 0;
+}
+
+void kora_trace_record(int syscall, const kora_trace_span_t *span, int64_t result,
+                       int nargs, const uint64_t *args) {
+    (void)syscall; (void)span; (void)result; (void)nargs; (void)args;
+}
+
+int kora_trace_start(const char *path) {
+    return kora_trace_start_flags(path, 0);
+}
+
+int kora_trace_start_flags(const char *path, int flags) {
+    (void)path; (void)flags;
+    errno = ENOTSUP;
+    return KORA_ERROR;
+}
+
+int kora_trace_stop(void) {
+    return KORA_SUCCESS;
+}
+
+int kora_trace_enabled(void) {
+    return 0;
+}
+
+uint64_t kora_trace_dropped(void) {
+    return 0;
+}
+
+#endif
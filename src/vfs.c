@@ -0,0 +1,1175 @@
+#include <internal/backend.h>
+#include <internal/error.h>
+#include <internal/fdtable.h>
+#include <internal/grace.h>
+#include <internal/syscall_impl.h>
+#include <internal/vfs.h>
+#include <kora/bcache.h>
+#include <kora/fatfs.h>
+#include <kora/memfs.h>
+#include <kora/syscalls.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(KORA_PLATFORM_WINDOWS)
+#include <pthread.h>
+#include <sys/stat.h>
+#endif
+
+/**
+ * Virtual filesystem routing
+ *
+ * The mount table is an immutable radix tree over the mounted prefixes,
+ * rebuilt on every mount and unmount and published through one atomic
+ * pointer, so routing a path takes no lock. Each node's label is the
+ * run of bytes its prefixes share beyond the parent, so routing compares
+ * each byte of the path at most once, however many prefixes are
+ * mounted, and picks the longest mounted prefix that ends at a path
+ * component boundary.
+ *
+ * A path call holds a grace section (internal/grace.h) while it uses
+ * the table and the filesystem it routed to. Mount and unmount wait for
+ * the sections that began before the change to end before freeing the
+ * replaced table or destroying the filesystem. While nothing is mounted
+ * kora_vfs_active is clear and the hooks are not reached at all.
+ *
+ * Host mounts are routing only: a path under one is rewritten to the
+ * host directory it stands for and handed to the platform backend, so
+ * the descriptors it returns are ordinary host descriptors.
+ *
+ * Descriptors of mounted filesystems are entries in the layer's
+ * descriptor table (internal/fdtable.h), owned by the filesystem, so a
+ * lookup is two loads. As with host descriptors, closing one while
+ * another thread is still using it is a caller bug.
+ */
+
+atomic_int kora_vfs_active = 0;
+
+#if !defined(KORA_PLATFORM_WINDOWS)
+
+typedef struct {
+    char *prefix;
+    size_t len;     /* 0 for "/" so every absolute path matches */
+    kora_vfs_t *fs;
+} vfs_mount_t;
+
+typedef struct {
+    const char *label;  /* Bytes beyond the parent, inside a mounted prefix */
+    uint32_t len;
+    uint32_t first;     /* Index of the first child */
+    uint32_t children;  /* Contiguous, in order of their first label byte */
+    kora_vfs_t *fs;     /* Mounted on the prefix ending here, or NULL */
+} vfs_node_t;
+
+typedef struct {
+    size_t count;
+    vfs_mount_t *mounts;  /* Sorted by prefix */
+    vfs_node_t nodes[];   /* nodes[0] is the root, with an empty label */
+} vfs_table_t;
+
+typedef struct {
+    kora_vfs_t base;
+    unsigned flags;
+    size_t len;
+    char dir[];     /* Host directory without trailing slashes, "" for the root */
+} host_mount_t;
+
+static _Atomic(vfs_table_t *) mount_table;
+static pthread_mutex_t vfs_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static const kora_vfs_ops_t host_ops;
+
+#define IS_HOST(fs) ((fs)->ops == &host_ops)
+
+/*
+ * Mount table
+ */
+
+/* Called inside a grace section, see internal/grace.h */
+static kora_vfs_t *route(const char *path, const char **rest) {
+    vfs_table_t *table = atomic_load_explicit(&mount_table, memory_order_seq_cst);
+
+    if (table == NULL || path == NULL || path[0] != '/') {
+        return NULL;
+    }
+    const vfs_node_t *node = table->nodes;
+    kora_vfs_t *best = node->fs;
+    const char *p = path, *end = path;
+    for (;;) {
+        const vfs_node_t *next = NULL;
+        for (uint32_t i = 0; i < node->children; i++) {
+            if (table->nodes[node->first + i].label[0] == *p) {
+                next = &table->nodes[node->first + i];
+                break;
+            }
+        }
+        if (next == NULL || strncmp(p, next->label, next->len) != 0) {
+            break;
+        }
+        p += next->len;
+        node = next;
+        if (node->fs != NULL && (*p == '/' || *p == '\0')) {
+            best = node->fs;
+            end = p;
+        }
+    }
+    if (best == NULL) {
+        return NULL;
+    }
+    *rest = *end != '\0' ? end : "/";
+    return best;
+}
+
+/* Copy of prefix without trailing slashes, "" for the root */
+static char *normalise_prefix(const char *prefix, size_t *len) {
+    if (prefix == NULL || prefix[0] != '/') {
+        return NULL;
+    }
+    size_t n = strlen(prefix);
+    while (n > 0 && prefix[n - 1] == '/') {
+        n--;
+    }
+    char *copy = malloc(n + 1);
+    if (copy != NULL) {
+        memcpy(copy, prefix, n);
+        copy[n] = '\0';
+        *len = n;
+    }
+    return copy;
+}
+
+/* Index of prefix in the sorted mount list, or of where it would go */
+static size_t find_mount(const vfs_table_t *table, const char *prefix, int *found) {
+    size_t lo = 0, hi = table != NULL ? table->count : 0;
+
+    *found = 0;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int c = strcmp(table->mounts[mid].prefix, prefix);
+        if (c == 0) {
+            *found = 1;
+            return mid;
+        }
+        if (c < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static size_t common_length(const vfs_mount_t *a, const vfs_mount_t *b) {
+    size_t n = 0;
+    while (n < a->len && n < b->len && a->prefix[n] == b->prefix[n]) {
+        n++;
+    }
+    return n;
+}
+
+/*
+ * Fill node `at` for mounts[lo, hi), which agree on their first `to`
+ * bytes; its label is bytes [from, to). Sorting puts a prefix that ends
+ * here first, and groups the rest by their next byte.
+ */
+static void lay_out(vfs_table_t *table, uint32_t *used, uint32_t at, size_t lo, size_t hi,
+                    size_t from, size_t to) {
+    const vfs_mount_t *m = table->mounts;
+    vfs_node_t *node = &table->nodes[at];
+
+    node->label = lo < hi ? m[lo].prefix + from : "";
+    node->len = (uint32_t)(to - from);
+    node->fs = NULL;
+    if (lo < hi && m[lo].len == to) {
+        node->fs = m[lo++].fs;
+    }
+    node->first = *used;
+    node->children = 0;
+    for (size_t i = lo; i < hi; i++) {
+        node->children += i == lo || m[i].prefix[to] != m[i - 1].prefix[to];
+    }
+    *used += node->children;
+
+    uint32_t child = node->first;
+    for (size_t i = lo; i < hi;) {
+        size_t j = i + 1;
+        while (j < hi && m[j].prefix[to] == m[i].prefix[to]) {
+            j++;
+        }
+        lay_out(table, used, child++, i, j, to, common_length(&m[i], &m[j - 1]));
+        i = j;
+    }
+}
+
+/* New table holding the old mounts with `gone` left out, or `add` inserted at `at` */
+static vfs_table_t *build_table(const vfs_table_t *old, size_t at, const vfs_mount_t *add) {
+    size_t old_count = old != NULL ? old->count : 0;
+    size_t count = add != NULL ? old_count + 1 : old_count - 1;
+    /* A radix tree has at most one branching node per prefix besides the prefixes' own */
+    size_t nodes = 2 * count + 1;
+    vfs_table_t *table = malloc(sizeof(*table) + nodes * sizeof(vfs_node_t) +
+                                count * sizeof(vfs_mount_t));
+    if (table == NULL) {
+        return NULL;
+    }
+    table->count = count;
+    table->mounts = (vfs_mount_t *)&table->nodes[nodes];
+    for (size_t i = 0, j = 0; i < old_count; i++) {
+        if (j == at && add != NULL) {
+            table->mounts[j++] = *add;
+        }
+        if (i != at || add != NULL) {
+            table->mounts[j++] = old->mounts[i];
+        }
+    }
+    if (add != NULL && at == old_count) {
+        table->mounts[at] = *add;
+    }
+    uint32_t used = 1;
+    lay_out(table, &used, 0, 0, count, 0, 0);
+    return table;
+}
+
+int kora_vfs_mount(const char *prefix, kora_vfs_t *fs) {
+    size_t len;
+    int found;
+    char *copy = normalise_prefix(prefix, &len);
+    if (copy == NULL) {
+        return prefix == NULL || prefix[0] != '/' ? -EINVAL : -ENOMEM;
+    }
+
+    pthread_mutex_lock(&vfs_lock);
+    vfs_table_t *old = atomic_load_explicit(&mount_table, memory_order_relaxed);
+    size_t at = find_mount(old, copy, &found);
+    if (found) {
+        pthread_mutex_unlock(&vfs_lock);
+        free(copy);
+        return -EBUSY;
+    }
+    vfs_mount_t add = { copy, len, fs };
+    vfs_table_t *table = build_table(old, at, &add);
+    if (table == NULL) {
+        pthread_mutex_unlock(&vfs_lock);
+        free(copy);
+        return -ENOMEM;
+    }
+    fs->prefix = len > 0 ? copy : "/";
+    atomic_store_explicit(&fs->handles, 0, memory_order_relaxed);
+    atomic_store_explicit(&mount_table, table, memory_order_seq_cst);
+    atomic_store_explicit(&kora_vfs_active, 1, memory_order_relaxed);
+    kora_grace_wait();
+    pthread_mutex_unlock(&vfs_lock);
+    free(old);
+    return 0;
+}
+
+int kora_vfs_unmount(const char *prefix, const kora_vfs_ops_t *ops) {
+    size_t len;
+    int found;
+    char *key = normalise_prefix(prefix, &len);
+    if (key == NULL) {
+        return -EINVAL;
+    }
+
+    pthread_mutex_lock(&vfs_lock);
+    vfs_table_t *old = atomic_load_explicit(&mount_table, memory_order_relaxed);
+    size_t i = find_mount(old, key, &found);
+    free(key);
+    if (!found) {
+        pthread_mutex_unlock(&vfs_lock);
+        return -EINVAL;
+    }
+    vfs_mount_t gone = old->mounts[i];
+    if (ops != NULL && gone.fs->ops != ops) {
+        pthread_mutex_unlock(&vfs_lock);
+        return -EINVAL;
+    }
+    if (atomic_load_explicit(&gone.fs->handles, memory_order_relaxed) != 0) {
+        pthread_mutex_unlock(&vfs_lock);
+        return -EBUSY;
+    }
+    vfs_table_t *table = build_table(old, i, NULL);
+    if (table == NULL) {
+        pthread_mutex_unlock(&vfs_lock);
+        return -ENOMEM;
+    }
+    atomic_store_explicit(&mount_table, table, memory_order_seq_cst);
+    kora_grace_wait();
+
+    /* An open that routed here before the table changed may have added a handle */
+    if (atomic_load_explicit(&gone.fs->handles, memory_order_acquire) != 0) {
+        atomic_store_explicit(&mount_table, old, memory_order_seq_cst);
+        kora_grace_wait();
+        pthread_mutex_unlock(&vfs_lock);
+        free(table);
+        return -EBUSY;
+    }
+    /*
+     * With the last mount gone no layer descriptor is left either, since
+     * every filesystem was unmounted without handles, so the hooks can go
+     */
+    if (table->count == 0) {
+        atomic_store_explicit(&kora_vfs_active, 0, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&vfs_lock);
+    free(old);
+
+    gone.fs->ops->destroy(gone.fs);
+    free(gone.prefix);
+    return 0;
+}
+
+/*
+ * Host mounts
+ */
+
+static void host_destroy(kora_vfs_t *fs) {
+    free(fs);
+}
+
+/* Only destroy is reached: the hooks hand host paths to the platform */
+static const kora_vfs_ops_t host_ops = {
+    .name = "host",
+    .destroy = host_destroy,
+};
+
+int kora_vfs_host_mount(const char *dir, const char *prefix, unsigned flags) {
+    char *real = realpath(dir != NULL ? dir : prefix != NULL ? prefix : "", NULL);
+    struct stat st;
+
+    if (prefix == NULL || prefix[0] != '/') {
+        free(real);
+        return -EINVAL;
+    }
+    if (real == NULL) {
+        return -errno;
+    }
+    if (stat(real, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        free(real);
+        return -ENOTDIR;
+    }
+    size_t len = strlen(real);
+    if (len == 1) {
+        len = 0;  /* "/" */
+    }
+    host_mount_t *m = malloc(sizeof(*m) + len + 1);
+    if (m == NULL) {
+        free(real);
+        return -ENOMEM;
+    }
+    m->base.ops = &host_ops;
+    m->flags = flags;
+    m->len = len;
+    memcpy(m->dir, real, len);
+    m->dir[len] = '\0';
+    free(real);
+
+    int r = kora_vfs_mount(prefix, &m->base);
+    if (r != 0) {
+        free(m);
+    }
+    return r;
+}
+
+/* The host path for rest under a host mount, or -EROFS for a change to a read-only one */
+static int host_path(kora_vfs_t *fs, const char *rest, int change, char *buf) {
+    const host_mount_t *m = (const host_mount_t *)fs;
+    size_t n = strlen(rest);
+
+    if (change && (m->flags & KORA_MOUNT_RDONLY)) {
+        return -EROFS;
+    }
+    if (m->len + n >= PATH_MAX) {
+        return -ENAMETOOLONG;
+    }
+    memcpy(buf, m->dir, m->len);
+    memcpy(buf + m->len, rest, n + 1);
+    return 0;
+}
+
+/*
+ * Descriptors
+ */
+
+/* Counted first, so an unmount racing the open sees the handle */
+static int desc_alloc(kora_vfs_t *fs, void *handle, int dir) {
+    atomic_fetch_add_explicit(&fs->handles, 1, memory_order_relaxed);
+    int fd = kora_fd_alloc(fs, fs->ops->name, handle, dir ? KORA_FD_DIR : 0);
+    if (fd < 0) {
+        atomic_fetch_sub_explicit(&fs->handles, 1, memory_order_relaxed);
+    }
+    return fd;
+}
+
+/* Released after the filesystem closed the handle, so unmount cannot destroy it first */
+static void desc_release(kora_vfs_t *fs) {
+    atomic_fetch_sub_explicit(&fs->handles, 1, memory_order_release);
+}
+
+#define DESC_FS(d) ((kora_vfs_t *)atomic_load_explicit(&(d)->owner, memory_order_relaxed))
+
+/*
+ * Results in the conventions of the platform backends: file I/O and
+ * directory calls fail with KORA_ERROR and errno, the file metadata
+ * calls with a negative errno
+ */
+
+static int result_errno(int syscall, int result, int *ret) {
+    if (result < 0) {
+        kora_record_error(syscall, -result);
+        errno = -result;
+        *ret = KORA_ERROR;
+    } else {
+        *ret = result;
+    }
+    return 1;
+}
+
+static int result_neg(int syscall, int result, int *ret) {
+    if (result < 0) {
+        kora_record_error(syscall, -result);
+    }
+    *ret = result;
+    return 1;
+}
+
+/*
+ * Hand a path call on a host mount to the platform with the path
+ * rewritten into `host`; a rewrite error is reported through fail. The
+ * grace section ends first, so a host call that blocks does not hold
+ * up unmount.
+ */
+#define ON_HOST(fs, rest, change, fail, syscall, call)         \
+    do {                                                       \
+        char host[PATH_MAX];                                   \
+        int host_r = host_path(fs, rest, change, host);        \
+        if (host_r < 0) {                                      \
+            return fail(syscall, host_r, ret);                 \
+        }                                                      \
+        kora_grace_leave();                                    \
+        *ret = (call);                                         \
+        return 1;                                              \
+    } while (0)
+
+/* A descriptor in the VFS range that is not open is still ours to reject */
+#define DESC_OR_EBADF(d, fd, want_dir)                                                \
+    (((d) = kora_fd_entry(fd)) != NULL &&                                             \
+     atomic_load_explicit(&(d)->owner, memory_order_acquire) != NULL &&               \
+     ((d)->flags & KORA_FD_DIR) == ((want_dir) ? KORA_FD_DIR : 0u))
+
+static int path_open(const char *path, int flags, int *ret) {
+    const char *rest;
+    kora_vfs_t *fs = route(path, &rest);
+    void *file;
+
+    if (fs == NULL) {
+        return 0;
+    }
+    if (IS_HOST(fs)) {
+        int change = flags & (KORA_O_WRONLY | KORA_O_CREAT | KORA_O_TRUNC);
+        ON_HOST(fs, rest, change, result_errno, SYS_OPEN, KORA_BACKEND(open, (host, flags)));
+    }
+    int r = fs->ops->open(fs, rest, flags, &file);
+    if (r == 0) {
+        r = desc_alloc(fs, file, 0);
+        if (r < 0) {
+            fs->ops->close(fs, file);
+        }
+    }
+    return result_errno(SYS_OPEN, r, ret);
+}
+
+int kora_vfs_close(int fd, int *ret) {
+    kora_fd_entry_t *d;
+    if (fd < KORA_VFS_FD_BASE) {
+        return 0;
+    }
+    if (!DESC_OR_EBADF(d, fd, 0)) {
+        return result_errno(SYS_CLOSE, -EBADF, ret);
+    }
+    kora_vfs_t *fs = DESC_FS(d);
+    void *file = KORA_FD_HANDLE(d);
+    kora_fd_free(fd);
+    int r = fs->ops->close(fs, file);
+    desc_release(fs);
+    return result_errno(SYS_CLOSE, r, ret);
+}
+
+int kora_vfs_read(int fd, void *buf, size_t count, int *ret) {
+    kora_fd_entry_t *d;
+    if (fd < KORA_VFS_FD_BASE) {
+        return 0;
+    }
+    if (!DESC_OR_EBADF(d, fd, 0)) {
+        return result_errno(SYS_READ, -EBADF, ret);
+    }
+    kora_vfs_t *fs = DESC_FS(d);
+    long r = fs->ops->read(fs, KORA_FD_HANDLE(d), buf, count > INT32_MAX ? INT32_MAX : count);
+    if (r == 0) {
+        *ret = KORA_EOF;
+        return 1;
+    }
+    return result_errno(SYS_READ, (int)r, ret);
+}
+
+int kora_vfs_write(int fd, const void *buf, size_t count, int *ret) {
+    kora_fd_entry_t *d;
+    if (fd < KORA_VFS_FD_BASE) {
+        return 0;
+    }
+    if (!DESC_OR_EBADF(d, fd, 0)) {
+        return result_errno(SYS_WRITE, -EBADF, ret);
+    }
+    kora_vfs_t *fs = DESC_FS(d);
+    long r = fs->ops->write(fs, KORA_FD_HANDLE(d), buf, count > INT32_MAX ? INT32_MAX : count);
+    return result_errno(SYS_WRITE, (int)r, ret);
+}
+
+int kora_vfs_seek(int fd, long offset, int whence, long *ret) {
+    kora_fd_entry_t *d;
+    if (fd < KORA_VFS_FD_BASE) {
+        return 0;
+    }
+    long r = -EBADF;
+    if (DESC_OR_EBADF(d, fd, 0)) {
+        kora_vfs_t *fs = DESC_FS(d);
+        r = fs->ops->seek(fs, KORA_FD_HANDLE(d), offset, whence);
+    }
+    if (r < 0) {
+        kora_record_error(SYS_SEEK, (int)-r);
+        errno = (int)-r;
+        r = KORA_ERROR;
+    }
+    *ret = r;
+    return 1;
+}
+
+/* Memory needs no access-pattern hints; only the descriptor is checked */
+int kora_vfs_fadvise(int fd, int *ret) {
+    kora_fd_entry_t *d;
+    if (fd < KORA_VFS_FD_BASE) {
+        return 0;
+    }
+    return result_neg(SYS_FADVISE, DESC_OR_EBADF(d, fd, 0) ? 0 : -EBADF, ret);
+}
+
+int kora_vfs_readahead(int fd, int *ret) {
+    kora_fd_entry_t *d;
+    if (fd < KORA_VFS_FD_BASE) {
+        return 0;
+    }
+    return result_neg(SYS_READAHEAD, DESC_OR_EBADF(d, fd, 0) ? 0 : -EBADF, ret);
+}
+
+int kora_vfs_ioctl(int fd, int *ret) {
+    kora_fd_entry_t *d;
+    if (fd < KORA_VFS_FD_BASE) {
+        return 0;
+    }
+    return result_errno(SYS_IOCTL, DESC_OR_EBADF(d, fd, 0) ? -ENOTTY : -EBADF, ret);
+}
+
+static int path_mkdir(const char *path, int *ret) {
+    const char *rest;
+    kora_vfs_t *fs = route(path, &rest);
+    kora_stat_t st;
+
+    if (fs == NULL) {
+        return 0;
+    }
+    if (IS_HOST(fs)) {
+        ON_HOST(fs, rest, 1, result_errno, SYS_MKDIR, KORA_BACKEND(mkdir, (host)));
+    }
+    int r = fs->ops->mkdir(fs, rest);
+    /* As on the host backends, an existing directory is success */
+    if (r == -EEXIST && fs->ops->stat(fs, rest, &st) == 0 && S_ISDIR(st.mode)) {
+        r = 0;
+    }
+    return result_errno(SYS_MKDIR, r, ret);
+}
+
+static int path_rmdir(const char *path, int *ret) {
+    const char *rest;
+    kora_vfs_t *fs = route(path, &rest);
+    if (fs == NULL) {
+        return 0;
+    }
+    if (IS_HOST(fs)) {
+        ON_HOST(fs, rest, 1, result_errno, SYS_RMDIR, KORA_BACKEND(rmdir, (host)));
+    }
+    return result_errno(SYS_RMDIR, fs->ops->rmdir(fs, rest), ret);
+}
+
+static int path_opendir(const char *path, int *ret) {
+    const char *rest;
+    kora_vfs_t *fs = route(path, &rest);
+    void *dir;
+
+    if (fs == NULL) {
+        return 0;
+    }
+    if (IS_HOST(fs)) {
+        ON_HOST(fs, rest, 0, result_errno, SYS_OPENDIR, KORA_BACKEND(opendir, (host)));
+    }
+    int r = fs->ops->opendir(fs, rest, &dir);
+    if (r == 0) {
+        r = desc_alloc(fs, dir, 1);
+        if (r < 0) {
+            fs->ops->closedir(fs, dir);
+        }
+    }
+    return result_errno(SYS_OPENDIR, r, ret);
+}
+
+int kora_vfs_readdir(int dir, kora_dirent_t *entry, int *ret) {
+    kora_fd_entry_t *d;
+    if (dir < KORA_VFS_FD_BASE) {
+        return 0;
+    }
+    if (entry == NULL || !DESC_OR_EBADF(d, dir, 1)) {
+        return result_errno(SYS_READDIR, -EBADF, ret);
+    }
+    kora_vfs_t *fs = DESC_FS(d);
+    return result_errno(SYS_READDIR, fs->ops->readdir(fs, KORA_FD_HANDLE(d), entry), ret);
+}
+
+int kora_vfs_closedir(int dir, int *ret) {
+    kora_fd_entry_t *d;
+    if (dir < KORA_VFS_FD_BASE) {
+        return 0;
+    }
+    if (!DESC_OR_EBADF(d, dir, 1)) {
+        return result_errno(SYS_CLOSEDIR, -EBADF, ret);
+    }
+    kora_vfs_t *fs = DESC_FS(d);
+    void *handle = KORA_FD_HANDLE(d);
+    kora_fd_free(dir);
+    int r = fs->ops->closedir(fs, handle);
+    desc_release(fs);
+    return result_errno(SYS_CLOSEDIR, r, ret);
+}
+
+static int path_symlink(const char *target, const char *linkpath, int *ret) {
+    const char *rest;
+    kora_vfs_t *fs = route(linkpath, &rest);
+    if (fs == NULL) {
+        return 0;
+    }
+    if (IS_HOST(fs)) {
+        ON_HOST(fs, rest, 1, result_errno, SYS_SYMLINK, KORA_BACKEND(symlink, (target, host)));
+    }
+    return result_errno(SYS_SYMLINK, target != NULL ? fs->ops->symlink(fs, target, rest) : -EINVAL,
+                        ret);
+}
+
+static int path_readlink(const char *path, char *buf, size_t size, int *ret) {
+    const char *rest;
+    kora_vfs_t *fs = route(path, &rest);
+    if (fs == NULL) {
+        return 0;
+    }
+    if (buf == NULL || size == 0) {
+        return result_errno(SYS_READLINK, -EINVAL, ret);
+    }
+    if (IS_HOST(fs)) {
+        ON_HOST(fs, rest, 0, result_errno, SYS_READLINK, KORA_BACKEND(readlink, (host, buf, size)));
+    }
+    /* Like the host backends, leave room for and add a terminating NUL */
+    int r = fs->ops->readlink(fs, rest, buf, size - 1);
+    if (r >= 0) {
+        buf[r] = '\0';
+    }
+    return result_errno(SYS_READLINK, r, ret);
+}
+
+static int path_get_file_info(const char *path, kora_file_info_t *info, int *ret) {
+    const char *rest;
+    kora_vfs_t *fs = route(path, &rest);
+    if (fs == NULL) {
+        return 0;
+    }
+    if (IS_HOST(fs)) {
+        ON_HOST(fs, rest, 0, result_neg, SYS_GET_FILE_INFO,
+                KORA_BACKEND(get_file_info, (host, info)));
+    }
+    if (info == NULL) {
+        *ret = -EINVAL;
+        return 1;
+    }
+    return result_neg(SYS_GET_FILE_INFO, fs->ops->get_info(fs, rest, info), ret);
+}
+
+int kora_vfs_get_fd_info(int fd, kora_file_info_t *info, int *ret) {
+    kora_fd_entry_t *d;
+    if (fd < KORA_VFS_FD_BASE) {
+        return 0;
+    }
+    if (info == NULL) {
+        *ret = -EINVAL;
+        return 1;
+    }
+    if (!DESC_OR_EBADF(d, fd, 0)) {
+        return result_neg(SYS_GET_FD_INFO, -EBADF, ret);
+    }
+    kora_vfs_t *fs = DESC_FS(d);
+    return result_neg(SYS_GET_FD_INFO, fs->ops->fget_info(fs, KORA_FD_HANDLE(d), info), ret);
+}
+
+static int path_stat(const char *path, kora_stat_t *st, int *ret) {
+    const char *rest;
+    kora_vfs_t *fs = route(path, &rest);
+    if (fs == NULL) {
+        return 0;
+    }
+    if (IS_HOST(fs)) {
+        ON_HOST(fs, rest, 0, result_neg, SYS_STAT, KORA_BACKEND(stat, (host, st)));
+    }
+    if (st == NULL) {
+        *ret = -EINVAL;
+        return 1;
+    }
+    return result_neg(SYS_STAT, fs->ops->stat(fs, rest, st), ret);
+}
+
+int kora_vfs_fstat(int fd, kora_stat_t *st, int *ret) {
+    kora_fd_entry_t *d;
+    if (fd < KORA_VFS_FD_BASE) {
+        return 0;
+    }
+    if (st == NULL) {
+        *ret = -EINVAL;
+        return 1;
+    }
+    if (!DESC_OR_EBADF(d, fd, 0)) {
+        return result_neg(SYS_FSTAT, -EBADF, ret);
+    }
+    kora_vfs_t *fs = DESC_FS(d);
+    return result_neg(SYS_FSTAT, fs->ops->fstat(fs, KORA_FD_HANDLE(d), st), ret);
+}
+
+static int path_lstat(const char *path, kora_stat_t *st, int *ret) {
+    const char *rest;
+    kora_vfs_t *fs = route(path, &rest);
+    if (fs == NULL) {
+        return 0;
+    }
+    if (IS_HOST(fs)) {
+        ON_HOST(fs, rest, 0, result_neg, SYS_LSTAT, KORA_BACKEND(lstat, (host, st)));
+    }
+    if (st == NULL) {
+        *ret = -EINVAL;
+        return 1;
+    }
+    return result_neg(SYS_LSTAT, fs->ops->lstat(fs, rest, st), ret);
+}
+
+static int path_exists(const char *path, uint8_t *type, int *ret) {
+    const char *rest;
+    kora_vfs_t *fs = route(path, &rest);
+    kora_stat_t st;
+
+    if (fs == NULL) {
+        return 0;
+    }
+    if (IS_HOST(fs)) {
+        ON_HOST(fs, rest, 0, result_neg, SYS_EXISTS, KORA_BACKEND(exists, (host, type)));
+    }
+    /* lstat, as on the host, so a dangling symlink still exists */
+    int r = fs->ops->lstat(fs, rest, &st);
+    if (r == -ENOENT) {
+        *ret = 0;
+        return 1;
+    }
+    if (r < 0) {
+        return result_neg(SYS_EXISTS, r, ret);
+    }
+    if (type != NULL) {
+        *type = S_ISREG(st.mode) ? KORA_FILE_TYPE_REGULAR :
+                S_ISDIR(st.mode) ? KORA_FILE_TYPE_DIRECTORY :
+                S_ISLNK(st.mode) ? KORA_FILE_TYPE_SYMLINK : KORA_FILE_TYPE_OTHER;
+    }
+    *ret = 1;
+    return 1;
+}
+
+static int path_unlink(const char *path, int *ret) {
+    const char *rest;
+    kora_vfs_t *fs = route(path, &rest);
+    if (fs == NULL) {
+        return 0;
+    }
+    if (IS_HOST(fs)) {
+        ON_HOST(fs, rest, 1, result_neg, SYS_UNLINK, KORA_BACKEND(unlink, (host)));
+    }
+    return result_neg(SYS_UNLINK, fs->ops->unlink(fs, rest), ret);
+}
+
+#define PAIR_HOST 2
+
+/*
+ * Both names must be on the same mounted filesystem, or both on the
+ * host, where a name under a host mount is rewritten into its buffer
+ * and one under no mount is passed on as the caller gave it. Either
+ * way *a and *b are left pointing at the names to use.
+ *
+ * @return 0 when neither is mounted, 1 for a mounted filesystem,
+ *         PAIR_HOST for the host, or a negative errno (EXDEV between them)
+ */
+static int route_pair(const char **a, const char **b, const char *given_a, const char *given_b,
+                      char *host_a, char *host_b, kora_vfs_t **fs) {
+    const char *rest_a, *rest_b;
+    kora_vfs_t *fa = route(*a, &rest_a);
+    kora_vfs_t *fb = route(*b, &rest_b);
+    int r = 0;
+
+    *fs = fa;
+    if (fa == NULL && fb == NULL) {
+        return 0;
+    }
+    if ((fa == NULL || IS_HOST(fa)) && (fb == NULL || IS_HOST(fb))) {
+        *a = given_a;
+        *b = given_b;
+        if (fa != NULL && (r = host_path(fa, rest_a, 1, host_a)) == 0) {
+            *a = host_a;
+        }
+        if (r == 0 && fb != NULL && (r = host_path(fb, rest_b, 1, host_b)) == 0) {
+            *b = host_b;
+        }
+        return r < 0 ? r : PAIR_HOST;
+    }
+    if (fa != fb) {
+        return -EXDEV;
+    }
+    *a = rest_a;
+    *b = rest_b;
+    return 1;
+}
+
+/* given_old and given_new are the caller's names, before lexical_path */
+static int path_rename(const char *oldpath, const char *newpath, const char *given_old,
+                       const char *given_new, int *ret) {
+    char host_old[PATH_MAX], host_new[PATH_MAX];
+    kora_vfs_t *fs;
+    int r = route_pair(&oldpath, &newpath, given_old, given_new, host_old, host_new, &fs);
+    if (r == 0) {
+        return 0;
+    }
+    if (r == PAIR_HOST) {
+        kora_grace_leave();
+        *ret = KORA_BACKEND(rename, (oldpath, newpath));
+        return 1;
+    }
+    return result_neg(SYS_RENAME, r > 0 ? fs->ops->rename(fs, oldpath, newpath) : r, ret);
+}
+
+static int path_link(const char *existing, const char *newpath, const char *given_existing,
+                     const char *given_new, int *ret) {
+    char host_existing[PATH_MAX], host_new[PATH_MAX];
+    kora_vfs_t *fs;
+    int r = route_pair(&existing, &newpath, given_existing, given_new, host_existing, host_new,
+                       &fs);
+    if (r == 0) {
+        return 0;
+    }
+    if (r == PAIR_HOST) {
+        kora_grace_leave();
+        *ret = KORA_BACKEND(link, (existing, newpath));
+        return 1;
+    }
+    return result_neg(SYS_LINK, r > 0 ? fs->ops->link(fs, existing, newpath) : r, ret);
+}
+
+static int path_utime(const char *path, uint64_t mtime, int *ret) {
+    const char *rest;
+    kora_vfs_t *fs = route(path, &rest);
+    if (fs == NULL) {
+        return 0;
+    }
+    if (IS_HOST(fs)) {
+        ON_HOST(fs, rest, 1, result_neg, SYS_UTIME, KORA_BACKEND(utime, (host, mtime)));
+    }
+    return result_neg(SYS_UTIME, fs->ops->utime(fs, rest, mtime), ret);
+}
+
+/*
+ * The path calls, counted while they run
+ */
+
+/*
+ * path with its "." and ".." components resolved and slashes collapsed,
+ * in buf unless there were none; ".." at the root stays there. Routing
+ * the result keeps a name from climbing out of the mount it starts in.
+ * A path left to the host is passed on as given, since there ".."
+ * follows symbolic links.
+ *
+ * @return path, buf, or NULL when path does not fit in PATH_MAX
+ */
+static const char *lexical_path(const char *path, char *buf) {
+    if (path == NULL || path[0] != '/' || strstr(path, "/.") == NULL) {
+        return path;
+    }
+    size_t n = strlen(path);
+    if (n >= PATH_MAX) {
+        return NULL;
+    }
+    size_t o = 0;
+    for (const char *p = path; *p != '\0';) {
+        while (*p == '/') {
+            p++;
+        }
+        size_t len = strcspn(p, "/");
+        if (len == 2 && p[0] == '.' && p[1] == '.') {
+            while (o > 0 && buf[o - 1] != '/') {
+                o--;
+            }
+            o -= o > 0;
+        } else if (len > 0 && !(len == 1 && p[0] == '.')) {
+            buf[o++] = '/';
+            memcpy(buf + o, p, len);
+            o += len;
+        }
+        p += len;
+    }
+    if (o == 0 || path[n - 1] == '/') {
+        buf[o++] = '/';
+    }
+    buf[o] = '\0';
+    return buf;
+}
+
+/* Too long a path is left to the host, which rejects it */
+#define LEXICAL(path, buf)                                \
+    do {                                                  \
+        if (((path) = lexical_path(path, buf)) == NULL) { \
+            return 0;                                     \
+        }                                                 \
+    } while (0)
+
+#define PATH_CALL(call)                       \
+    do {                                      \
+        int path_outer = kora_grace_enter();  \
+        int path_r = (call);                  \
+        kora_grace_exit(path_outer);          \
+        return path_r;                        \
+    } while (0)
+
+int kora_vfs_open(const char *path, int flags, int *ret) {
+    char lexical[PATH_MAX];
+    LEXICAL(path, lexical);
+    PATH_CALL(path_open(path, flags, ret));
+}
+
+int kora_vfs_mkdir(const char *path, int *ret) {
+    char lexical[PATH_MAX];
+    LEXICAL(path, lexical);
+    PATH_CALL(path_mkdir(path, ret));
+}
+
+int kora_vfs_rmdir(const char *path, int *ret) {
+    char lexical[PATH_MAX];
+    LEXICAL(path, lexical);
+    PATH_CALL(path_rmdir(path, ret));
+}
+
+int kora_vfs_opendir(const char *path, int *ret) {
+    char lexical[PATH_MAX];
+    LEXICAL(path, lexical);
+    PATH_CALL(path_opendir(path, ret));
+}
+
+int kora_vfs_symlink(const char *target, const char *linkpath, int *ret) {
+    char lexical[PATH_MAX];
+    LEXICAL(linkpath, lexical);
+    PATH_CALL(path_symlink(target, linkpath, ret));
+}
+
+int kora_vfs_readlink(const char *path, char *buf, size_t size, int *ret) {
+    char lexical[PATH_MAX];
+    LEXICAL(path, lexical);
+    PATH_CALL(path_readlink(path, buf, size, ret));
+}
+
+int kora_vfs_get_file_info(const char *path, kora_file_info_t *info, int *ret) {
+    char lexical[PATH_MAX];
+    LEXICAL(path, lexical);
+    PATH_CALL(path_get_file_info(path, info, ret));
+}
+
+int kora_vfs_stat(const char *path, kora_stat_t *st, int *ret) {
+    char lexical[PATH_MAX];
+    LEXICAL(path, lexical);
+    PATH_CALL(path_stat(path, st, ret));
+}
+
+int kora_vfs_lstat(const char *path, kora_stat_t *st, int *ret) {
+    char lexical[PATH_MAX];
+    LEXICAL(path, lexical);
+    PATH_CALL(path_lstat(path, st, ret));
+}
+
+int kora_vfs_exists(const char *path, uint8_t *type, int *ret) {
+    char lexical[PATH_MAX];
+    LEXICAL(path, lexical);
+    PATH_CALL(path_exists(path, type, ret));
+}
+
+int kora_vfs_unlink(const char *path, int *ret) {
+    char lexical[PATH_MAX];
+    LEXICAL(path, lexical);
+    PATH_CALL(path_unlink(path, ret));
+}
+
+int kora_vfs_rename(const char *oldpath, const char *newpath, int *ret) {
+    char lexical_a[PATH_MAX], lexical_b[PATH_MAX];
+    const char *a = oldpath, *b = newpath;
+    LEXICAL(a, lexical_a);
+    LEXICAL(b, lexical_b);
+    PATH_CALL(path_rename(a, b, oldpath, newpath, ret));
+}
+
+int kora_vfs_link(const char *existing, const char *newpath, int *ret) {
+    char lexical_a[PATH_MAX], lexical_b[PATH_MAX];
+    const char *a = existing, *b = newpath;
+    LEXICAL(a, lexical_a);
+    LEXICAL(b, lexical_b);
+    PATH_CALL(path_link(a, b, existing, newpath, ret));
+}
+
+int kora_vfs_utime(const char *path, uint64_t mtime, int *ret) {
+    char lexical[PATH_MAX];
+    LEXICAL(path, lexical);
+    PATH_CALL(path_utime(path, mtime, ret));
+}
+
+int kora_vfs_sys_mount(const char *src, const char *tgt, const char *type, unsigned flags,
+                       const void *data, int *ret) {
+    static const char *const fat_types[] = { "fat", "vfat", "msdos", "fat12", "fat16", "fat32" };
+    (void)data;
+
+    if (type == NULL) {
+        return 0;
+    }
+    for (size_t i = 0; i < sizeof(fat_types) / sizeof(fat_types[0]); i++) {
+        if (strcmp(type, fat_types[i]) == 0) {
+            *ret = kora_fatfs_mount(src, tgt, flags);
+            if (*ret != KORA_SUCCESS) {
+                kora_record_error(SYS_MOUNT, errno);
+            }
+            return 1;
+        }
+    }
+    if (strcmp(type, "memfs") == 0 || strcmp(type, "tmpfs") == 0) {
+        /* An empty filesystem that refuses changes would stay empty */
+        if (flags & KORA_MOUNT_RDONLY) {
+            return result_errno(SYS_MOUNT, -EINVAL, ret);
+        }
+        *ret = kora_memfs_mount(tgt);
+        if (*ret != KORA_SUCCESS) {
+            kora_record_error(SYS_MOUNT, errno);
+        }
+        return 1;
+    }
+    if (strcmp(type, "host") == 0 || strcmp(type, "bind") == 0) {
+        return result_errno(SYS_MOUNT, kora_vfs_host_mount(src, tgt, flags), ret);
+    }
+    return 0;
+}
+
+int kora_vfs_sys_umount(const char *tgt, int *ret) {
+    return result_errno(SYS_UMOUNT, kora_vfs_unmount(tgt, NULL), ret);
+}
+
+void kora_vfs_sys_exit(void) {
+    if (atomic_load_explicit(&kora_vfs_active, memory_order_relaxed)) {
+        kora_bcache_sync();
+    }
+}
+
+/*
+ * Mounts requested in the environment. Read here rather than in the
+ * backends, which a static link only pulls in when they are referenced.
+ */
+#if defined(__GNUC__)
+__attribute__((constructor))
+static void vfs_init_from_env(void) {
+    const char *spec = getenv("KORA_MEMFS");
+    if (spec == NULL || spec[0] == '\0') {
+        return;
+    }
+    if (strcmp(spec, "1") == 0) {
+        spec = "/";
+    }
+    char *copy = strdup(spec);
+    char *save = NULL;
+    for (char *prefix = copy != NULL ? strtok_r(copy, ":", &save) : NULL; prefix != NULL;
+         prefix = strtok_r(NULL, ":", &save)) {
+        /* Recorded like any failed mount; the layer never prints */
+        if (kora_memfs_mount(prefix) != KORA_SUCCESS) {
+            kora_record_error(SYS_MOUNT, errno);
+        }
+    }
+    free(copy);
+}
+#endif
+
+#else /* KORA_PLATFORM_WINDOWS */
+
+int kora_vfs_mount(const char *prefix, kora_vfs_t *fs) {
+    (void)prefix; (void)fs;
+    return -ENOTSUP;
+}
+
+int kora_vfs_unmount(const char *prefix, const kora_vfs_ops_t *ops) {
+    (void)prefix; (void)ops;
+    return -EINVAL;
+}
+
+int kora_vfs_host_mount(const char *dir, const char *prefix, unsigned flags) {
+    (void)dir; (void)prefix; (void)flags;
+    return -ENOTSUP;
+}
+
+/* Nothing can be mounted, so kora_vfs_active stays clear and no hook is reached */
+int kora_vfs_sys_mount(const char *src, const char *tgt, const char *type, unsigned flags,
+                       const void *data, int *ret) {
+    (void)src; (void)tgt; (void)type; (void)flags; (void)data; (void)ret;
+    return 0;
+}
+
+int kora_vfs_sys_umount(const char *tgt, int *ret) {
+    (void)tgt; (void)ret;
+    return 0;
+}
+
+void kora_vfs_sys_exit(void) {
+}
+
+int kora_vfs_open(const char *path, int flags, int *ret) { (void)path; (void)flags; (void)ret; return 0; }
+int kora_vfs_close(int fd, int *ret) { (void)fd; (void)ret; return 0; }
+int kora_vfs_read(int fd, void *buf, size_t count, int *ret) { (void)fd; (void)buf; (void)count; (void)ret; return 0; }
+int kora_vfs_write(int fd, const void *buf, size_t count, int *ret) { (void)fd; (void)buf; (void)count; (void)ret; return 0; }
+int kora_vfs_seek(int fd, long offset, int whence, long *ret) { (void)fd; (void)offset; (void)whence; (void)ret; return 0; }
+int kora_vfs_fadvise(int fd, int *ret) { (void)fd; (void)ret; return 0; }
+int kora_vfs_readahead(int fd, int *ret) { (void)fd; (void)ret; return 0; }
+int kora_vfs_ioctl(int fd, int *ret) { (void)fd; (void)ret; return 0; }
+int kora_vfs_mkdir(const char *path, int *ret) { (void)path; (void)ret; return 0; }
+int kora_vfs_rmdir(const char *path, int *ret) { (void)path; (void)ret; return 0; }
+int kora_vfs_opendir(const char *path, int *ret) { (void)path; (void)ret; return 0; }
+int kora_vfs_readdir(int dir, kora_dirent_t *entry, int *ret) { (void)dir; (void)entry; (void)ret; return 0; }
+int kora_vfs_closedir(int dir, int *ret) { (void)dir; (void)ret; return 0; }
+int kora_vfs_symlink(const char *target, const char *linkpath, int *ret) { (void)target; (void)linkpath; (void)ret; return 0; }
+int kora_vfs_readlink(const char *path, char *buf, size_t size, int *ret) { (void)path; (void)buf; (void)size; (void)ret; return 0; }
+int kora_vfs_get_file_info(const char *path, kora_file_info_t *info, int *ret) { (void)path; (void)info; (void)ret; return 0; }
+int kora_vfs_get_fd_info(int fd, kora_file_info_t *info, int *ret) { (void)fd; (void)info; (void)ret; return 0; }
+int kora_vfs_stat(const char *path, kora_stat_t *st, int *ret) { (void)path; (void)st; (void)ret; return 0; }
+int kora_vfs_fstat(int fd, kora_stat_t *st, int *ret) { (void)fd; (void)st; (void)ret; return 0; }
+int kora_vfs_lstat(const char *path, kora_stat_t *st, int *ret) { (void)path; (void)st; (void)ret; return 0; }
+int kora_vfs_exists(const char *path, uint8_t *type, int *ret) { (void)path; (void)type; (void)ret; return 0; }
+int kora_vfs_unlink(const char *path, int *ret) { (void)path; (void)ret; return 0; }
+int kora_vfs_rename(const char *oldpath, const char *newpath, int *ret) { (void)oldpath; (void)newpath; (void)ret; return 0; }
+int kora_vfs_link(const char *existing, const char *newpath, int *ret) { (void)existing; (void)newpath; (void)ret; return 0; }
+int kora_vfs_utime(const char *path, uint64_t mtime, int *ret) { (void)path; (void)mtime; (void)ret; return 0; }
+
+#endif
@@ -46,6 +46,18 @@ long windows_sys_seek(int fd, long offset, int whence) {
     return KORA_ERROR;
 }
 
+int windows_sys_fadvise(int fd, uint64_t offset, uint64_t len, int advice) {
+    (void)fd; (void)offset; (void)len; (void)advice;
+    /* TODO: Implement Windows version */
+    return -1;
+}
+
+int windows_sys_readahead(int fd, uint64_t offset, size_t count) {
+    (void)fd; (void)offset; (void)count;
+    /* TODO: Implement Windows version */
+    return -1;
+}
+
 int windows_sys_ioctl(int fd, unsigned long request, void *arg) {
     /* TODO: Implement Windows version */
     return KORA_ERROR;
@@ -81,6 +93,30 @@ int windows_sys_mprotect(void *addr, size_t len, int prot) {
     return -1;
 }
 
+int windows_sys_shm_create(const char *name, uint64_t size, int flags) {
+    (void)name; (void)size; (void)flags;
+    /* TODO: Implement Windows version */
+    return -1;
+}
+
+int windows_sys_shm_open(const char *name, int flags) {
+    (void)name; (void)flags;
+    /* TODO: Implement Windows version */
+    return -1;
+}
+
+int windows_sys_shm_unlink(const char *name) {
+    (void)name;
+    /* TODO: Implement Windows version */
+    return -1;
+}
+
+int windows_sys_shm_seal(int fd, unsigned seals) {
+    (void)fd; (void)seals;
+    /* TODO: Implement Windows version */
+    return -1;
+}
+
 pid_t windows_sys_spawn(const char *path, char *const argv[], char *const envp[]) {
     (void)path; (void)argv; (void)envp;
     /* TODO: Implement Windows version */
@@ -98,6 +134,41 @@ pid_t windows_sys_wait(pid_t pid, int *status, int options) {
     return -1;
 }
 
+pid_t windows_sys_wait4(pid_t pid, int *status, int options, kora_rusage_t *usage) {
+    (void)pid; (void)status; (void)options; (void)usage;
+    /* TODO: Implement Windows version */
+    return -1;
+}
+
+int windows_sys_getrusage(int who, kora_rusage_t *usage) {
+    (void)who; (void)usage;
+    /* TODO: Implement Windows version */
+    return -1;
+}
+
+int windows_sys_thread_create(kora_thread_t *thread, const kora_thread_attr_t *attr,
+                              void *(*entry)(void *), void *arg) {
+    (void)thread; (void)attr; (void)entry; (void)arg;
+    /* TODO: Implement Windows version */
+    return -1;
+}
+
+int windows_sys_thread_join(kora_thread_t thread, void **retval) {
+    (void)thread; (void)retval;
+    /* TODO: Implement Windows version */
+    return -1;
+}
+
+void windows_sys_thread_exit(void *retval) {
+    (void)retval;
+    /* TODO: Implement Windows version */
+}
+
+kora_thread_t windows_sys_thread_self(void) {
+    /* TODO: Implement Windows version */
+    return NULL;
+}
+
 int windows_sys_yield(void) {
     /* TODO: Implement Windows version */
     return -1;
@@ -119,12 +190,90 @@ int windows_sys_setpriority(pid_t pid, int prio) {
     return -1;
 }
 
+pid_t windows_sys_gettid(void) {
+    /* TODO: Implement Windows version */
+    return -1;
+}
+
+int windows_sys_sched_setpolicy(pid_t tid, int policy, int priority) {
+    (void)tid; (void)policy; (void)priority;
+    /* TODO: Implement Windows version */
+    return -1;
+}
+
+int windows_sys_sched_getpolicy(pid_t tid, int *priority) {
+    (void)tid; (void)priority;
+    /* TODO: Implement Windows version */
+    return -1;
+}
+
+int windows_sys_ioprio_set(pid_t tid, int ioclass, int level) {
+    (void)tid; (void)ioclass; (void)level;
+    /* TODO: Implement Windows version */
+    return -1;
+}
+
+int windows_sys_ioprio_get(pid_t tid, int *level) {
+    (void)tid; (void)level;
+    /* TODO: Implement Windows version */
+    return -1;
+}
+
+int windows_sys_sched_setaffinity(pid_t pid, const kora_cpuset_t *set) {
+    (void)pid; (void)set;
+    /* TODO: Implement Windows version */
+    return -1;
+}
+
+int windows_sys_sched_getaffinity(pid_t pid, kora_cpuset_t *set) {
+    (void)pid; (void)set;
+    /* TODO: Implement Windows version */
+    return -1;
+}
+
+int windows_sys_getcpu(unsigned *cpu, unsigned *node) {
+    (void)cpu; (void)node;
+    /* TODO: Implement Windows version */
+    return -1;
+}
+
+int windows_sys_cpu_topology(kora_cpu_topology_t *topo, kora_cpu_info_t *cpus, size_t max) {
+    (void)topo; (void)cpus; (void)max;
+    /* TODO: Implement Windows version */
+    return -1;
+}
+
 int windows_sys_pipe(int fds[2]) {
     (void)fds;
     /* TODO: Implement Windows version */
     return -1;
 }
 
+int windows_sys_pipe2(int fds[2], int flags) {
+    (void)fds; (void)flags;
+    /* TODO: Implement Windows version */
+    return -1;
+}
+
+int windows_sys_pipe_size(int fd, int size) {
+    (void)fd; (void)size;
+    /* TODO: Implement Windows version */
+    return -1;
+}
+
+long windows_sys_splice(int fd_in, int64_t *off_in, int fd_out, int64_t *off_out,
+                        size_t len, unsigned flags) {
+    (void)fd_in; (void)off_in; (void)fd_out; (void)off_out; (void)len; (void)flags;
+    /* TODO: Implement Windows version */
+    return -1;
+}
+
+long windows_sys_tee(int fd_in, int fd_out, size_t len, unsigned flags) {
+    (void)fd_in; (void)fd_out; (void)len; (void)flags;
+    /* TODO: Implement Windows version */
+    return -1;
+}
+
 int windows_sys_dup(int oldfd) {
     (void)oldfd;
     /* TODO: Implement Windows version */
@@ -230,6 +379,26 @@ sighandler_t windows_sys_signal(int signum, sighandler_t handler) {
     return SIG_ERR;
 }
 
+int windows_sys_sigaction(int signum, const struct sigaction *act, struct sigaction *oldact) {
+    (void)signum; (void)act; (void)oldact;
+    return -1;
+}
+
+int windows_sys_sigprocmask(int how, const sigset_t *set, sigset_t *oldset) {
+    (void)how; (void)set; (void)oldset;
+    return -1;
+}
+
+int windows_sys_signalfd(const sigset_t *mask, int flags) {
+    (void)mask; (void)flags;
+    return -1;
+}
+
+int windows_sys_signalfd_read(int fd, kora_siginfo_t *info, size_t max) {
+    (void)fd; (void)info; (void)max;
+    return -1;
+}
+
 int windows_sys_kill(pid_t pid, int signum) {
     (void)pid; (void)signum;
     return -1;
@@ -256,4 +425,10 @@ int windows_sys_mount(const char *src, const char *tgt, const char *type,
     /* TODO: Implement Windows version */
     return -1;
 }
+
+int windows_sys_umount(const char *tgt) {
+    (void)tgt;
+    /* TODO: Implement Windows version */
+    return -1;
+}
 #endif
@@ -0,0 +1,149 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <kora/backend.h>
+#include <kora/syscalls.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MNT "/kora-backend-test"
+
+static const kora_backend_ops_t *counting_next;
+static int opens;
+static char last_path[128];
+
+static int count_open(const char *path, int flags) {
+    opens++;
+    snprintf(last_path, sizeof(last_path), "%s", path);
+    return counting_next->open(path, flags);
+}
+
+static const kora_backend_ops_t counting = { .open = count_open };
+
+static pid_t fixed_getpid(void) {
+    return 4242;
+}
+
+static const kora_backend_ops_t fixed = { .getpid = fixed_getpid };
+
+/* Two layers on getpid that record the order they are reached in */
+static const kora_backend_ops_t *outer_next, *inner_next;
+static char order[8];
+
+static pid_t outer_getpid(void) {
+    strcat(order, "o");
+    return outer_next->getpid() + 1;
+}
+
+static pid_t inner_getpid(void) {
+    strcat(order, "i");
+    return inner_next->getpid() * 10;
+}
+
+static const kora_backend_ops_t outer = { .getpid = outer_getpid };
+static const kora_backend_ops_t inner = { .getpid = inner_getpid };
+
+/* Hooks can be compiled out with -DKORA_BACKEND_HOOKS=OFF */
+static void push_or_skip(const kora_backend_ops_t *ops, const kora_backend_ops_t **next) {
+    if (kora_backend_push(ops, next) != KORA_SUCCESS) {
+        assert_int_equal(errno, ENOTSUP);
+        skip();
+    }
+}
+
+static void test_backend_interpose(void **state) {
+    const kora_backend_ops_t *next;
+    (void)state;
+
+    push_or_skip(&counting, &counting_next);
+    assert_ptr_equal(counting_next, kora_backend_host());
+    int fd = sys_open("/dev/null", KORA_O_RDONLY);
+    assert_true(fd >= 0);
+    assert_int_equal(sys_close(fd), KORA_SUCCESS);
+    assert_int_equal(sys_open("/nonexistent/kora", KORA_O_RDONLY), KORA_ERROR);
+    assert_int_equal(errno, ENOENT);
+    assert_int_equal(opens, 2);
+
+    /* Calls the layer does not replace go straight through */
+    assert_int_equal(sys_getpid(), getpid());
+
+    /* Pushed once only */
+    assert_int_equal(kora_backend_push(&counting, &next), KORA_ERROR);
+    assert_int_equal(errno, EINVAL);
+    assert_int_equal(kora_backend_pop(&counting), KORA_SUCCESS);
+    fd = sys_open("/dev/null", KORA_O_RDONLY);
+    assert_int_equal(sys_close(fd), KORA_SUCCESS);
+    assert_int_equal(opens, 2);
+}
+
+static void test_backend_replace(void **state) {
+    const kora_backend_ops_t *next;
+    (void)state;
+
+    push_or_skip(&fixed, &next);
+    assert_int_equal(sys_getpid(), 4242);
+    assert_int_equal(kora_backend_pop(&fixed), KORA_SUCCESS);
+    assert_int_equal(sys_getpid(), getpid());
+}
+
+static void test_backend_stack(void **state) {
+    (void)state;
+
+    /* The last layer pushed sees the call first */
+    push_or_skip(&inner, &inner_next);
+    assert_int_equal(kora_backend_push(&outer, &outer_next), KORA_SUCCESS);
+    assert_int_equal(sys_getpid(), getpid() * 10 + 1);
+    assert_string_equal(order, "oi");
+
+    /* Only the top layer can be popped */
+    assert_int_equal(kora_backend_pop(&inner), KORA_ERROR);
+    assert_int_equal(errno, EBUSY);
+    assert_int_equal(kora_backend_pop(&fixed), KORA_ERROR);
+    assert_int_equal(errno, EINVAL);
+    assert_int_equal(kora_backend_pop(&outer), KORA_SUCCESS);
+    order[0] = '\0';
+    assert_int_equal(sys_getpid(), getpid() * 10);
+    assert_string_equal(order, "i");
+    assert_int_equal(kora_backend_pop(&inner), KORA_SUCCESS);
+    assert_int_equal(kora_backend_pop(&inner), KORA_ERROR);
+    assert_int_equal(errno, EINVAL);
+}
+
+static void test_backend_host_mount(void **state) {
+    char dir[64], path[96], real[128];
+    (void)state;
+
+    push_or_skip(&counting, &counting_next);
+    strcpy(dir, "/tmp/kora-backend-XXXXXX");
+    assert_non_null(mkdtemp(dir));
+    assert_non_null(realpath(dir, real));
+    assert_int_equal(sys_mount(dir, MNT, "host", 0, NULL), KORA_SUCCESS);
+
+    /* A layer sees the host path a mount rewrote, not the caller's */
+    opens = 0;
+    int fd = sys_open(MNT "/file", KORA_O_WRONLY | KORA_O_CREAT);
+    assert_true(fd >= 0);
+    assert_int_equal(sys_close(fd), KORA_SUCCESS);
+    assert_int_equal(opens, 1);
+    snprintf(path, sizeof(path), "%.63s/file", real);
+    assert_string_equal(last_path, path);
+    assert_int_equal(kora_backend_pop(&counting), KORA_SUCCESS);
+
+    assert_int_equal(sys_umount(MNT), KORA_SUCCESS);
+    assert_int_equal(unlink(path), 0);
+    assert_int_equal(rmdir(dir), 0);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_backend_interpose),
+        cmocka_unit_test(test_backend_replace),
+        cmocka_unit_test(test_backend_stack),
+        cmocka_unit_test(test_backend_host_mount),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,317 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <kora/syscalls.h>
+#include <kora/bcache.h>
+#include <kora/fatfs.h>
+#include <errno.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MNT "/kora-bcache-test"
+
+/* FAT16, 16 MiB, 2 KiB clusters */
+#define TOTAL_SECTORS 32768
+#define FAT_SECTORS   32
+#define ROOT_ENTRIES  512
+#define CLUSTER_SIZE  2048
+#define DATA_OFFSET   ((1 + 2 * FAT_SECTORS + ROOT_ENTRIES * 32 / 512) * 512)
+
+static char image_path[64];
+
+static void format_image(void) {
+    uint8_t sector[512] = {0};
+
+    snprintf(image_path, sizeof(image_path), "/tmp/kora-bcache-%d.img", (int)getpid());
+    int fd = open(image_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    assert_true(fd >= 0);
+    assert_int_equal(ftruncate(fd, (off_t)TOTAL_SECTORS * 512), 0);
+    memcpy(sector, "\xEB\x3C\x90KORATEST\x00\x02\x04\x01\x00\x02\x00\x02\x00\x80\xF8\x20\x00", 24);
+    sector[510] = 0x55;
+    sector[511] = 0xAA;
+    assert_int_equal(pwrite(fd, sector, 512, 0), 512);
+    memset(sector, 0, sizeof(sector));
+    memcpy(sector, "\xF8\xFF\xFF\xFF", 4);
+    assert_int_equal(pwrite(fd, sector, 512, 512), 512);
+    assert_int_equal(pwrite(fd, sector, 512, (1 + FAT_SECTORS) * 512), 512);
+    close(fd);
+    assert_int_equal(sys_mount(image_path, MNT, "vfat", 0, NULL), KORA_SUCCESS);
+}
+
+static int setup(void **state) {
+    (void)state;
+    format_image();
+    return 0;
+}
+
+static int teardown(void **state) {
+    (void)state;
+    kora_fatfs_unmount(MNT);
+    kora_bcache_set_capacity(64 << 20);
+    unlink(image_path);
+    return 0;
+}
+
+static char *pattern(size_t size, int seed) {
+    char *data = malloc(size);
+    assert_non_null(data);
+    for (size_t i = 0; i < size; i++) {
+        data[i] = (char)(i * 31 + i / 4096 + (size_t)seed);
+    }
+    return data;
+}
+
+static void write_file(const char *path, const char *data, size_t size) {
+    int fd = sys_open(path, KORA_O_WRONLY | KORA_O_CREAT | KORA_O_TRUNC);
+    assert_true(fd >= 0);
+    assert_int_equal(sys_write(fd, data, size), (int)size);
+    assert_int_equal(sys_close(fd), KORA_SUCCESS);
+}
+
+/* Read a file in chunk-sized pieces and compare it */
+static void check_file(const char *path, const char *data, size_t size, size_t chunk) {
+    char *buf = malloc(chunk);
+    assert_non_null(buf);
+    int fd = sys_open(path, KORA_O_RDONLY);
+    assert_true(fd >= 0);
+    for (size_t off = 0; off < size; off += chunk) {
+        size_t n = size - off < chunk ? size - off : chunk;
+        assert_int_equal(sys_read(fd, buf, chunk), (int)n);
+        assert_memory_equal(buf, data + off, n);
+    }
+    assert_int_equal(sys_close(fd), KORA_SUCCESS);
+    free(buf);
+}
+
+static void test_bcache_hits(void **state) {
+    (void)state;
+    kora_bcache_stats_t before, after;
+    char *data = pattern(64 * 1024, 1);
+
+    write_file(MNT "/hot", data, 64 * 1024);
+    check_file(MNT "/hot", data, 64 * 1024, 4096);
+    kora_bcache_stats(&before);
+    check_file(MNT "/hot", data, 64 * 1024, 4096);
+    kora_bcache_stats(&after);
+    assert_int_equal(after.misses, before.misses);
+    assert_true(after.hits >= before.hits + 16);
+    assert_int_equal(after.reads, before.reads);
+    assert_true(after.cached >= 16);
+    assert_int_equal(after.capacity, (64 << 20) / KORA_BCACHE_BLOCK_SIZE);
+    free(data);
+}
+
+static void test_bcache_readahead(void **state) {
+    (void)state;
+    const size_t size = 1 << 20;
+    kora_bcache_stats_t before, after;
+    char *data = pattern(size, 2);
+
+    /* Remounting drops the image's blocks, so every read starts cold */
+    write_file(MNT "/stream", data, size);
+    assert_int_equal(kora_fatfs_unmount(MNT), KORA_SUCCESS);
+    assert_int_equal(sys_mount(image_path, MNT, "vfat", KORA_MOUNT_RDONLY, NULL), KORA_SUCCESS);
+
+    kora_bcache_stats(&before);
+    check_file(MNT "/stream", data, size, 4096);
+    kora_bcache_stats(&after);
+    assert_true(after.readahead - before.readahead >= 128);
+    assert_true(after.readahead_hits - before.readahead_hits >= 128);
+    assert_true(after.reads - before.reads <= 32);  /* Not one per 4 KiB read */
+    free(data);
+}
+
+static void test_bcache_writeback(void **state) {
+    (void)state;
+    const size_t size = 512 * 1024;
+    kora_bcache_stats_t before, after;
+    kora_file_info_t info;
+    char *data = pattern(size, 3);
+    char *disk = malloc(size);
+    assert_non_null(disk);
+
+    kora_bcache_stats(&before);
+    write_file(MNT "/out", data, size);
+    assert_int_equal(kora_bcache_sync(), KORA_SUCCESS);
+    kora_bcache_stats(&after);
+    assert_int_equal(after.dirty, 0);
+    assert_true(after.writeback_blocks - before.writeback_blocks >= size / KORA_BCACHE_BLOCK_SIZE);
+    /* Adjacent blocks were merged into a few large writes */
+    assert_true(after.writes - before.writes <= 16);
+
+    /* The image file holds the data while still mounted */
+    assert_int_equal(sys_get_file_info(MNT "/out", &info), 0);
+    int fd = open(image_path, O_RDONLY);
+    assert_true(fd >= 0);
+    off_t off = DATA_OFFSET + (off_t)(info.starting_cluster - 2) * CLUSTER_SIZE;
+    assert_int_equal(pread(fd, disk, size, off), (ssize_t)size);
+    assert_memory_equal(disk, data, size);
+
+    /* Without a sync, the writeback thread gets there on its own */
+    int file = sys_open(MNT "/out", KORA_O_WRONLY);
+    assert_true(file >= 0);
+    assert_int_equal(sys_write(file, data + 1, 4096), 4096);
+    assert_int_equal(sys_close(file), KORA_SUCCESS);
+    for (int i = 0; i < 200; i++) {
+        kora_bcache_stats(&after);
+        if (after.dirty == 0) {
+            break;
+        }
+        struct timespec ts = { 0, 10 * 1000 * 1000 };
+        nanosleep(&ts, NULL);
+    }
+    assert_int_equal(after.dirty, 0);
+    assert_int_equal(pread(fd, disk, 4096, off), 4096);
+    assert_memory_equal(disk, data + 1, 4096);
+    close(fd);
+    free(disk);
+    free(data);
+}
+
+static void test_bcache_scan(void **state) {
+    (void)state;
+    const size_t scan = 2 << 20, hot = 32 * 1024;
+    kora_bcache_stats_t before, after;
+    char *big = pattern(scan, 4);
+    char *small = pattern(hot, 5);
+
+    write_file(MNT "/hot", small, hot);
+    write_file(MNT "/scan", big, scan);
+    assert_int_equal(kora_fatfs_unmount(MNT), KORA_SUCCESS);
+    assert_int_equal(kora_bcache_set_capacity(0), KORA_SUCCESS);  /* The minimum */
+    assert_int_equal(sys_mount(image_path, MNT, "vfat", 0, NULL), KORA_SUCCESS);
+    kora_bcache_stats(&after);
+    assert_int_equal(after.capacity, 64);
+    assert_true(after.cached <= 64);
+
+    /* Used twice, the hot file outlives a pass over a file much larger than the cache */
+    check_file(MNT "/hot", small, hot, 4096);
+    check_file(MNT "/hot", small, hot, 4096);
+    check_file(MNT "/scan", big, scan, 8192);
+    kora_bcache_stats(&before);
+    check_file(MNT "/hot", small, hot, 4096);
+    kora_bcache_stats(&after);
+    assert_int_equal(after.misses, before.misses);
+    assert_true(after.evictions > 0);
+
+    /* Writes larger than the cache evict dirty blocks and still land */
+    write_file(MNT "/scan", small, hot);
+    write_file(MNT "/big", big, scan);
+    assert_int_equal(kora_fatfs_unmount(MNT), KORA_SUCCESS);
+    kora_bcache_stats(&after);
+    assert_true(after.dirty_evictions > 0);
+    assert_int_equal(sys_mount(image_path, MNT, "vfat", 0, NULL), KORA_SUCCESS);
+    check_file(MNT "/big", big, scan, 65536);
+    check_file(MNT "/scan", small, hot, 65536);
+    free(big);
+    free(small);
+}
+
+static void test_bcache_fork(void **state) {
+    (void)state;
+    const size_t size = 64 * 1024;
+    kora_file_info_t info;
+    char *old = pattern(size, 6);
+    char *data = pattern(size, 7);
+    char *disk = malloc(size);
+    int go[2];
+    int status;
+    assert_non_null(disk);
+    assert_int_equal(pipe(go), 0);
+
+    /* The child inherits these blocks still dirty, and exits after the next write */
+    write_file(MNT "/out", old, size);
+    pid_t pid = fork();
+    assert_true(pid >= 0);
+    if (pid == 0) {
+        char c;
+        close(go[1]);
+        exit(read(go[0], &c, 1) == 1 ? 0 : 1);
+    }
+    close(go[0]);
+    write_file(MNT "/out", data, size);
+    assert_int_equal(kora_bcache_sync(), KORA_SUCCESS);
+    assert_int_equal(write(go[1], "x", 1), 1);
+    close(go[1]);
+    assert_int_equal(waitpid(pid, &status, 0), pid);
+    assert_true(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    /* The child's exit did not write its stale copy over the parent's data */
+    assert_int_equal(sys_get_file_info(MNT "/out", &info), 0);
+    int fd = open(image_path, O_RDONLY);
+    assert_true(fd >= 0);
+    off_t off = DATA_OFFSET + (off_t)(info.starting_cluster - 2) * CLUSTER_SIZE;
+    assert_int_equal(pread(fd, disk, size, off), (ssize_t)size);
+    assert_memory_equal(disk, data, size);
+    close(fd);
+    free(disk);
+    free(data);
+    free(old);
+}
+
+static atomic_int forking;
+
+static void *write_while_forking(void *arg) {
+    const char *data = arg;
+    while (atomic_load(&forking)) {
+        int fd = sys_open(MNT "/busy", KORA_O_WRONLY | KORA_O_CREAT | KORA_O_TRUNC);
+        if (fd >= 0) {
+            sys_write(fd, data, 64 * 1024);
+            sys_close(fd);
+        }
+    }
+    return NULL;
+}
+
+static void test_bcache_fork_busy(void **state) {
+    (void)state;
+    char *data = pattern(64 * 1024, 8);
+    kora_thread_t writer;
+    int status;
+
+    /* Forks land while another thread holds the cache's locks; children see whole tables */
+    atomic_store(&forking, 1);
+    assert_int_equal(sys_thread_create(&writer, NULL, write_while_forking, data), 0);
+    for (int i = 0; i < 20; i++) {
+        pid_t pid = fork();
+        assert_true(pid >= 0);
+        if (pid == 0) {
+            _exit(kora_bcache_sync() == KORA_SUCCESS ? 0 : 1);
+        }
+        /* A child stuck on a lock or a torn list is killed after ten seconds */
+        struct timespec tick = { 0, 1000000 };
+        int waited = 0;
+        while (waitpid(pid, &status, WNOHANG) == 0 && waited++ < 10000) {
+            nanosleep(&tick, NULL);
+        }
+        if (waited > 10000) {
+            kill(pid, SIGKILL);
+            waitpid(pid, &status, 0);
+        }
+        assert_true(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        sys_yield();
+    }
+    atomic_store(&forking, 0);
+    assert_int_equal(sys_thread_join(writer, NULL), 0);
+    free(data);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_bcache_hits, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_bcache_readahead, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_bcache_writeback, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_bcache_scan, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_bcache_fork, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_bcache_fork_busy, setup, teardown),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,174 @@
+/**
+ * Shared-memory channel test for KoraLayer using CMocka
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <kora/syscalls.h>
+#include <kora/channel.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+
+#define MESSAGES 20000
+
+/* Map a shared block holding a fresh channel */
+static kora_channel_t *make_channel(uint32_t capacity, uint32_t msg_size, int mode,
+                                    size_t *size_out) {
+    size_t size = kora_channel_footprint(capacity, msg_size);
+    int fd = sys_shm_create(NULL, size, KORA_SHM_CLOEXEC);
+    if (fd < 0) {
+        return NULL;
+    }
+    void *mem = sys_mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    sys_close(fd);
+    if (mem == (void *)-1) {
+        return NULL;
+    }
+    *size_out = size;
+    return kora_channel_init(mem, size, capacity, msg_size, mode);
+}
+
+static void test_channel_basic(void **state) {
+    (void)state;
+    size_t size = 0;
+    kora_channel_t *ch = make_channel(4, 32, KORA_CHANNEL_SPSC, &size);
+    assert_non_null(ch);
+    assert_ptr_equal(kora_channel_attach(ch), ch);
+
+    assert_int_equal(kora_channel_send(ch, "hello", 5, 0), KORA_SUCCESS);
+    char buf[32];
+    assert_int_equal(kora_channel_recv(ch, buf, sizeof(buf), 0), 5);
+    assert_memory_equal(buf, "hello", 5);
+
+    /* Empty and full report EAGAIN without blocking */
+    assert_int_equal(kora_channel_recv(ch, buf, sizeof(buf), 0), KORA_ERROR);
+    assert_int_equal(errno, EAGAIN);
+    for (int i = 0; i < 4; i++) {
+        assert_int_equal(kora_channel_send(ch, &i, sizeof(i), 0), KORA_SUCCESS);
+    }
+    assert_int_equal(kora_channel_send(ch, "x", 1, 0), KORA_ERROR);
+    assert_int_equal(errno, EAGAIN);
+    assert_int_equal(kora_channel_send(ch, "x", 1, 10), KORA_ERROR);
+    assert_int_equal(errno, ETIMEDOUT);
+
+    char big[64] = {0};
+    assert_int_equal(kora_channel_send(ch, big, sizeof(big), 0), KORA_ERROR);
+    assert_int_equal(errno, EMSGSIZE);
+
+    sys_munmap(ch, size);
+}
+
+static void test_channel_batch_and_close(void **state) {
+    (void)state;
+    size_t size = 0;
+    kora_channel_t *ch = make_channel(8, sizeof(int), KORA_CHANNEL_MPMC, &size);
+    assert_non_null(ch);
+
+    int in[12], out[12];
+    uint32_t lens[12];
+    for (int i = 0; i < 12; i++) {
+        in[i] = i * 7;
+    }
+
+    /* Only the free slots are filled */
+    assert_int_equal(kora_channel_send_batch(ch, in, 12, 0), 8);
+    assert_int_equal(kora_channel_recv_batch(ch, out, lens, 12, 0), 8);
+    assert_memory_equal(out, in, 8 * sizeof(int));
+    assert_int_equal(lens[7], sizeof(int));
+
+    assert_int_equal(kora_channel_send_batch(ch, in + 8, 4, 0), 4);
+    kora_channel_close(ch);
+    assert_int_equal(kora_channel_send(ch, in, sizeof(int), 0), KORA_ERROR);
+    assert_int_equal(errno, EPIPE);
+
+    /* Queued messages survive close, then EOF */
+    assert_int_equal(kora_channel_recv_batch(ch, out, NULL, 12, -1), 4);
+    assert_int_equal(out[3], in[11]);
+    assert_int_equal(kora_channel_recv(ch, out, sizeof(int), -1), KORA_EOF);
+
+    sys_munmap(ch, size);
+}
+
+static void test_channel_cross_process_spsc(void **state) {
+    (void)state;
+    size_t size = 0;
+    kora_channel_t *ch = make_channel(64, sizeof(uint64_t), KORA_CHANNEL_SPSC, &size);
+    assert_non_null(ch);
+
+    pid_t pid = fork();
+    assert_true(pid >= 0);
+    if (pid == 0) {
+        kora_channel_t *child = kora_channel_attach(ch);
+        for (uint64_t i = 0; i < MESSAGES; i++) {
+            if (kora_channel_send(child, &i, sizeof(i), -1) != KORA_SUCCESS) {
+                sys_exit(1);
+            }
+        }
+        kora_channel_close(child);
+        sys_exit(0);
+    }
+
+    uint64_t expect = 0, v;
+    int n;
+    while ((n = kora_channel_recv(ch, &v, sizeof(v), -1)) != KORA_EOF) {
+        assert_int_equal(n, sizeof(v));
+        assert_int_equal(v, expect);
+        expect++;
+    }
+    assert_int_equal(expect, MESSAGES);
+
+    int status = 0;
+    assert_int_equal(sys_wait(pid, &status, 0), pid);
+    assert_int_equal(WEXITSTATUS(status), 0);
+    sys_munmap(ch, size);
+}
+
+static void test_channel_cross_process_mpmc(void **state) {
+    (void)state;
+    size_t size = 0;
+    kora_channel_t *ch = make_channel(16, sizeof(uint64_t), KORA_CHANNEL_MPMC, &size);
+    assert_non_null(ch);
+
+    pid_t pids[3];
+    for (int p = 0; p < 3; p++) {
+        pids[p] = fork();
+        assert_true(pids[p] >= 0);
+        if (pids[p] == 0) {
+            for (uint64_t i = 1; i <= MESSAGES; i++) {
+                if (kora_channel_send(ch, &i, sizeof(i), -1) != KORA_SUCCESS) {
+                    sys_exit(1);
+                }
+            }
+            sys_exit(0);
+        }
+    }
+
+    uint64_t sum = 0, v;
+    for (int i = 0; i < 3 * MESSAGES; i++) {
+        assert_int_equal(kora_channel_recv(ch, &v, sizeof(v), 5000), sizeof(v));
+        sum += v;
+    }
+    assert_int_equal(sum, 3ull * MESSAGES * (MESSAGES + 1) / 2);
+
+    for (int p = 0; p < 3; p++) {
+        int status = 0;
+        assert_int_equal(sys_wait(pids[p], &status, 0), pids[p]);
+        assert_int_equal(WEXITSTATUS(status), 0);
+    }
+    sys_munmap(ch, size);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_channel_basic),
+        cmocka_unit_test(test_channel_batch_and_close),
+        cmocka_unit_test(test_channel_cross_process_spsc),
+        cmocka_unit_test(test_channel_cross_process_mpmc),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,129 @@
+/**
+ * Error reporting test for KoraLayer using CMocka
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <kora/syscalls.h>
+#include <kora/error.h>
+#include <errno.h>
+
+#define MISSING_DIR "/tmp/kora_test_error_missing/child"
+
+static int setup(void **state) {
+    (void)state;
+    kora_diag_record_t scratch[64];
+    kora_set_diag_sink(NULL, NULL);
+    while (kora_diag_drain(scratch, 64) > 0) { }
+    kora_clear_error();
+    return 0;
+}
+
+static int teardown(void **state) {
+    (void)state;
+    kora_set_diag_sink(NULL, NULL);
+    return 0;
+}
+
+static void test_last_error_records_failure(void **state) {
+    (void)state;
+    assert_int_equal(kora_last_error().syscall, 0);
+
+    assert_int_equal(sys_opendir(MISSING_DIR), KORA_ERROR);
+    kora_error_t err = kora_last_error();
+    assert_int_equal(err.syscall, SYS_OPENDIR);
+    assert_int_equal(err.host_errno, ENOENT);
+
+    assert_int_equal(sys_mkdir(MISSING_DIR), KORA_ERROR);
+    assert_int_equal(kora_last_error().syscall, SYS_MKDIR);
+
+    kora_clear_error();
+    assert_int_equal(kora_last_error().syscall, 0);
+}
+
+static void test_invalid_dir_handle(void **state) {
+    (void)state;
+    kora_dirent_t entry;
+    assert_int_equal(sys_readdir(-1, &entry), KORA_ERROR);
+    assert_int_equal(kora_last_error().syscall, SYS_READDIR);
+    assert_int_equal(kora_last_error().host_errno, EBADF);
+
+    assert_int_equal(sys_closedir(-1), KORA_ERROR);
+    assert_int_equal(kora_last_error().syscall, SYS_CLOSEDIR);
+    assert_int_equal(kora_last_error().host_errno, EBADF);
+}
+
+static void test_silent_by_default(void **state) {
+    (void)state;
+    kora_diag_record_t rec;
+    assert_int_equal(sys_opendir(MISSING_DIR), KORA_ERROR);
+    assert_int_equal(kora_diag_drain(&rec, 1), 0);
+}
+
+static void test_ring_sink_drain(void **state) {
+    (void)state;
+    kora_diag_record_t recs[4];
+    kora_set_diag_sink(kora_diag_ring_sink, NULL);
+
+    assert_int_equal(sys_opendir(MISSING_DIR), KORA_ERROR);
+    assert_int_equal(sys_closedir(-1), KORA_ERROR);
+
+    assert_int_equal(kora_diag_drain(recs, 4), 2);
+    assert_int_equal(recs[0].syscall, SYS_OPENDIR);
+    assert_int_equal(recs[0].host_errno, ENOENT);
+    assert_int_equal(recs[1].syscall, SYS_CLOSEDIR);
+    assert_true(recs[0].thread != 0);
+    assert_true(recs[1].timestamp_ns >= recs[0].timestamp_ns);
+    assert_int_equal(kora_diag_drain(recs, 4), 0);
+}
+
+/* Like a sink that logs with stdio */
+static void clobbering_sink(const kora_diag_record_t *rec, void *ctx) {
+    (void)rec;
+    (*(int *)ctx)++;
+    errno = EIO;
+}
+
+static void test_sink_keeps_errno(void **state) {
+    (void)state;
+    int calls = 0;
+    kora_set_diag_sink(clobbering_sink, &calls);
+
+    assert_int_equal(sys_opendir(MISSING_DIR), KORA_ERROR);
+    assert_int_equal(errno, ENOENT);
+    assert_int_equal(sys_closedir(-1), KORA_ERROR);
+    assert_int_equal(errno, EBADF);
+    assert_int_equal(calls, 2);
+}
+
+static void test_ring_overflow_counts_drops(void **state) {
+    (void)state;
+    kora_diag_record_t rec;
+    uint64_t dropped = kora_diag_dropped();
+    kora_set_diag_sink(kora_diag_ring_sink, NULL);
+
+    for (int i = 0; i < KORA_DIAG_RING_SIZE + 10; i++) {
+        sys_closedir(-1);
+    }
+    assert_int_equal(kora_diag_dropped() - dropped, 10);
+
+    size_t drained = 0;
+    while (kora_diag_drain(&rec, 1) == 1) {
+        drained++;
+    }
+    assert_int_equal(drained, KORA_DIAG_RING_SIZE);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_last_error_records_failure, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_invalid_dir_handle, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_silent_by_default, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_ring_sink_drain, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_sink_keeps_errno, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_ring_overflow_counts_drops, setup, teardown),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,91 @@
+/**
+ * Access pattern advice test for KoraLayer using CMocka
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <kora/syscalls.h>
+#include <string.h>
+#include <errno.h>
+
+#define TEST_FILE "/tmp/kora_test_fadvise.dat"
+
+static int setup(void **state) {
+    char block[4096];
+    memset(block, 'k', sizeof(block));
+
+    sys_unlink(TEST_FILE);
+    int fd = sys_open(TEST_FILE, KORA_O_CREAT | KORA_O_RDWR | KORA_O_TRUNC);
+    if (fd < 0) {
+        return -1;
+    }
+    for (int i = 0; i < 16; i++) {
+        if (sys_write(fd, block, sizeof(block)) != (int)sizeof(block)) {
+            sys_close(fd);
+            return -1;
+        }
+    }
+    sys_close(fd);
+
+    *state = NULL;
+    return 0;
+}
+
+static int teardown(void **state) {
+    (void)state;
+    sys_unlink(TEST_FILE);
+    return 0;
+}
+
+static void test_fadvise_all_modes(void **state) {
+    (void)state;
+    int fd = sys_open(TEST_FILE, KORA_O_RDONLY);
+    assert_true(fd >= 0);
+
+    assert_int_equal(sys_fadvise(fd, 0, 0, KORA_FADV_SEQUENTIAL), 0);
+    assert_int_equal(sys_fadvise(fd, 0, 0, KORA_FADV_RANDOM), 0);
+    assert_int_equal(sys_fadvise(fd, 0, 8192, KORA_FADV_WILLNEED), 0);
+    assert_int_equal(sys_fadvise(fd, 0, 0, KORA_FADV_DONTNEED), 0);
+    assert_int_equal(sys_fadvise(fd, 0, 0, KORA_FADV_NOREUSE), 0);
+    assert_int_equal(sys_fadvise(fd, 0, 0, KORA_FADV_NORMAL), 0);
+
+    /* Advice must not disturb normal reads */
+    char buf[16];
+    assert_int_equal(sys_read(fd, buf, sizeof(buf)), (int)sizeof(buf));
+    assert_int_equal(buf[0], 'k');
+
+    sys_close(fd);
+}
+
+static void test_fadvise_invalid(void **state) {
+    (void)state;
+    int fd = sys_open(TEST_FILE, KORA_O_RDONLY);
+    assert_true(fd >= 0);
+
+    assert_int_equal(sys_fadvise(fd, 0, 0, 42), -EINVAL);
+    sys_close(fd);
+
+    assert_true(sys_fadvise(-1, 0, 0, KORA_FADV_SEQUENTIAL) < 0);
+}
+
+static void test_readahead(void **state) {
+    (void)state;
+    int fd = sys_open(TEST_FILE, KORA_O_RDONLY);
+    assert_true(fd >= 0);
+
+    assert_int_equal(sys_readahead(fd, 0, 65536), 0);
+    sys_close(fd);
+
+    assert_true(sys_readahead(-1, 0, 4096) < 0);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_fadvise_all_modes),
+        cmocka_unit_test(test_fadvise_invalid),
+        cmocka_unit_test(test_readahead),
+    };
+    return cmocka_run_group_tests(tests, setup, teardown);
+}
@@ -0,0 +1,523 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <kora/syscalls.h>
+#include <kora/fatfs.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MNT "/kora-fatfs-test"
+
+static char image_path[64];
+
+static void put16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+    put16(p, (uint16_t)v);
+    put16(p + 2, (uint16_t)(v >> 16));
+}
+
+typedef struct {
+    uint32_t total, spc, reserved, root_entries, fat_sectors;
+} layout_t;
+
+/* Geometries that land in each FAT variant's cluster-count range */
+static layout_t layout_for(int bits) {
+    switch (bits) {
+    case 12:
+        return (layout_t){ 2880, 1, 1, 224, 9 };      /* 1.44 MB floppy */
+    case 16:
+        return (layout_t){ 32768, 4, 1, 512, 32 };    /* 16 MB */
+    default:
+        return (layout_t){ 69632, 1, 32, 0, 544 };    /* 34 MB */
+    }
+}
+
+static uint64_t data_offset(int bits) {
+    layout_t l = layout_for(bits);
+    return ((uint64_t)l.reserved + 2 * l.fat_sectors + (l.root_entries * 32 + 511) / 512) * 512;
+}
+
+/* Write an empty FAT file system into image_path, as mkfs would */
+static void format_image(int bits) {
+    layout_t l = layout_for(bits);
+    uint8_t sector[512] = {0};
+
+    snprintf(image_path, sizeof(image_path), "/tmp/kora-fatfs-%d.img", (int)getpid());
+    int fd = open(image_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    assert_true(fd >= 0);
+    assert_int_equal(ftruncate(fd, (off_t)l.total * 512), 0);
+
+    sector[0] = 0xEB;
+    sector[1] = 0x3C;
+    sector[2] = 0x90;
+    memcpy(sector + 3, "KORATEST", 8);
+    put16(sector + 11, 512);
+    sector[13] = (uint8_t)l.spc;
+    put16(sector + 14, (uint16_t)l.reserved);
+    sector[16] = 2;
+    put16(sector + 17, (uint16_t)l.root_entries);
+    put16(sector + 19, l.total < 65536 ? (uint16_t)l.total : 0);
+    sector[21] = 0xF8;
+    if (bits == 32) {
+        put32(sector + 32, l.total);
+        put32(sector + 36, l.fat_sectors);
+        put32(sector + 44, 2);   /* Root directory cluster */
+        put16(sector + 48, 1);   /* FSInfo sector */
+    } else {
+        put16(sector + 22, (uint16_t)l.fat_sectors);
+    }
+    sector[510] = 0x55;
+    sector[511] = 0xAA;
+    assert_int_equal(pwrite(fd, sector, 512, 0), 512);
+
+    if (bits == 32) {
+        memset(sector, 0, sizeof(sector));
+        put32(sector, 0x41615252);
+        put32(sector + 484, 0x61417272);
+        put32(sector + 488, 0xFFFFFFFF);
+        put32(sector + 492, 0xFFFFFFFF);
+        put32(sector + 508, 0xAA550000);
+        assert_int_equal(pwrite(fd, sector, 512, 512), 512);
+    }
+
+    /* Reserved FAT entries, plus the FAT32 root directory's cluster */
+    memset(sector, 0, sizeof(sector));
+    if (bits == 12) {
+        memcpy(sector, "\xF8\xFF\xFF", 3);
+    } else if (bits == 16) {
+        memcpy(sector, "\xF8\xFF\xFF\xFF", 4);
+    } else {
+        put32(sector, 0x0FFFFFF8);
+        put32(sector + 4, 0x0FFFFFFF);
+        put32(sector + 8, 0x0FFFFFFF);
+    }
+    for (uint32_t i = 0; i < 2; i++) {
+        off_t off = (off_t)(l.reserved + i * l.fat_sectors) * 512;
+        assert_int_equal(pwrite(fd, sector, 512, off), 512);
+    }
+    close(fd);
+}
+
+static int teardown(void **state) {
+    (void)state;
+    kora_fatfs_unmount(MNT);
+    unlink(image_path);
+    return 0;
+}
+
+static void write_file(const char *path, const void *data, size_t size) {
+    int fd = sys_open(path, KORA_O_WRONLY | KORA_O_CREAT | KORA_O_TRUNC);
+    assert_true(fd >= 0);
+    assert_int_equal(sys_write(fd, data, size), (int)size);
+    assert_int_equal(sys_close(fd), KORA_SUCCESS);
+}
+
+static void assert_file(const char *path, const void *data, size_t size) {
+    char *buf = malloc(size + 1);
+    assert_non_null(buf);
+    int fd = sys_open(path, KORA_O_RDONLY);
+    assert_true(fd >= 0);
+    assert_int_equal(size == 0 ? KORA_EOF : (int)size, sys_read(fd, buf, size + 1));
+    assert_memory_equal(buf, data, size);
+    assert_int_equal(sys_close(fd), KORA_SUCCESS);
+    free(buf);
+}
+
+static void test_fatfs_mount(void **state) {
+    (void)state;
+    kora_file_info_t info;
+
+    /* Other types still go to the platform */
+    assert_int_equal(sys_mount("none", MNT, "kora-no-such-type", 0, NULL), KORA_ERROR);
+    assert_int_equal(errno, ENOSYS);
+
+    /* Anything but a FAT image is refused */
+    snprintf(image_path, sizeof(image_path), "/tmp/kora-fatfs-%d.img", (int)getpid());
+    int fd = open(image_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    assert_true(fd >= 0);
+    assert_int_equal(ftruncate(fd, 1 << 20), 0);
+    close(fd);
+    assert_int_equal(sys_mount(image_path, MNT, "vfat", 0, NULL), KORA_ERROR);
+    assert_int_equal(errno, EINVAL);
+    assert_int_equal(sys_mount("/tmp/kora-fatfs-missing.img", MNT, "vfat", 0, NULL), KORA_ERROR);
+    assert_int_equal(errno, ENOENT);
+
+    int bits[] = { 12, 16, 32 };
+    for (int i = 0; i < 3; i++) {
+        format_image(bits[i]);
+        assert_int_equal(sys_mount(image_path, MNT, "fat", 0, NULL), KORA_SUCCESS);
+        assert_int_equal(sys_mount(image_path, MNT, "fat", 0, NULL), KORA_ERROR);
+        assert_int_equal(errno, EBUSY);
+
+        assert_int_equal(sys_get_file_info(MNT, &info), 0);
+        assert_int_equal(info.type, KORA_FILE_TYPE_DIRECTORY);
+        assert_int_equal(info.starting_cluster, bits[i] == 32 ? 2u : 0u);
+
+        fd = sys_open(MNT "/A.TXT", KORA_O_WRONLY | KORA_O_CREAT);
+        assert_true(fd >= 0);
+        assert_int_equal(kora_fatfs_unmount(MNT), KORA_ERROR);
+        assert_int_equal(errno, EBUSY);
+        assert_int_equal(sys_close(fd), KORA_SUCCESS);
+        assert_int_equal(kora_fatfs_unmount(MNT), KORA_SUCCESS);
+    }
+}
+
+/* A file written by another implementation, with a long name */
+static void test_fatfs_existing(void **state) {
+    (void)state;
+    static const char long_name[] = "Hello World.txt";
+    uint8_t dir[3 * 32] = {0};
+    uint8_t raw[11];
+    uint8_t sum = 0;
+    char data[3000];
+
+    format_image(16);
+    memcpy(raw, "HELLOW~1TXT", 11);
+    for (int i = 0; i < 11; i++) {
+        sum = (uint8_t)(((sum & 1) << 7) + (sum >> 1) + raw[i]);
+    }
+    /* Two long-name slots, last part first, then the short entry */
+    static const int offsets[13] = {1, 3, 5, 7, 9, 14, 16, 18, 20, 22, 24, 28, 30};
+    for (int k = 2; k >= 1; k--) {
+        uint8_t *b = dir + (2 - k) * 32;
+        b[0] = (uint8_t)(k | (k == 2 ? 0x40 : 0));
+        b[11] = 0x0F;
+        b[13] = sum;
+        for (int i = 0; i < 13; i++) {
+            int u = (k - 1) * 13 + i;
+            int len = (int)strlen(long_name);
+            put16(b + offsets[i], u < len ? (uint16_t)long_name[u] : u == len ? 0 : 0xFFFF);
+        }
+    }
+    memcpy(dir + 64, raw, 11);
+    dir[64 + 11] = 0x20;
+    put16(dir + 64 + 24, (uint16_t)((45 << 9) | (6 << 5) | 15));  /* 2025-06-15 */
+    put16(dir + 64 + 26, 2);
+    put32(dir + 64 + 28, sizeof(data));
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (char)('a' + i % 26);
+    }
+
+    /* Clusters 2 and 3 in both FATs, the data, and the root directory */
+    layout_t l = layout_for(16);
+    uint8_t fat[8] = { 0xF8, 0xFF, 0xFF, 0xFF, 3, 0, 0xFF, 0xFF };
+    int fd = open(image_path, O_RDWR);
+    assert_true(fd >= 0);
+    for (uint32_t i = 0; i < 2; i++) {
+        assert_int_equal(pwrite(fd, fat, sizeof(fat), (off_t)(l.reserved + i * l.fat_sectors) * 512), 8);
+    }
+    assert_int_equal(pwrite(fd, dir, sizeof(dir), (off_t)(l.reserved + 2 * l.fat_sectors) * 512), 96);
+    assert_int_equal(pwrite(fd, data, sizeof(data), (off_t)data_offset(16)), (int)sizeof(data));
+    close(fd);
+
+    assert_int_equal(sys_mount(image_path, MNT, "msdos", KORA_MOUNT_RDONLY, NULL), KORA_SUCCESS);
+    int d = sys_opendir(MNT);
+    assert_true(d >= 0);
+    kora_dirent_t entry;
+    int found = 0;
+    while (sys_readdir(d, &entry) > 0) {
+        found += strcmp(entry.name, long_name) == 0 && entry.type == KORA_DT_REG;
+    }
+    assert_int_equal(sys_closedir(d), KORA_SUCCESS);
+    assert_int_equal(found, 1);
+
+    /* By long name in any case, or by the 8.3 alias */
+    assert_file(MNT "/Hello World.txt", data, sizeof(data));
+    assert_file(MNT "/HELLO WORLD.TXT", data, sizeof(data));
+    assert_file(MNT "/hellow~1.txt", data, sizeof(data));
+
+    kora_file_info_t info;
+    assert_int_equal(sys_get_file_info(MNT "/hello world.txt", &info), 0);
+    assert_int_equal(info.starting_cluster, 2);
+    assert_int_equal(info.size, sizeof(data));
+    assert_int_equal(info.attributes, KORA_FILE_ATTR_ARCHIVE);
+    kora_stat_t st;
+    assert_int_equal(sys_stat(MNT "/hello world.txt", &st), 0);
+    assert_int_equal(st.mtime, 1749945600);
+
+    /* Read-only mounts refuse changes */
+    assert_int_equal(sys_open(MNT "/new.txt", KORA_O_WRONLY | KORA_O_CREAT), KORA_ERROR);
+    assert_int_equal(errno, EROFS);
+    assert_int_equal(sys_mkdir(MNT "/dir"), KORA_ERROR);
+    assert_int_equal(errno, EROFS);
+    assert_int_equal(sys_unlink(MNT "/hello world.txt"), -EROFS);
+}
+
+static void check_files(int bits) {
+    const size_t size = 300 * 1024 + 17;
+    char *data = malloc(size);
+    char buf[64];
+    assert_non_null(data);
+    for (size_t i = 0; i < size; i++) {
+        data[i] = (char)(i * 7 + i / 4096);
+    }
+
+    format_image(bits);
+    assert_int_equal(sys_mount(image_path, MNT, "vfat", 0, NULL), KORA_SUCCESS);
+
+    /* A multi-cluster file written in odd-sized pieces */
+    int fd = sys_open(MNT "/Data File.bin", KORA_O_RDWR | KORA_O_CREAT);
+    assert_true(fd >= 0);
+    for (size_t off = 0; off < size; off += 5000) {
+        size_t n = size - off < 5000 ? size - off : 5000;
+        assert_int_equal(sys_write(fd, data + off, n), (int)n);
+    }
+    assert_int_equal(sys_seek(fd, 100000, KORA_SEEK_SET), 100000);
+    assert_int_equal(sys_read(fd, buf, 10), 10);
+    assert_memory_equal(buf, data + 100000, 10);
+    assert_int_equal(sys_close(fd), KORA_SUCCESS);
+
+    /* Writing past the end leaves zeros, as FAT has no holes */
+    write_file(MNT "/gap", "", 0);
+    fd = sys_open(MNT "/gap", KORA_O_RDWR);
+    assert_true(fd >= 0);
+    assert_int_equal(sys_seek(fd, 5000, KORA_SEEK_SET), 5000);
+    assert_int_equal(sys_write(fd, "end", 3), 3);
+    assert_int_equal(sys_seek(fd, 4998, KORA_SEEK_SET), 4998);
+    assert_int_equal(sys_read(fd, buf, sizeof(buf)), 5);
+    assert_memory_equal(buf, "\0\0end", 5);
+    assert_int_equal(sys_close(fd), KORA_SUCCESS);
+
+    fd = sys_open(MNT "/gap", KORA_O_WRONLY | KORA_O_APPEND);
+    assert_true(fd >= 0);
+    assert_int_equal(sys_write(fd, "!", 1), 1);
+    assert_int_equal(sys_close(fd), KORA_SUCCESS);
+
+    kora_file_info_t info;
+    assert_int_equal(sys_get_file_info(MNT "/gap", &info), 0);
+    assert_int_equal(info.size, 5004);
+    assert_true(info.starting_cluster >= 2);
+    uint32_t first = info.starting_cluster;
+
+    /* Everything is in the image after a remount */
+    assert_int_equal(kora_fatfs_unmount(MNT), KORA_SUCCESS);
+    assert_int_equal(sys_mount(image_path, MNT, "vfat", 0, NULL), KORA_SUCCESS);
+    assert_file(MNT "/DATA FILE.BIN", data, size);
+    assert_int_equal(sys_get_file_info(MNT "/gap", &info), 0);
+    assert_int_equal(info.starting_cluster, first);
+    assert_int_equal(info.size, 5004);
+
+    /* Truncation releases the clusters */
+    write_file(MNT "/gap", "x", 1);
+    assert_int_equal(sys_get_file_info(MNT "/gap", &info), 0);
+    assert_int_equal(info.size, 1);
+    fd = sys_open(MNT "/gap", KORA_O_WRONLY | KORA_O_TRUNC);
+    assert_int_equal(sys_close(fd), KORA_SUCCESS);
+    assert_int_equal(sys_get_file_info(MNT "/gap", &info), 0);
+    assert_int_equal(info.starting_cluster, 0);
+    assert_int_equal(info.size, 0);
+
+    assert_int_equal(kora_fatfs_unmount(MNT), KORA_SUCCESS);
+    free(data);
+}
+
+static void test_fatfs_files(void **state) {
+    (void)state;
+    check_files(12);
+    check_files(16);
+    check_files(32);
+}
+
+static void check_directories(int bits) {
+    char path[96];
+    kora_dirent_t entry;
+    kora_stat_t st;
+
+    format_image(bits);
+    assert_int_equal(sys_mount(image_path, MNT, "fat", 0, NULL), KORA_SUCCESS);
+
+    assert_int_equal(sys_mkdir(MNT "/Projects"), KORA_SUCCESS);
+    assert_int_equal(sys_mkdir(MNT "/projects"), KORA_SUCCESS);  /* Same directory */
+    assert_int_equal(sys_mkdir(MNT "/PROJECTS/src"), KORA_SUCCESS);
+
+    /* Enough entries, half with long names, to span several clusters */
+    for (int i = 0; i < 400; i++) {
+        snprintf(path, sizeof(path), i % 2 ? MNT "/projects/F%d.C" : MNT "/projects/source file %d.c", i);
+        write_file(path, path, strlen(path));
+    }
+    for (int i = 0; i < 400; i += 4) {
+        snprintf(path, sizeof(path), i % 2 ? MNT "/projects/F%d.C" : MNT "/projects/source file %d.c", i);
+        assert_int_equal(sys_unlink(path), 0);
+    }
+    int d = sys_opendir(MNT "/projects");
+    assert_true(d >= 0);
+    int count = 0, dirs = 0;
+    while (sys_readdir(d, &entry) > 0) {
+        count += entry.type == KORA_DT_REG;
+        dirs += entry.type == KORA_DT_DIR;
+    }
+    assert_int_equal(sys_closedir(d), KORA_SUCCESS);
+    assert_int_equal(count, 300);
+    assert_int_equal(dirs, 3);  /* ".", ".." and src */
+
+    /* Lookups survive a remount, which reparses the directory */
+    assert_int_equal(kora_fatfs_unmount(MNT), KORA_SUCCESS);
+    assert_int_equal(sys_mount(image_path, MNT, "fat", 0, NULL), KORA_SUCCESS);
+    for (int i = 1; i < 400; i++) {
+        snprintf(path, sizeof(path), i % 2 ? MNT "/projects/f%d.c" : MNT "/Projects/Source File %d.C", i);
+        assert_int_equal(sys_exists(path, NULL), i % 4 != 0);
+    }
+    assert_file(MNT "/projects/source file 2.c", MNT "/projects/source file 2.c",
+                strlen(MNT "/projects/source file 2.c"));
+
+    /* Names reuse freed slots, and short names keep their case */
+    write_file(MNT "/projects/readme.md", "r", 1);
+    write_file(MNT "/projects/Mixed.TXT", "m", 1);
+    d = sys_opendir(MNT "/projects");
+    int seen = 0;
+    while (sys_readdir(d, &entry) > 0) {
+        seen += strcmp(entry.name, "readme.md") == 0 || strcmp(entry.name, "Mixed.TXT") == 0;
+    }
+    assert_int_equal(sys_closedir(d), KORA_SUCCESS);
+    assert_int_equal(seen, 2);
+
+    /* Moving a directory repoints its ".." */
+    write_file(MNT "/projects/src/main.c", "int main;", 9);
+    assert_int_equal(sys_rename(MNT "/projects/src", MNT "/src moved"), 0);
+    assert_file(MNT "/SRC MOVED/MAIN.C", "int main;", 9);
+    assert_int_equal(sys_rename(MNT "/src moved", MNT "/src moved/x"), -EINVAL);
+    assert_int_equal(sys_rename(MNT "/src moved/main.c", MNT "/projects/f1.c"), 0);
+    assert_file(MNT "/projects/f1.c", "int main;", 9);
+    assert_int_equal(sys_rename(MNT "/projects/f1.c", MNT "/projects/F1.c"), 0);  /* Case only */
+    assert_int_equal(kora_fatfs_unmount(MNT), KORA_SUCCESS);
+    assert_int_equal(sys_mount(image_path, MNT, "fat", 0, NULL), KORA_SUCCESS);
+    assert_int_equal(sys_stat(MNT "/src moved/..", &st), 0);
+    assert_true(S_ISDIR(st.mode));
+    assert_file(MNT "/projects/F1.C", "int main;", 9);
+
+    assert_int_equal(sys_rmdir(MNT "/projects"), KORA_ERROR);
+    assert_int_equal(errno, ENOTEMPTY);
+    assert_int_equal(sys_rmdir(MNT "/src moved"), KORA_SUCCESS);
+    assert_int_equal(sys_unlink(MNT "/projects"), -EISDIR);
+    assert_int_equal(sys_link(MNT "/projects/F1.C", MNT "/l"), -EPERM);
+    assert_int_equal(sys_symlink("F1.C", MNT "/s"), KORA_ERROR);
+    assert_int_equal(errno, EPERM);
+    assert_int_equal(sys_open(MNT "/bad:name", KORA_O_WRONLY | KORA_O_CREAT), KORA_ERROR);
+    assert_int_equal(errno, EINVAL);
+
+    assert_int_equal(kora_fatfs_unmount(MNT), KORA_SUCCESS);
+}
+
+static void test_fatfs_directories(void **state) {
+    (void)state;
+    check_directories(12);
+    check_directories(16);
+    check_directories(32);
+}
+
+static void test_fatfs_full(void **state) {
+    (void)state;
+    char path[64];
+    static char chunk[64 * 1024];
+
+    /* The FAT12 root directory is fixed in size */
+    format_image(12);
+    assert_int_equal(sys_mount(image_path, MNT, "fat", 0, NULL), KORA_SUCCESS);
+    write_file(MNT "/KEEP.TXT", "keep", 4);
+    int created = 1;
+    for (int i = 0; i < 300; i++) {
+        snprintf(path, sizeof(path), MNT "/F%d", i);
+        int fd = sys_open(path, KORA_O_WRONLY | KORA_O_CREAT);
+        if (fd < 0) {
+            assert_int_equal(errno, ENOSPC);
+            break;
+        }
+        sys_close(fd);
+        created++;
+    }
+    assert_int_equal(created, layout_for(12).root_entries);
+
+    /* Mixed case needs a long-name slot more than the name it replaces */
+    assert_int_equal(sys_rename(MNT "/F0", MNT "/Keep.txt"), -ENOSPC);
+    assert_file(MNT "/KEEP.TXT", "keep", 4);
+    assert_int_equal(sys_exists(MNT "/F0", NULL), 1);
+    assert_int_equal(kora_fatfs_unmount(MNT), KORA_SUCCESS);
+    assert_int_equal(sys_mount(image_path, MNT, "fat", 0, NULL), KORA_SUCCESS);
+    assert_file(MNT "/KEEP.TXT", "keep", 4);
+    assert_int_equal(sys_exists(MNT "/F0", NULL), 1);
+    assert_int_equal(sys_rename(MNT "/F0", MNT "/KEEP.TXT"), 0);
+    assert_file(MNT "/KEEP.TXT", "", 0);
+    assert_int_equal(sys_exists(MNT "/F0", NULL), 0);
+    write_file(MNT "/F0", "", 0);
+
+    /* Filling the data area stops short and frees on unlink */
+    int fd = sys_open(MNT "/F0", KORA_O_WRONLY);
+    assert_true(fd >= 0);
+    long total = 0;
+    int n;
+    while ((n = sys_write(fd, chunk, sizeof(chunk))) > 0) {
+        total += n;
+    }
+    assert_int_equal(n, KORA_ERROR);
+    assert_int_equal(errno, ENOSPC);
+    assert_int_equal(sys_close(fd), KORA_SUCCESS);
+    assert_true(total > 1400 * 1024);
+    assert_int_equal(sys_unlink(MNT "/F0"), 0);
+    write_file(MNT "/F1", chunk, sizeof(chunk));
+    assert_int_equal(kora_fatfs_unmount(MNT), KORA_SUCCESS);
+}
+
+#define LOOKUP_THREADS 4
+
+static void *lookup_files(void *arg) {
+    kora_stat_t st;
+    intptr_t bad = 0;
+    (void)arg;
+    for (int i = 0; i < 200; i++) {
+        bad += sys_stat(MNT "/D/SUB/F", &st) != 0 || st.size != 5;
+        int fd = sys_open(MNT "/d/sub/f", KORA_O_RDONLY);
+        bad += fd < 0 || sys_close(fd) != KORA_SUCCESS;
+        int dir = sys_opendir(MNT "/D/Sub");
+        bad += dir < 0 || sys_closedir(dir) != KORA_SUCCESS;
+        bad += sys_stat(MNT "/D/none", &st) != -ENOENT;
+    }
+    return (void *)bad;
+}
+
+static void test_fatfs_lookups(void **state) {
+    (void)state;
+    kora_thread_t threads[LOOKUP_THREADS];
+
+    format_image(16);
+    assert_int_equal(sys_mount(image_path, MNT, "vfat", 0, NULL), KORA_SUCCESS);
+    assert_int_equal(sys_mkdir(MNT "/D"), KORA_SUCCESS);
+    assert_int_equal(sys_mkdir(MNT "/D/SUB"), KORA_SUCCESS);
+    write_file(MNT "/D/SUB/F", "hello", 5);
+    assert_int_equal(kora_fatfs_unmount(MNT), KORA_SUCCESS);
+
+    /* Threads share the lock once the directories on the way are loaded */
+    assert_int_equal(sys_mount(image_path, MNT, "vfat", 0, NULL), KORA_SUCCESS);
+    for (int i = 0; i < LOOKUP_THREADS; i++) {
+        assert_int_equal(sys_thread_create(&threads[i], NULL, lookup_files, NULL), 0);
+    }
+    for (int i = 0; i < LOOKUP_THREADS; i++) {
+        void *bad = NULL;
+        assert_int_equal(sys_thread_join(threads[i], &bad), 0);
+        assert_null(bad);
+    }
+    assert_int_equal(sys_unlink(MNT "/D/SUB/F"), 0);
+    assert_int_equal(sys_exists(MNT "/D/SUB/F", NULL), 0);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_fatfs_mount, NULL, teardown),
+        cmocka_unit_test_setup_teardown(test_fatfs_existing, NULL, teardown),
+        cmocka_unit_test_setup_teardown(test_fatfs_files, NULL, teardown),
+        cmocka_unit_test_setup_teardown(test_fatfs_directories, NULL, teardown),
+        cmocka_unit_test_setup_teardown(test_fatfs_full, NULL, teardown),
+        cmocka_unit_test_setup_teardown(test_fatfs_lookups, NULL, teardown),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,259 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <kora/fd.h>
+#include <kora/memfs.h>
+#include <kora/syscalls.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#define MNT "/kora-fd-test"
+#define THREADS 8
+#define ROUNDS 2000
+
+/* Slots are process-wide, so every test shares these two */
+static int slot = -1;
+static int quiet = -1;
+static int released;
+static int released_fd;
+static void *released_value;
+
+static void count_release(int fd, void *value) {
+    released++;
+    released_fd = fd;
+    released_value = value;
+}
+
+static int setup(void **state) {
+    (void)state;
+    if (slot < 0) {
+        slot = kora_fd_slot_register(count_release);
+        quiet = kora_fd_slot_register(NULL);
+    }
+    released = 0;
+    return slot >= 0 && quiet >= 0 && kora_memfs_mount(MNT) == KORA_SUCCESS ? 0 : -1;
+}
+
+static int teardown(void **state) {
+    (void)state;
+    return kora_memfs_unmount(MNT) == KORA_SUCCESS ? 0 : -1;
+}
+
+static void test_fd_host(void **state) {
+    int a, b;
+    (void)state;
+
+    int fd = sys_open("/dev/null", KORA_O_RDONLY);
+    assert_true(fd >= 0);
+    assert_string_equal(kora_fd_backend(fd), "host");
+    assert_null(kora_fd_get(fd, slot));
+
+    assert_int_equal(kora_fd_set(fd, slot, &a), KORA_SUCCESS);
+    assert_int_equal(kora_fd_set(fd, quiet, &b), KORA_SUCCESS);
+    assert_ptr_equal(kora_fd_get(fd, slot), &a);
+    assert_ptr_equal(kora_fd_get(fd, quiet), &b);
+
+    /* Replacing a value releases the old one, storing it again does not */
+    assert_int_equal(kora_fd_set(fd, slot, &b), KORA_SUCCESS);
+    assert_int_equal(released, 1);
+    assert_ptr_equal(released_value, &a);
+    assert_int_equal(kora_fd_set(fd, slot, &b), KORA_SUCCESS);
+    assert_int_equal(released, 1);
+
+    assert_int_equal(sys_close(fd), KORA_SUCCESS);
+    assert_int_equal(released, 2);
+    assert_int_equal(released_fd, fd);
+    assert_ptr_equal(released_value, &b);
+    assert_null(kora_fd_get(fd, slot));
+    assert_null(kora_fd_get(fd, quiet));
+}
+
+static void test_fd_layer(void **state) {
+    int a;
+    (void)state;
+
+    int fd = sys_open(MNT "/file", KORA_O_RDWR | KORA_O_CREAT);
+    assert_true(fd >= 0);
+    assert_string_equal(kora_fd_backend(fd), "memfs");
+    assert_int_equal(kora_fd_set(fd, slot, &a), KORA_SUCCESS);
+    assert_int_equal(sys_write(fd, "x", 1), 1);
+    assert_ptr_equal(kora_fd_get(fd, slot), &a);
+
+    assert_int_equal(sys_close(fd), KORA_SUCCESS);
+    assert_int_equal(released, 1);
+    assert_int_equal(released_fd, fd);
+    assert_null(kora_fd_backend(fd));
+    assert_null(kora_fd_get(fd, slot));
+    assert_int_equal(kora_fd_set(fd, slot, &a), KORA_ERROR);
+    assert_int_equal(errno, EBADF);
+
+    /* Directory handles are numbered from the same table */
+    int dir = sys_opendir(MNT);
+    assert_true(dir >= 0);
+    assert_string_equal(kora_fd_backend(dir), "memfs");
+    assert_int_equal(kora_fd_set(dir, slot, &a), KORA_SUCCESS);
+    assert_int_equal(sys_closedir(dir), KORA_SUCCESS);
+    assert_int_equal(released, 2);
+    assert_int_equal(released_fd, dir);
+}
+
+static void test_fd_dup(void **state) {
+    int a, b;
+    (void)state;
+
+    int fd = sys_open("/dev/null", KORA_O_RDONLY);
+    int other = sys_open("/dev/null", KORA_O_RDONLY);
+    assert_true(fd >= 0 && other >= 0);
+    assert_int_equal(kora_fd_set(fd, slot, &a), KORA_SUCCESS);
+    assert_int_equal(kora_fd_set(other, slot, &b), KORA_SUCCESS);
+
+    /* A duplicate is a new descriptor and starts empty */
+    int copy = sys_dup(fd);
+    assert_true(copy >= 0);
+    assert_null(kora_fd_get(copy, slot));
+
+    /* dup2 onto a descriptor closes it, onto itself leaves it alone */
+    assert_int_equal(sys_dup2(fd, fd), fd);
+    assert_int_equal(released, 0);
+    assert_int_equal(sys_dup2(fd, other), other);
+    assert_int_equal(released, 1);
+    assert_int_equal(released_fd, other);
+    assert_ptr_equal(released_value, &b);
+    assert_null(kora_fd_get(other, slot));
+    assert_ptr_equal(kora_fd_get(fd, slot), &a);
+
+    sys_close(copy);
+    sys_close(other);
+    sys_close(fd);
+    assert_int_equal(released, 2);
+}
+
+static void test_fd_errors(void **state) {
+    int a;
+    (void)state;
+
+    assert_int_equal(kora_fd_set(-1, slot, &a), KORA_ERROR);
+    assert_int_equal(errno, EBADF);
+    assert_int_equal(kora_fd_set(0, KORA_FD_SLOTS, &a), KORA_ERROR);
+    assert_int_equal(errno, EINVAL);
+    assert_int_equal(kora_fd_set(0, -1, &a), KORA_ERROR);
+    assert_int_equal(errno, EINVAL);
+    assert_null(kora_fd_get(-1, slot));
+    assert_null(kora_fd_get(0, KORA_FD_SLOTS));
+    assert_null(kora_fd_backend(-1));
+    assert_string_equal(kora_fd_backend(0), "host");
+    assert_null(kora_fd_backend(1 << 30));
+
+    /* A slot past the registered ones cannot be set */
+    int next = slot > quiet ? slot + 1 : quiet + 1;
+    if (next < KORA_FD_SLOTS) {
+        assert_int_equal(kora_fd_set(0, next, &a), KORA_ERROR);
+        assert_int_equal(errno, EINVAL);
+    }
+}
+
+/* A host directory numbered past the host entries is refused, not stored past them */
+static void test_fd_host_range(void **state) {
+    const int top = 1 << 20;
+    struct rlimit old, rl;
+    (void)state;
+
+    /* Needs a descriptor limit above top, which takes a raised fs.nr_open */
+    getrlimit(RLIMIT_NOFILE, &old);
+    rl.rlim_cur = rl.rlim_max = (rlim_t)top + 64;
+    if (setrlimit(RLIMIT_NOFILE, &rl) != 0) {
+        skip();
+    }
+    /* Fill every lower number, so the next directory lands on top */
+    unsigned char *filled = calloc((size_t)top, 1);
+    assert_non_null(filled);
+    int base = open("/dev/null", O_RDONLY);
+    assert_true(base >= 0);
+    for (int fd = 0; fd < top; fd++) {
+        if (fcntl(fd, F_GETFD) < 0) {
+            filled[fd] = dup2(base, fd) == fd;
+        }
+    }
+    assert_int_equal(sys_opendir("/"), KORA_ERROR);
+    assert_int_equal(errno, EBADF);
+    assert_int_equal(fcntl(top, F_GETFD), -1);
+
+    for (int fd = 0; fd < top; fd++) {
+        if (filled[fd]) {
+            close(fd);
+        }
+    }
+    close(base);
+    free(filled);
+    setrlimit(RLIMIT_NOFILE, &old);
+}
+
+/* Layer descriptor numbers are reused across threads without mixing up slots */
+static void *churn(void *arg) {
+    uintptr_t id = (uintptr_t)arg;
+    char path[64];
+
+    snprintf(path, sizeof(path), MNT "/t%u", (unsigned)id);
+    for (int i = 0; i < ROUNDS; i++) {
+        int fd = sys_open(path, KORA_O_RDWR | KORA_O_CREAT);
+        if (fd < 0) {
+            return (void *)1;
+        }
+        if (kora_fd_set(fd, quiet, (void *)(id + 1)) != KORA_SUCCESS ||
+            kora_fd_get(fd, quiet) != (void *)(id + 1) ||
+            strcmp(kora_fd_backend(fd), "memfs") != 0) {
+            sys_close(fd);
+            return (void *)1;
+        }
+        sys_close(fd);
+    }
+    return NULL;
+}
+
+static void test_fd_threads(void **state) {
+    pthread_t threads[THREADS];
+    void *failed;
+    (void)state;
+
+    for (uintptr_t i = 0; i < THREADS; i++) {
+        assert_int_equal(pthread_create(&threads[i], NULL, churn, (void *)i), 0);
+    }
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(threads[i], &failed);
+        assert_null(failed);
+    }
+}
+
+/* Runs last: it takes the remaining slots */
+static void test_fd_register(void **state) {
+    int n = 0;
+    (void)state;
+
+    while (kora_fd_slot_register(NULL) >= 0) {
+        n++;
+    }
+    assert_int_equal(errno, ENOSPC);
+    assert_true(n <= KORA_FD_SLOTS - 2);
+    assert_int_equal(kora_fd_slot_register(count_release), KORA_ERROR);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_fd_host, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_fd_layer, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_fd_dup, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_fd_errors, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_fd_host_range, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_fd_threads, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_fd_register, setup, teardown),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
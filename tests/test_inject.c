@@ -0,0 +1,225 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <kora/syscalls.h>
+#include <kora/inject.h>
+#include <kora/error.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <time.h>
+
+/* Hooks can be compiled out with -DKORA_INJECT_HOOKS=OFF */
+static void configure_or_skip(const char *spec) {
+    if (kora_inject_configure(spec) != KORA_SUCCESS) {
+        assert_int_equal(errno, ENOTSUP);
+        skip();
+    }
+}
+
+static int teardown(void **state) {
+    (void)state;
+    kora_inject_configure(NULL);
+    return 0;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void test_inject_configure(void **state) {
+    (void)state;
+
+    configure_or_skip("read: delay=uniform(10us, 2ms)@1%, delay=pareto(1ms,1.5), short=0.5 ;"
+                      " * : eintr=0.001; seed=7");
+    assert_true(kora_inject_enabled());
+
+    /* Malformed specs are rejected and leave the rules in force */
+    const char *bad[] = {
+        "read",                   /* No options */
+        "read:",                  /* Empty option */
+        "nosuchcall:eintr=1",     /* Unknown call */
+        "getpid:eintr=1",         /* Call without hooks */
+        "open:short=0.1",         /* open has no transfer to shorten */
+        "*:short=0.1",            /* Neither do most calls */
+        "read:eintr=2",           /* Rate above 1 */
+        "read:delay=uniform(2ms,1ms)",
+        "read:delay=exp(1ms",
+        "read:eintr=0.1 write:eintr=0.1",
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        errno = 0;
+        assert_int_equal(kora_inject_configure(bad[i]), KORA_ERROR);
+        assert_int_equal(errno, EINVAL);
+        assert_true(kora_inject_enabled());
+    }
+
+    assert_int_equal(kora_inject_configure(""), KORA_SUCCESS);
+    assert_false(kora_inject_enabled());
+}
+
+static void test_inject_errors(void **state) {
+    (void)state;
+    int fds[2];
+    char buf[8];
+    kora_stat_t st;
+    kora_inject_stats_t stats;
+
+    assert_int_equal(sys_pipe(fds), 0);
+    configure_or_skip("read:eintr=1;write:enospc=100%;stat:eagain=1");
+
+    /* File I/O fails with -1 and errno */
+    errno = 0;
+    assert_int_equal(sys_write(fds[1], "x", 1), -1);
+    assert_int_equal(errno, ENOSPC);
+    errno = 0;
+    assert_int_equal(sys_read(fds[0], buf, sizeof(buf)), -1);
+    assert_int_equal(errno, EINTR);
+    assert_int_equal(kora_last_error().syscall, SYS_READ);
+    assert_int_equal(kora_last_error().host_errno, EINTR);
+
+    /* Metadata calls return a negative errno */
+    assert_int_equal(sys_stat("/", &st), -EAGAIN);
+
+    kora_inject_stats(SYS_READ, &stats);
+    assert_int_equal(stats.calls, 1);
+    assert_int_equal(stats.failed, 1);
+    kora_inject_stats(SYS_CLOSE, &stats);
+    assert_int_equal(stats.calls, 0);
+
+    /* Nothing reached the pipe, and calls work again once turned off */
+    kora_inject_configure(NULL);
+    assert_int_equal(sys_write(fds[1], "y", 1), 1);
+    assert_int_equal(sys_read(fds[0], buf, sizeof(buf)), 1);
+    assert_int_equal(buf[0], 'y');
+    sys_close(fds[0]);
+    sys_close(fds[1]);
+}
+
+static void test_inject_short(void **state) {
+    (void)state;
+    int fds[2];
+    char buf[100] = { 0 };
+    kora_inject_stats_t stats;
+
+    assert_int_equal(sys_pipe(fds), 0);
+    configure_or_skip("write:short=1");
+    for (int i = 0; i < 20; i++) {
+        int n = sys_write(fds[1], buf, sizeof(buf));
+        assert_true(n >= 1 && n < (int)sizeof(buf));
+        assert_int_equal(sys_read(fds[0], buf, sizeof(buf)), n);
+    }
+    kora_inject_stats(SYS_WRITE, &stats);
+    assert_int_equal(stats.shortened, 20);
+
+    /* A single byte cannot be shortened */
+    assert_int_equal(sys_write(fds[1], buf, 1), 1);
+    sys_close(fds[0]);
+    sys_close(fds[1]);
+}
+
+static void test_inject_delay(void **state) {
+    (void)state;
+    kora_stat_t st;
+    kora_inject_stats_t stats;
+
+    configure_or_skip("stat:delay=10ms");
+    uint64_t start = now_ns();
+    assert_int_equal(sys_stat("/", &st), 0);
+    assert_true(now_ns() - start >= 10000000);
+
+    kora_inject_stats(SYS_STAT, &stats);
+    assert_int_equal(stats.delayed, 1);
+    assert_int_equal(stats.delay_ns, 10000000);
+}
+
+#define RATE_CALLS 4000
+
+static int count_failures(const char *spec) {
+    char byte;
+    int failures = 0;
+    int fd = sys_open("/dev/zero", KORA_O_RDONLY);
+    assert_true(fd >= 0);
+
+    configure_or_skip(spec);
+    for (int i = 0; i < RATE_CALLS; i++) {
+        failures += sys_read(fd, &byte, 1) < 0;
+    }
+    kora_inject_configure(NULL);
+    sys_close(fd);
+    return failures;
+}
+
+static void test_inject_rates(void **state) {
+    (void)state;
+
+    int failures = count_failures("read:eagain=10%;seed=1");
+    assert_true(failures > RATE_CALLS / 20 && failures < RATE_CALLS / 5);
+
+    /* The same seed gives the same draws */
+    assert_int_equal(count_failures("read:eagain=10%;seed=1"), failures);
+    assert_int_equal(count_failures("read:eagain=0"), 0);
+}
+
+#define RECONFIGURE_THREADS 4
+
+static atomic_int reconfiguring;
+static atomic_int reconfigure_failures[RECONFIGURE_THREADS];
+
+static void *stat_while_reconfigured(void *arg) {
+    kora_stat_t st;
+    atomic_int *failures = arg;
+    while (atomic_load(&reconfiguring)) {
+        if (sys_stat("/", &st) != 0) {
+            atomic_fetch_add(failures, 1);
+        }
+    }
+    return NULL;
+}
+
+static int every_thread_failed(void) {
+    for (int i = 0; i < RECONFIGURE_THREADS; i++) {
+        if (atomic_load(&reconfigure_failures[i]) == 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void test_inject_reconfigure(void **state) {
+    (void)state;
+    kora_thread_t threads[RECONFIGURE_THREADS];
+
+    /* Replaced tables are freed while other threads draw from the rules */
+    configure_or_skip("stat:eagain=50%,delay=uniform(0,20us)");
+    atomic_store(&reconfiguring, 1);
+    for (int i = 0; i < RECONFIGURE_THREADS; i++) {
+        atomic_store(&reconfigure_failures[i], 0);
+        assert_int_equal(sys_thread_create(&threads[i], NULL, stat_while_reconfigured,
+                                           &reconfigure_failures[i]), 0);
+    }
+    for (int i = 0; i < 200 || !every_thread_failed(); i++) {
+        assert_int_equal(kora_inject_configure(i % 2 ? "stat:eagain=50%,delay=uniform(0,20us)"
+                                                     : "stat:eagain=1;seed=3"), KORA_SUCCESS);
+        sys_yield();
+    }
+    atomic_store(&reconfiguring, 0);
+    for (int i = 0; i < RECONFIGURE_THREADS; i++) {
+        assert_int_equal(sys_thread_join(threads[i], NULL), 0);
+    }
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_inject_configure, NULL, teardown),
+        cmocka_unit_test_setup_teardown(test_inject_errors, NULL, teardown),
+        cmocka_unit_test_setup_teardown(test_inject_short, NULL, teardown),
+        cmocka_unit_test_setup_teardown(test_inject_delay, NULL, teardown),
+        cmocka_unit_test_setup_teardown(test_inject_rates, NULL, teardown),
+        cmocka_unit_test_setup_teardown(test_inject_reconfigure, NULL, teardown),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,192 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <kora/linux_raw.h>
+#include <kora/backend.h>
+#include <kora/error.h>
+#include <kora/syscalls.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(KORA_HAVE_LINUX_RAW)
+
+static char dir[64];
+
+static int setup(void **state) {
+    (void)state;
+    strcpy(dir, "/tmp/kora-raw-XXXXXX");
+    return mkdtemp(dir) != NULL ? 0 : -1;
+}
+
+static int teardown(void **state) {
+    char cmd[96];
+    (void)state;
+    snprintf(cmd, sizeof(cmd), "rm -rf %s", dir);
+    return system(cmd) == 0 ? 0 : -1;
+}
+
+/* Each result is checked against what glibc sees of the same file */
+static void test_raw_files(void **state) {
+    char path[96], other[96], buf[32] = {0};
+    kora_stat_t st, host;
+    uint8_t type;
+    (void)state;
+
+    snprintf(path, sizeof(path), "%s/file", dir);
+    int fd = kora_raw_open(path, KORA_O_RDWR | KORA_O_CREAT | KORA_O_TRUNC);
+    assert_true(fd >= 0);
+    assert_int_equal(kora_raw_write(fd, "hello raw", 9), 9);
+    assert_int_equal(kora_raw_seek(fd, 6, KORA_SEEK_SET), 6);
+    assert_int_equal(kora_raw_read(fd, buf, sizeof(buf)), 3);
+    assert_string_equal(buf, "raw");
+    assert_int_equal(kora_raw_read(fd, buf, sizeof(buf)), 0);
+    assert_int_equal(kora_raw_fstat(fd, &st), 0);
+    assert_int_equal(st.size, 9);
+    assert_int_equal(kora_raw_close(fd), 0);
+
+    assert_int_equal(sys_stat(path, &host), 0);
+    assert_int_equal(kora_raw_stat(path, &st), 0);
+    assert_int_equal(st.mode, host.mode);
+    assert_int_equal(st.size, host.size);
+    assert_int_equal(st.mtime, host.mtime);
+
+    /* Failures come back as -errno and leave errno alone */
+    errno = 0;
+    assert_int_equal(kora_raw_open("/nonexistent/kora", KORA_O_RDONLY), -ENOENT);
+    assert_int_equal(kora_raw_close(-1), -EBADF);
+    assert_int_equal(kora_raw_seek(0, 0, 7), -EINVAL);
+    assert_int_equal(errno, 0);
+
+    snprintf(other, sizeof(other), "%s/sub", dir);
+    assert_int_equal(kora_raw_mkdir(other), 0);
+    assert_int_equal(kora_raw_mkdir(other), 0);   /* Already a directory */
+    assert_int_equal(kora_raw_mkdir(path), -EEXIST);
+    assert_int_equal(kora_raw_exists(other, &type), 1);
+    assert_int_equal(type, KORA_FILE_TYPE_DIRECTORY);
+    assert_int_equal(kora_raw_rmdir(other), 0);
+    assert_int_equal(kora_raw_exists(other, NULL), 0);
+
+    assert_int_equal(kora_raw_symlink("file", other), 0);
+    assert_int_equal(kora_raw_exists(other, &type), 1);
+    assert_int_equal(type, KORA_FILE_TYPE_SYMLINK);
+    assert_int_equal(kora_raw_readlink(other, buf, sizeof(buf)), 4);
+    assert_string_equal(buf, "file");
+    assert_int_equal(kora_raw_lstat(other, &st), 0);
+    assert_true(S_ISLNK(st.mode));
+    assert_int_equal(kora_raw_unlink(other), 0);
+
+    assert_int_equal(kora_raw_link(path, other), 0);
+    assert_int_equal(kora_raw_link(path, other), -EEXIST);
+    assert_int_equal(kora_raw_unlink(path), 0);
+    assert_int_equal(kora_raw_rename(other, path), 0);
+    assert_int_equal(access(path, F_OK), 0);
+    assert_int_equal(access(other, F_OK), -1);
+    assert_int_equal(kora_raw_unlink(other), -ENOENT);
+}
+
+static void test_raw_process(void **state) {
+    struct timespec raw, host, nap = { 0, 1000 };
+    char cwd[256], host_cwd[256];
+    int fds[2];
+    (void)state;
+
+    assert_int_equal(kora_raw_getpid(), getpid());
+    assert_int_equal(kora_raw_getppid(), getppid());
+    assert_int_equal(kora_raw_gettid(), sys_gettid());
+    assert_int_equal(kora_raw_yield(), 0);
+    assert_int_equal(kora_raw_kill(getpid(), 0), 0);
+    assert_int_equal(kora_raw_nanosleep(&nap, NULL), 0);
+
+    clock_gettime(CLOCK_MONOTONIC, &host);
+    assert_int_equal(kora_raw_clock_gettime(CLOCK_MONOTONIC, &raw), 0);
+    assert_true(raw.tv_sec - host.tv_sec <= 1);
+    assert_true(raw.tv_sec > host.tv_sec || raw.tv_nsec >= host.tv_nsec);
+
+    assert_int_equal(kora_raw_getcwd(cwd, sizeof(cwd)), 0);
+    assert_non_null(getcwd(host_cwd, sizeof(host_cwd)));
+    assert_string_equal(cwd, host_cwd);
+    assert_int_equal(kora_raw_getcwd(cwd, 1), -ERANGE);
+
+    char *p = kora_raw_mmap(NULL, 8192, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                            -1, 0);
+    assert_false(KORA_RAW_MMAP_FAILED(p));
+    p[8191] = 1;
+    assert_int_equal(kora_raw_mprotect(p, 4096, PROT_READ), 0);
+    assert_int_equal(kora_raw_munmap(p, 8192), 0);
+    p = kora_raw_mmap(NULL, 0, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    assert_true(KORA_RAW_MMAP_FAILED(p));
+    assert_int_equal((long)p, -EINVAL);
+
+    assert_int_equal(kora_raw_pipe2(fds, KORA_PIPE_CLOEXEC), 0);
+    int copy = kora_raw_dup(fds[1]);
+    assert_true(copy >= 0);
+    assert_int_equal(kora_raw_dup2(copy, copy), copy);
+    assert_int_equal(kora_raw_dup2(fds[0], copy), copy);
+    assert_int_equal(kora_raw_write(fds[1], "p", 1), 1);
+    char c;
+    assert_int_equal(kora_raw_read(copy, &c, 1), 1);
+    assert_int_equal(c, 'p');
+    assert_int_equal(kora_raw_dup2(99999, copy), -EBADF);
+    kora_raw_close(copy);
+    kora_raw_close(fds[0]);
+    kora_raw_close(fds[1]);
+}
+
+/* As a backend layer the same calls follow the sys_* conventions */
+static void test_raw_layer(void **state) {
+    const kora_backend_ops_t *next;
+    char path[96];
+    char buf[8];
+    (void)state;
+
+    if (kora_backend_push(kora_backend_linux_raw(), &next) != KORA_SUCCESS) {
+        assert_int_equal(errno, ENOTSUP);
+        skip();
+    }
+    assert_int_equal(sys_getpid(), getpid());
+
+    assert_int_equal(sys_open("/nonexistent/kora", KORA_O_RDONLY), KORA_ERROR);
+    assert_int_equal(errno, ENOENT);
+    assert_int_equal(kora_last_error().syscall, SYS_OPEN);
+    assert_int_equal(kora_last_error().host_errno, ENOENT);
+
+    snprintf(path, sizeof(path), "%s/layer", dir);
+    int fd = sys_open(path, KORA_O_RDWR | KORA_O_CREAT);
+    assert_true(fd >= 0);
+    assert_int_equal(sys_write(fd, "abc", 3), 3);
+    assert_int_equal(sys_seek(fd, 0, KORA_SEEK_SET), 0);
+    assert_int_equal(sys_read(fd, buf, sizeof(buf)), 3);
+    assert_int_equal(sys_read(fd, buf, sizeof(buf)), KORA_EOF);
+    assert_int_equal(sys_close(fd), KORA_SUCCESS);
+    assert_int_equal(sys_mkdir(path), KORA_ERROR);
+    assert_int_equal(errno, EEXIST);
+
+    assert_int_equal(sys_unlink(path), 0);
+    assert_int_equal(sys_unlink(path), -ENOENT);
+    assert_int_equal(sys_exists(path, NULL), 0);
+
+    assert_int_equal(kora_backend_pop(kora_backend_linux_raw()), KORA_SUCCESS);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_raw_files, setup, teardown),
+        cmocka_unit_test(test_raw_process),
+        cmocka_unit_test_setup_teardown(test_raw_layer, setup, teardown),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
+
+#else
+
+int main(void) {
+    return 0;
+}
+
+#endif /* KORA_HAVE_LINUX_RAW */
@@ -0,0 +1,352 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <kora/syscalls.h>
+#include <kora/memfs.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MNT "/kora-memfs-test"
+
+static int setup(void **state) {
+    (void)state;
+    return kora_memfs_mount(MNT) == KORA_SUCCESS ? 0 : -1;
+}
+
+static int teardown(void **state) {
+    (void)state;
+    return kora_memfs_unmount(MNT) == KORA_SUCCESS ? 0 : -1;
+}
+
+static void write_file(const char *path, const char *data) {
+    int fd = sys_open(path, KORA_O_WRONLY | KORA_O_CREAT | KORA_O_TRUNC);
+    assert_true(fd >= 0);
+    assert_int_equal(sys_write(fd, data, strlen(data)), (int)strlen(data));
+    assert_int_equal(sys_close(fd), KORA_SUCCESS);
+}
+
+static void assert_file(const char *path, const char *data) {
+    char buf[256] = {0};
+    int fd = sys_open(path, KORA_O_RDONLY);
+    assert_true(fd >= 0);
+    int n = sys_read(fd, buf, sizeof(buf) - 1);
+    assert_int_equal(n, (int)strlen(data));
+    assert_string_equal(buf, data);
+    assert_int_equal(sys_close(fd), KORA_SUCCESS);
+}
+
+static void test_memfs_mount(void **state) {
+    (void)state;
+
+    /* Mounting twice, or somewhere relative, is refused */
+    assert_int_equal(kora_memfs_mount(MNT "/"), KORA_ERROR);
+    assert_int_equal(errno, EBUSY);
+    assert_int_equal(kora_memfs_mount("relative"), KORA_ERROR);
+    assert_int_equal(errno, EINVAL);
+    assert_int_equal(kora_memfs_unmount("/kora-memfs-none"), KORA_ERROR);
+    assert_int_equal(errno, EINVAL);
+
+    /* The mount point is an empty directory; its siblings are not routed */
+    uint8_t type = 0;
+    assert_int_equal(sys_exists(MNT, &type), 1);
+    assert_int_equal(type, KORA_FILE_TYPE_DIRECTORY);
+    assert_int_equal(sys_exists(MNT "x/file", NULL), 0);
+    assert_int_equal(sys_open(MNT "/missing", KORA_O_RDONLY), KORA_ERROR);
+    assert_int_equal(errno, ENOENT);
+
+    /* A descriptor keeps the filesystem mounted */
+    int fd = sys_open(MNT "/f", KORA_O_WRONLY | KORA_O_CREAT);
+    assert_true(fd >= 0);
+    assert_int_equal(kora_memfs_unmount(MNT), KORA_ERROR);
+    assert_int_equal(errno, EBUSY);
+    assert_int_equal(sys_close(fd), KORA_SUCCESS);
+    assert_int_equal(sys_close(fd), KORA_ERROR);
+    assert_int_equal(errno, EBADF);
+}
+
+static void test_memfs_read_write(void **state) {
+    (void)state;
+    char buf[64];
+
+    write_file(MNT "/f", "hello world");
+    assert_file(MNT "/f", "hello world");
+
+    int fd = sys_open(MNT "/f", KORA_O_RDWR);
+    assert_true(fd >= 0);
+    assert_int_equal(sys_seek(fd, 6, KORA_SEEK_SET), 6);
+    assert_int_equal(sys_write(fd, "kora!", 5), 5);
+    assert_int_equal(sys_seek(fd, -5, KORA_SEEK_END), 6);
+    assert_int_equal(sys_read(fd, buf, sizeof(buf)), 5);
+    assert_memory_equal(buf, "kora!", 5);
+    assert_int_equal(sys_read(fd, buf, sizeof(buf)), KORA_EOF);
+    assert_int_equal(sys_seek(fd, -1, KORA_SEEK_SET), KORA_ERROR);
+    assert_int_equal(errno, EINVAL);
+    assert_int_equal(sys_ioctl(fd, 0, NULL), KORA_ERROR);
+    assert_int_equal(errno, ENOTTY);
+    assert_int_equal(sys_close(fd), KORA_SUCCESS);
+
+    /* Appends go to the end whatever the position */
+    fd = sys_open(MNT "/f", KORA_O_WRONLY | KORA_O_APPEND);
+    assert_true(fd >= 0);
+    assert_int_equal(sys_seek(fd, 0, KORA_SEEK_SET), 0);
+    assert_int_equal(sys_write(fd, "?", 1), 1);
+    assert_int_equal(sys_read(fd, buf, 1), KORA_ERROR);
+    assert_int_equal(errno, EBADF);
+    assert_int_equal(sys_close(fd), KORA_SUCCESS);
+    assert_file(MNT "/f", "hello kora!?");
+
+    write_file(MNT "/f", "short");
+    assert_file(MNT "/f", "short");
+}
+
+static void test_memfs_large(void **state) {
+    (void)state;
+    const size_t size = 5 * 1024 * 1024 + 123;
+    unsigned char *data = malloc(size);
+    unsigned char *back = malloc(size);
+    assert_non_null(data);
+    assert_non_null(back);
+    for (size_t i = 0; i < size; i++) {
+        data[i] = (unsigned char)(i * 31 + (i >> 12));
+    }
+
+    /* Odd-sized sequential writes cross extent boundaries */
+    int fd = sys_open(MNT "/big", KORA_O_RDWR | KORA_O_CREAT);
+    assert_true(fd >= 0);
+    for (size_t off = 0; off < size; off += 7001) {
+        size_t n = size - off < 7001 ? size - off : 7001;
+        assert_int_equal(sys_write(fd, data + off, n), (int)n);
+    }
+    kora_stat_t st;
+    assert_int_equal(sys_fstat(fd, &st), 0);
+    assert_int_equal(st.size, size);
+
+    assert_int_equal(sys_seek(fd, 0, KORA_SEEK_SET), 0);
+    assert_int_equal(sys_read(fd, back, size), (int)size);
+    assert_memory_equal(back, data, size);
+
+    /* A write past the end leaves a hole that reads as zeros */
+    assert_int_equal(sys_seek(fd, (long)size + 4096, KORA_SEEK_SET), (long)size + 4096);
+    assert_int_equal(sys_write(fd, "x", 1), 1);
+    assert_int_equal(sys_seek(fd, (long)size - 1, KORA_SEEK_SET), (long)size - 1);
+    assert_int_equal(sys_read(fd, back, 4098), 4098);
+    assert_int_equal(back[0], data[size - 1]);
+    for (size_t i = 1; i < 4097; i++) {
+        assert_int_equal(back[i], 0);
+    }
+    assert_int_equal(back[4097], 'x');
+
+    /* Overwriting across extents */
+    assert_int_equal(sys_seek(fd, 1024 * 1024 - 10, KORA_SEEK_SET), 1024 * 1024 - 10);
+    assert_int_equal(sys_write(fd, "abcdefghijklmnopqrst", 20), 20);
+    assert_int_equal(sys_seek(fd, 1024 * 1024 - 12, KORA_SEEK_SET), 1024 * 1024 - 12);
+    assert_int_equal(sys_read(fd, back, 24), 24);
+    assert_memory_equal(back, data + 1024 * 1024 - 12, 2);
+    assert_memory_equal(back + 2, "abcdefghijklmnopqrst", 20);
+    assert_memory_equal(back + 22, data + 1024 * 1024 + 10, 2);
+
+    assert_int_equal(sys_close(fd), KORA_SUCCESS);
+    free(data);
+    free(back);
+}
+
+static void test_memfs_directories(void **state) {
+    (void)state;
+    kora_dirent_t entry;
+
+    assert_int_equal(sys_mkdir(MNT "/d"), KORA_SUCCESS);
+    assert_int_equal(sys_mkdir(MNT "/d"), KORA_SUCCESS);  /* Existing directory */
+    assert_int_equal(sys_mkdir(MNT "/d/e/f"), KORA_ERROR);
+    assert_int_equal(errno, ENOENT);
+    assert_int_equal(sys_mkdir(MNT "/d/e"), KORA_SUCCESS);
+    write_file(MNT "/d/file", "x");
+    assert_int_equal(sys_mkdir(MNT "/d/file"), KORA_ERROR);
+    assert_int_equal(errno, EEXIST);
+    assert_int_equal(sys_open(MNT "/d/file/x", KORA_O_RDONLY), KORA_ERROR);
+    assert_int_equal(errno, ENOTDIR);
+    assert_int_equal(sys_open(MNT "/d", KORA_O_WRONLY), KORA_ERROR);
+    assert_int_equal(errno, EISDIR);
+
+    int dir = sys_opendir(MNT "/d/e/..");
+    assert_true(dir >= 0);
+    int seen = 0;
+    while (sys_readdir(dir, &entry) > 0) {
+        if (strcmp(entry.name, ".") == 0 || strcmp(entry.name, "..") == 0) {
+            seen |= 1;
+        } else if (strcmp(entry.name, "e") == 0 && entry.type == KORA_DT_DIR) {
+            seen |= 2;
+        } else if (strcmp(entry.name, "file") == 0 && entry.type == KORA_DT_REG) {
+            seen |= 4;
+        } else {
+            fail_msg("unexpected entry %s", entry.name);
+        }
+    }
+    assert_int_equal(seen, 7);
+    assert_int_equal(sys_closedir(dir), KORA_SUCCESS);
+    assert_int_equal(sys_opendir(MNT "/d/file"), KORA_ERROR);
+    assert_int_equal(errno, ENOTDIR);
+
+    assert_int_equal(sys_rmdir(MNT "/d"), KORA_ERROR);
+    assert_int_equal(errno, ENOTEMPTY);
+    assert_int_equal(sys_unlink(MNT "/d/e"), -EISDIR);
+    assert_int_equal(sys_rmdir(MNT "/d/e"), KORA_SUCCESS);
+    assert_int_equal(sys_unlink(MNT "/d/file"), 0);
+    assert_int_equal(sys_rmdir(MNT "/d"), KORA_SUCCESS);
+    assert_int_equal(sys_exists(MNT "/d", NULL), 0);
+}
+
+static void test_memfs_many_entries(void **state) {
+    (void)state;
+    char path[64];
+    kora_dirent_t entry;
+    const int count = 5000;
+
+    assert_int_equal(sys_mkdir(MNT "/many"), KORA_SUCCESS);
+    for (int i = 0; i < count; i++) {
+        snprintf(path, sizeof(path), MNT "/many/%d", i);
+        int fd = sys_open(path, KORA_O_WRONLY | KORA_O_CREAT);
+        assert_true(fd >= 0);
+        assert_int_equal(sys_close(fd), KORA_SUCCESS);
+    }
+    /* Remove every other entry, then check lookups and the listing */
+    for (int i = 0; i < count; i += 2) {
+        snprintf(path, sizeof(path), MNT "/many/%d", i);
+        assert_int_equal(sys_unlink(path), 0);
+    }
+    for (int i = 0; i < count; i++) {
+        snprintf(path, sizeof(path), MNT "/many/%d", i);
+        assert_int_equal(sys_exists(path, NULL), i % 2);
+    }
+    int dir = sys_opendir(MNT "/many");
+    assert_true(dir >= 0);
+    int listed = 0;
+    while (sys_readdir(dir, &entry) > 0) {
+        listed += entry.name[0] != '.' && atoi(entry.name) % 2 == 1;
+    }
+    assert_int_equal(sys_closedir(dir), KORA_SUCCESS);
+    assert_int_equal(listed, count / 2);
+}
+
+static void test_memfs_links(void **state) {
+    (void)state;
+    char buf[64];
+    kora_stat_t st;
+
+    write_file(MNT "/a", "data");
+    assert_int_equal(sys_link(MNT "/a", MNT "/b"), 0);
+    assert_int_equal(sys_link(MNT "/a", MNT "/b"), -EEXIST);
+    assert_int_equal(sys_mkdir(MNT "/dir"), KORA_SUCCESS);
+    assert_int_equal(sys_link(MNT "/dir", MNT "/dir2"), -EPERM);
+
+    /* Relative and absolute symlinks, the latter naming a path in the mount */
+    assert_int_equal(sys_symlink("a", MNT "/rel"), KORA_SUCCESS);
+    assert_int_equal(sys_symlink(MNT "/dir", MNT "/abs"), KORA_SUCCESS);
+    assert_int_equal(sys_symlink("/elsewhere", MNT "/out"), KORA_SUCCESS);
+    assert_int_equal(sys_readlink(MNT "/rel", buf, sizeof(buf)), 1);
+    assert_string_equal(buf, "a");
+    assert_int_equal(sys_readlink(MNT "/abs", buf, 5), 4);
+    assert_string_equal(buf, "/kor");
+    assert_int_equal(sys_readlink(MNT "/a", buf, sizeof(buf)), KORA_ERROR);
+    assert_int_equal(errno, EINVAL);
+    assert_file(MNT "/rel", "data");
+    write_file(MNT "/abs/inside", "in");
+    assert_file(MNT "/dir/inside", "in");
+    assert_int_equal(sys_stat(MNT "/out", &st), -ENOENT);
+
+    uint8_t type = 0;
+    assert_int_equal(sys_exists(MNT "/out", &type), 1);
+    assert_int_equal(type, KORA_FILE_TYPE_SYMLINK);
+    assert_int_equal(sys_lstat(MNT "/abs", &st), 0);
+    assert_true(S_ISLNK(st.mode));
+    assert_int_equal(sys_stat(MNT "/abs", &st), 0);
+    assert_true(S_ISDIR(st.mode));
+
+    assert_int_equal(sys_symlink("loop2", MNT "/loop1"), KORA_SUCCESS);
+    assert_int_equal(sys_symlink("loop1", MNT "/loop2"), KORA_SUCCESS);
+    assert_int_equal(sys_stat(MNT "/loop1", &st), -ELOOP);
+
+    /* Hard links share data and identity */
+    kora_file_info_t ia, ib;
+    assert_int_equal(sys_get_file_info(MNT "/a", &ia), 0);
+    assert_int_equal(sys_get_file_info(MNT "/b", &ib), 0);
+    assert_int_equal(ia.starting_cluster, ib.starting_cluster);
+    assert_int_equal(ib.size, 4);
+
+    /* An unlinked file stays readable through an open descriptor */
+    int fd = sys_open(MNT "/a", KORA_O_RDONLY);
+    assert_true(fd >= 0);
+    assert_int_equal(sys_unlink(MNT "/a"), 0);
+    assert_int_equal(sys_unlink(MNT "/b"), 0);
+    assert_int_equal(sys_exists(MNT "/a", NULL), 0);
+    assert_int_equal(sys_read(fd, buf, sizeof(buf)), 4);
+    assert_int_equal(sys_get_fd_info(fd, &ia), 0);
+    assert_int_equal(ia.starting_cluster, ib.starting_cluster);
+    assert_int_equal(sys_close(fd), KORA_SUCCESS);
+}
+
+static void test_memfs_rename(void **state) {
+    (void)state;
+    kora_stat_t st;
+
+    write_file(MNT "/x", "x");
+    write_file(MNT "/y", "y");
+    assert_int_equal(sys_rename(MNT "/x", MNT "/y"), 0);
+    assert_file(MNT "/y", "x");
+    assert_int_equal(sys_stat(MNT "/x", &st), -ENOENT);
+
+    assert_int_equal(sys_mkdir(MNT "/p"), KORA_SUCCESS);
+    assert_int_equal(sys_mkdir(MNT "/p/q"), KORA_SUCCESS);
+    assert_int_equal(sys_rename(MNT "/p", MNT "/p/q/r"), -EINVAL);
+    assert_int_equal(sys_rename(MNT "/y", MNT "/p/q"), -EISDIR);
+    assert_int_equal(sys_rename(MNT "/p", MNT "/y"), -ENOTDIR);
+    assert_int_equal(sys_rename(MNT "/p/q", MNT "/q"), 0);
+    assert_int_equal(sys_rename(MNT "/y", MNT "/q/y"), 0);
+    assert_file(MNT "/p/../q/y", "x");
+
+    /* Names cannot move between the mount and the host */
+    assert_int_equal(sys_rename(MNT "/q/y", "/tmp/kora-memfs-y"), -EXDEV);
+    assert_int_equal(sys_link(MNT "/q/y", "/tmp/kora-memfs-y"), -EXDEV);
+
+    assert_int_equal(sys_utime(MNT "/q/y", 1234567), 0);
+    assert_int_equal(sys_stat(MNT "/q/y", &st), 0);
+    assert_int_equal(st.mtime, 1234567);
+}
+
+static void test_memfs_host(void **state) {
+    (void)state;
+    char path[64];
+
+    /* Host paths and descriptors work alongside the mount */
+    snprintf(path, sizeof(path), "/tmp/kora-memfs-%d", (int)getpid());
+    write_file(path, "host");
+    assert_file(path, "host");
+    write_file(MNT "/m", "mem");
+    assert_int_equal(sys_unlink(path), 0);
+    assert_int_equal(sys_exists(path, NULL), 0);
+    assert_file(MNT "/m", "mem");
+
+    /* Contents go with the mount */
+    assert_int_equal(kora_memfs_unmount(MNT), KORA_SUCCESS);
+    assert_int_equal(sys_exists(MNT "/m", NULL), 0);
+    assert_int_equal(kora_memfs_mount(MNT), KORA_SUCCESS);
+    assert_int_equal(sys_exists(MNT "/m", NULL), 0);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_memfs_mount, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_memfs_read_write, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_memfs_large, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_memfs_directories, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_memfs_many_entries, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_memfs_links, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_memfs_rename, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_memfs_host, setup, teardown),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
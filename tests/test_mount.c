@@ -0,0 +1,214 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <kora/syscalls.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MNT "/kora-mount-test"
+#define PREFIXES 96
+
+static char host_dir[64];
+
+static int setup(void **state) {
+    (void)state;
+    strcpy(host_dir, "/tmp/kora-mount-XXXXXX");
+    return mkdtemp(host_dir) != NULL ? 0 : -1;
+}
+
+static int teardown(void **state) {
+    char cmd[96];
+    (void)state;
+    snprintf(cmd, sizeof(cmd), "rm -rf %s", host_dir);
+    return system(cmd) == 0 ? 0 : -1;
+}
+
+static void write_file(const char *path, const char *data) {
+    int fd = sys_open(path, KORA_O_WRONLY | KORA_O_CREAT | KORA_O_TRUNC);
+    assert_true(fd >= 0);
+    assert_int_equal(sys_write(fd, data, strlen(data)), (int)strlen(data));
+    assert_int_equal(sys_close(fd), KORA_SUCCESS);
+}
+
+/* Prefixes under MNT built from the components "a", "b" and "ab", up to five deep */
+static void make_prefix(char *buf, size_t size, unsigned n) {
+    static const char *const parts[] = { "a", "b", "ab" };
+    int len = snprintf(buf, size, "%s", MNT);
+    do {
+        len += snprintf(buf + len, size - (size_t)len, "/%s", parts[n % 3]);
+        n /= 3;
+    } while (n > 0);
+}
+
+static void test_mount_routing(void **state) {
+    char prefix[PREFIXES][64], path[96];
+    (void)state;
+
+    /*
+     * Every prefix gets its own filesystem holding one marker file.
+     * Mounting in an order unrelated to the tree shape exercises splits
+     * and prefixes that end inside another prefix's label.
+     */
+    for (unsigned i = 0; i < PREFIXES; i++) {
+        make_prefix(prefix[i], sizeof(prefix[i]), (i * 37) % PREFIXES);
+        assert_int_equal(sys_mount(NULL, prefix[i], "memfs", 0, NULL), KORA_SUCCESS);
+        snprintf(path, sizeof(path), "%.63s/m%u", prefix[i], i);
+        write_file(path, "x");
+    }
+    for (unsigned i = 0; i < PREFIXES; i++) {
+        for (unsigned j = 0; j < PREFIXES; j++) {
+            snprintf(path, sizeof(path), "%.63s/m%u", prefix[i], j);
+            assert_int_equal(sys_exists(path, NULL), i == j);
+        }
+    }
+
+    /* Only whole components match: MNT "/abx" is not under MNT "/ab" */
+    assert_int_equal(sys_exists(MNT "/abx", NULL), 0);
+    assert_int_equal(sys_mkdir(MNT "/abx"), KORA_ERROR);
+
+    /* Unmounting a prefix uncovers the one above it */
+    for (unsigned i = 0; i < PREFIXES; i += 2) {
+        assert_int_equal(sys_umount(prefix[i]), KORA_SUCCESS);
+    }
+    for (unsigned i = 1; i < PREFIXES; i += 2) {
+        for (unsigned j = 1; j < PREFIXES; j += 2) {
+            snprintf(path, sizeof(path), "%.63s/m%u", prefix[i], j);
+            assert_int_equal(sys_exists(path, NULL), i == j);
+        }
+    }
+    for (unsigned i = 1; i < PREFIXES; i += 2) {
+        assert_int_equal(sys_umount(prefix[i]), KORA_SUCCESS);
+    }
+    assert_int_equal(sys_exists(MNT "/a/m1", NULL), 0);
+}
+
+static void test_mount_host(void **state) {
+    char path[128];
+    char buf[16] = {0};
+    kora_stat_t st;
+    (void)state;
+
+    /* Paths under the prefix reach the host directory, with host descriptors */
+    assert_int_equal(sys_mount(host_dir, MNT, "host", 0, NULL), KORA_SUCCESS);
+    int fd = sys_open(MNT "/file", KORA_O_WRONLY | KORA_O_CREAT);
+    assert_true(fd >= 0 && fd < (1 << 24));
+    int copy = sys_dup(fd);
+    assert_true(copy >= 0);
+    assert_int_equal(sys_write(copy, "host", 4), 4);
+    assert_int_equal(sys_close(copy), KORA_SUCCESS);
+    assert_int_equal(sys_close(fd), KORA_SUCCESS);
+    snprintf(path, sizeof(path), "%s/file", host_dir);
+    int hfd = open(path, O_RDONLY);
+    assert_true(hfd >= 0);
+    assert_int_equal(read(hfd, buf, sizeof(buf)), 4);
+    assert_string_equal(buf, "host");
+    close(hfd);
+
+    assert_int_equal(sys_mkdir(MNT "/dir"), KORA_SUCCESS);
+    assert_int_equal(sys_rename(MNT "/file", MNT "/dir/moved"), 0);
+    assert_int_equal(sys_stat(MNT "/dir/moved", &st), 0);
+    assert_int_equal(st.size, 4);
+    int dir = sys_opendir(MNT "/dir");
+    assert_true(dir >= 0);
+    assert_int_equal(sys_closedir(dir), KORA_SUCCESS);
+
+    /* Names move freely between a host mount and unmounted host paths */
+    snprintf(path, sizeof(path), "%s/outside", host_dir);
+    assert_int_equal(sys_rename(MNT "/dir/moved", path), 0);
+    assert_int_equal(sys_exists(MNT "/outside", NULL), 1);
+
+    /* An unmounted name reaches the host as given, where ".." follows a symlink */
+    char link[128];
+    snprintf(path, sizeof(path), "%s/dir/sub", host_dir);
+    assert_int_equal(mkdir(path, 0755), 0);
+    snprintf(link, sizeof(link), "%s/ln", host_dir);
+    assert_int_equal(symlink(path, link), 0);
+    snprintf(path, sizeof(path), "%s/ln/../back", host_dir);
+    assert_int_equal(sys_rename(MNT "/outside", path), 0);
+    assert_int_equal(sys_exists(MNT "/dir/back", NULL), 1);
+    assert_int_equal(sys_rename(path, MNT "/outside"), 0);
+    assert_int_equal(sys_exists(MNT "/outside", NULL), 1);
+
+    /* A host mount shows through a memory filesystem mounted above it */
+    assert_int_equal(sys_mount(NULL, MNT "-mem", "tmpfs", 0, NULL), KORA_SUCCESS);
+    assert_int_equal(sys_mount(host_dir, MNT "-mem/real", "bind", 0, NULL), KORA_SUCCESS);
+    assert_int_equal(sys_exists(MNT "-mem/real/outside", NULL), 1);
+    assert_int_equal(sys_exists(MNT "-mem/outside", NULL), 0);
+    assert_int_equal(sys_rename(MNT "-mem/real/outside", MNT "-mem/outside"), -EXDEV);
+    assert_int_equal(sys_umount(MNT "-mem/real"), KORA_SUCCESS);
+    assert_int_equal(sys_umount(MNT "-mem"), KORA_SUCCESS);
+
+    /* Read-only: lookups work, changes fail */
+    assert_int_equal(sys_umount(MNT), KORA_SUCCESS);
+    assert_int_equal(sys_mount(host_dir, MNT, "host", KORA_MOUNT_RDONLY, NULL), KORA_SUCCESS);
+    fd = sys_open(MNT "/outside", KORA_O_RDONLY);
+    assert_true(fd >= 0);
+    assert_int_equal(sys_close(fd), KORA_SUCCESS);
+    assert_int_equal(sys_open(MNT "/outside", KORA_O_RDWR), KORA_ERROR);
+    assert_int_equal(errno, EROFS);
+    assert_int_equal(sys_mkdir(MNT "/new"), KORA_ERROR);
+    assert_int_equal(errno, EROFS);
+    assert_int_equal(sys_unlink(MNT "/outside"), -EROFS);
+
+    /* ".." resolves before routing, so it cannot climb out of a mount */
+    snprintf(path, sizeof(path), "%s/dir", host_dir);
+    assert_int_equal(sys_mount(path, MNT "-rw", "host", 0, NULL), KORA_SUCCESS);
+    assert_int_equal(sys_exists(MNT "-rw/../outside", NULL), 0);
+    assert_int_equal(sys_exists(MNT "-rw/./../" MNT "/dir/../outside", NULL), 1);
+    assert_int_equal(sys_unlink(MNT "-rw/.." MNT "/outside"), -EROFS);
+    assert_int_equal(sys_mkdir(MNT "-rw/../" MNT "/new"), KORA_ERROR);
+    assert_int_equal(errno, EROFS);
+    assert_int_equal(sys_umount(MNT "-rw"), KORA_SUCCESS);
+    assert_int_equal(sys_umount(MNT), KORA_SUCCESS);
+}
+
+static void test_mount_errors(void **state) {
+    char path[128];
+    (void)state;
+
+    assert_int_equal(sys_umount(MNT), KORA_ERROR);
+    assert_int_equal(errno, EINVAL);
+    assert_int_equal(sys_mount(NULL, "relative", "memfs", 0, NULL), KORA_ERROR);
+    assert_int_equal(errno, EINVAL);
+    assert_int_equal(sys_mount(NULL, MNT, "memfs", KORA_MOUNT_RDONLY, NULL), KORA_ERROR);
+    assert_int_equal(errno, EINVAL);
+
+    snprintf(path, sizeof(path), "%s/missing", host_dir);
+    assert_int_equal(sys_mount(path, MNT, "host", 0, NULL), KORA_ERROR);
+    assert_int_equal(errno, ENOENT);
+    int fd = open(path, O_WRONLY | O_CREAT, 0644);
+    assert_true(fd >= 0);
+    close(fd);
+    assert_int_equal(sys_mount(path, MNT, "host", 0, NULL), KORA_ERROR);
+    assert_int_equal(errno, ENOTDIR);
+
+    /* One filesystem per prefix, and not while descriptors are open */
+    assert_int_equal(sys_mount(NULL, MNT, "memfs", 0, NULL), KORA_SUCCESS);
+    assert_int_equal(sys_mount(host_dir, MNT "/", "host", 0, NULL), KORA_ERROR);
+    assert_int_equal(errno, EBUSY);
+    fd = sys_open(MNT "/busy", KORA_O_WRONLY | KORA_O_CREAT);
+    assert_true(fd >= 0);
+    assert_int_equal(sys_umount(MNT), KORA_ERROR);
+    assert_int_equal(errno, EBUSY);
+    assert_int_equal(sys_close(fd), KORA_SUCCESS);
+    assert_int_equal(sys_umount(MNT "/"), KORA_SUCCESS);
+
+    /* Types the layer does not implement still go to the platform */
+    assert_int_equal(sys_mount("/dev/null", MNT, "ext4", 0, NULL), KORA_ERROR);
+    assert_int_equal(errno, ENOSYS);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_mount_routing, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_mount_host, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_mount_errors, setup, teardown),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
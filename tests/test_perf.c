@@ -0,0 +1,101 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <kora/perf.h>
+#include <kora/syscalls.h>
+#include <errno.h>
+
+static volatile uint64_t sink;
+
+static void spin(unsigned n) {
+    for (unsigned i = 0; i < n; i++) {
+        sink += i;
+    }
+}
+
+static kora_perf_counter_t *open_or_skip(const int *events, size_t count) {
+    kora_perf_counter_t *group = kora_perf_counter_open(events, count, 0);
+    if (group == NULL) {
+        /* Containers and VMs frequently expose no counters at all */
+        assert_true(errno == ENOTSUP || errno == ENOENT || errno == EACCES);
+    }
+    return group;
+}
+
+static void test_perf_invalid(void **state) {
+    (void)state;
+    int bad = 1000;
+    errno = 0;
+    assert_null(kora_perf_counter_open(&bad, 1, 0));
+    assert_true(errno == EINVAL || errno == ENOTSUP);
+    errno = 0;
+    assert_null(kora_perf_counter_open(&bad, 0, 0));
+    assert_true(errno == EINVAL || errno == ENOTSUP);
+}
+
+static void test_perf_software_group(void **state) {
+    (void)state;
+    int events[] = { KORA_PERF_TASK_CLOCK, KORA_PERF_PAGE_FAULTS };
+    kora_perf_counter_t *group = open_or_skip(events, 2);
+    if (!group) {
+        skip();
+    }
+
+    kora_perf_values_t before;
+    assert_int_equal(kora_perf_counter_read(group, &before), KORA_SUCCESS);
+    assert_int_equal(before.count, 2);
+    assert_int_equal(before.raw[0], 0);
+
+    assert_int_equal(kora_perf_counter_enable(group), KORA_SUCCESS);
+    spin(1000000);
+    assert_int_equal(kora_perf_counter_disable(group), KORA_SUCCESS);
+
+    kora_perf_values_t after;
+    assert_int_equal(kora_perf_counter_read(group, &after), KORA_SUCCESS);
+    assert_true(after.raw[0] > 0);
+    assert_true(after.time_enabled_ns > 0);
+    assert_true(after.scaled[0] >= after.raw[0]);
+
+    /* Disabled counters hold still */
+    spin(100000);
+    kora_perf_values_t held;
+    assert_int_equal(kora_perf_counter_read(group, &held), KORA_SUCCESS);
+    assert_int_equal(held.raw[0], after.raw[0]);
+
+    assert_int_equal(kora_perf_counter_reset(group), KORA_SUCCESS);
+    assert_int_equal(kora_perf_counter_read(group, &held), KORA_SUCCESS);
+    assert_int_equal(held.raw[0], 0);
+    kora_perf_counter_close(group);
+}
+
+static void test_perf_hardware_group(void **state) {
+    (void)state;
+    int events[] = { KORA_PERF_CYCLES, KORA_PERF_INSTRUCTIONS, KORA_PERF_BRANCH_MISSES };
+    kora_perf_counter_t *group = open_or_skip(events, 3);
+    if (!group) {
+        skip();
+    }
+
+    assert_int_equal(kora_perf_counter_enable(group), KORA_SUCCESS);
+    spin(1000000);
+    assert_int_equal(kora_perf_counter_disable(group), KORA_SUCCESS);
+
+    kora_perf_values_t values;
+    assert_int_equal(kora_perf_counter_read(group, &values), KORA_SUCCESS);
+    assert_int_equal(values.count, 3);
+    if (values.time_running_ns > 0) {
+        assert_true(values.raw[1] >= 1000000);
+        assert_true(values.scaled[1] >= values.raw[1]);
+    }
+    kora_perf_counter_close(group);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_perf_invalid),
+        cmocka_unit_test(test_perf_software_group),
+        cmocka_unit_test(test_perf_hardware_group),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
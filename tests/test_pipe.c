@@ -4,6 +4,9 @@
 #include <cmocka.h>
 #include <kora/syscalls.h>
 #include <string.h>
+#include <fcntl.h>
+
+#define SPLICE_FILE "/tmp/kora_test_splice.dat"
 
 static void test_pipe_rw(void **state) {
     (void)state;
@@ -21,9 +24,104 @@ static void test_pipe_rw(void **state) {
     sys_close(fds[1]);
 }
 
+static void test_pipe2_flags(void **state) {
+    (void)state;
+    int fds[2];
+
+    assert_int_equal(sys_pipe2(fds, 0), 0);
+    assert_false(fcntl(fds[0], F_GETFL) & O_NONBLOCK);
+    assert_false(fcntl(fds[1], F_GETFD) & FD_CLOEXEC);
+    sys_close(fds[0]);
+    sys_close(fds[1]);
+
+    assert_int_equal(sys_pipe2(fds, KORA_PIPE_NONBLOCK | KORA_PIPE_CLOEXEC), 0);
+    assert_true(fcntl(fds[0], F_GETFL) & O_NONBLOCK);
+    assert_true(fcntl(fds[1], F_GETFL) & O_NONBLOCK);
+    assert_true(fcntl(fds[0], F_GETFD) & FD_CLOEXEC);
+    assert_true(fcntl(fds[1], F_GETFD) & FD_CLOEXEC);
+
+    /* Empty non-blocking pipe must not block */
+    char c;
+    assert_int_equal(sys_read(fds[0], &c, 1), KORA_ERROR);
+    sys_close(fds[0]);
+    sys_close(fds[1]);
+}
+
+static void test_pipe_size(void **state) {
+    (void)state;
+    int fds[2];
+    assert_int_equal(sys_pipe2(fds, 0), 0);
+
+    int size = sys_pipe_size(fds[0], 0);
+    assert_true(size > 0);
+    assert_true(sys_pipe_size(fds[1], 256 * 1024) >= 256 * 1024);
+    assert_true(sys_pipe_size(fds[0], 0) >= 256 * 1024);
+
+    sys_close(fds[0]);
+    sys_close(fds[1]);
+}
+
+static void test_splice_file_roundtrip(void **state) {
+    (void)state;
+    const char *msg = "spliced through a pipe";
+    size_t len = strlen(msg);
+    int fds[2];
+    assert_int_equal(sys_pipe2(fds, 0), 0);
+
+    int fd = sys_open(SPLICE_FILE, KORA_O_CREAT | KORA_O_RDWR | KORA_O_TRUNC);
+    assert_true(fd >= 0);
+
+    /* Pipe to file at an explicit offset */
+    assert_int_equal(sys_write(fds[1], msg, len), (int)len);
+    int64_t off = 0;
+    assert_int_equal(sys_splice(fds[0], NULL, fd, &off, len, 0), (long)len);
+    assert_int_equal(off, (int64_t)len);
+
+    /* File back into the pipe */
+    off = 0;
+    assert_int_equal(sys_splice(fd, &off, fds[1], NULL, len, KORA_SPLICE_MOVE), (long)len);
+
+    char buf[64] = {0};
+    assert_int_equal(sys_read(fds[0], buf, sizeof(buf)), (int)len);
+    assert_string_equal(buf, msg);
+
+    sys_close(fd);
+    sys_unlink(SPLICE_FILE);
+    sys_close(fds[0]);
+    sys_close(fds[1]);
+}
+
+static void test_tee_duplicates(void **state) {
+    (void)state;
+    int a[2], b[2];
+    assert_int_equal(sys_pipe2(a, 0), 0);
+    assert_int_equal(sys_pipe2(b, 0), 0);
+
+    assert_int_equal(sys_write(a[1], "tee", 3), 3);
+    assert_int_equal(sys_tee(a[0], b[1], 3, 0), 3);
+
+    char buf[4] = {0};
+    assert_int_equal(sys_read(b[0], buf, 3), 3);
+    assert_string_equal(buf, "tee");
+
+    /* The source still holds its data */
+    memset(buf, 0, sizeof(buf));
+    assert_int_equal(sys_read(a[0], buf, 3), 3);
+    assert_string_equal(buf, "tee");
+
+    sys_close(a[0]);
+    sys_close(a[1]);
+    sys_close(b[0]);
+    sys_close(b[1]);
+}
+
 int main(void) {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_pipe_rw),
+        cmocka_unit_test(test_pipe2_flags),
+        cmocka_unit_test(test_pipe_size),
+        cmocka_unit_test(test_splice_file_roundtrip),
+        cmocka_unit_test(test_tee_duplicates),
     };
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
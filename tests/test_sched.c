@@ -4,6 +4,8 @@
 #include <cmocka.h>
 #include <kora/syscalls.h>
 #include <unistd.h>
+#include <errno.h>
+#include <sys/wait.h>
 
 static void test_getpid_getppid(void **state) {
     (void)state;
@@ -24,11 +26,141 @@ static void test_setpriority_call(void **state) {
     assert_int_equal(ret, 0);
 }
 
+static void test_affinity_roundtrip(void **state) {
+    (void)state;
+    kora_cpuset_t orig;
+    kora_cpuset_t set;
+    assert_int_equal(sys_sched_getaffinity(0, &orig), 0);
+
+    int first = -1;
+    for (int cpu = 0; cpu < KORA_CPUSET_SIZE && first < 0; cpu++) {
+        if (KORA_CPU_ISSET(cpu, &orig)) {
+            first = cpu;
+        }
+    }
+    assert_true(first >= 0);
+
+    KORA_CPU_ZERO(&set);
+    KORA_CPU_SET(first, &set);
+    if (sys_sched_setaffinity(0, &set) != 0) {
+        skip();
+    }
+
+    unsigned cpu = 0;
+    unsigned node = 0;
+    assert_int_equal(sys_getcpu(&cpu, &node), 0);
+    assert_int_equal(cpu, first);
+
+    assert_int_equal(sys_sched_getaffinity(0, &set), 0);
+    assert_true(KORA_CPU_ISSET(first, &set));
+    assert_int_equal(sys_sched_setaffinity(0, &orig), 0);
+}
+
+static void test_cpu_topology(void **state) {
+    (void)state;
+    kora_cpu_topology_t topo;
+    kora_cpu_info_t cpus[KORA_CPUSET_SIZE];
+    int n = sys_cpu_topology(&topo, cpus, KORA_CPUSET_SIZE);
+    assert_true(n > 0);
+    assert_int_equal((unsigned)n, topo.logical_cpus);
+    assert_true(topo.physical_cores >= 1);
+    assert_true(topo.physical_cores <= topo.logical_cpus);
+    assert_true(topo.packages >= 1);
+    assert_true(topo.numa_nodes >= 1);
+    assert_true(topo.threads_per_core >= 1);
+    assert_true(topo.cache_line >= 16);
+
+    /* Exactly one first sibling per core */
+    unsigned firsts = 0;
+    for (int i = 0; i < n; i++) {
+        assert_true(cpus[i].core < topo.physical_cores);
+        assert_true(cpus[i].smt_index < topo.threads_per_core);
+        if (cpus[i].smt_index == 0) {
+            firsts++;
+        }
+    }
+    assert_int_equal(firsts, topo.physical_cores);
+
+    /* Counts only */
+    assert_int_equal(sys_cpu_topology(&topo, NULL, 0), 0);
+}
+
+static void test_gettid(void **state) {
+    (void)state;
+    assert_true(sys_gettid() > 0);
+}
+
+static void test_sched_policy_batch(void **state) {
+    (void)state;
+    int prio = -1;
+    assert_int_equal(sys_sched_setpolicy(0, KORA_SCHED_BATCH, 0), 0);
+    assert_int_equal(sys_sched_getpolicy(sys_gettid(), &prio), KORA_SCHED_BATCH);
+    assert_int_equal(prio, 0);
+    assert_int_equal(sys_sched_setpolicy(0, KORA_SCHED_OTHER, 0), 0);
+    assert_int_equal(sys_sched_getpolicy(0, NULL), KORA_SCHED_OTHER);
+}
+
+static void test_sched_policy_realtime(void **state) {
+    (void)state;
+    int prio = 0;
+    if (sys_sched_setpolicy(0, KORA_SCHED_FIFO, 1) != 0) {
+        assert_true(errno == EPERM || errno == ENOTSUP);
+        skip();
+    }
+    assert_int_equal(sys_sched_getpolicy(0, &prio), KORA_SCHED_FIFO);
+    assert_int_equal(prio, 1);
+    assert_int_equal(sys_sched_setpolicy(0, KORA_SCHED_OTHER, 0), 0);
+}
+
+static void test_sched_policy_invalid(void **state) {
+    (void)state;
+    errno = 0;
+    assert_int_equal(sys_sched_setpolicy(0, 42, 0), -1);
+    assert_int_equal(errno, EINVAL);
+}
+
+static void test_ioprio(void **state) {
+    (void)state;
+    int level = -1;
+    if (sys_ioprio_set(0, KORA_IOPRIO_CLASS_BE, 7) != 0) {
+        assert_true(errno == ENOTSUP || errno == ENOSYS);
+        skip();
+    }
+    int cls = sys_ioprio_get(0, &level);
+    assert_int_equal(cls, KORA_IOPRIO_CLASS_BE);
+#if defined(__linux__)
+    assert_int_equal(level, 7);
+#endif
+
+    /* Dropping to idle is one-way for unprivileged callers; do it in a child */
+    pid_t pid = fork();
+    assert_true(pid >= 0);
+    if (pid == 0) {
+        if (sys_ioprio_set(0, KORA_IOPRIO_CLASS_IDLE, 0) != 0) {
+            _exit(1);
+        }
+        _exit(sys_ioprio_get(0, NULL) == KORA_IOPRIO_CLASS_IDLE ? 0 : 2);
+    }
+    int status = 0;
+    assert_int_equal(sys_wait(pid, &status, 0), pid);
+    assert_true(WIFEXITED(status));
+    assert_int_equal(WEXITSTATUS(status), 0);
+
+    assert_int_equal(sys_ioprio_set(0, KORA_IOPRIO_CLASS_NONE, 0), 0);
+}
+
 int main(void) {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_getpid_getppid),
         cmocka_unit_test(test_yield_call),
         cmocka_unit_test(test_setpriority_call),
+        cmocka_unit_test(test_affinity_roundtrip),
+        cmocka_unit_test(test_cpu_topology),
+        cmocka_unit_test(test_gettid),
+        cmocka_unit_test(test_sched_policy_batch),
+        cmocka_unit_test(test_sched_policy_realtime),
+        cmocka_unit_test(test_sched_policy_invalid),
+        cmocka_unit_test(test_ioprio),
     };
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
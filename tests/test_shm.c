@@ -0,0 +1,150 @@
+/**
+ * Shared memory object test for KoraLayer using CMocka
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <kora/syscalls.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#define SHM_NAME "/kora_test_shm"
+#define SHM_SIZE (1024 * 1024)
+
+static void test_shm_anonymous_map(void **state) {
+    (void)state;
+    int fd = sys_shm_create(NULL, SHM_SIZE, 0);
+    assert_true(fd >= 0);
+
+    char *a = sys_mmap(NULL, SHM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    char *b = sys_mmap(NULL, SHM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    assert_ptr_not_equal(a, (void *)-1);
+    assert_ptr_not_equal(b, (void *)-1);
+
+    /* Both mappings see the same pages */
+    strcpy(a + SHM_SIZE - 64, "zero-copy");
+    assert_string_equal(b + SHM_SIZE - 64, "zero-copy");
+
+    kora_stat_t st;
+    assert_int_equal(sys_fstat(fd, &st), 0);
+    assert_int_equal(st.size, SHM_SIZE);
+
+    sys_munmap(a, SHM_SIZE);
+    sys_munmap(b, SHM_SIZE);
+    sys_close(fd);
+}
+
+static void test_shm_named_open_unlink(void **state) {
+    (void)state;
+    sys_shm_unlink(SHM_NAME);
+
+    int fd = sys_shm_create(SHM_NAME, 4096, KORA_SHM_EXCL);
+    assert_true(fd >= 0);
+    assert_int_equal(sys_shm_create(SHM_NAME, 4096, KORA_SHM_EXCL), -1);
+    assert_int_equal(errno, EEXIST);
+
+    char *w = sys_mmap(NULL, 4096, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    assert_ptr_not_equal(w, (void *)-1);
+    strcpy(w, "named");
+
+    int rfd = sys_shm_open(SHM_NAME, KORA_SHM_RDONLY);
+    assert_true(rfd >= 0);
+    char *r = sys_mmap(NULL, 4096, PROT_READ, MAP_SHARED, rfd, 0);
+    assert_ptr_not_equal(r, (void *)-1);
+    assert_string_equal(r, "named");
+
+    assert_int_equal(sys_shm_unlink(SHM_NAME), 0);
+    assert_int_equal(sys_shm_open(SHM_NAME, 0), -1);
+
+    /* Mappings outlive the name */
+    assert_string_equal(r, "named");
+
+    sys_munmap(w, 4096);
+    sys_munmap(r, 4096);
+    sys_close(fd);
+    sys_close(rfd);
+}
+
+static void test_shm_failed_create_leaves_no_name(void **state) {
+    (void)state;
+    sys_shm_unlink(SHM_NAME);
+
+    /* Too large for off_t, so sizing the new object fails */
+    assert_int_equal(sys_shm_create(SHM_NAME, UINT64_MAX, KORA_SHM_EXCL), -1);
+    assert_int_equal(sys_shm_open(SHM_NAME, 0), -1);
+
+    int fd = sys_shm_create(SHM_NAME, 4096, KORA_SHM_EXCL);
+    assert_true(fd >= 0);
+
+    /* An object that was already there is left in place */
+    assert_int_equal(sys_shm_create(SHM_NAME, UINT64_MAX, 0), -1);
+    int again = sys_shm_open(SHM_NAME, 0);
+    assert_true(again >= 0);
+
+    sys_close(again);
+    sys_close(fd);
+    sys_shm_unlink(SHM_NAME);
+}
+
+static void test_shm_inherited_by_spawn(void **state) {
+    (void)state;
+    int fd = sys_shm_create(NULL, 4096, 0);
+    assert_true(fd >= 0 && fd < 10);
+
+    char *mem = sys_mmap(NULL, 4096, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    assert_ptr_not_equal(mem, (void *)-1);
+
+    /* The child writes through the inherited descriptor */
+    char script[64];
+    snprintf(script, sizeof(script), "printf child >&%d", fd);
+    char *argv[] = {"/bin/sh", "-c", script, NULL};
+    pid_t pid = sys_spawn("/bin/sh", argv, NULL);
+    assert_true(pid > 0);
+
+    int status = 0;
+    assert_int_equal(sys_wait(pid, &status, 0), pid);
+    assert_true(WIFEXITED(status));
+    assert_int_equal(WEXITSTATUS(status), 0);
+    assert_memory_equal(mem, "child", 5);
+
+    sys_munmap(mem, 4096);
+    sys_close(fd);
+}
+
+static void test_shm_seal_write(void **state) {
+    (void)state;
+    int fd = sys_shm_create(NULL, 4096, KORA_SHM_SEALABLE);
+    assert_true(fd >= 0);
+
+    if (sys_shm_seal(fd, KORA_SHM_SEAL_WRITE | KORA_SHM_SEAL_SEAL) != 0) {
+        assert_int_equal(errno, ENOTSUP);
+        sys_close(fd);
+        skip();
+    }
+
+    void *mem = sys_mmap(NULL, 4096, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    assert_ptr_equal(mem, (void *)-1);
+    assert_int_equal(sys_write(fd, "x", 1), KORA_ERROR);
+
+    mem = sys_mmap(NULL, 4096, PROT_READ, MAP_SHARED, fd, 0);
+    assert_ptr_not_equal(mem, (void *)-1);
+    sys_munmap(mem, 4096);
+    sys_close(fd);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_shm_anonymous_map),
+        cmocka_unit_test(test_shm_named_open_unlink),
+        cmocka_unit_test(test_shm_failed_create_leaves_no_name),
+        cmocka_unit_test(test_shm_inherited_by_spawn),
+        cmocka_unit_test(test_shm_seal_write),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
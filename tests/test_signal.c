@@ -4,6 +4,10 @@
 #include <cmocka.h>
 #include <kora/syscalls.h>
 #include <signal.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/select.h>
 
 static volatile int handled = 0;
 
@@ -43,10 +47,77 @@ static void test_signal_interrupt_sleep(void **state) {
     assert_true(alarmed);
 }
 
+static volatile pid_t info_pid = 0;
+
+static void siginfo_handler(int signo, siginfo_t *info, void *ctx) {
+    (void)signo; (void)ctx;
+    info_pid = info->si_pid;
+}
+
+static void test_sigaction_siginfo(void **state) {
+    (void)state;
+    struct sigaction act;
+    struct sigaction old;
+    memset(&act, 0, sizeof(act));
+    act.sa_sigaction = siginfo_handler;
+    act.sa_flags = SA_SIGINFO;
+    sigemptyset(&act.sa_mask);
+
+    info_pid = 0;
+    assert_int_equal(sys_sigaction(SIGUSR2, &act, &old), 0);
+    assert_int_equal(sys_kill(sys_getpid(), SIGUSR2), 0);
+    struct timespec ts = {0, 1000000};
+    sys_nanosleep(&ts, NULL);
+    assert_int_equal(info_pid, sys_getpid());
+    assert_int_equal(sys_sigaction(SIGUSR2, &old, NULL), 0);
+}
+
+static void test_signalfd_batch(void **state) {
+    (void)state;
+    sigset_t mask;
+    sigset_t old;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGUSR1);
+    sigaddset(&mask, SIGUSR2);
+    assert_int_equal(sys_sigprocmask(SIG_BLOCK, &mask, &old), 0);
+
+    int fd = sys_signalfd(&mask, KORA_SIGNALFD_NONBLOCK | KORA_SIGNALFD_CLOEXEC);
+    assert_true(fd >= 0);
+
+    kora_siginfo_t info[4];
+    errno = 0;
+    assert_int_equal(sys_signalfd_read(fd, info, 4), -1);
+    assert_int_equal(errno, EAGAIN);
+
+    assert_int_equal(sys_kill(sys_getpid(), SIGUSR1), 0);
+    assert_int_equal(sys_kill(sys_getpid(), SIGUSR2), 0);
+
+    fd_set rfds;
+    FD_ZERO(&rfds);
+    FD_SET(fd, &rfds);
+    struct timeval tv = {1, 0};
+    assert_int_equal(sys_select(fd + 1, &rfds, NULL, NULL, &tv), 1);
+
+    int n = sys_signalfd_read(fd, info, 4);
+    assert_int_equal(n, 2);
+    int seen1 = 0;
+    int seen2 = 0;
+    for (int i = 0; i < n; i++) {
+        seen1 |= info[i].signo == SIGUSR1;
+        seen2 |= info[i].signo == SIGUSR2;
+    }
+    assert_true(seen1 && seen2);
+
+    close(fd);
+    assert_int_equal(sys_sigprocmask(SIG_SETMASK, &old, NULL), 0);
+}
+
 int main(void) {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_signal_send),
         cmocka_unit_test(test_signal_interrupt_sleep),
+        cmocka_unit_test(test_sigaction_siginfo),
+        cmocka_unit_test(test_signalfd_batch),
     };
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
@@ -19,9 +19,44 @@ static void test_spawn_wait(void **state) {
     assert_int_equal(WEXITSTATUS(status), 0);
 }
 
+static void test_spawn_wait4_rusage(void **state) {
+    (void)state;
+    /* Burn some CPU in the child so its accounting is non-zero */
+    char *argv[] = {"/bin/sh", "-c",
+                    "i=0; while [ $i -lt 50000 ]; do i=$((i+1)); done", NULL};
+    char *envp[] = {NULL};
+    pid_t pid = sys_spawn("/bin/sh", argv, envp);
+    assert_true(pid > 0);
+
+    int status = 0;
+    kora_rusage_t usage;
+    assert_int_equal(sys_wait4(pid, &status, 0, &usage), pid);
+    assert_true(WIFEXITED(status));
+    assert_true(usage.utime_ns + usage.stime_ns > 0);
+    assert_true(usage.maxrss_kb > 0);
+
+    kora_rusage_t children;
+    assert_int_equal(sys_getrusage(KORA_RUSAGE_CHILDREN, &children), 0);
+    assert_true(children.utime_ns + children.stime_ns >= usage.utime_ns + usage.stime_ns);
+}
+
+static void test_getrusage_self(void **state) {
+    (void)state;
+    kora_rusage_t self;
+    kora_rusage_t thread;
+    /* Thread first: the process total taken afterwards can only be larger */
+    assert_int_equal(sys_getrusage(KORA_RUSAGE_THREAD, &thread), 0);
+    assert_int_equal(sys_getrusage(KORA_RUSAGE_SELF, &self), 0);
+    assert_true(self.maxrss_kb > 0);
+    assert_true(thread.utime_ns <= self.utime_ns);
+    assert_int_equal(sys_getrusage(42, &self), -1);
+}
+
 int main(void) {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_spawn_wait),
+        cmocka_unit_test(test_spawn_wait4_rusage),
+        cmocka_unit_test(test_getrusage_self),
     };
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
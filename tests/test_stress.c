@@ -0,0 +1,209 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <kora/error.h>
+#include <kora/syscalls.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Many threads at once on calls that keep state in the layer */
+#define THREADS 32
+#define ROUNDS 200
+#define ENTRIES 8
+
+static char dir[64];
+static char list[96];
+static char mnt[96];
+static char churn[96];
+static atomic_int churning;
+static pthread_barrier_t barrier;
+
+static int setup(void **state) {
+    char path[128];
+    (void)state;
+
+    strcpy(dir, "/tmp/kora-stress-XXXXXX");
+    if (mkdtemp(dir) == NULL) {
+        return -1;
+    }
+    snprintf(list, sizeof(list), "%s/list", dir);
+    snprintf(mnt, sizeof(mnt), "%s/mnt", dir);
+    snprintf(churn, sizeof(churn), "%s/churn", dir);
+    if (sys_mkdir(list) != KORA_SUCCESS) {
+        return -1;
+    }
+    for (int i = 0; i < ENTRIES; i++) {
+        snprintf(path, sizeof(path), "%s/e%d", list, i);
+        int fd = sys_open(path, KORA_O_WRONLY | KORA_O_CREAT);
+        if (fd < 0) {
+            return -1;
+        }
+        sys_close(fd);
+    }
+    return sys_mount(NULL, mnt, "memfs", 0, NULL);
+}
+
+static int teardown(void **state) {
+    char cmd[96];
+    (void)state;
+    sys_umount(mnt);
+    snprintf(cmd, sizeof(cmd), "rm -rf %s", dir);
+    return system(cmd) == 0 ? 0 : -1;
+}
+
+/* Runs body on THREADS threads released together; returns the failures */
+static int run_threads(void *(*body)(void *)) {
+    pthread_t threads[THREADS];
+    void *failed;
+    int failures = 0;
+
+    pthread_barrier_init(&barrier, NULL, THREADS);
+    for (uintptr_t i = 0; i < THREADS; i++) {
+        assert_int_equal(pthread_create(&threads[i], NULL, body, (void *)i), 0);
+    }
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(threads[i], &failed);
+        failures += (int)(uintptr_t)failed;
+    }
+    pthread_barrier_destroy(&barrier);
+    return failures;
+}
+
+static int list_entries(int d) {
+    kora_dirent_t entry;
+    int n = 0;
+
+    while (sys_readdir(d, &entry) == 1) {
+        n += entry.name[0] == 'e';
+    }
+    return n;
+}
+
+/* Every thread lists the same directory, each through its own handle */
+static void *list_body(void *arg) {
+    uintptr_t failures = 0;
+    (void)arg;
+
+    /* First with all THREADS handles open at once */
+    int d = sys_opendir(list);
+    pthread_barrier_wait(&barrier);
+    failures += d < 0 || list_entries(d) != ENTRIES;
+    pthread_barrier_wait(&barrier);
+    failures += d >= 0 && sys_closedir(d) != KORA_SUCCESS;
+
+    for (int i = 0; i < ROUNDS; i++) {
+        if ((d = sys_opendir(list)) < 0) {
+            failures++;
+            continue;
+        }
+        failures += list_entries(d) != ENTRIES;
+        failures += sys_closedir(d) != KORA_SUCCESS;
+    }
+    return (void *)failures;
+}
+
+static void test_stress_opendir(void **state) {
+    (void)state;
+    assert_int_equal(run_threads(list_body), 0);
+}
+
+/* Each thread reads back what it wrote, on the host and in memfs */
+static void *io_body(void *arg) {
+    uintptr_t id = (uintptr_t)arg, failures = 0;
+    char path[128], buf[64], back[64];
+
+    snprintf(path, sizeof(path), "%s/f%u", id % 2 ? mnt : dir, (unsigned)id);
+    memset(buf, 'a' + (int)id % 26, sizeof(buf));
+    pthread_barrier_wait(&barrier);
+    for (int i = 0; i < ROUNDS; i++) {
+        int fd = sys_open(path, KORA_O_RDWR | KORA_O_CREAT | KORA_O_TRUNC);
+        if (fd < 0) {
+            failures++;
+            continue;
+        }
+        failures += sys_write(fd, buf, sizeof(buf)) != sizeof(buf);
+        failures += sys_seek(fd, 0, KORA_SEEK_SET) != 0;
+        failures += sys_read(fd, back, sizeof(back)) != sizeof(back) ||
+                    memcmp(back, buf, sizeof(buf)) != 0;
+        failures += sys_close(fd) != KORA_SUCCESS;
+    }
+    return (void *)failures;
+}
+
+static void test_stress_file_io(void **state) {
+    (void)state;
+    assert_int_equal(run_threads(io_body), 0);
+}
+
+/* errno and kora_last_error stay with the thread that failed */
+static void *error_body(void *arg) {
+    uintptr_t id = (uintptr_t)arg, failures = 0;
+    char path[128];
+    int expect = id % 2 ? EBADF : ENOENT;
+
+    snprintf(path, sizeof(path), "%s/missing", dir);
+    pthread_barrier_wait(&barrier);
+    for (int i = 0; i < ROUNDS; i++) {
+        int r = id % 2 ? sys_close(-1) : sys_open(path, KORA_O_RDONLY);
+        kora_error_t e = kora_last_error();
+        failures += r != KORA_ERROR || errno != expect || e.host_errno != expect ||
+                    e.syscall != (id % 2 ? SYS_CLOSE : SYS_OPEN);
+    }
+    return (void *)failures;
+}
+
+static void test_stress_errors(void **state) {
+    (void)state;
+    assert_int_equal(run_threads(error_body), 0);
+}
+
+/* Thread 0 mounts and unmounts while the others make path calls under the prefix */
+static void *unmount_body(void *arg) {
+    uintptr_t id = (uintptr_t)arg, failures = 0;
+    char file[128], sub[128];
+    kora_stat_t st;
+
+    snprintf(file, sizeof(file), "%s/f", churn);
+    snprintf(sub, sizeof(sub), "%s/d", churn);
+    pthread_barrier_wait(&barrier);
+    if (id == 0) {
+        for (int i = 0; i < 10 * ROUNDS; i++) {
+            failures += sys_mount(NULL, churn, "memfs", 0, NULL) != KORA_SUCCESS;
+            failures += sys_umount(churn) != KORA_SUCCESS;
+        }
+        atomic_store(&churning, 0);
+        return (void *)failures;
+    }
+    /* None of these keeps a descriptor, which would make the unmount fail */
+    while (atomic_load(&churning)) {
+        /* Unmounted, the paths are under a missing host directory */
+        int r = sys_mkdir(sub);
+        failures += r != KORA_SUCCESS && errno != ENOENT;
+        failures += sys_open(file, KORA_O_RDONLY) != KORA_ERROR || errno != ENOENT;
+        r = sys_stat(sub, &st);
+        failures += r != 0 && r != -ENOENT;
+    }
+    return (void *)failures;
+}
+
+static void test_stress_unmount(void **state) {
+    (void)state;
+    atomic_store(&churning, 1);
+    assert_int_equal(run_threads(unmount_body), 0);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_stress_opendir, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_stress_file_io, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_stress_errors, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_stress_unmount, setup, teardown),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,223 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <kora/syscalls.h>
+#include <kora/error.h>
+#include <kora/trace.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static void *return_arg(void *arg) {
+    return arg;
+}
+
+static void test_thread_create_join(void **state) {
+    (void)state;
+    kora_thread_t threads[4];
+    for (intptr_t i = 0; i < 4; i++) {
+        assert_int_equal(sys_thread_create(&threads[i], NULL, return_arg, (void *)(i + 1)), 0);
+    }
+    for (intptr_t i = 0; i < 4; i++) {
+        void *ret = NULL;
+        assert_int_equal(sys_thread_join(threads[i], &ret), 0);
+        assert_int_equal((intptr_t)ret, i + 1);
+    }
+}
+
+static void *record_stack(void *arg) {
+    int local = 0;
+    *(uintptr_t *)arg = (uintptr_t)&local;
+    return NULL;
+}
+
+static void test_thread_caller_stack(void **state) {
+    (void)state;
+    size_t size = 256 * 1024;
+    void *stack = malloc(size);
+    assert_non_null(stack);
+
+    kora_thread_attr_t attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.stack = stack;
+    attr.stack_size = size;
+
+    uintptr_t where = 0;
+    kora_thread_t t;
+    assert_int_equal(sys_thread_create(&t, &attr, record_stack, &where), 0);
+    assert_int_equal(sys_thread_join(t, NULL), 0);
+    assert_true(where >= (uintptr_t)stack && where < (uintptr_t)stack + size);
+    free(stack);
+}
+
+static void *exit_early(void *arg) {
+    sys_thread_exit(arg);
+}
+
+static void test_thread_exit(void **state) {
+    (void)state;
+    kora_thread_t t;
+    void *ret = NULL;
+    assert_int_equal(sys_thread_create(&t, NULL, exit_early, (void *)0x5a), 0);
+    assert_int_equal(sys_thread_join(t, &ret), 0);
+    assert_ptr_equal(ret, (void *)0x5a);
+}
+
+static void *return_self(void *arg) {
+    (void)arg;
+    return sys_thread_self();
+}
+
+static void test_thread_self(void **state) {
+    (void)state;
+    kora_thread_t t;
+    void *ret = NULL;
+    assert_int_equal(sys_thread_create(&t, NULL, return_self, NULL), 0);
+    kora_thread_t handle = t;
+    assert_int_equal(sys_thread_join(t, &ret), 0);
+    assert_ptr_equal(ret, handle);
+
+    /* The main thread gets a stable handle too */
+    assert_non_null(sys_thread_self());
+    assert_ptr_equal(sys_thread_self(), sys_thread_self());
+}
+
+/* A thread the layer did not start gets a handle that cannot be joined */
+static void *foreign_self(void *arg) {
+    (void)arg;
+    kora_thread_t self = sys_thread_self();
+    intptr_t ok = self != NULL && self == sys_thread_self() &&
+                  sys_thread_join(self, NULL) == -1 && errno == EINVAL;
+    return (void *)ok;
+}
+
+static void test_thread_self_foreign(void **state) {
+    (void)state;
+    for (int i = 0; i < 64; i++) {
+        pthread_t p;
+        void *ret = NULL;
+        assert_int_equal(pthread_create(&p, NULL, foreign_self, NULL), 0);
+        assert_int_equal(pthread_join(p, &ret), 0);
+        assert_true((intptr_t)ret);
+    }
+}
+
+static void *fail_in_thread(void *arg) {
+    (void)arg;
+    intptr_t ok = sys_pipe_size(-1, 0) == -1 && kora_last_error().syscall == SYS_PIPE_SIZE;
+    return (void *)ok;
+}
+
+static void test_thread_error_state(void **state) {
+    (void)state;
+    kora_clear_error();
+    kora_thread_t t;
+    void *ret = NULL;
+    assert_int_equal(sys_thread_create(&t, NULL, fail_in_thread, NULL), 0);
+    assert_int_equal(sys_thread_join(t, &ret), 0);
+    assert_true((intptr_t)ret);
+    assert_int_equal(kora_last_error().syscall, 0);
+}
+
+#if defined(__linux__) && (defined(__x86_64__) || defined(__aarch64__)) && __GNUC__ >= 11
+static volatile uintptr_t raw_tp;
+
+static void *record_thread_pointer(void *arg) {
+    raw_tp = (uintptr_t)__builtin_thread_pointer();
+    return arg;
+}
+
+static void test_thread_raw_tls(void **state) {
+    (void)state;
+    size_t size = 64 * 1024;
+    void *stack = malloc(size);
+    void **tls = calloc(1, 4096);
+    assert_non_null(stack);
+    assert_non_null(tls);
+
+    /* The thread pointer addresses the TCB, whose first word points at itself */
+    void **tp = tls + 256;
+    tp[0] = tp;
+
+    kora_thread_attr_t attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.stack = stack;
+    attr.stack_size = size;
+    attr.tls = tp;
+
+    kora_thread_t t;
+    void *ret = NULL;
+    raw_tp = 0;
+    assert_int_equal(sys_thread_create(&t, &attr, record_thread_pointer, (void *)7), 0);
+    assert_int_equal(sys_thread_join(t, &ret), 0);
+    assert_int_equal((intptr_t)ret, 7);
+    assert_int_equal(raw_tp, (uintptr_t)tp);
+    free(tls);
+    free(stack);
+}
+
+/* Traced, a raw thread still reaches the host without touching host TLS */
+static void *exit_raw(void *arg) {
+    sys_thread_exit(sys_thread_self() != NULL ? arg : NULL);
+    return NULL;
+}
+
+static void test_thread_raw_traced(void **state) {
+    char path[] = "/tmp/kora-thread-trace-XXXXXX";
+    size_t size = 64 * 1024;
+    void *stack = malloc(size);
+    void **tls = calloc(1, 4096);
+    (void)state;
+    assert_non_null(stack);
+    assert_non_null(tls);
+    void **tp = tls + 256;
+    tp[0] = tp;
+
+    int fd = mkstemp(path);
+    assert_true(fd >= 0);
+    close(fd);
+    /* Hooks can be compiled out, which leaves the calls untraced */
+    int traced = kora_trace_start(path) == 0;
+    if (!traced) {
+        assert_int_equal(errno, ENOTSUP);
+    }
+
+    kora_thread_attr_t attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.stack = stack;
+    attr.stack_size = size;
+    attr.tls = tp;
+
+    kora_thread_t t;
+    void *ret = NULL;
+    assert_int_equal(sys_thread_create(&t, &attr, exit_raw, (void *)7), 0);
+    assert_int_equal(sys_thread_join(t, &ret), 0);
+    assert_int_equal((intptr_t)ret, 7);
+    if (traced) {
+        kora_trace_stop();
+    }
+    unlink(path);
+    free(tls);
+    free(stack);
+}
+#endif
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_thread_create_join),
+        cmocka_unit_test(test_thread_caller_stack),
+        cmocka_unit_test(test_thread_exit),
+        cmocka_unit_test(test_thread_self),
+        cmocka_unit_test(test_thread_self_foreign),
+        cmocka_unit_test(test_thread_error_state),
+#if defined(__linux__) && (defined(__x86_64__) || defined(__aarch64__)) && __GNUC__ >= 11
+        cmocka_unit_test(test_thread_raw_tls),
+        cmocka_unit_test(test_thread_raw_traced),
+#endif
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
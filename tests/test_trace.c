@@ -0,0 +1,315 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <kora/syscalls.h>
+#include <kora/trace.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TRACE_PATH "/tmp/kora_test_trace.bin"
+
+typedef struct {
+    uint32_t tid;
+    kora_trace_record_t rec;
+    uint64_t args[KORA_TRACE_MAX_ARGS];
+    kora_trace_payload_t payload;
+    char paths[2 * KORA_TRACE_MAX_PATH + 8];
+} parsed_record_t;
+
+typedef struct {
+    kora_trace_header_t header;
+    kora_trace_end_t end;
+    int ended;
+    size_t count;
+    parsed_record_t *records;
+} parsed_trace_t;
+
+static void parse_trace(const char *path, parsed_trace_t *out) {
+    FILE *f = fopen(path, "rb");
+    assert_non_null(f);
+    memset(out, 0, sizeof(*out));
+    assert_int_equal(fread(&out->header, sizeof(out->header), 1, f), 1);
+    assert_int_equal(out->header.magic, KORA_TRACE_MAGIC);
+    assert_int_equal(out->header.version, KORA_TRACE_VERSION);
+
+    size_t cap = 0;
+    kora_trace_chunk_t chunk;
+    while (fread(&chunk, sizeof(chunk), 1, f) == 1) {
+        assert_false(out->ended);
+        if (chunk.type == KORA_TRACE_CHUNK_END) {
+            assert_int_equal(chunk.bytes, sizeof(out->end));
+            assert_int_equal(fread(&out->end, sizeof(out->end), 1, f), 1);
+            out->ended = 1;
+            continue;
+        }
+        assert_int_equal(chunk.type, KORA_TRACE_CHUNK_RECORDS);
+        for (uint32_t i = 0; i < chunk.count; i++) {
+            if (out->count == cap) {
+                cap = cap ? cap * 2 : 256;
+                out->records = realloc(out->records, cap * sizeof(*out->records));
+                assert_non_null(out->records);
+            }
+            parsed_record_t *r = &out->records[out->count++];
+            r->tid = chunk.tid;
+            assert_int_equal(fread(&r->rec, sizeof(r->rec), 1, f), 1);
+            assert_true(r->rec.nargs <= KORA_TRACE_MAX_ARGS);
+            assert_int_equal(fread(r->args, sizeof(uint64_t), r->rec.nargs, f), r->rec.nargs);
+            memset(&r->payload, 0, sizeof(r->payload));
+            memset(r->paths, 0, sizeof(r->paths));
+            if (r->rec.flags & KORA_TRACE_F_PAYLOAD) {
+                assert_int_equal(fread(&r->payload, sizeof(r->payload), 1, f), 1);
+                size_t text = KORA_TRACE_PAYLOAD_SIZE(&r->payload) - sizeof(r->payload);
+                assert_true(text < sizeof(r->paths));
+                assert_int_equal(fread(r->paths, 1, text, f), text);
+            }
+        }
+    }
+    fclose(f);
+    assert_true(out->ended);
+}
+
+static const parsed_record_t *find_call(const parsed_trace_t *t, int syscall) {
+    for (size_t i = 0; i < t->count; i++) {
+        if (t->records[i].rec.syscall == syscall) {
+            return &t->records[i];
+        }
+    }
+    return NULL;
+}
+
+/* Hooks can be compiled out with -DKORA_TRACE_HOOKS=OFF */
+static void start_or_skip(void) {
+    if (kora_trace_start(TRACE_PATH) != KORA_SUCCESS) {
+        assert_int_equal(errno, ENOTSUP);
+        skip();
+    }
+}
+
+static void test_trace_records_calls(void **state) {
+    (void)state;
+    char buf[16];
+
+    start_or_skip();
+    assert_true(kora_trace_enabled());
+
+    pid_t pid = sys_getpid();
+    assert_int_equal(sys_open("/nonexistent/kora_trace", O_RDONLY), KORA_ERROR);
+    int fds[2];
+    assert_int_equal(sys_pipe(fds), 0);
+    assert_int_equal(sys_write(fds[1], "trace", 5), 5);
+    assert_int_equal(sys_read(fds[0], buf, sizeof(buf)), 5);
+    sys_close(fds[0]);
+    sys_close(fds[1]);
+
+    assert_int_equal(kora_trace_stop(), KORA_SUCCESS);
+    assert_false(kora_trace_enabled());
+
+    parsed_trace_t t;
+    parse_trace(TRACE_PATH, &t);
+    assert_int_equal(t.header.pid, (uint32_t)getpid());
+    assert_int_equal(t.end.dropped, 0);
+
+    const parsed_record_t *r = find_call(&t, SYS_GETPID);
+    assert_non_null(r);
+    assert_int_equal(r->rec.nargs, 0);
+    assert_int_equal(r->rec.result, pid);
+    assert_int_equal(r->tid, (uint32_t)sys_gettid());
+    assert_true(r->rec.start_ns >= t.header.start_monotonic_ns);
+
+    r = find_call(&t, SYS_OPEN);
+    assert_non_null(r);
+    assert_int_equal(r->rec.nargs, 2);
+    assert_int_equal(r->args[1], O_RDONLY);
+    assert_int_equal(r->rec.result, -1);
+    assert_int_equal(r->rec.host_errno, ENOENT);
+
+    r = find_call(&t, SYS_READ);
+    assert_non_null(r);
+    assert_int_equal(r->rec.nargs, 3);
+    assert_int_equal(r->args[0], fds[0]);
+    assert_int_equal(r->args[1], (uint64_t)(uintptr_t)buf);
+    assert_int_equal(r->args[2], sizeof(buf));
+    assert_int_equal(r->rec.result, 5);
+    assert_int_equal(r->rec.host_errno, 0);
+
+    /* Calls are recorded in order */
+    assert_true(find_call(&t, SYS_WRITE)->rec.start_ns <= r->rec.start_ns);
+
+    free(t.records);
+    unlink(TRACE_PATH);
+}
+
+static void test_trace_cpu_time(void **state) {
+    (void)state;
+    struct timespec nap = { 0, 20000000 };
+
+    start_or_skip();
+    assert_int_equal(sys_nanosleep(&nap, NULL), 0);
+    assert_int_equal(kora_trace_stop(), KORA_SUCCESS);
+
+    parsed_trace_t t;
+    parse_trace(TRACE_PATH, &t);
+    const parsed_record_t *r = find_call(&t, SYS_NANOSLEEP);
+    assert_non_null(r);
+    assert_true(r->rec.duration_ns >= 20000000);
+    assert_true(r->rec.cpu_ns <= r->rec.duration_ns / 2);
+
+    free(t.records);
+    unlink(TRACE_PATH);
+}
+
+#define THREADS 4
+#define CALLS_PER_THREAD 1000
+
+static void *make_calls(void *arg) {
+    (void)arg;
+    for (int i = 0; i < CALLS_PER_THREAD; i++) {
+        sys_getppid();
+    }
+    return NULL;
+}
+
+static void test_trace_threads(void **state) {
+    (void)state;
+    kora_thread_t threads[THREADS];
+
+    start_or_skip();
+    for (int i = 0; i < THREADS; i++) {
+        assert_int_equal(sys_thread_create(&threads[i], NULL, make_calls, NULL), 0);
+    }
+    for (int i = 0; i < THREADS; i++) {
+        assert_int_equal(sys_thread_join(threads[i], NULL), 0);
+    }
+    assert_int_equal(kora_trace_stop(), KORA_SUCCESS);
+
+    parsed_trace_t t;
+    parse_trace(TRACE_PATH, &t);
+    assert_int_equal(t.end.dropped, 0);
+
+    uint32_t tids[THREADS] = { 0 };
+    int per_thread[THREADS] = { 0 };
+    int total = 0;
+    for (size_t i = 0; i < t.count; i++) {
+        if (t.records[i].rec.syscall != SYS_GETPPID) {
+            continue;
+        }
+        int slot = 0;
+        while (slot < THREADS && tids[slot] != 0 && tids[slot] != t.records[i].tid) {
+            slot++;
+        }
+        assert_true(slot < THREADS);
+        tids[slot] = t.records[i].tid;
+        per_thread[slot]++;
+        total++;
+    }
+    assert_int_equal(total, THREADS * CALLS_PER_THREAD);
+    for (int i = 0; i < THREADS; i++) {
+        assert_int_equal(per_thread[i], CALLS_PER_THREAD);
+    }
+
+    free(t.records);
+    unlink(TRACE_PATH);
+}
+
+static void test_trace_start_stop(void **state) {
+    (void)state;
+
+    /* Stopping when not tracing is harmless */
+    assert_int_equal(kora_trace_stop(), KORA_SUCCESS);
+
+    start_or_skip();
+    assert_int_equal(kora_trace_start(TRACE_PATH), KORA_ERROR);
+    assert_int_equal(errno, EBUSY);
+    assert_int_equal(kora_trace_stop(), KORA_SUCCESS);
+
+    assert_int_equal(kora_trace_start("/nonexistent/dir/trace.bin"), KORA_ERROR);
+    assert_int_equal(errno, ENOENT);
+    assert_false(kora_trace_enabled());
+
+    /* Nothing is recorded once stopped */
+    sys_getpid();
+    parsed_trace_t t;
+    parse_trace(TRACE_PATH, &t);
+    assert_null(find_call(&t, SYS_GETPID));
+    free(t.records);
+    unlink(TRACE_PATH);
+}
+
+static void test_trace_payloads(void **state) {
+    (void)state;
+    const char *from = "/tmp/kora_test_trace_from";
+    const char *to = "/tmp/kora_test_trace_to";
+
+    if (kora_trace_start_flags(TRACE_PATH, KORA_TRACE_PAYLOADS) != KORA_SUCCESS) {
+        assert_int_equal(errno, ENOTSUP);
+        skip();
+    }
+    int fd = sys_open(from, KORA_O_WRONLY | KORA_O_CREAT | KORA_O_TRUNC);
+    assert_true(fd >= 0);
+    assert_int_equal(sys_write(fd, "hello", 5), 5);
+    sys_close(fd);
+    assert_int_equal(sys_rename(from, to), 0);
+    assert_int_equal(kora_trace_stop(), KORA_SUCCESS);
+    sys_unlink(to);
+
+    parsed_trace_t t;
+    parse_trace(TRACE_PATH, &t);
+    const parsed_record_t *r = find_call(&t, SYS_OPEN);
+    assert_non_null(r);
+    assert_true(r->rec.flags & KORA_TRACE_F_PAYLOAD);
+    assert_int_equal(r->payload.path_bytes[0], strlen(from));
+    assert_memory_equal(r->paths, from, strlen(from));
+
+    r = find_call(&t, SYS_WRITE);
+    assert_non_null(r);
+    assert_int_equal(r->payload.data_bytes, 5);
+    assert_true(r->payload.hash == kora_trace_hash("hello", 5));
+    assert_true(r->payload.hash != kora_trace_hash("hellp", 5));
+
+    /* Both names of a rename, back to back */
+    r = find_call(&t, SYS_RENAME);
+    assert_non_null(r);
+    assert_int_equal(r->payload.path_bytes[1], strlen(to));
+    assert_memory_equal(r->paths + strlen(from), to, strlen(to));
+
+    /* Calls without paths or data carry no payload */
+    assert_false(find_call(&t, SYS_CLOSE)->rec.flags & KORA_TRACE_F_PAYLOAD);
+    free(t.records);
+
+    /* Nor does anything without the flag */
+    start_or_skip();
+    assert_int_equal(sys_open("/nonexistent/kora_trace", O_RDONLY), KORA_ERROR);
+    assert_int_equal(kora_trace_stop(), KORA_SUCCESS);
+    parse_trace(TRACE_PATH, &t);
+    assert_false(find_call(&t, SYS_OPEN)->rec.flags & KORA_TRACE_F_PAYLOAD);
+    free(t.records);
+    unlink(TRACE_PATH);
+}
+
+static void test_syscall_name(void **state) {
+    (void)state;
+    assert_string_equal(kora_syscall_name(SYS_READ), "read");
+    assert_string_equal(kora_syscall_name(SYS_SCHED_SETAFFINITY), "sched_setaffinity");
+    assert_string_equal(kora_syscall_name(SYS_WAIT4), "wait4");
+    assert_null(kora_syscall_name(0));
+    assert_null(kora_syscall_name(10000));
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_trace_records_calls),
+        cmocka_unit_test(test_trace_cpu_time),
+        cmocka_unit_test(test_trace_threads),
+        cmocka_unit_test(test_trace_start_stop),
+        cmocka_unit_test(test_trace_payloads),
+        cmocka_unit_test(test_syscall_name),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,926 @@
+/**
+ * Trace replayer
+ *
+ * Re-issues the file system calls of a trace recorded with payloads
+ * (kora_trace_start_flags with KORA_TRACE_PAYLOADS, or KORA_TRACE_PAYLOADS=1)
+ * inside a sandbox directory, then compares every result and latency
+ * with the recording, per call, for performance regression runs.
+ *
+ * Absolute paths are moved under the sandbox and relative paths are
+ * taken from it, following the traced chdir calls. "." and ".." resolve
+ * by name and stop at the sandbox, and link targets are rewritten to
+ * absolute paths in it, so nothing replayed reaches outside; reading
+ * back a link the trace made returns the rewritten target instead.
+ * Files, directories and links that the traced program found already
+ * in place are created first, with files sized to cover every byte it
+ * read. The sandbox must be empty or not exist yet.
+ *
+ * Calls from all threads are replayed on one thread in start order.
+ * With --timed each call waits for its original offset from the start
+ * of the trace, which also reproduces the gaps left by skipped sleeps;
+ * otherwise calls run back to back. Only data hashes are recorded, so
+ * writes send zeros and prepared files read back as zeros: the data
+ * line of the report shows how many reads still returned the same bytes.
+ *
+ * Usage: kora_replay [--timed] <trace> <sandbox>
+ */
+
+#include "trace_file.h"
+
+#include <kora/syscalls.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define FD_SLOTS   4096   /* Recorded descriptors above this are not replayed */
+#define PATH_BYTES (2 * KORA_TRACE_MAX_PATH + 4096)
+
+typedef struct {
+    size_t seq;          /* Position in the file, to keep the sort stable */
+    uint32_t tid;
+    kora_trace_record_t rec;
+    uint64_t args[KORA_TRACE_MAX_ARGS];
+    const kora_trace_payload_t *payload;
+} call_t;
+
+typedef struct {
+    call_t *calls;
+    size_t count;
+    size_t cap;
+    int failed;
+} call_list_t;
+
+static void collect_record(uint32_t tid, const kora_trace_record_t *rec,
+                           const uint64_t *args, const kora_trace_payload_t *payload,
+                           void *ctx) {
+    call_list_t *list = ctx;
+    if (list->count == list->cap) {
+        size_t cap = list->cap ? list->cap * 2 : 4096;
+        call_t *calls = realloc(list->calls, cap * sizeof(*calls));
+        if (calls == NULL) {
+            list->failed = 1;
+            return;
+        }
+        list->calls = calls;
+        list->cap = cap;
+    }
+    call_t *c = &list->calls[list->count];
+    c->seq = list->count++;
+    c->tid = tid;
+    c->rec = *rec;
+    memcpy(c->args, args, rec->nargs * sizeof(uint64_t));
+    c->payload = payload;
+}
+
+static int cmp_start(const void *a, const void *b) {
+    const call_t *x = a;
+    const call_t *y = b;
+    if (x->rec.start_ns != y->rec.start_ns) {
+        return x->rec.start_ns < y->rec.start_ns ? -1 : 1;
+    }
+    return x->seq < y->seq ? -1 : x->seq > y->seq;
+}
+
+static char sandbox[PATH_BYTES];
+static char trace_cwd[PATH_BYTES];  /* Where relative paths start, "" for the top */
+
+/* Appends the components of text to path, with "." and ".." resolved by name */
+static int add_components(char *path, size_t size, const char *text, size_t len) {
+    const char *end = text + len;
+    size_t o = strlen(path);
+
+    for (const char *p = text; p < end;) {
+        const char *next = memchr(p, '/', (size_t)(end - p));
+        size_t n = (size_t)((next != NULL ? next : end) - p);
+        if (n == 2 && p[0] == '.' && p[1] == '.') {
+            /* At the top ".." stays there */
+            while (o > 0 && path[o - 1] != '/') {
+                o--;
+            }
+            o -= o > 0;
+        } else if (n > 0 && !(n == 1 && p[0] == '.')) {
+            if (o + n + 1 >= size) {
+                return -1;
+            }
+            path[o++] = '/';
+            memcpy(path + o, p, n);
+            o += n;
+        }
+        p += n + 1;
+    }
+    path[o] = '\0';
+    return 0;
+}
+
+/* Path argument i of a call as the traced program meant it, "" for the top */
+static int trace_path(const call_t *c, int i, char *out, size_t size) {
+    if (c->payload == NULL || (c->rec.flags & KORA_TRACE_F_TRUNCATED) ||
+        c->payload->path_bytes[i] == 0) {
+        return -1;
+    }
+    size_t len;
+    const char *text = trace_file_path(c->payload, i, &len);
+    snprintf(out, size, "%s", text[0] == '/' ? "" : trace_cwd);
+    return add_components(out, size, text, len);
+}
+
+/* Path argument i of a call as it appears in the sandbox */
+static int sandbox_path(const call_t *c, int i, char *out, size_t size) {
+    char path[PATH_BYTES];
+    if (trace_path(c, i, path, sizeof(path)) != 0) {
+        return -1;
+    }
+    int n = snprintf(out, size, "%s%s", sandbox, path);
+    return n > 0 && (size_t)n < size ? 0 : -1;
+}
+
+/* Target of a symlink call as an absolute sandbox path, taken from the link's directory */
+static int sandbox_target(const call_t *c, char *out, size_t size) {
+    char path[PATH_BYTES];
+    if (trace_path(c, 1, path, sizeof(path)) != 0 || c->payload->path_bytes[0] == 0) {
+        return -1;
+    }
+    size_t len;
+    const char *target = trace_file_path(c->payload, 0, &len);
+    char *slash = strrchr(path, '/');
+    if (target[0] == '/' || slash == NULL) {
+        path[0] = '\0';
+    } else {
+        *slash = '\0';
+    }
+    if (add_components(path, sizeof(path), target, len) != 0) {
+        return -1;
+    }
+    int n = snprintf(out, size, "%s%s", sandbox, path);
+    return n > 0 && (size_t)n < size ? 0 : -1;
+}
+
+/* Later relative paths start where a successful chdir in the trace went */
+static void follow_chdir(const call_t *c) {
+    char path[PATH_BYTES];
+    if (c->rec.result >= 0 && trace_path(c, 0, path, sizeof(path)) == 0) {
+        memcpy(trace_cwd, path, strlen(path) + 1);
+    }
+}
+
+static void make_parents(const char *path) {
+    char dir[PATH_BYTES];
+    snprintf(dir, sizeof(dir), "%s", path);
+    for (char *p = dir + 1; *p != '\0'; p++) {
+        if (*p == '/') {
+            *p = '\0';
+            sys_mkdir(dir);
+            *p = '/';
+        }
+    }
+}
+
+/*
+ * Preparation: work out what had to exist before the traced program ran
+ */
+
+enum { NODE_FILE, NODE_DIR, NODE_LINK };
+
+typedef struct {
+    char *path;
+    int type;
+    uint64_t size;  /* File size, or link target length */
+} node_t;
+
+typedef struct {
+    uint64_t hash;  /* Path hash, 0 for an empty slot */
+    int node;       /* Index into nodes, or -1 if the trace creates the path */
+} seen_t;
+
+typedef struct {
+    seen_t *seen;
+    size_t seen_cap;
+    size_t seen_count;
+    node_t *nodes;
+    size_t count;
+    size_t cap;
+    int fd_node[FD_SLOTS];
+    uint64_t fd_pos[FD_SLOTS];
+} prepare_t;
+
+static seen_t *seen_slot(prepare_t *p, const char *path) {
+    if (p->seen_count * 2 >= p->seen_cap) {
+        size_t cap = p->seen_cap ? p->seen_cap * 2 : 1024;
+        seen_t *seen = calloc(cap, sizeof(*seen));
+        if (seen == NULL) {
+            return NULL;
+        }
+        for (size_t i = 0; i < p->seen_cap; i++) {
+            if (p->seen[i].hash != 0) {
+                size_t j = p->seen[i].hash & (cap - 1);
+                while (seen[j].hash != 0) {
+                    j = (j + 1) & (cap - 1);
+                }
+                seen[j] = p->seen[i];
+            }
+        }
+        free(p->seen);
+        p->seen = seen;
+        p->seen_cap = cap;
+    }
+    uint64_t hash = kora_trace_hash(path, strlen(path)) | 1;
+    size_t i = hash & (p->seen_cap - 1);
+    while (p->seen[i].hash != 0 && p->seen[i].hash != hash) {
+        i = (i + 1) & (p->seen_cap - 1);
+    }
+    if (p->seen[i].hash == 0) {
+        p->seen[i].hash = hash;
+        p->seen[i].node = -1;
+        p->seen_count++;
+    }
+    return &p->seen[i];
+}
+
+/* The path was in place before the call; returns its node, or -1 if the trace made it */
+static int prepare_needed(prepare_t *p, const char *path, int type) {
+    size_t before = p->seen_count;
+    seen_t *slot = seen_slot(p, path);
+    if (slot == NULL || p->seen_count == before) {
+        return slot != NULL ? slot->node : -1;
+    }
+    if (p->count == p->cap) {
+        size_t cap = p->cap ? p->cap * 2 : 64;
+        node_t *nodes = realloc(p->nodes, cap * sizeof(*nodes));
+        if (nodes == NULL) {
+            return -1;
+        }
+        p->nodes = nodes;
+        p->cap = cap;
+    }
+    node_t *node = &p->nodes[p->count];
+    node->path = strdup(path);
+    node->type = type;
+    node->size = 0;
+    slot->node = (int)p->count++;
+    return slot->node;
+}
+
+static int prepare_arg(prepare_t *p, const call_t *c, int i, int type) {
+    char path[PATH_BYTES];
+    if (sandbox_path(c, i, path, sizeof(path)) != 0) {
+        return -1;
+    }
+    return prepare_needed(p, path, type);
+}
+
+/* The call makes the path itself, so only its directory has to be in place */
+static void prepare_created(prepare_t *p, const call_t *c, int i) {
+    char path[PATH_BYTES];
+    if (sandbox_path(c, i, path, sizeof(path)) != 0) {
+        return;
+    }
+    char *slash = strrchr(path, '/');
+    if (slash != NULL && (size_t)(slash - path) > strlen(sandbox)) {
+        *slash = '\0';
+        prepare_needed(p, path, NODE_DIR);
+        *slash = '/';
+    }
+    seen_slot(p, path);
+}
+
+static void prepare_call(prepare_t *p, const call_t *c) {
+    const kora_trace_record_t *rec = &c->rec;
+    uint64_t fd = rec->nargs > 0 ? c->args[0] : FD_SLOTS;
+    int node;
+
+    if (rec->result < 0) {
+        return;
+    }
+    switch (rec->syscall) {
+    case SYS_OPEN:
+        if (c->args[1] & KORA_O_CREAT) {
+            prepare_created(p, c, 0);
+        }
+        node = prepare_arg(p, c, 0, NODE_FILE);
+        if (rec->result < FD_SLOTS) {
+            p->fd_node[rec->result] = node;
+            p->fd_pos[rec->result] = 0;
+        }
+        break;
+    case SYS_CLOSE:
+        if (fd < FD_SLOTS) {
+            p->fd_node[fd] = -1;
+        }
+        break;
+    case SYS_READ:
+        if (fd < FD_SLOTS && p->fd_node[fd] >= 0) {
+            node_t *n = &p->nodes[p->fd_node[fd]];
+            p->fd_pos[fd] += (uint64_t)rec->result;
+            n->size = p->fd_pos[fd] > n->size ? p->fd_pos[fd] : n->size;
+        }
+        break;
+    case SYS_WRITE:
+        if (fd < FD_SLOTS) {
+            p->fd_pos[fd] += (uint64_t)rec->result;
+        }
+        break;
+    case SYS_SEEK:
+        if (fd < FD_SLOTS) {
+            p->fd_pos[fd] = (uint64_t)rec->result;
+        }
+        break;
+    case SYS_MKDIR:
+        prepare_created(p, c, 0);
+        break;
+    case SYS_SYMLINK:
+        prepare_created(p, c, 1);
+        break;
+    case SYS_RENAME:
+    case SYS_LINK:
+        prepare_arg(p, c, 0, NODE_FILE);
+        prepare_created(p, c, 1);
+        break;
+    case SYS_CHDIR:
+        prepare_arg(p, c, 0, NODE_DIR);
+        follow_chdir(c);
+        break;
+    case SYS_OPENDIR:
+    case SYS_RMDIR:
+        prepare_arg(p, c, 0, NODE_DIR);
+        break;
+    case SYS_READLINK:
+        node = prepare_arg(p, c, 0, NODE_LINK);
+        if (node >= 0) {
+            p->nodes[node].size = (uint64_t)rec->result;
+        }
+        break;
+    case SYS_STAT:
+    case SYS_LSTAT:
+    case SYS_GET_FILE_INFO:
+    case SYS_EXISTS:
+    case SYS_UTIME:
+    case SYS_UNLINK:
+        prepare_arg(p, c, 0, NODE_FILE);
+        break;
+    }
+}
+
+static void create_node(const node_t *node) {
+    char target[KORA_TRACE_MAX_PATH + 1];
+
+    make_parents(node->path);
+    switch (node->type) {
+    case NODE_DIR:
+        sys_mkdir(node->path);
+        break;
+    case NODE_LINK: {
+        size_t len = node->size > 0 && node->size < sizeof(target) ? node->size : 1;
+        memset(target, 'x', len);
+        target[len] = '\0';
+        sys_symlink(target, node->path);
+        break;
+    }
+    default: {
+        int fd = sys_open(node->path, KORA_O_WRONLY | KORA_O_CREAT | KORA_O_TRUNC);
+        if (fd >= 0) {
+            /* Extend with a single byte at the end; the rest reads as zeros */
+            if (node->size > 0 && sys_seek(fd, (long)node->size - 1, KORA_SEEK_SET) >= 0) {
+                sys_write(fd, "", 1);
+            }
+            sys_close(fd);
+        }
+        break;
+    }
+    }
+}
+
+static size_t prepare_sandbox(const call_list_t *list) {
+    prepare_t *p = calloc(1, sizeof(*p));
+    if (p == NULL) {
+        return 0;
+    }
+    for (int i = 0; i < FD_SLOTS; i++) {
+        p->fd_node[i] = -1;
+    }
+    for (size_t i = 0; i < list->count; i++) {
+        prepare_call(p, &list->calls[i]);
+    }
+
+    size_t created = p->count;
+    for (size_t i = 0; i < p->count; i++) {
+        create_node(&p->nodes[i]);
+        free(p->nodes[i].path);
+    }
+    free(p->nodes);
+    free(p->seen);
+    free(p);
+    return created;
+}
+
+/*
+ * Replay
+ */
+
+typedef struct {
+    uint64_t *recorded;  /* Durations of replayed calls, as recorded */
+    uint64_t *replayed;  /* ... and as replayed */
+    uint64_t count;
+    uint64_t cap;
+    uint64_t mismatches;
+    uint64_t skipped;
+    uint64_t recorded_ns;
+    uint64_t replayed_ns;
+} call_stats_t;
+
+typedef struct {
+    call_stats_t calls[UINT16_MAX + 1];
+    int fds[FD_SLOTS];   /* Recorded descriptor to replay descriptor */
+    int dirs[FD_SLOTS];  /* Same for directory handles */
+    unsigned char *scratch;
+    size_t scratch_size;
+    uint64_t data_compared;
+    uint64_t data_matched;
+} replay_t;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    sys_clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static int lookup(const int *table, uint64_t handle) {
+    return handle < FD_SLOTS ? table[handle] : -1;
+}
+
+static void remember(int *table, int64_t recorded, int replayed) {
+    if (recorded >= 0 && recorded < FD_SLOTS) {
+        table[recorded] = replayed;
+    }
+}
+
+/* Zeroed buffer of at least size bytes, used for both reads and writes */
+static void *scratch(replay_t *r, size_t size) {
+    if (size > r->scratch_size) {
+        unsigned char *buf = realloc(r->scratch, size);
+        if (buf == NULL) {
+            return NULL;
+        }
+        r->scratch = buf;
+        r->scratch_size = size;
+    }
+    memset(r->scratch, 0, size);
+    return r->scratch;
+}
+
+static void compare_data(replay_t *r, const call_t *c, int64_t ret) {
+    if (c->payload != NULL && c->payload->data_bytes > 0 && ret > 0) {
+        r->data_compared++;
+        if (kora_trace_hash(r->scratch, (size_t)ret) == c->payload->hash) {
+            r->data_matched++;
+        }
+    }
+}
+
+/* Re-issue one call; returns -1 if it cannot be replayed */
+static int replay_call(replay_t *r, const call_t *c, int64_t *ret) {
+    const uint64_t *a = c->args;
+    char path[PATH_BYTES];
+    char path2[PATH_BYTES];
+    int fd = c->rec.nargs > 0 ? lookup(r->fds, a[0]) : -1;
+    int dir = c->rec.nargs > 0 ? lookup(r->dirs, a[0]) : -1;
+    kora_stat_t st;
+    kora_file_info_t info;
+    kora_dirent_t entry;
+    struct timespec ts;
+    struct timeval tv;
+    uint8_t type;
+    void *buf;
+
+    switch (c->rec.syscall) {
+    case SYS_OPEN:
+        if (sandbox_path(c, 0, path, sizeof(path)) != 0) {
+            return -1;
+        }
+        *ret = sys_open(path, (int)a[1]);
+        if (*ret >= 0) {
+            remember(r->fds, c->rec.result, (int)*ret);
+        }
+        return 0;
+    case SYS_CLOSE:
+        /* Standard streams stay on the null device */
+        if (fd < 0 || a[0] <= 2) {
+            return -1;
+        }
+        *ret = sys_close(fd);
+        remember(r->fds, (int64_t)a[0], -1);
+        return 0;
+    case SYS_READ:
+        if (fd < 0 || (buf = scratch(r, (size_t)a[2])) == NULL) {
+            return -1;
+        }
+        *ret = sys_read(fd, buf, (size_t)a[2]);
+        compare_data(r, c, *ret);
+        return 0;
+    case SYS_WRITE:
+        if (fd < 0 || (buf = scratch(r, (size_t)a[2])) == NULL) {
+            return -1;
+        }
+        *ret = sys_write(fd, buf, (size_t)a[2]);
+        return 0;
+    case SYS_SEEK:
+        if (fd < 0) {
+            return -1;
+        }
+        *ret = sys_seek(fd, (long)a[1], (int)a[2]);
+        return 0;
+    case SYS_FADVISE:
+        if (fd < 0) {
+            return -1;
+        }
+        *ret = sys_fadvise(fd, a[1], a[2], (int)a[3]);
+        return 0;
+    case SYS_READAHEAD:
+        if (fd < 0) {
+            return -1;
+        }
+        *ret = sys_readahead(fd, a[1], (size_t)a[2]);
+        return 0;
+    case SYS_FSTAT:
+        if (fd < 0) {
+            return -1;
+        }
+        *ret = sys_fstat(fd, &st);
+        return 0;
+    case SYS_GET_FD_INFO:
+        if (fd < 0) {
+            return -1;
+        }
+        *ret = sys_get_fd_info(fd, &info);
+        return 0;
+    case SYS_DUP:
+        if (fd < 0) {
+            return -1;
+        }
+        *ret = sys_dup(fd);
+        if (*ret >= 0) {
+            remember(r->fds, c->rec.result, (int)*ret);
+        }
+        return 0;
+    case SYS_OPENDIR:
+        if (sandbox_path(c, 0, path, sizeof(path)) != 0) {
+            return -1;
+        }
+        *ret = sys_opendir(path);
+        if (*ret >= 0) {
+            remember(r->dirs, c->rec.result, (int)*ret);
+        }
+        return 0;
+    case SYS_READDIR:
+        if (dir < 0) {
+            return -1;
+        }
+        *ret = sys_readdir(dir, &entry);
+        return 0;
+    case SYS_CLOSEDIR:
+        if (dir < 0) {
+            return -1;
+        }
+        *ret = sys_closedir(dir);
+        remember(r->dirs, (int64_t)a[0], -1);
+        return 0;
+    case SYS_SYMLINK:
+        if (sandbox_target(c, path, sizeof(path)) != 0 ||
+            sandbox_path(c, 1, path2, sizeof(path2)) != 0) {
+            return -1;
+        }
+        *ret = sys_symlink(path, path2);
+        return 0;
+    case SYS_READLINK:
+        if (sandbox_path(c, 0, path, sizeof(path)) != 0 ||
+            (buf = scratch(r, (size_t)a[2])) == NULL) {
+            return -1;
+        }
+        *ret = sys_readlink(path, buf, (size_t)a[2]);
+        compare_data(r, c, *ret);
+        return 0;
+    case SYS_RENAME:
+    case SYS_LINK:
+        if (sandbox_path(c, 0, path, sizeof(path)) != 0 ||
+            sandbox_path(c, 1, path2, sizeof(path2)) != 0) {
+            return -1;
+        }
+        *ret = c->rec.syscall == SYS_RENAME ? sys_rename(path, path2) : sys_link(path, path2);
+        return 0;
+    case SYS_MKDIR:
+    case SYS_RMDIR:
+    case SYS_UNLINK:
+    case SYS_CHDIR:
+    case SYS_STAT:
+    case SYS_LSTAT:
+    case SYS_GET_FILE_INFO:
+    case SYS_EXISTS:
+    case SYS_UTIME:
+        if (sandbox_path(c, 0, path, sizeof(path)) != 0) {
+            return -1;
+        }
+        switch (c->rec.syscall) {
+        case SYS_MKDIR:         *ret = sys_mkdir(path); break;
+        case SYS_RMDIR:         *ret = sys_rmdir(path); break;
+        case SYS_UNLINK:        *ret = sys_unlink(path); break;
+        case SYS_CHDIR:         *ret = sys_chdir(path); follow_chdir(c); break;
+        case SYS_STAT:          *ret = sys_stat(path, &st); break;
+        case SYS_LSTAT:         *ret = sys_lstat(path, &st); break;
+        case SYS_GET_FILE_INFO: *ret = sys_get_file_info(path, &info); break;
+        case SYS_EXISTS:        *ret = sys_exists(path, &type); break;
+        default:                *ret = sys_utime(path, a[1]); break;
+        }
+        return 0;
+    case SYS_GETCWD:
+        *ret = sys_getcwd(path, sizeof(path));
+        return 0;
+    case SYS_SYNC:
+        *ret = sys_sync();
+        return 0;
+    case SYS_GETPID:
+        *ret = sys_getpid();
+        return 0;
+    case SYS_GETPPID:
+        *ret = sys_getppid();
+        return 0;
+    case SYS_GETTID:
+        *ret = sys_gettid();
+        return 0;
+    case SYS_YIELD:
+        *ret = sys_yield();
+        return 0;
+    case SYS_CLOCK_GETTIME:
+        *ret = sys_clock_gettime((clockid_t)a[0], &ts);
+        return 0;
+    case SYS_GETTIMEOFDAY:
+        *ret = sys_gettimeofday(&tv, NULL);
+        return 0;
+    }
+    /* Sleeps, memory, processes, threads, signals, pipes and the like */
+    return -1;
+}
+
+/* Descriptors and ids differ between runs; only success or failure must agree */
+static int same_result(const call_t *c, int64_t ret) {
+    switch (c->rec.syscall) {
+    case SYS_OPEN:
+    case SYS_OPENDIR:
+    case SYS_DUP:
+    case SYS_GETPID:
+    case SYS_GETPPID:
+    case SYS_GETTID:
+    case SYS_GETCWD:
+        return (ret < 0) == (c->rec.result < 0);
+    }
+    return c->rec.result < 0 ? ret < 0 : ret == c->rec.result;
+}
+
+static void add_sample(call_stats_t *s, uint64_t recorded, uint64_t replayed) {
+    if (s->count == s->cap) {
+        uint64_t cap = s->cap ? s->cap * 2 : 64;
+        uint64_t *a = realloc(s->recorded, cap * sizeof(*a));
+        uint64_t *b = a != NULL ? realloc(s->replayed, cap * sizeof(*b)) : NULL;
+        if (a != NULL) {
+            s->recorded = a;
+        }
+        if (b == NULL) {
+            return;
+        }
+        s->replayed = b;
+        s->cap = cap;
+    }
+    s->recorded[s->count] = recorded;
+    s->replayed[s->count] = replayed;
+    s->count++;
+    s->recorded_ns += recorded;
+    s->replayed_ns += replayed;
+}
+
+static void wait_until(uint64_t deadline) {
+    uint64_t now = now_ns();
+    if (now < deadline) {
+        struct timespec ts = { (time_t)((deadline - now) / 1000000000u),
+                               (long)((deadline - now) % 1000000000u) };
+        sys_nanosleep(&ts, NULL);
+    }
+}
+
+static uint64_t replay(replay_t *r, const call_list_t *list, int timed) {
+    int null_fd = sys_open("/dev/null", KORA_O_RDWR);
+    trace_cwd[0] = '\0';
+    for (int i = 0; i < FD_SLOTS; i++) {
+        r->fds[i] = i <= 2 ? null_fd : -1;
+        r->dirs[i] = -1;
+    }
+
+    uint64_t first = list->calls[0].rec.start_ns;
+    uint64_t begin = now_ns();
+    for (size_t i = 0; i < list->count; i++) {
+        const call_t *c = &list->calls[i];
+        call_stats_t *s = &r->calls[c->rec.syscall];
+        int64_t ret = 0;
+
+        if (timed) {
+            wait_until(begin + (c->rec.start_ns - first));
+        }
+        uint64_t t0 = now_ns();
+        if (replay_call(r, c, &ret) != 0) {
+            s->skipped++;
+            continue;
+        }
+        uint64_t t1 = now_ns();
+        add_sample(s, c->rec.duration_ns, t1 - t0);
+        if (!same_result(c, ret)) {
+            s->mismatches++;
+        }
+    }
+    uint64_t elapsed = now_ns() - begin;
+
+    for (int i = 0; i < FD_SLOTS; i++) {
+        if (r->fds[i] >= 0 && r->fds[i] != null_fd) {
+            sys_close(r->fds[i]);
+        }
+        if (r->dirs[i] >= 0) {
+            sys_closedir(r->dirs[i]);
+        }
+    }
+    if (null_fd >= 0) {
+        sys_close(null_fd);
+    }
+    return elapsed;
+}
+
+/*
+ * Report
+ */
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static replay_t *sort_ctx;
+
+static int cmp_recorded(const void *a, const void *b) {
+    uint64_t x = sort_ctx->calls[*(const int *)a].recorded_ns;
+    uint64_t y = sort_ctx->calls[*(const int *)b].recorded_ns;
+    return x < y ? 1 : x > y ? -1 : 0;
+}
+
+static uint64_t percentile(const uint64_t *sorted, uint64_t count, unsigned pct) {
+    return sorted[(count - 1) * pct / 100];
+}
+
+static const char *call_name(int syscall, char *buf, size_t size) {
+    const char *name = kora_syscall_name(syscall);
+    if (name == NULL) {
+        snprintf(buf, size, "syscall_%d", syscall);
+        name = buf;
+    }
+    return name;
+}
+
+static void report(replay_t *r, const call_list_t *list, uint64_t elapsed) {
+    int *order = malloc((UINT16_MAX + 1) * sizeof(*order));
+    uint64_t replayed = 0, skipped = 0, mismatches = 0;
+    int n = 0;
+    char unknown[32];
+
+    if (order == NULL) {
+        return;
+    }
+    for (int i = 0; i <= UINT16_MAX; i++) {
+        call_stats_t *s = &r->calls[i];
+        replayed += s->count;
+        skipped += s->skipped;
+        mismatches += s->mismatches;
+        if (s->count > 0) {
+            qsort(s->recorded, s->count, sizeof(uint64_t), cmp_u64);
+            qsort(s->replayed, s->count, sizeof(uint64_t), cmp_u64);
+            order[n++] = i;
+        }
+    }
+    sort_ctx = r;
+    qsort(order, (size_t)n, sizeof(*order), cmp_recorded);
+
+    printf("%-20s %10s %8s %10s %10s %10s %10s %8s\n", "call", "count", "mismatch",
+           "rec_p50", "rec_p99", "rep_p50", "rep_p99", "delta");
+    for (int i = 0; i < n; i++) {
+        call_stats_t *s = &r->calls[order[i]];
+        double delta = s->recorded_ns
+            ? 100.0 * ((double)s->replayed_ns - (double)s->recorded_ns) / (double)s->recorded_ns
+            : 0.0;
+        printf("%-20s %10" PRIu64 " %8" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64
+               " %10" PRIu64 " %+7.1f%%\n",
+               call_name(order[i], unknown, sizeof(unknown)), s->count, s->mismatches,
+               percentile(s->recorded, s->count, 50), percentile(s->recorded, s->count, 99),
+               percentile(s->replayed, s->count, 50), percentile(s->replayed, s->count, 99),
+               delta);
+    }
+
+    printf("\n%" PRIu64 " calls replayed, %" PRIu64 " mismatched, %" PRIu64 " skipped",
+           replayed, mismatches, skipped);
+    const char *sep = ":";
+    for (int i = 0; i <= UINT16_MAX; i++) {
+        if (r->calls[i].skipped > 0) {
+            printf("%s %s %" PRIu64, sep, call_name(i, unknown, sizeof(unknown)),
+                   r->calls[i].skipped);
+            sep = ",";
+        }
+    }
+    printf("\n%" PRIu64 " of %" PRIu64 " reads returned the recorded data\n",
+           r->data_matched, r->data_compared);
+
+    const call_t *last = &list->calls[list->count - 1];
+    printf("recorded %.3f s, replayed %.3f s\n",
+           (last->rec.start_ns + last->rec.duration_ns - list->calls[0].rec.start_ns) / 1e9,
+           elapsed / 1e9);
+
+    for (int i = 0; i <= UINT16_MAX; i++) {
+        free(r->calls[i].recorded);
+        free(r->calls[i].replayed);
+    }
+    free(order);
+}
+
+/* Create the sandbox, refuse to replay into one that has contents, and enter it */
+static int enter_sandbox(const char *path) {
+    kora_dirent_t entry;
+
+    snprintf(sandbox, sizeof(sandbox), "%s/", path);
+    make_parents(sandbox);
+    int dir = sys_opendir(path);
+    if (dir < 0) {
+        fprintf(stderr, "kora_replay: %s: cannot open sandbox\n", path);
+        return -1;
+    }
+    while (sys_readdir(dir, &entry) == 1) {
+        if (strcmp(entry.name, ".") != 0 && strcmp(entry.name, "..") != 0) {
+            sys_closedir(dir);
+            fprintf(stderr, "kora_replay: %s: sandbox is not empty\n", path);
+            return -1;
+        }
+    }
+    sys_closedir(dir);
+
+    if (sys_chdir(path) != 0 || sys_getcwd(sandbox, sizeof(sandbox)) != 0) {
+        fprintf(stderr, "kora_replay: %s: cannot enter sandbox\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "usage: %s [--timed] <trace> <sandbox>\n", prog);
+}
+
+int main(int argc, char **argv) {
+    int timed = 0;
+    int arg = 1;
+
+    if (arg < argc && strcmp(argv[arg], "--timed") == 0) {
+        timed = 1;
+        arg++;
+    }
+    if (argc - arg != 2) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    trace_file_t trace;
+    if (trace_file_load(argv[arg], &trace) != 0) {
+        return 1;
+    }
+
+    call_list_t list = { 0 };
+    trace_file_for_each(&trace, collect_record, &list);
+    if (list.failed) {
+        fprintf(stderr, "kora_replay: out of memory\n");
+        return 1;
+    }
+    if (list.count == 0) {
+        fprintf(stderr, "kora_replay: %s: no calls recorded\n", argv[arg]);
+        return 1;
+    }
+    qsort(list.calls, list.count, sizeof(*list.calls), cmp_start);
+
+    replay_t *r = calloc(1, sizeof(*r));
+    if (r == NULL || enter_sandbox(argv[arg + 1]) != 0) {
+        return 1;
+    }
+    size_t created = prepare_sandbox(&list);
+    printf("replaying %zu calls in %s%s, %zu paths prepared\n\n", list.count, sandbox,
+           timed ? " with recorded timing" : "", created);
+
+    uint64_t elapsed = replay(r, &list, timed);
+    report(r, &list, elapsed);
+
+    free(r->scratch);
+    free(r);
+    free(list.calls);
+    trace_file_free(&trace);
+    return 0;
+}
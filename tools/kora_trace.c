@@ -0,0 +1,321 @@
+/**
+ * Trace file decoder
+ *
+ * Reads a file written by kora_trace_start (or KORA_TRACE=path) and
+ * prints every call, a per-call summary of counts, errors and latency
+ * percentiles sorted by total time, or a Chrome Trace Event JSON
+ * timeline for chrome://tracing and ui.perfetto.dev.
+ *
+ * Usage: kora_trace dump <file>
+ *        kora_trace summary <file>
+ *        kora_trace chrome <file> [output.json]
+ */
+
+#include "trace_file.h"
+
+#include <kora/syscalls.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* A call counts as blocking when most of it, and at least this much, was off-CPU */
+#define BLOCKED_MIN_NS 1000
+
+static uint64_t blocked_ns(const kora_trace_record_t *rec) {
+    return rec->duration_ns > rec->cpu_ns ? rec->duration_ns - rec->cpu_ns : 0;
+}
+
+static int is_blocking(const kora_trace_record_t *rec) {
+    uint64_t blocked = blocked_ns(rec);
+    return blocked >= BLOCKED_MIN_NS && blocked > rec->cpu_ns;
+}
+
+static void print_name(int syscall) {
+    const char *name = kora_syscall_name(syscall);
+    if (name != NULL) {
+        printf("%s", name);
+    } else {
+        printf("syscall_%d", syscall);
+    }
+}
+
+/* Small values as signed decimals, anything that looks like an address in hex */
+static void print_value(uint64_t v) {
+    int64_t s = (int64_t)v;
+    if (s > -65536 && s < (int64_t)1 << 32) {
+        printf("%" PRId64, s);
+    } else {
+        printf("0x%" PRIx64, v);
+    }
+}
+
+static void dump_record(uint32_t tid, const kora_trace_record_t *rec,
+                        const uint64_t *args, const kora_trace_payload_t *payload,
+                        void *ctx) {
+    const kora_trace_header_t *header = ctx;
+    uint64_t rel = rec->start_ns - header->start_monotonic_ns;
+
+    printf("%7" PRIu32 " %6" PRIu64 ".%06" PRIu64 " ", tid, rel / 1000000000u, rel / 1000u % 1000000u);
+    print_name(rec->syscall);
+    printf("(");
+    const char *text = payload != NULL ? (const char *)(payload + 1) : NULL;
+    for (int i = 0; i < rec->nargs; i++) {
+        printf(i ? ", " : "");
+        if (text != NULL && i < 2 && payload->path_bytes[i] > 0) {
+            printf("\"%.*s\"", (int)payload->path_bytes[i], text);
+            text += payload->path_bytes[i];
+        } else {
+            print_value(args[i]);
+        }
+    }
+    printf(") = ");
+    print_value((uint64_t)rec->result);
+    if (rec->host_errno != 0) {
+        printf(" %s", strerror(rec->host_errno));
+    }
+    if (payload != NULL && payload->data_bytes > 0) {
+        printf(" #%016" PRIx64, payload->hash);
+    }
+    printf(" <%.6f cpu %.6f>\n", rec->duration_ns / 1e9, rec->cpu_ns / 1e9);
+}
+
+static int cmd_dump(trace_file_t *trace) {
+    trace_file_for_each(trace, dump_record, (void *)trace->header);
+    return 0;
+}
+
+typedef struct {
+    uint64_t count;
+    uint64_t errors;
+    uint64_t total_ns;
+    uint64_t blocked_ns;
+    uint64_t *durations;
+    size_t cap;
+} call_stats_t;
+
+typedef struct {
+    call_stats_t calls[UINT16_MAX + 1];
+    uint64_t records;
+} summary_t;
+
+static void summary_record(uint32_t tid, const kora_trace_record_t *rec,
+                           const uint64_t *args, const kora_trace_payload_t *payload,
+                           void *ctx) {
+    (void)tid; (void)args; (void)payload;
+    summary_t *sum = ctx;
+    call_stats_t *c = &sum->calls[rec->syscall];
+
+    if (c->count == c->cap) {
+        c->cap = c->cap ? c->cap * 2 : 64;
+        c->durations = realloc(c->durations, c->cap * sizeof(*c->durations));
+        if (c->durations == NULL) {
+            fprintf(stderr, "kora_trace: out of memory\n");
+            exit(1);
+        }
+    }
+    c->durations[c->count++] = rec->duration_ns;
+    c->total_ns += rec->duration_ns;
+    c->blocked_ns += blocked_ns(rec);
+    c->errors += rec->result == -1 || rec->host_errno != 0;
+    sum->records++;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static summary_t *sort_ctx;
+
+static int cmp_total(const void *a, const void *b) {
+    uint64_t x = sort_ctx->calls[*(const int *)a].total_ns;
+    uint64_t y = sort_ctx->calls[*(const int *)b].total_ns;
+    return x < y ? 1 : x > y ? -1 : 0;
+}
+
+static uint64_t percentile(const call_stats_t *c, unsigned pct) {
+    return c->durations[(c->count - 1) * pct / 100];
+}
+
+static int cmd_summary(trace_file_t *trace) {
+    summary_t *sum = calloc(1, sizeof(*sum));
+    int *order = malloc((UINT16_MAX + 1) * sizeof(*order));
+    int n = 0;
+    if (sum == NULL || order == NULL) {
+        fprintf(stderr, "kora_trace: out of memory\n");
+        return 1;
+    }
+
+    trace_file_for_each(trace, summary_record, sum);
+    for (int i = 0; i <= UINT16_MAX; i++) {
+        if (sum->calls[i].count > 0) {
+            qsort(sum->calls[i].durations, sum->calls[i].count, sizeof(uint64_t), cmp_u64);
+            order[n++] = i;
+        }
+    }
+    sort_ctx = sum;
+    qsort(order, (size_t)n, sizeof(*order), cmp_total);
+
+    printf("%-20s %10s %8s %12s %8s %10s %10s %10s %10s\n", "call", "count", "errors",
+           "total_us", "blocked", "mean_ns", "p50_ns", "p99_ns", "max_ns");
+    for (int i = 0; i < n; i++) {
+        call_stats_t *c = &sum->calls[order[i]];
+        const char *name = kora_syscall_name(order[i]);
+        char unknown[32];
+        if (name == NULL) {
+            snprintf(unknown, sizeof(unknown), "syscall_%d", order[i]);
+            name = unknown;
+        }
+        printf("%-20s %10" PRIu64 " %8" PRIu64 " %12.1f %7.1f%% %10" PRIu64 " %10" PRIu64
+               " %10" PRIu64 " %10" PRIu64 "\n",
+               name, c->count, c->errors, c->total_ns / 1e3,
+               c->total_ns ? 100.0 * c->blocked_ns / c->total_ns : 0.0, c->total_ns / c->count,
+               percentile(c, 50), percentile(c, 99), c->durations[c->count - 1]);
+        free(c->durations);
+    }
+
+    printf("\n%" PRIu64 " records", sum->records);
+    if (trace->end != NULL) {
+        printf(", %" PRIu64 " dropped, %.3f s traced\n", trace->end->dropped,
+               (trace->end->stop_monotonic_ns - trace->header->start_monotonic_ns) / 1e9);
+    } else {
+        printf(", trace was not stopped cleanly\n");
+    }
+
+    free(order);
+    free(sum);
+    return 0;
+}
+
+typedef struct {
+    FILE *out;
+    const kora_trace_header_t *header;
+    uint32_t *tids;     /* Threads already given a name */
+    size_t ntids;
+    size_t cap;
+} chrome_t;
+
+/* Microseconds since the start of the trace, to the nanosecond */
+static void chrome_time(FILE *out, uint64_t ns) {
+    fprintf(out, "%" PRIu64 ".%03" PRIu64, ns / 1000, ns % 1000);
+}
+
+static void chrome_thread(chrome_t *ch, uint32_t tid) {
+    for (size_t i = 0; i < ch->ntids; i++) {
+        if (ch->tids[i] == tid) {
+            return;
+        }
+    }
+    if (ch->ntids == ch->cap) {
+        ch->cap = ch->cap ? ch->cap * 2 : 16;
+        ch->tids = realloc(ch->tids, ch->cap * sizeof(*ch->tids));
+        if (ch->tids == NULL) {
+            fprintf(stderr, "kora_trace: out of memory\n");
+            exit(1);
+        }
+    }
+    ch->tids[ch->ntids++] = tid;
+    fprintf(ch->out, ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%" PRIu32
+            ",\"tid\":%" PRIu32 ",\"args\":{\"name\":\"%s%" PRIu32 "\"}}",
+            ch->header->pid, tid, tid == ch->header->pid ? "main " : "thread ", tid);
+}
+
+/*
+ * One complete ("X") event per call. Blocking calls get their own name
+ * suffix, category and colour so they stand apart from CPU-bound calls
+ * in both viewers; tdur carries the CPU share of every span.
+ */
+static void chrome_record(uint32_t tid, const kora_trace_record_t *rec,
+                          const uint64_t *args, const kora_trace_payload_t *payload,
+                          void *ctx) {
+    chrome_t *ch = ctx;
+    FILE *out = ch->out;
+    int blocking = is_blocking(rec);
+    const char *name = kora_syscall_name(rec->syscall);
+    (void)payload;
+
+    chrome_thread(ch, tid);
+
+    fprintf(out, ",\n{\"ph\":\"X\",\"pid\":%" PRIu32 ",\"tid\":%" PRIu32 ",\"name\":\"",
+            ch->header->pid, tid);
+    if (name != NULL) {
+        fprintf(out, "%s", name);
+    } else {
+        fprintf(out, "syscall_%d", rec->syscall);
+    }
+    fprintf(out, "%s\",\"cat\":\"%s\",\"cname\":\"%s\",\"ts\":",
+            blocking ? " (blocked)" : "", blocking ? "blocked" : "cpu",
+            blocking ? "thread_state_sleeping" : "thread_state_running");
+    chrome_time(out, rec->start_ns - ch->header->start_monotonic_ns);
+    fprintf(out, ",\"dur\":");
+    chrome_time(out, rec->duration_ns);
+    fprintf(out, ",\"tdur\":");
+    chrome_time(out, rec->cpu_ns < rec->duration_ns ? rec->cpu_ns : rec->duration_ns);
+    fprintf(out, ",\"args\":{\"result\":%" PRId64 ",\"errno\":%" PRId32
+            ",\"cpu_ns\":%" PRIu64 ",\"blocked_ns\":%" PRIu64 ",\"args\":[",
+            rec->result, rec->host_errno, rec->cpu_ns, blocked_ns(rec));
+    for (int i = 0; i < rec->nargs; i++) {
+        fprintf(out, "%s%" PRIu64, i ? "," : "", args[i]);
+    }
+    fprintf(out, "]}}");
+}
+
+static int cmd_chrome(trace_file_t *trace, const char *path) {
+    chrome_t ch = { stdout, trace->header, NULL, 0, 0 };
+    if (path != NULL && (ch.out = fopen(path, "w")) == NULL) {
+        fprintf(stderr, "kora_trace: %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+
+    fprintf(ch.out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n"
+            "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":%" PRIu32
+            ",\"args\":{\"name\":\"koralayer %" PRIu32 "\"}}",
+            trace->header->pid, trace->header->pid);
+    trace_file_for_each(trace, chrome_record, &ch);
+    fprintf(ch.out, "\n]}\n");
+
+    free(ch.tids);
+    if (ch.out != stdout && fclose(ch.out) != 0) {
+        fprintf(stderr, "kora_trace: %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+    return 0;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "usage: %s dump|summary <trace-file>\n"
+                    "       %s chrome <trace-file> [output.json]\n", prog, prog);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    int chrome = strcmp(argv[1], "chrome") == 0;
+    if (chrome ? argc > 4 : (argc != 3 || (strcmp(argv[1], "dump") != 0 &&
+                                           strcmp(argv[1], "summary") != 0))) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    trace_file_t trace;
+    if (trace_file_load(argv[2], &trace) != 0) {
+        return 1;
+    }
+
+    int ret;
+    if (chrome) {
+        ret = cmd_chrome(&trace, argc > 3 ? argv[3] : NULL);
+    } else if (strcmp(argv[1], "dump") == 0) {
+        ret = cmd_dump(&trace);
+    } else {
+        ret = cmd_summary(&trace);
+    }
+    trace_file_free(&trace);
+    return ret;
+}
@@ -0,0 +1,115 @@
+#include "trace_file.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int trace_file_load(const char *path, trace_file_t *trace) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        fprintf(stderr, "trace: %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    size_t cap = 1 << 20;
+    trace->data = malloc(cap);
+    trace->size = 0;
+    size_t n;
+    while (trace->data != NULL &&
+           (n = fread(trace->data + trace->size, 1, cap - trace->size, f)) > 0) {
+        trace->size += n;
+        if (trace->size == cap) {
+            unsigned char *grown = realloc(trace->data, cap * 2);
+            if (grown == NULL) {
+                free(trace->data);
+            }
+            trace->data = grown;
+            cap *= 2;
+        }
+    }
+    fclose(f);
+    if (trace->data == NULL) {
+        fprintf(stderr, "trace: out of memory\n");
+        return -1;
+    }
+
+    trace->header = (const kora_trace_header_t *)trace->data;
+    if (trace->size < sizeof(*trace->header) || trace->header->magic != KORA_TRACE_MAGIC) {
+        fprintf(stderr, "trace: %s: not a trace file\n", path);
+        trace_file_free(trace);
+        return -1;
+    }
+    if (trace->header->version != KORA_TRACE_VERSION) {
+        fprintf(stderr, "trace: %s: unsupported version %" PRIu32 "\n",
+                path, trace->header->version);
+        trace_file_free(trace);
+        return -1;
+    }
+    trace->end = NULL;
+    return 0;
+}
+
+void trace_file_for_each(trace_file_t *trace, trace_record_fn fn, void *ctx) {
+    size_t off = sizeof(kora_trace_header_t);
+
+    while (off + sizeof(kora_trace_chunk_t) <= trace->size) {
+        kora_trace_chunk_t chunk;
+        memcpy(&chunk, trace->data + off, sizeof(chunk));
+        off += sizeof(chunk);
+        if (chunk.bytes > trace->size - off) {
+            fprintf(stderr, "trace: truncated chunk at offset %zu\n", off);
+            return;
+        }
+
+        if (chunk.type == KORA_TRACE_CHUNK_END && chunk.bytes >= sizeof(kora_trace_end_t)) {
+            trace->end = (const kora_trace_end_t *)(trace->data + off);
+        } else if (chunk.type == KORA_TRACE_CHUNK_RECORDS) {
+            /* Everything read below is checked against the chunk first */
+            size_t end = off + chunk.bytes;
+            size_t pos = off;
+            for (uint32_t i = 0; i < chunk.count; i++) {
+                kora_trace_record_t rec;
+                uint64_t args[KORA_TRACE_MAX_ARGS];
+                if (end - pos < sizeof(rec)) {
+                    fprintf(stderr, "trace: corrupt record at offset %zu\n", pos);
+                    return;
+                }
+                memcpy(&rec, trace->data + pos, sizeof(rec));
+                pos += sizeof(rec);
+                if (rec.nargs > KORA_TRACE_MAX_ARGS || end - pos < rec.nargs * sizeof(uint64_t)) {
+                    fprintf(stderr, "trace: corrupt record at offset %zu\n", pos);
+                    return;
+                }
+                memcpy(args, trace->data + pos, rec.nargs * sizeof(uint64_t));
+                pos += rec.nargs * sizeof(uint64_t);
+                const kora_trace_payload_t *payload = NULL;
+                if (rec.flags & KORA_TRACE_F_PAYLOAD) {
+                    payload = (const kora_trace_payload_t *)(trace->data + pos);
+                    if (end - pos < sizeof(*payload) || end - pos < KORA_TRACE_PAYLOAD_SIZE(payload)) {
+                        fprintf(stderr, "trace: corrupt payload at offset %zu\n", pos);
+                        return;
+                    }
+                    pos += KORA_TRACE_PAYLOAD_SIZE(payload);
+                }
+                fn(chunk.tid, &rec, args, payload, ctx);
+            }
+        }
+        off += chunk.bytes;
+    }
+}
+
+const char *trace_file_path(const kora_trace_payload_t *payload, int i, size_t *len) {
+    const char *text = (const char *)(payload + 1);
+    if (i == 1) {
+        text += payload->path_bytes[0];
+    }
+    *len = payload->path_bytes[i];
+    return text;
+}
+
+void trace_file_free(trace_file_t *trace) {
+    free(trace->data);
+    trace->data = NULL;
+}
@@ -0,0 +1,36 @@
+/**
+ * Reader for trace files, shared by the tools
+ *
+ * The whole file is loaded into memory and walked in file order. Records
+ * of one thread are in time order; records of different threads are
+ * interleaved by chunk.
+ */
+
+#pragma once
+
+#include <kora/trace.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    unsigned char *data;
+    size_t size;
+    const kora_trace_header_t *header;
+    const kora_trace_end_t *end;   /* NULL if the trace was cut short */
+} trace_file_t;
+
+/** Called for every record; payload is NULL unless KORA_TRACE_F_PAYLOAD is set */
+typedef void (*trace_record_fn)(uint32_t tid, const kora_trace_record_t *rec,
+                                const uint64_t *args, const kora_trace_payload_t *payload,
+                                void *ctx);
+
+/** Load and check a trace file; prints the reason and returns -1, holding nothing, on failure */
+int trace_file_load(const char *path, trace_file_t *trace);
+
+/** Walk every record; sets trace->end when the final chunk is reached */
+void trace_file_for_each(trace_file_t *trace, trace_record_fn fn, void *ctx);
+
+/** Path argument i (0 or 1) of a record's payload, and its length */
+const char *trace_file_path(const kora_trace_payload_t *payload, int i, size_t *len);
+
+void trace_file_free(trace_file_t *trace);